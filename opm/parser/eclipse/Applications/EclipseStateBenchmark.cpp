@@ -0,0 +1,133 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+  Constructs a number of EclipseState instances - one per deck - first
+  sequentially and then concurrently, and reports the wall clock time
+  of both. Usage:
+
+     bench-eclipsestate [numStates=64] [deckFile]
+
+  If no deck file is given a synthetic deck with a 40x40x20 grid,
+  saturation tables and some EDIT keywords is used.
+*/
+
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opm/parser/eclipse/Parser/Parser.hpp>
+#include <opm/parser/eclipse/Deck/Deck.hpp>
+#include <opm/parser/eclipse/EclipseState/EclipseState.hpp>
+
+
+static std::string createDeckString(size_t deckIndex) {
+    const size_t nx = 40, ny = 40, nz = 20;
+    const size_t numCells = nx*ny*nz;
+    std::ostringstream deck;
+
+    deck << "RUNSPEC\n"
+         << "OIL\nWATER\nGAS\n"
+         << "TABDIMS\n1 /\n"
+         << "DIMENS\n" << nx << " " << ny << " " << nz << " /\n"
+         << "GRID\n"
+         << "DX\n" << numCells << "*10 /\n"
+         << "DY\n" << numCells << "*10 /\n"
+         << "DZ\n" << numCells << "*2 /\n"
+         << "TOPS\n" << nx*ny << "*1000 /\n"
+         << "PORO\n" << numCells << "*0.25 /\n"
+         << "PERMX\n" << numCells << "*100 /\n"
+         << "COPY\n  'PERMX' 'PERMY' /\n  'PERMX' 'PERMZ' /\n/\n"
+         << "MULTIPLY\n  'PERMZ' 0.1 /\n/\n"
+         << "EDIT\n"
+         << "PROPS\n"
+         << "SWOF\n"
+         << "  " << 0.1 + 0.001*deckIndex << " 0    1.0  2.0\n"
+         << "  0.5  0.3  0.3  0.5\n"
+         << "  0.9  0.9  0.0  0.0\n"
+         << "/\n"
+         << "SGOF\n"
+         << "  0.0  0.0  1.0  0.0\n"
+         << "  0.8  0.9  0.0  0.0\n"
+         << "/\n"
+         << "SWL\n" << numCells << "*0.15 /\n"
+         << "REGIONS\n"
+         << "SATNUM\n" << numCells << "*1 /\n"
+         << "SOLUTION\n"
+         << "SCHEDULE\n";
+
+    return deck.str();
+}
+
+
+template <class Function>
+static double timeIt(Function function) {
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+
+int main(int argc, char** argv) {
+    const size_t numStates = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 64;
+    Opm::ParserPtr parser(new Opm::Parser());
+
+    // Every state gets a deck of its own; a deck must not be shared
+    // between states which are constructed concurrently.
+    std::vector<Opm::DeckConstPtr> decks;
+    for (size_t i = 0; i < 2*numStates; i++) {
+        if (argc > 2)
+            decks.push_back( parser->parseFile( argv[2] , false ));
+        else
+            decks.push_back( parser->parseString( createDeckString( i ) ));
+    }
+
+    std::vector<Opm::EclipseStateConstPtr> states(2*numStates);
+    const double sequentialTime = timeIt([&]() {
+            for (size_t i = 0; i < numStates; i++)
+                states[i] = std::make_shared<const Opm::EclipseState>( decks[i] );
+        });
+
+    const double concurrentTime = timeIt([&]() {
+            std::vector<std::future<Opm::EclipseStateConstPtr> > futures;
+            for (size_t i = numStates; i < 2*numStates; i++) {
+                Opm::DeckConstPtr deck = decks[i];
+                futures.push_back( std::async( std::launch::async , [deck]() {
+                            return std::make_shared<const Opm::EclipseState>( deck );
+                        }));
+            }
+
+            for (size_t i = 0; i < numStates; i++)
+                states[numStates + i] = futures[i].get();
+        });
+
+    std::cout << "EclipseState construction, " << numStates << " states" << std::endl;
+    std::cout << "  sequential: " << sequentialTime << " s" << std::endl;
+    std::cout << "  concurrent: " << concurrentTime << " s" << std::endl;
+    std::cout << "  speedup:    " << sequentialTime / concurrentTime
+              << " (" << std::thread::hardware_concurrency() << " hardware threads)" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,144 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+  Measures the throughput of the kernels behind the GridProperty box
+  operators on a large property, and checks that the results are
+  bit-identical to a plain scalar loop over the index list of the
+  box. The kernels are called directly, since GridProperty does not
+  touch the cells at all when e.g. a constant property is scaled or
+  the full grid is copied. Usage:
+
+     bench-gridproperty [nx ny nz]
+
+  The default grid is 500 x 500 x 200, i.e. 50M cells.
+*/
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <opm/parser/eclipse/EclipseState/Grid/Box.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/GridPropertyKernels.hpp>
+
+
+template <class Function>
+static double timeIt(Function function) {
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+
+static void report(const std::string& name , size_t bytes , double kernelTime , double scalarTime) {
+    std::cout << "  " << name << ": "
+              << bytes / kernelTime * 1e-9 << " GB/s  (scalar index list: "
+              << bytes / scalarTime * 1e-9 << " GB/s)" << std::endl;
+}
+
+
+template <typename T>
+static bool identical(const std::vector<T>& v1 , const std::vector<T>& v2) {
+    return (v1.size() == v2.size()) && (std::memcmp( v1.data() , v2.data() , v1.size() * sizeof(T)) == 0);
+}
+
+
+template <typename T>
+static bool benchmark(const std::string& typeName , size_t nx , size_t ny , size_t nz , std::shared_ptr<const Opm::Box> box) {
+    std::vector<T> data( nx * ny * nz , T(1) );
+    std::vector<T> reference( data );
+    const std::vector<T> sourceData( nx * ny * nz , T(3) );
+    const std::vector<size_t> indexList = box->getIndexList();
+
+    // read + write of every cell in the box.
+    const size_t bytes = 2 * box->size() * sizeof(T);
+    bool ok = true;
+
+    std::cout << typeName << ", box with " << box->size() << " cells in " << box->numRuns() << " runs" << std::endl;
+    {
+        double kernelTime = timeIt([&]() { Opm::GridPropertyKernels::scale( data.data() , *box , T(3) ); });
+        double scalarTime = timeIt([&]() {
+                for (size_t i = 0; i < indexList.size(); i++)
+                    reference[indexList[i]] *= T(3);
+            });
+        report( "scale    " , bytes , kernelTime , scalarTime );
+        ok = ok && identical( data , reference );
+    }
+
+    {
+        double kernelTime = timeIt([&]() { Opm::GridPropertyKernels::add( data.data() , *box , T(7) ); });
+        double scalarTime = timeIt([&]() {
+                for (size_t i = 0; i < indexList.size(); i++)
+                    reference[indexList[i]] += T(7);
+            });
+        report( "add      " , bytes , kernelTime , scalarTime );
+        ok = ok && identical( data , reference );
+    }
+
+    {
+        double kernelTime = timeIt([&]() { Opm::GridPropertyKernels::setScalar( data.data() , *box , T(5) ); });
+        double scalarTime = timeIt([&]() {
+                for (size_t i = 0; i < indexList.size(); i++)
+                    reference[indexList[i]] = T(5);
+            });
+        report( "setScalar" , bytes / 2 , kernelTime , scalarTime );
+        ok = ok && identical( data , reference );
+    }
+
+    {
+        double kernelTime = timeIt([&]() { Opm::GridPropertyKernels::copy( data.data() , sourceData.data() , *box ); });
+        double scalarTime = timeIt([&]() {
+                for (size_t i = 0; i < indexList.size(); i++)
+                    reference[indexList[i]] = sourceData[indexList[i]];
+            });
+        report( "copyFrom " , bytes , kernelTime , scalarTime );
+        ok = ok && identical( data , reference );
+    }
+
+    if (!ok)
+        std::cout << "  ERROR: results differ from the scalar code" << std::endl;
+
+    return ok;
+}
+
+
+int main(int argc, char** argv) {
+    size_t nx = 500, ny = 500, nz = 200;
+    if (argc > 3) {
+        nx = std::strtoul( argv[1] , nullptr , 10 );
+        ny = std::strtoul( argv[2] , nullptr , 10 );
+        nz = std::strtoul( argv[3] , nullptr , 10 );
+    }
+
+    std::shared_ptr<const Opm::Box> globalBox = std::make_shared<const Opm::Box>( nx , ny , nz );
+    std::shared_ptr<const Opm::Box> subBox = std::make_shared<const Opm::Box>( *globalBox , 1 , nx - 2 , 1 , ny - 2 , 0 , nz - 1 );
+
+    bool ok = true;
+    ok = benchmark<double>( "double" , nx , ny , nz , globalBox ) && ok;
+    ok = benchmark<double>( "double" , nx , ny , nz , subBox ) && ok;
+    ok = benchmark<int>( "int" , nx , ny , nz , globalBox ) && ok;
+    ok = benchmark<int>( "int" , nx , ny , nz , subBox ) && ok;
+
+    return ok ? 0 : 1;
+}
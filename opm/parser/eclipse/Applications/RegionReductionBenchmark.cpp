@@ -0,0 +1,114 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+  Measures the time to reduce a double property and a weight property
+  per region, on a synthetic grid with 1000 box shaped regions and 10%
+  inactive cells, and checks the results against a plain sequential
+  loop. Usage:
+
+     bench-region-reduction [nx ny nz]
+
+  The default grid is 500 x 500 x 200, i.e. 50M cells.
+*/
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <opm/parser/eclipse/EclipseState/Grid/RegionReduction.hpp>
+
+
+template <class Function>
+static double timeIt(Function function) {
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+
+int main(int argc, char** argv) {
+    size_t nx = 500, ny = 500, nz = 200;
+    if (argc > 3) {
+        nx = std::strtoul( argv[1] , nullptr , 10 );
+        ny = std::strtoul( argv[2] , nullptr , 10 );
+        nz = std::strtoul( argv[3] , nullptr , 10 );
+    }
+    const size_t numCells = nx * ny * nz;
+
+    // 10 x 10 x 10 regions
+    auto regions = std::make_shared<std::vector<int> >( numCells );
+    auto values = std::make_shared<std::vector<double> >( numCells );
+    auto weights = std::make_shared<std::vector<double> >( numCells );
+    std::vector<int> actnum( numCells );
+    for (size_t k = 0; k < nz; k++) {
+        for (size_t j = 0; j < ny; j++) {
+            for (size_t i = 0; i < nx; i++) {
+                const size_t g = i + j*nx + k*nx*ny;
+                (*regions)[g] = static_cast<int>(1 + (10*i) / nx + 10*((10*j) / ny) + 100*((10*k) / nz));
+                (*values)[g] = 0.1 + 0.01 * (g % 23);
+                (*weights)[g] = 1000 + (g % 17);
+                actnum[g] = (g % 10) != 7;
+            }
+        }
+    }
+
+    std::shared_ptr<const std::vector<int> > regionData = regions;
+    std::shared_ptr<const std::vector<double> > valueData = values;
+    std::shared_ptr<const std::vector<double> > weightData = weights;
+    Opm::GridPropertyView<int> regionView( regionData );
+    Opm::GridPropertyView<double> valueView( valueData );
+    Opm::GridPropertyView<double> weightView( weightData );
+
+    std::unique_ptr<Opm::RegionReduction> reduction;
+    double time = timeIt([&]() {
+            reduction.reset( new Opm::RegionReduction( regionView , valueView , &weightView , actnum ));
+        });
+
+    std::cout << numCells << " cells, " << reduction->numRegions() << " regions: "
+              << time << " s  (" << numCells / time * 1e-6 << " Mcells/s)" << std::endl;
+
+    std::vector<double> sum( 1001 , 0 ) , weightedSum( 1001 , 0 );
+    time = timeIt([&]() {
+            for (size_t g = 0; g < numCells; g++) {
+                if (actnum[g]) {
+                    sum[(*regions)[g]] += (*values)[g];
+                    weightedSum[(*regions)[g]] += (*weights)[g] * (*values)[g];
+                }
+            }
+        });
+    std::cout << "Sequential reference loop: " << time << " s" << std::endl;
+
+    size_t errors = 0;
+    for (int region : reduction->getRegions()) {
+        const double weightedMean = weightedSum[region] / reduction->getWeightSum( region );
+        if (std::fabs( sum[region] - reduction->getSum( region )) > 1e-9 * std::fabs( sum[region] ) ||
+            std::fabs( weightedMean - reduction->getWeightedMean( region )) > 1e-9 * weightedMean)
+            errors++;
+    }
+
+    if (errors > 0)
+        std::cout << "ERROR: " << errors << " regions differ from the sequential loop" << std::endl;
+
+    return (errors == 0) ? 0 : 1;
+}
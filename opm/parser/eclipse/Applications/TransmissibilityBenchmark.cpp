@@ -0,0 +1,135 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+  Measures the time to compute the TRANX, TRANY and TRANZ
+  transmissibilities of a large synthetic corner point grid with
+  sloping layers, heterogeneous permeabilities and 10% inactive cells,
+  and checks a sample of the connections against a direct evaluation
+  of the two cells. Usage:
+
+     bench-transmissibility [nx ny nz]
+
+  The default grid is 250 x 200 x 200, i.e. 10M cells.
+*/
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <opm/parser/eclipse/EclipseState/Grid/CellGeometry.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/Transmissibility.hpp>
+
+
+template <class Function>
+static double timeIt(Function function) {
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+
+static void createGrid(size_t nx , size_t ny , size_t nz , std::vector<double>& coord , std::vector<double>& zcorn) {
+    const double dx = 50, dy = 50, dz = 2;
+    coord.clear();
+    coord.reserve( 6*(nx + 1)*(ny + 1) );
+    for (size_t j = 0; j <= ny; j++) {
+        for (size_t i = 0; i <= nx; i++) {
+            const double pillar[6] = { i*dx , j*dy , 0 , i*dx + 5 , j*dy , 1000 };
+            coord.insert( coord.end() , pillar , pillar + 6 );
+        }
+    }
+
+    zcorn.resize( 8*nx*ny*nz );
+    for (size_t k = 0; k < 2*nz; k++) {
+        const double layerDepth = 2000 + ((k + 1) / 2) * dz;
+        for (size_t j = 0; j < 2*ny; j++) {
+            for (size_t i = 0; i < 2*nx; i++) {
+                const double x = ((i + 1) / 2) * dx;
+                const double y = ((j + 1) / 2) * dy;
+                zcorn[(k*2*ny + j)*2*nx + i] = layerDepth + 0.01 * x + 10 * std::sin( y * 1e-3 );
+            }
+        }
+    }
+}
+
+
+int main(int argc, char** argv) {
+    size_t nx = 250, ny = 200, nz = 200;
+    if (argc > 3) {
+        nx = std::strtoul( argv[1] , nullptr , 10 );
+        ny = std::strtoul( argv[2] , nullptr , 10 );
+        nz = std::strtoul( argv[3] , nullptr , 10 );
+    }
+    const size_t numCells = nx * ny * nz;
+
+    std::vector<double> coord , zcorn;
+    createGrid( nx , ny , nz , coord , zcorn );
+
+    std::vector<int> actnum( numCells );
+    auto permx = std::make_shared<std::vector<double> >( numCells );
+    for (size_t g = 0; g < numCells; g++) {
+        actnum[g] = (g % 10) != 7;
+        (*permx)[g] = 1e-13 * (1 + (g % 13));
+    }
+
+    std::shared_ptr<const std::vector<double> > permxData = permx;
+    Opm::GridPropertyView<double> permxView( permxData );
+    Opm::GridPropertyView<double> permzView( numCells , 1e-14 );
+    Opm::GridPropertyView<double> ntgView( numCells , 0.8 );
+    Opm::TransMult transMult( nx , ny , nz );
+
+    std::unique_ptr<Opm::Transmissibility> trans;
+    double time = timeIt([&]() {
+            trans.reset( new Opm::Transmissibility( nx , ny , nz , coord , zcorn , actnum ,
+                                                    permxView , permxView , permzView , ntgView , transMult ));
+        });
+
+    std::cout << numCells << " cells, " << trans->size() << " connections: "
+              << time << " s  (" << numCells / time * 1e-6 << " Mcells/s)" << std::endl;
+
+    // Every 1000th connection is recomputed from the two cells.
+    const std::vector<int>& cell1 = trans->getCell1();
+    const std::vector<int>& cell2 = trans->getCell2();
+    size_t errors = 0;
+    for (size_t n = 0; n < trans->size(); n += 1000) {
+        const size_t g1 = cell1[n];
+        const size_t g2 = cell2[n];
+        const int d = (g2 - g1 == 1) ? 0 : ((g2 - g1 == nx) ? 1 : 2);
+        double factors1[6] , factors2[6];
+        Opm::CellGeometry::halfTransFactors( nx , ny , g1 % nx , (g1 / nx) % ny , g1 / (nx*ny) , coord.data() , zcorn.data() , factors1 );
+        Opm::CellGeometry::halfTransFactors( nx , ny , g2 % nx , (g2 / nx) % ny , g2 / (nx*ny) , coord.data() , zcorn.data() , factors2 );
+
+        const double ntg = (d < 2) ? 0.8 : 1.0;
+        const double t1 = ((d < 2) ? (*permx)[g1] : 1e-14) * ntg * factors1[2*d + 1];
+        const double t2 = ((d < 2) ? (*permx)[g2] : 1e-14) * ntg * factors2[2*d];
+        const double reference = t1 * t2 / (t1 + t2);
+        if (std::fabs( reference - trans->getTrans()[n] ) > 1e-12 * std::fabs( reference ))
+            errors++;
+    }
+
+    if (errors > 0)
+        std::cout << "ERROR: " << errors << " connections differ from the direct evaluation" << std::endl;
+
+    return (errors == 0) ? 0 : 1;
+}
@@ -198,17 +198,10 @@ namespace Opm {
     }
 
     bool Section::isSectionDelimiter(const std::string& keywordName) {
-        static std::set<std::string> sectionDelimiters;
-        if (sectionDelimiters.size() == 0) {
-            sectionDelimiters.insert("RUNSPEC");
-            sectionDelimiters.insert("GRID");
-            sectionDelimiters.insert("EDIT");
-            sectionDelimiters.insert("PROPS");
-            sectionDelimiters.insert("REGIONS");
-            sectionDelimiters.insert("SOLUTION");
-            sectionDelimiters.insert("SUMMARY");
-            sectionDelimiters.insert("SCHEDULE");
-        }
+        // initialized once in a thread safe manner; several sections
+        // may be created concurrently.
+        static const std::set<std::string> sectionDelimiters = {"RUNSPEC" , "GRID" , "EDIT" , "PROPS" ,
+                                                                "REGIONS" , "SOLUTION" , "SUMMARY" , "SCHEDULE"};
 
         return sectionDelimiters.count(keywordName) > 0;
     }
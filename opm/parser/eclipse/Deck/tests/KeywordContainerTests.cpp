@@ -84,7 +84,7 @@ BOOST_AUTO_TEST_CASE(getKeyword_outOfRange_throws) {
     KeywordContainerPtr container(new KeywordContainer());
     DeckKeywordPtr keyword = DeckKeywordPtr(new DeckKeyword("TRULS"));
     container->addKeyword(keyword);
-    BOOST_CHECK_THROW( container->getKeyword("TRULS" , 3) , std::out_of_range)
+    BOOST_CHECK_THROW( container->getKeyword("TRULS" , 3) , std::out_of_range);
 }
 
 
@@ -92,7 +92,7 @@ BOOST_AUTO_TEST_CASE(getKeywordList_notFound_throws) {
     KeywordContainerPtr container(new KeywordContainer());
     DeckKeywordPtr keyword = DeckKeywordPtr(new DeckKeyword("TRULS"));
     container->addKeyword(keyword);
-    BOOST_CHECK_THROW( container->getKeywordList("TRULSX") , std::invalid_argument)
+    BOOST_CHECK_THROW( container->getKeywordList("TRULSX") , std::invalid_argument);
 }
 
 BOOST_AUTO_TEST_CASE(getKeywordList_OK) {
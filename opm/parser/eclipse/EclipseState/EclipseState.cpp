@@ -25,14 +25,18 @@
 #include <opm/parser/eclipse/EclipseState/Schedule/ScheduleEnums.hpp>
 #include <opm/parser/eclipse/EclipseState/EclipseState.hpp>
 #include <opm/parser/eclipse/EclipseState/Grid/MULTREGTScanner.hpp>
+#include <opm/parser/eclipse/EclipseState/Util/TaskGraph.hpp>
 
+#include <cmath>
+#include <limits>
 #include <iostream>
 #include <sstream>
 #include <boost/algorithm/string/join.hpp>
 
 namespace Opm {
     
-    EclipseState::EclipseState(DeckConstPtr deck, bool beStrict)
+    EclipseState::EclipseState(DeckConstPtr deck, bool beStrict, bool parallelInit)
+        : m_dissolvedGas( false )
     {
         m_deckUnitSystem = deck->getActiveUnitSystem();
 
@@ -44,15 +48,29 @@ namespace Opm {
                                             + oss.str());
         }
 
-        initPhases(deck);
-        initTables(deck);
-        initEclipseGrid(deck);
-        initSchedule(deck);
-        initTitle(deck);
-        initProperties(deck);
-        initTransMult();
-        initFaults(deck);
-        initMULTREGT(deck);
+        /*
+          The initialization is expressed as a graph of stages with the
+          actual dependencies between them; when running in parallel the
+          independent stages - e.g. building the grid and the schedule -
+          will overlap. The stages are added in the order they are
+          executed in sequential mode.
+        */
+        TaskGraph initStages;
+        initStages.addTask("PHASES"     , [this , deck]() { initPhases(deck); });
+        initStages.addTask("TABLES"     , [this , deck]() { initTables(deck); });
+        initStages.addTask("GRID"       , [this , deck]() { initEclipseGrid(deck); });
+        initStages.addTask("SCHEDULE"   , [this , deck]() { initSchedule(deck); });
+        initStages.addTask("TITLE"      , [this , deck]() { initTitle(deck); });
+        initStages.addTask("PROPERTIES" , [this , deck]() { initProperties(deck); } , {"GRID" , "TABLES"});
+        initStages.addTask("TRANSMULT"  , [this]()        { initTransMult(); }      , {"PROPERTIES"});
+        // Both FAULTS and MULTREGT update the multipliers in the TransMult
+        // object; they must be applied one after the other.
+        initStages.addTask("FAULTS"     , [this , deck]() { initFaults(deck); }     , {"TRANSMULT"});
+        initStages.addTask("MULTREGT"   , [this , deck]() { initMULTREGT(deck); }   , {"FAULTS"});
+        // MINPV and PINCH update the ACTNUM of the grid.
+        initStages.addTask("MINPV"      , [this , deck]() { initMINPV(deck); }      , {"MULTREGT"});
+
+        initStages.run( parallelInit );
     }
 
     std::shared_ptr<const UnitSystem> EclipseState::getDeckUnitSystem() const {
@@ -151,6 +169,173 @@ namespace Opm {
         return m_transMult;
     }
 
+    /*
+      Reading the views first evaluates any pending edits, which
+      increments the revisions. An absent keyword, which is not
+      created here, has the revision numeric_limits<size_t>::max().
+    */
+    std::vector<size_t> EclipseState::getPropertyRevisions(const std::vector<std::string>& doubleKeywords ,
+                                                           const std::vector<std::string>& intKeywords) const {
+        std::vector<size_t> revisions;
+        for (auto iter = doubleKeywords.begin(); iter != doubleKeywords.end(); ++iter) {
+            if (hasDoubleGridProperty( *iter )) {
+                std::shared_ptr<GridProperty<double> > property = getDoubleGridProperty( *iter );
+                property->getView();
+                revisions.push_back( property->getRevision() );
+            } else
+                revisions.push_back( std::numeric_limits<size_t>::max() );
+        }
+
+        for (auto iter = intKeywords.begin(); iter != intKeywords.end(); ++iter) {
+            if (hasIntGridProperty( *iter )) {
+                std::shared_ptr<GridProperty<int> > property = getIntGridProperty( *iter );
+                property->getView();
+                revisions.push_back( property->getRevision() );
+            } else
+                revisions.push_back( std::numeric_limits<size_t>::max() );
+        }
+        return revisions;
+    }
+
+
+    /*
+      Concurrent calls with stale values may both compute the value;
+      they compute identical values and one of them is kept.
+    */
+    std::shared_ptr<const Transmissibility> EclipseState::getTransmissibility() const {
+        if (!hasDoubleGridProperty("PERMX") || !hasDoubleGridProperty("PERMY") || !hasDoubleGridProperty("PERMZ"))
+            throw std::invalid_argument("The transmissibilities can not be computed without PERMX, PERMY and PERMZ");
+
+        std::shared_ptr<const ActiveIndexMap> activeIndexMap = m_eclipseGrid->getActiveIndexMap();
+        std::vector<size_t> revisions = getPropertyRevisions( {"PERMX" , "PERMY" , "PERMZ" , "NTG"} , {} );
+        auto transmissibility = std::atomic_load( &m_transmissibility );
+        if (!transmissibility || transmissibility->activeIndexMap != activeIndexMap || transmissibility->revisions != revisions) {
+            auto newTransmissibility = std::make_shared<DerivedValue<Transmissibility> >();
+            newTransmissibility->activeIndexMap = activeIndexMap;
+            newTransmissibility->revisions = revisions;
+            std::vector<int> actnum;
+            m_eclipseGrid->exportACTNUM( actnum );
+            const size_t cartesianSize = m_eclipseGrid->getCartesianSize();
+            const GridPropertyView<double> ntg = hasDoubleGridProperty("NTG") ? getDoubleGridProperty("NTG")->getView() : GridPropertyView<double>( cartesianSize , 1.0 );
+            newTransmissibility->value = std::make_shared<const Transmissibility>( m_eclipseGrid->getNX() , m_eclipseGrid->getNY() , m_eclipseGrid->getNZ() ,
+                                                                                   m_eclipseGrid->getCOORD() , m_eclipseGrid->getZCORN() , actnum ,
+                                                                                   getDoubleGridProperty("PERMX")->getView() ,
+                                                                                   getDoubleGridProperty("PERMY")->getView() ,
+                                                                                   getDoubleGridProperty("PERMZ")->getView() ,
+                                                                                   ntg ,
+                                                                                   *m_transMult );
+            transmissibility = newTransmissibility;
+            std::atomic_store( &m_transmissibility , transmissibility );
+        }
+        return transmissibility->value;
+    }
+
+    std::shared_ptr<const NNC> EclipseState::getNNC() const {
+        std::shared_ptr<const ActiveIndexMap> activeIndexMap = m_eclipseGrid->getActiveIndexMap();
+        std::vector<size_t> revisions = getPropertyRevisions( {} , {"MULTNUM" , "FLUXNUM" , "OPERNUM"} );
+        auto nnc = std::atomic_load( &m_nnc );
+        if (!nnc || nnc->activeIndexMap != activeIndexMap || nnc->revisions != revisions) {
+            auto newNNC = std::make_shared<NNC>( *m_eclipseGrid );
+            newNNC->applyMULTREGT( m_multregtScanner , m_intGridProperties );
+
+            auto derivedNNC = std::make_shared<DerivedValue<NNC> >();
+            derivedNNC->activeIndexMap = activeIndexMap;
+            derivedNNC->revisions = revisions;
+            derivedNNC->value = newNNC;
+            nnc = derivedNNC;
+            std::atomic_store( &m_nnc , nnc );
+        }
+        return nnc->value;
+    }
+
+    std::shared_ptr<const CellAdjacency> EclipseState::getCellAdjacency() const {
+        auto transmissibility = getTransmissibility();
+        auto nnc = getNNC();
+        auto cellAdjacency = std::atomic_load( &m_cellAdjacency );
+        if (!cellAdjacency || cellAdjacency->transmissibility != transmissibility || cellAdjacency->nnc != nnc) {
+            std::vector<double> nncTrans;
+            const size_t cartesianSize = m_eclipseGrid->getCartesianSize();
+            const GridPropertyView<double> ntg = hasDoubleGridProperty("NTG") ? getDoubleGridProperty("NTG")->getView() : GridPropertyView<double>( cartesianSize , 1.0 );
+            Transmissibility::computeNNCTrans( m_eclipseGrid->getNX() , m_eclipseGrid->getNY() , *nnc , *m_eclipseGrid->getCellGeometry() ,
+                                               getDoubleGridProperty("PERMX")->getView() ,
+                                               getDoubleGridProperty("PERMY")->getView() ,
+                                               ntg ,
+                                               *m_nncTransMult ,
+                                               nncTrans );
+
+            auto newCellAdjacency = std::make_shared<CellAdjacencyValue>();
+            newCellAdjacency->transmissibility = transmissibility;
+            newCellAdjacency->nnc = nnc;
+            newCellAdjacency->value = std::make_shared<const CellAdjacency>( *m_eclipseGrid->getActiveIndexMap() , *transmissibility , *nnc , nncTrans );
+            cellAdjacency = newCellAdjacency;
+            std::atomic_store( &m_cellAdjacency , cellAdjacency );
+        }
+        return cellAdjacency->value;
+    }
+
+    std::shared_ptr<const std::vector<double> > EclipseState::getPoreVolume() const {
+        std::shared_ptr<const ActiveIndexMap> activeIndexMap = m_eclipseGrid->getActiveIndexMap();
+        std::vector<size_t> revisions = getPropertyRevisions( {"PORO" , "NTG" , "MULTPV" , "PORV"} , {} );
+        auto poreVolume = std::atomic_load( &m_poreVolume );
+        if (!poreVolume || poreVolume->activeIndexMap != activeIndexMap || poreVolume->revisions != revisions) {
+            const bool hasPORV = hasDoubleGridProperty("PORV");
+            if (!hasPORV && !hasDoubleGridProperty("PORO"))
+                throw std::invalid_argument("The pore volume can not be computed without PORV or PORO");
+
+            const size_t cartesianSize = m_eclipseGrid->getCartesianSize();
+            const GridPropertyView<double> poro = hasDoubleGridProperty("PORO") ? getDoubleGridProperty("PORO")->getView() : GridPropertyView<double>( cartesianSize , std::nan("") );
+            const GridPropertyView<double> ntg = hasDoubleGridProperty("NTG") ? getDoubleGridProperty("NTG")->getView() : GridPropertyView<double>( cartesianSize , 1.0 );
+            const GridPropertyView<double> multpv = hasDoubleGridProperty("MULTPV") ? getDoubleGridProperty("MULTPV")->getView() : GridPropertyView<double>( cartesianSize , 1.0 );
+            std::unique_ptr<GridPropertyView<double> > porv;
+            if (hasPORV)
+                porv.reset( new GridPropertyView<double>( getDoubleGridProperty("PORV")->getView() ));
+
+            auto newPoreVolume = std::make_shared<std::vector<double> >();
+            MinpvProcessor::computePoreVolume( *m_eclipseGrid->getCellGeometry() , poro , ntg , multpv , porv.get() , *newPoreVolume );
+
+            auto derivedPoreVolume = std::make_shared<DerivedValue<std::vector<double> > >();
+            derivedPoreVolume->activeIndexMap = activeIndexMap;
+            derivedPoreVolume->revisions = revisions;
+            derivedPoreVolume->value = newPoreVolume;
+            poreVolume = derivedPoreVolume;
+            std::atomic_store( &m_poreVolume , poreVolume );
+        }
+        return poreVolume->value;
+    }
+
+    const std::vector< std::pair<size_t , size_t> >& EclipseState::getPinchConnections() const {
+        return m_pinchConnections;
+    }
+
+    RegionReduction EclipseState::getRegionReduction(const std::string& regionKeyword , const std::string& keyword ,
+                                                     const std::string& weightKeyword , bool activeOnly) const {
+        if (!hasDoubleGridProperty( keyword ))
+            throw std::invalid_argument("The region reduction needs the keyword " + keyword);
+
+        return getRegionReduction( regionKeyword , getDoubleGridProperty( keyword )->getView() , weightKeyword , activeOnly );
+    }
+
+    RegionReduction EclipseState::getRegionReduction(const std::string& regionKeyword , const GridPropertyView<double>& values ,
+                                                     const std::string& weightKeyword , bool activeOnly) const {
+        // The keywords are not created here, since this is a const
+        // method which may run concurrently.
+        if (!hasIntGridProperty( regionKeyword ))
+            throw std::invalid_argument("The region reduction needs the region keyword " + regionKeyword);
+
+        if (!weightKeyword.empty() && !hasDoubleGridProperty( weightKeyword ))
+            throw std::invalid_argument("The region reduction needs the weight keyword " + weightKeyword);
+
+        std::vector<int> actnum;
+        if (activeOnly)
+            m_eclipseGrid->exportACTNUM( actnum );
+
+        std::unique_ptr<GridPropertyView<double> > weights;
+        if (!weightKeyword.empty())
+            weights.reset( new GridPropertyView<double>( getDoubleGridProperty( weightKeyword )->getView() ));
+
+        return RegionReduction( getIntGridProperty( regionKeyword )->getView() , values , weights.get() , actnum );
+    }
+
     std::string EclipseState::getTitle() const {
         return m_title;
     }
@@ -286,13 +471,54 @@ namespace Opm {
             }
         }
 
+        m_nncTransMult = std::make_shared<const TransMult>( *m_transMult );
         m_transMult->applyMULTREGT( scanner , m_intGridProperties);
+        m_multregtScanner = scanner;
     }
     
 
 
+    void EclipseState::initMINPV(DeckConstPtr deck) {
+        if (!m_eclipseGrid->isMinpvActive() && !m_eclipseGrid->isPinchActive())
+            return;
+
+        MinpvProcessor::PinchOptions pinch;
+        if (m_eclipseGrid->isPinchActive()) {
+            DeckRecordConstPtr pinchRecord = deck->getKeyword("PINCH")->getRecord(0);
+            pinch.active = true;
+            pinch.thresholdThickness = m_eclipseGrid->getPinchThresholdThickness();
+            pinch.gap = (pinchRecord->getItem("CONTROL_OPTION")->getString(0) != "NOGAP");
+            pinch.maxEmptyGap = pinchRecord->getItem("MAX_EMPTY_GAP")->getSIDouble(0);
+        }
+
+        // MINPV is skipped when the pore volume can not be computed.
+        double minpv = 0;
+        std::shared_ptr<const std::vector<double> > poreVolume = std::make_shared<const std::vector<double> >();
+        if (m_eclipseGrid->isMinpvActive() && (hasDoubleGridProperty("PORV") || hasDoubleGridProperty("PORO"))) {
+            minpv = m_eclipseGrid->getMinpvValue();
+            poreVolume = getPoreVolume();
+        }
+
+        std::vector<int> actnum;
+        m_eclipseGrid->exportACTNUM( actnum );
+        MinpvProcessor processor( m_eclipseGrid->getNX() , m_eclipseGrid->getNY() , m_eclipseGrid->getNZ() ,
+                                  m_eclipseGrid->getZCORN() , actnum , *poreVolume , minpv , pinch );
+
+        // Resetting ACTNUM invalidates the active index map and the
+        // values derived from it, so it is skipped when no cell changed.
+        const std::vector<int>& newActnum = processor.getACTNUM();
+        bool changed = false;
+        for (size_t g = 0; g < newActnum.size() && !changed; g++)
+            changed = ((newActnum[g] > 0) != (actnum.empty() || actnum[g] > 0));
+
+        if (changed)
+            m_eclipseGrid->resetACTNUM( newActnum.data() );
+        m_pinchConnections = processor.getPinchConnections();
+    }
+
+
     void EclipseState::initEclipseGrid(DeckConstPtr deck) {
-        m_eclipseGrid = EclipseGridConstPtr( new EclipseGrid( deck ));
+        m_eclipseGrid = EclipseGridPtr( new EclipseGrid( deck ));
     }
 
 
@@ -305,6 +531,8 @@ namespace Opm {
 
         if (deck->hasKeyword("WATER"))
             phases.insert(Phase::PhaseEnum::WATER);
+
+        m_dissolvedGas = deck->hasKeyword("DISGAS");
     }
 
 
@@ -312,6 +540,11 @@ namespace Opm {
          return (phases.count(phase) == 1);
     }
 
+
+    bool EclipseState::hasDissolvedGas() const {
+        return m_dissolvedGas;
+    }
+
     void EclipseState::initTitle(DeckConstPtr deck){
         if (deck->hasKeyword("TITLE")) {
             DeckKeywordConstPtr titleKeyword = deck->getKeyword("TITLE");
@@ -385,6 +618,10 @@ namespace Opm {
         return m_doubleGridProperties->getKeyword( keyword );
     }
 
+    std::shared_ptr<const RegionIndex> EclipseState::getRegionIndex( const std::string& keyword ) const {
+        return m_intGridProperties->getRegionIndex( keyword );
+    }
+
     
     
     void EclipseState::loadGridPropertyFromDeckKeyword(std::shared_ptr<const Box> inputBox , DeckKeywordConstPtr deckKeyword, int enabledTypes) {
@@ -406,205 +643,162 @@ namespace Opm {
         
     
 
-    void EclipseState::initProperties(DeckConstPtr deck) {
+    namespace {
         typedef GridProperties<int>::SupportedKeywordInfo SupportedIntKeywordInfo;
-        static std::vector<SupportedIntKeywordInfo> supportedIntKeywords =
-            {SupportedIntKeywordInfo( "SATNUM" , 1, "1" ),
-             SupportedIntKeywordInfo( "IMBNUM" , 1, "1" ),
-             SupportedIntKeywordInfo( "PVTNUM" , 1, "1" ),
-             SupportedIntKeywordInfo( "EQLNUM" , 1, "1" ),
-             SupportedIntKeywordInfo( "ENDNUM" , 1, "1" ),
-             SupportedIntKeywordInfo( "FLUXNUM" , 1 , "1" ),
-             SupportedIntKeywordInfo( "MULTNUM", 1 , "1" ),
-             SupportedIntKeywordInfo( "FIPNUM" , 1, "1" )};
-
-        double nan = std::numeric_limits<double>::quiet_NaN();
-        const auto eptLookup = std::make_shared<GridPropertyEndpointTableLookupInitializer<>>(*deck, *this);
-
-        // Note that the variants of grid keywords for radial grids
-        // are not supported. (and hopefully never will be)
         typedef GridProperties<double>::SupportedKeywordInfo SupportedDoubleKeywordInfo;
-        static std::vector<SupportedDoubleKeywordInfo> supportedDoubleKeywords = {
+
+        /*
+          The registry of supported grid property keywords is built
+          once, in a thread safe manner, and is never modified. It only
+          contains information which is independent of the deck and the
+          EclipseState; the initializers which need to look at the
+          state - i.e. the endpoint scaling keywords - are bound per
+          EclipseState in initProperties().
+        */
+        const std::vector<SupportedIntKeywordInfo>& supportedIntKeywords() {
+            static const std::vector<SupportedIntKeywordInfo> keywords =
+                {SupportedIntKeywordInfo( "SATNUM" , 1, "1" ),
+                 SupportedIntKeywordInfo( "IMBNUM" , 1, "1" ),
+                 SupportedIntKeywordInfo( "PVTNUM" , 1, "1" ),
+                 SupportedIntKeywordInfo( "EQLNUM" , 1, "1" ),
+                 SupportedIntKeywordInfo( "ENDNUM" , 1, "1" ),
+                 SupportedIntKeywordInfo( "FLUXNUM" , 1 , "1" ),
+                 SupportedIntKeywordInfo( "MULTNUM", 1 , "1" ),
+                 SupportedIntKeywordInfo( "FIPNUM" , 1, "1" )};
+
+            return keywords;
+        }
+
+
+        // The endpoint scaling keywords are all dimensionless and
+        // initialized from the saturation tables of the state.
+        const std::vector<std::string>& endpointScalingKeywords() {
+            static const std::vector<std::string> keywords = {
             // keywords to specify the scaled connate gas
             // saturations.
-            SupportedDoubleKeywordInfo( "SGL"    , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISGL"   , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SGLX"   , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SGLX-"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISGLX"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISGLX-" , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SGLY"   , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SGLY-"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISGLY"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISGLY-" , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SGLZ"   , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SGLZ-"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISGLZ"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISGLZ-" , eptLookup, "1" ),
+            "SGL" , "ISGL" , "SGLX" , "SGLX-" , "ISGLX" , "ISGLX-" , "SGLY" ,
+            "SGLY-" , "ISGLY" , "ISGLY-" , "SGLZ" , "SGLZ-" , "ISGLZ" , "ISGLZ-" ,
 
             // keywords to specify the connate water saturation.
-            SupportedDoubleKeywordInfo( "SWL"    , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISWL"   , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SWLX"   , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SWLX-"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISWLX"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISWLX-" , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SWLY"   , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SWLY-"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISWLY"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISWLY-" , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SWLZ"   , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SWLZ-"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISWLZ"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISWLZ-" , eptLookup, "1" ),
+            "SWL" , "ISWL" , "SWLX" , "SWLX-" , "ISWLX" , "ISWLX-" , "SWLY" ,
+            "SWLY-" , "ISWLY" , "ISWLY-" , "SWLZ" , "SWLZ-" , "ISWLZ" , "ISWLZ-" ,
 
             // keywords to specify the maximum gas saturation.
-            SupportedDoubleKeywordInfo( "SGU"    , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISGU"   , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SGUX"   , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SGUX-"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISGUX"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISGUX-" , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SGUY"   , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SGUY-"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISGUY"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISGUY-" , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SGUZ"   , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SGUZ-"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISGUZ"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISGUZ-" , eptLookup, "1" ),
+            "SGU" , "ISGU" , "SGUX" , "SGUX-" , "ISGUX" , "ISGUX-" , "SGUY" ,
+            "SGUY-" , "ISGUY" , "ISGUY-" , "SGUZ" , "SGUZ-" , "ISGUZ" , "ISGUZ-" ,
 
             // keywords to specify the maximum water saturation.
-            SupportedDoubleKeywordInfo( "SWU"    , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISWU"   , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SWUX"   , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SWUX-"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISWUX"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISWUX-" , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SWUY"   , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SWUY-"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISWUY"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISWUY-" , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SWUZ"   , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SWUZ-"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISWUZ"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISWUZ-" , eptLookup, "1" ),
+            "SWU" , "ISWU" , "SWUX" , "SWUX-" , "ISWUX" , "ISWUX-" , "SWUY" ,
+            "SWUY-" , "ISWUY" , "ISWUY-" , "SWUZ" , "SWUZ-" , "ISWUZ" , "ISWUZ-" ,
 
             // keywords to specify the scaled critical gas
             // saturation.
-            SupportedDoubleKeywordInfo( "SGCR"     , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISGCR"    , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SGCRX"    , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SGCRX-"   , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISGCRX"   , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISGCRX-"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SGCRY"    , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SGCRY-"   , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISGCRY"   , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISGCRY-"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SGCRZ"    , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SGCRZ-"   , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISGCRZ"   , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISGCRZ-"  , eptLookup, "1" ),
+            "SGCR" , "ISGCR" , "SGCRX" , "SGCRX-" , "ISGCRX" , "ISGCRX-" , "SGCRY" ,
+            "SGCRY-" , "ISGCRY" , "ISGCRY-" , "SGCRZ" , "SGCRZ-" , "ISGCRZ" , "ISGCRZ-" ,
 
             // keywords to specify the scaled critical oil-in-water
             // saturation.
-            SupportedDoubleKeywordInfo( "SOWCR"    , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISOWCR"   , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SOWCRX"   , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SOWCRX-"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISOWCRX"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISOWCRX-" , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SOWCRY"   , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SOWCRY-"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISOWCRY"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISOWCRY-" , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SOWCRZ"   , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SOWCRZ-"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISOWCRZ"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISOWCRZ-" , eptLookup, "1" ),
+            "SOWCR" , "ISOWCR" , "SOWCRX" , "SOWCRX-" , "ISOWCRX" , "ISOWCRX-" , "SOWCRY" ,
+            "SOWCRY-" , "ISOWCRY" , "ISOWCRY-" , "SOWCRZ" , "SOWCRZ-" , "ISOWCRZ" , "ISOWCRZ-" ,
 
             // keywords to specify the scaled critical oil-in-gas
             // saturation.
-            SupportedDoubleKeywordInfo( "SOGCR"    , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISOGCR"   , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SOGCRX"   , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SOGCRX-"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISOGCRX"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISOGCRX-" , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SOGCRY"   , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SOGCRY-"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISOGCRY"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISOGCRY-" , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SOGCRZ"   , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SOGCRZ-"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISOGCRZ"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISOGCRZ-" , eptLookup, "1" ),
+            "SOGCR" , "ISOGCR" , "SOGCRX" , "SOGCRX-" , "ISOGCRX" , "ISOGCRX-" , "SOGCRY" ,
+            "SOGCRY-" , "ISOGCRY" , "ISOGCRY-" , "SOGCRZ" , "SOGCRZ-" , "ISOGCRZ" , "ISOGCRZ-" ,
 
             // keywords to specify the scaled critical water
             // saturation.
-            SupportedDoubleKeywordInfo( "SWCR"     , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISWCR"    , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SWCRX"    , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SWCRX-"   , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISWCRX"   , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISWCRX-"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SWCRY"    , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SWCRY-"   , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISWCRY"   , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISWCRY-"  , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SWCRZ"    , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "SWCRZ-"   , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISWCRZ"   , eptLookup, "1" ),
-            SupportedDoubleKeywordInfo( "ISWCRZ-"  , eptLookup, "1" ),
-
-            // porosity
-            SupportedDoubleKeywordInfo( "PORO"  , nan, "1" ),
-
-            // pore volume
-            SupportedDoubleKeywordInfo( "PORV"  , nan, "Volume" ),
-
-            // pore volume multipliers
-            SupportedDoubleKeywordInfo( "MULTPV", 1.0, "1" ),
-
-            // the permeability keywords
-            SupportedDoubleKeywordInfo( "PERMX" , nan, "Permeability" ),
-            SupportedDoubleKeywordInfo( "PERMY" , nan, "Permeability" ),
-            SupportedDoubleKeywordInfo( "PERMZ" , nan, "Permeability" ),
-            SupportedDoubleKeywordInfo( "PERMXY", nan, "Permeability" ), // E300 only
-            SupportedDoubleKeywordInfo( "PERMXZ", nan, "Permeability" ), // E300 only
-            SupportedDoubleKeywordInfo( "PERMYZ", nan, "Permeability" ), // E300 only
-
-            // gross-to-net thickness (acts as a multiplier for PORO
-            // and the permeabilities in the X-Y plane as well as for
-            // the well rates.)
-            SupportedDoubleKeywordInfo( "NTG"   , 1.0, "1" ),
-
-            // transmissibility multipliers
-            SupportedDoubleKeywordInfo( "MULTX" , 1.0, "1" ),
-            SupportedDoubleKeywordInfo( "MULTY" , 1.0, "1" ),
-            SupportedDoubleKeywordInfo( "MULTZ" , 1.0, "1" ),
-            SupportedDoubleKeywordInfo( "MULTX-", 1.0, "1" ),
-            SupportedDoubleKeywordInfo( "MULTY-", 1.0, "1" ),
-            SupportedDoubleKeywordInfo( "MULTZ-", 1.0, "1" ),
-
-            // initialisation
-            SupportedDoubleKeywordInfo( "SWATINIT" , 0.0, "1")
-        };
+            "SWCR" , "ISWCR" , "SWCRX" , "SWCRX-" , "ISWCRX" , "ISWCRX-" , "SWCRY" ,
+            "SWCRY-" , "ISWCRY" , "ISWCRY-" , "SWCRZ" , "SWCRZ-" , "ISWCRZ" , "ISWCRZ-" 
+            };
+
+            return keywords;
+        }
+
+
+        // Note that the variants of grid keywords for radial grids
+        // are not supported. (and hopefully never will be)
+        const std::vector<SupportedDoubleKeywordInfo>& supportedConstantDoubleKeywords() {
+            static const double nan = std::numeric_limits<double>::quiet_NaN();
+            static const std::vector<SupportedDoubleKeywordInfo> keywords = {
+                // porosity
+                SupportedDoubleKeywordInfo( "PORO"  , nan, "1" ),
+
+                // pore volume
+                SupportedDoubleKeywordInfo( "PORV"  , nan, "Volume" ),
+
+                // pore volume multipliers
+                SupportedDoubleKeywordInfo( "MULTPV", 1.0, "1" ),
+
+                // the permeability keywords
+                SupportedDoubleKeywordInfo( "PERMX" , nan, "Permeability" ),
+                SupportedDoubleKeywordInfo( "PERMY" , nan, "Permeability" ),
+                SupportedDoubleKeywordInfo( "PERMZ" , nan, "Permeability" ),
+                SupportedDoubleKeywordInfo( "PERMXY", nan, "Permeability" ), // E300 only
+                SupportedDoubleKeywordInfo( "PERMXZ", nan, "Permeability" ), // E300 only
+                SupportedDoubleKeywordInfo( "PERMYZ", nan, "Permeability" ), // E300 only
+
+                // gross-to-net thickness (acts as a multiplier for PORO
+                // and the permeabilities in the X-Y plane as well as for
+                // the well rates.)
+                SupportedDoubleKeywordInfo( "NTG"   , 1.0, "1" ),
+
+                // transmissibility multipliers
+                SupportedDoubleKeywordInfo( "MULTX" , 1.0, "1" ),
+                SupportedDoubleKeywordInfo( "MULTY" , 1.0, "1" ),
+                SupportedDoubleKeywordInfo( "MULTZ" , 1.0, "1" ),
+                SupportedDoubleKeywordInfo( "MULTX-", 1.0, "1" ),
+                SupportedDoubleKeywordInfo( "MULTY-", 1.0, "1" ),
+                SupportedDoubleKeywordInfo( "MULTZ-", 1.0, "1" ),
+
+                // initialisation
+                SupportedDoubleKeywordInfo( "SWATINIT" , 0.0, "1")
+            };
+
+            return keywords;
+        }
+    }
+
+
+    void EclipseState::initProperties(DeckConstPtr deck) {
+        // bind the endpoint scaling keywords to the tables and grid of
+        // this state.
+        const auto eptLookup = std::make_shared<GridPropertyEndpointTableLookupInitializer<>>(*deck, *this);
+        std::vector<SupportedDoubleKeywordInfo> supportedDoubleKeywords;
+        {
+            const auto& endpointKeywords = endpointScalingKeywords();
+            const auto& constantKeywords = supportedConstantDoubleKeywords();
+
+            supportedDoubleKeywords.reserve( endpointKeywords.size() + constantKeywords.size() );
+            for (auto iter = endpointKeywords.begin(); iter != endpointKeywords.end(); ++iter)
+                supportedDoubleKeywords.push_back( SupportedDoubleKeywordInfo( *iter , eptLookup, "1" ));
+
+            supportedDoubleKeywords.insert( supportedDoubleKeywords.end() , constantKeywords.begin() , constantKeywords.end());
+        }
 
         // create the grid properties
         m_intGridProperties = std::make_shared<GridProperties<int> >(m_eclipseGrid->getNX(),
                                                                      m_eclipseGrid->getNY(),
                                                                      m_eclipseGrid->getNZ(),
-                                                                     supportedIntKeywords);
+                                                                     supportedIntKeywords());
         m_doubleGridProperties = std::make_shared<GridProperties<double> >(m_eclipseGrid->getNX(),
                                                                            m_eclipseGrid->getNY(),
                                                                            m_eclipseGrid->getNZ(),
                                                                            supportedDoubleKeywords);
 
+        // the EQUALS, MULTIPLY and ADD operations are recorded and
+        // evaluated fused when a property is first read.
+        m_intGridProperties->setDeferredEdits( true );
+        m_doubleGridProperties->setDeferredEdits( true );
+
         // first process all integer grid properties as these may be needed in order to
         // initialize the double properties
         processGridProperties(deck, /*enabledTypes=*/IntProperties);
+
+        // the region properties (SATNUM, FIPNUM, ...) are stored with 8
+        // or 16 bits per cell when their values allow it.
+        m_intGridProperties->compress();
+
         processGridProperties(deck, /*enabledTypes=*/DoubleProperties);
     }
 
@@ -27,6 +27,11 @@
 #include <opm/parser/eclipse/EclipseState/Grid/BoxManager.hpp>
 #include <opm/parser/eclipse/EclipseState/Grid/GridProperties.hpp>
 #include <opm/parser/eclipse/EclipseState/Grid/TransMult.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/Transmissibility.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/NNC.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/CellAdjacency.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/MinpvProcessor.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/RegionReduction.hpp>
 #include <opm/parser/eclipse/EclipseState/Schedule/ScheduleEnums.hpp>
 #include <opm/parser/eclipse/EclipseState/Grid/FaultCollection.hpp>
 
@@ -63,12 +68,20 @@ namespace Opm {
             AllProperties = IntProperties | DoubleProperties
         };
 
-        EclipseState(DeckConstPtr deck, bool beStrict = false);
+        /*
+          With parallelInit == true the independent parts of the
+          initialization (grid, tables, schedule, ...) are built
+          concurrently; the resulting state is identical to the one
+          created sequentially.
+        */
+        EclipseState(DeckConstPtr deck, bool beStrict = false, bool parallelInit = false);
 
         ScheduleConstPtr getSchedule() const;
         EclipseGridConstPtr getEclipseGrid() const;
         EclipseGridPtr getEclipseGridCopy() const;
         bool hasPhase(enum Phase::PhaseEnum phase) const;
+        // DISGAS, i.e. the oil may contain dissolved gas
+        bool hasDissolvedGas() const;
         std::string getTitle() const;
         bool supportsGridProperty(const std::string& keyword, int enabledTypes=AllProperties) const;
 
@@ -76,11 +89,37 @@ namespace Opm {
         std::shared_ptr<GridProperty<double> > getDoubleGridProperty( const std::string& keyword ) const;
         bool hasIntGridProperty(const std::string& keyword) const;
         bool hasDoubleGridProperty(const std::string& keyword) const;
+        // the cached cells per region of a region keyword like EQLNUM or FIPNUM
+        std::shared_ptr<const RegionIndex> getRegionIndex(const std::string& keyword) const;
 
         void loadGridPropertyFromDeckKeyword(std::shared_ptr<const Box> inputBox , DeckKeywordConstPtr deckKeyword, int enabledTypes = AllProperties);
 
         std::shared_ptr<const FaultCollection> getFaults() const;
         std::shared_ptr<const TransMult> getTransMult() const;
+        /*
+          The transmissibilities, NNCs and cell graph are computed on
+          first use, and computed again when ACTNUM or the properties
+          they are computed from have been modified since.
+        */
+        // computed from PERMX, PERMY, PERMZ, NTG and the multipliers
+        std::shared_ptr<const Transmissibility> getTransmissibility() const;
+        // detected from the grid geometry, with the MULTREGT multipliers
+        std::shared_ptr<const NNC> getNNC() const;
+        // the active cell graph with the transmissibilities of the connections and NNCs as weights
+        std::shared_ptr<const CellAdjacency> getCellAdjacency() const;
+
+        // the pore volume of all the cells, from PORV or PORO, NTG and MULTPV
+        std::shared_ptr<const std::vector<double> > getPoreVolume() const;
+        // the vertical connections across the cells deactivated by MINPV or
+        // PINCH; MINPV is ignored without PORV or PORO
+        const std::vector< std::pair<size_t , size_t> >& getPinchConnections() const;
+        // statistics of a double property per region of an int property, e.g. FIPNUM; the weights are
+        // optional. Throws std::invalid_argument if a keyword is not in the deck.
+        RegionReduction getRegionReduction(const std::string& regionKeyword , const std::string& keyword ,
+                                           const std::string& weightKeyword = "" , bool activeOnly = true) const;
+        // as above for values which are not a property, e.g. the pore volume; one value per cell
+        RegionReduction getRegionReduction(const std::string& regionKeyword , const GridPropertyView<double>& values ,
+                                           const std::string& weightKeyword = "" , bool activeOnly = true) const;
 
         // the tables used by the deck. If the tables had some defaulted data in the
         // deck, the objects returned here exhibit the correct values. If the table is
@@ -118,6 +157,7 @@ namespace Opm {
         void initProperties(DeckConstPtr deck);
         void initTransMult();
         void initFaults(DeckConstPtr deck);
+        void initMINPV(DeckConstPtr deck);
 
         template <class TableType>
         void initSimpleTables(DeckConstPtr deck,
@@ -186,7 +226,29 @@ namespace Opm {
         void copyIntKeyword(const std::string& srcField , const std::string& targetField , std::shared_ptr<const Box> inputBox);
         void copyDoubleKeyword(const std::string& srcField , const std::string& targetField , std::shared_ptr<const Box> inputBox);
 
-        EclipseGridConstPtr m_eclipseGrid;
+        // the revisions of the properties, with a missing property as the largest size_t
+        std::vector<size_t> getPropertyRevisions(const std::vector<std::string>& doubleKeywords ,
+                                                 const std::vector<std::string>& intKeywords) const;
+
+        /*
+          A value computed from the grid and some of the properties,
+          with the active cells and the property revisions it was
+          computed from.
+        */
+        template <typename T>
+        struct DerivedValue {
+            std::shared_ptr<const ActiveIndexMap> activeIndexMap;
+            std::vector<size_t> revisions;
+            std::shared_ptr<const T> value;
+        };
+
+        struct CellAdjacencyValue {
+            std::shared_ptr<const Transmissibility> transmissibility;
+            std::shared_ptr<const NNC> nnc;
+            std::shared_ptr<const CellAdjacency> value;
+        };
+
+        EclipseGridPtr m_eclipseGrid;
         ScheduleConstPtr schedule;
 
         std::vector<EnkrvdTable> m_enkrvdTables;
@@ -209,12 +271,21 @@ namespace Opm {
         std::vector<TlmixparTable> m_tlmixparTables;
 
         std::set<enum Phase::PhaseEnum> phases;
+        bool m_dissolvedGas;
         std::string m_title;
         std::shared_ptr<const UnitSystem> m_deckUnitSystem;
         std::shared_ptr<GridProperties<int> > m_intGridProperties;
         std::shared_ptr<GridProperties<double> > m_doubleGridProperties;
         std::shared_ptr<TransMult> m_transMult;
+        // the multipliers of m_transMult before MULTREGT, for the NNCs
+        std::shared_ptr<const TransMult> m_nncTransMult;
         std::shared_ptr<FaultCollection> m_faults;
+        std::shared_ptr<MULTREGTScanner> m_multregtScanner;
+        mutable std::shared_ptr<const DerivedValue<Transmissibility> > m_transmissibility;
+        mutable std::shared_ptr<const DerivedValue<NNC> > m_nnc;
+        mutable std::shared_ptr<const CellAdjacencyValue> m_cellAdjacency;
+        mutable std::shared_ptr<const DerivedValue<std::vector<double> > > m_poreVolume;
+        std::vector< std::pair<size_t , size_t> > m_pinchConnections;
     };
 
     typedef std::shared_ptr<EclipseState> EclipseStatePtr;
@@ -0,0 +1,130 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include <opm/parser/eclipse/EclipseState/Grid/ActiveIndexMap.hpp>
+
+namespace Opm {
+
+    /*
+      The map is built in two passes over blocks of cells: first the
+      active cells of every block are counted, then every block numbers
+      its active cells starting from the number of active cells in the
+      preceding blocks. The result is independent of the number of
+      threads.
+    */
+    ActiveIndexMap::ActiveIndexMap(size_t cartesianSize , const std::vector<int>& actnum)
+        : m_globalToActive( cartesianSize )
+    {
+        if (actnum.size() > 0 && actnum.size() != cartesianSize)
+            throw std::invalid_argument("Size mismatch between the ACTNUM vector and the grid");
+
+        if (cartesianSize > static_cast<size_t>(std::numeric_limits<int>::max()))
+            throw std::invalid_argument("The grid is too large for an active index map");
+
+        if (actnum.size() == 0) {
+            m_activeToGlobal.resize( cartesianSize );
+            for (size_t g = 0; g < cartesianSize; ++g) {
+                m_globalToActive[g] = static_cast<int>(g);
+                m_activeToGlobal[g] = static_cast<int>(g);
+            }
+            return;
+        }
+
+        const size_t blockSize = 1 << 14;
+        const long numBlocks = static_cast<long>((cartesianSize + blockSize - 1) / blockSize);
+        std::vector<size_t> blockOffset( numBlocks + 1 , 0 );
+
+#pragma omp parallel for schedule(static) if (cartesianSize >= parallelThreshold)
+        for (long blockIdx = 0; blockIdx < numBlocks; ++blockIdx) {
+            const size_t begin = blockIdx * blockSize;
+            const size_t end = std::min( begin + blockSize , cartesianSize );
+            size_t numActive = 0;
+            for (size_t g = begin; g < end; ++g)
+                if (actnum[g] != 0)
+                    numActive++;
+
+            blockOffset[blockIdx + 1] = numActive;
+        }
+
+        for (long blockIdx = 0; blockIdx < numBlocks; ++blockIdx)
+            blockOffset[blockIdx + 1] += blockOffset[blockIdx];
+
+        m_activeToGlobal.resize( blockOffset[numBlocks] );
+
+#pragma omp parallel for schedule(static) if (cartesianSize >= parallelThreshold)
+        for (long blockIdx = 0; blockIdx < numBlocks; ++blockIdx) {
+            const size_t begin = blockIdx * blockSize;
+            const size_t end = std::min( begin + blockSize , cartesianSize );
+            size_t activeIndex = blockOffset[blockIdx];
+            for (size_t g = begin; g < end; ++g) {
+                if (actnum[g] != 0) {
+                    m_globalToActive[g] = static_cast<int>(activeIndex);
+                    m_activeToGlobal[activeIndex] = static_cast<int>(g);
+                    activeIndex++;
+                } else
+                    m_globalToActive[g] = -1;
+            }
+        }
+    }
+
+
+    size_t ActiveIndexMap::getCartesianSize() const {
+        return m_globalToActive.size();
+    }
+
+
+    size_t ActiveIndexMap::getNumActive() const {
+        return m_activeToGlobal.size();
+    }
+
+
+    bool ActiveIndexMap::isActive(size_t globalIndex) const {
+        return getActiveIndex( globalIndex ) >= 0;
+    }
+
+
+    int ActiveIndexMap::getActiveIndex(size_t globalIndex) const {
+        if (globalIndex >= m_globalToActive.size())
+            throw std::invalid_argument("Global index out of range");
+
+        return m_globalToActive[globalIndex];
+    }
+
+
+    size_t ActiveIndexMap::getGlobalIndex(size_t activeIndex) const {
+        if (activeIndex >= m_activeToGlobal.size())
+            throw std::invalid_argument("Active index out of range");
+
+        return static_cast<size_t>(m_activeToGlobal[activeIndex]);
+    }
+
+
+    const std::vector<int>& ActiveIndexMap::getGlobalToActive() const {
+        return m_globalToActive;
+    }
+
+
+    const std::vector<int>& ActiveIndexMap::getActiveToGlobal() const {
+        return m_activeToGlobal;
+    }
+}
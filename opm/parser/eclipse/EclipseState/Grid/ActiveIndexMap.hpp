@@ -0,0 +1,98 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ACTIVE_INDEX_MAP_HPP_
+#define ACTIVE_INDEX_MAP_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <opm/parser/eclipse/EclipseState/Grid/GridPropertyView.hpp>
+#include <opm/parser/eclipse/EclipseState/Util/Parallel.hpp>
+
+/*
+  The ActiveIndexMap class maps between the global (cartesian) index
+  of a cell and its index among the active cells. The two directions
+  are stored as int arrays: globalToActive has one element per cell,
+  -1 for the inactive cells, and activeToGlobal has one element per
+  active cell.
+
+  The map is immutable; it is built once from the ACTNUM of an
+  EclipseGrid, see EclipseGrid::getActiveIndexMap(). Large grids are
+  processed multithreaded with OpenMP.
+*/
+
+namespace Opm {
+
+    class ActiveIndexMap {
+    public:
+        // An empty actnum vector means that all cells are active.
+        ActiveIndexMap(size_t cartesianSize , const std::vector<int>& actnum);
+
+        size_t getCartesianSize() const;
+        size_t getNumActive() const;
+
+        bool isActive(size_t globalIndex) const;
+        // -1 for an inactive cell.
+        int getActiveIndex(size_t globalIndex) const;
+        size_t getGlobalIndex(size_t activeIndex) const;
+
+        const std::vector<int>& getGlobalToActive() const;
+        const std::vector<int>& getActiveToGlobal() const;
+
+        /*
+          Gathers the values of the active cells, in the order of the
+          active index, from the values of a GridProperty or from an
+          array with one value per cell.
+        */
+        template <typename T>
+        std::vector<T> compress(const GridPropertyView<T>& values) const {
+            if (values.size() != getCartesianSize())
+                throw std::invalid_argument("Size mismatch when compressing property to the active cells");
+
+            const long numActive = static_cast<long>(getNumActive());
+            if (values.isConstant())
+                return std::vector<T>( numActive , values.getConstantValue() );
+
+            std::vector<T> compressed( numActive );
+            T* target = compressed.data();
+            const int* activeToGlobal = m_activeToGlobal.data();
+
+#pragma omp parallel for schedule(static) if (getNumActive() >= parallelThreshold)
+            for (long activeIndex = 0; activeIndex < numActive; ++activeIndex)
+                target[activeIndex] = values[ activeToGlobal[activeIndex] ];
+
+            return compressed;
+        }
+
+        template <typename T>
+        std::vector<T> compress(const std::vector<T>& values) const {
+            std::shared_ptr<const std::vector<T> > data( &values , [](const std::vector<T>*) { } );
+            return compress( GridPropertyView<T>( data ));
+        }
+
+    private:
+        std::vector<int> m_globalToActive;
+        std::vector<int> m_activeToGlobal;
+    };
+}
+
+#endif
@@ -46,7 +46,7 @@ namespace Opm {
         m_stride[2] = m_dims[0] * m_dims[1];
 
         m_isGlobal = true;
-        initIndexList();
+        initRuns();
     }
 
 
@@ -72,7 +72,7 @@ namespace Opm {
         else
             m_isGlobal = false;
         
-        initIndexList();
+        initRuns();
     }
     
 
@@ -103,32 +103,94 @@ namespace Opm {
     }
 
 
-    const std::vector<size_t>& Box::getIndexList() const {
-        return m_indexList;
+    std::vector<size_t> Box::getIndexList() const {
+        std::vector<size_t> indexList;
+        indexList.reserve( size() );
+
+        for (auto iter = runsBegin(); iter != runsEnd(); ++iter) {
+            const IndexRun run = *iter;
+            for (size_t g = run.begin; g < run.end; g++)
+                indexList.push_back( g );
+        }
+
+        return indexList;
     }
 
-    
-    void Box::initIndexList() {
-        m_indexList.resize( size() );
-        
-        size_t ii,ij,ik;
-        size_t l = 0;
-        
-        for (ik=0; ik < m_dims[2]; ik++) {
-            size_t k = ik + m_offset[2];
-            for (ij=0; ij < m_dims[1]; ij++) {
-                size_t j = ij + m_offset[1];
-                for (ii=0; ii < m_dims[0]; ii++) {
-                    size_t i = ii + m_offset[0];
-                    size_t g = i * m_stride[0] + j*m_stride[1] + k*m_stride[2];
-                    
-                    m_indexList[l] = g;
-                    l++;
-                }
-            }
+
+    void Box::initRuns() {
+        m_runLength = m_dims[0];
+
+        // Merge the rows when the box spans the full i range, and the
+        // layers when it also spans the full j range.
+        if (m_stride[1] == m_dims[0]) {
+            m_runLength *= m_dims[1];
+            if (m_stride[2] == m_dims[0] * m_dims[1])
+                m_runLength *= m_dims[2];
         }
+
+        m_numRuns = size() / m_runLength;
     }
 
+
+    size_t Box::numRuns() const {
+        return m_numRuns;
+    }
+
+
+    Box::IndexRun Box::getRun(size_t runIndex) const {
+        if (runIndex >= m_numRuns)
+            throw std::invalid_argument("The run index is out of range");
+
+        // The first cell of a run always has i == 0 in the local
+        // coordinates of the box.
+        size_t l  = runIndex * m_runLength;
+        size_t ij = (l / m_dims[0]) % m_dims[1];
+        size_t ik = l / (m_dims[0] * m_dims[1]);
+
+        IndexRun run;
+        run.begin = m_offset[0] * m_stride[0] + (ij + m_offset[1]) * m_stride[1] + (ik + m_offset[2]) * m_stride[2];
+        run.end = run.begin + m_runLength;
+        return run;
+    }
+
+
+    Box::RunIterator Box::runsBegin() const {
+        return RunIterator( *this , 0 );
+    }
+
+
+    Box::RunIterator Box::runsEnd() const {
+        return RunIterator( *this , m_numRuns );
+    }
+
+
+    Box::RunIterator::RunIterator(const Box& box , size_t runIndex)
+        : m_box( &box ),
+          m_runIndex( runIndex )
+    { }
+
+
+    Box::IndexRun Box::RunIterator::operator*() const {
+        return m_box->getRun( m_runIndex );
+    }
+
+
+    Box::RunIterator& Box::RunIterator::operator++() {
+        m_runIndex++;
+        return *this;
+    }
+
+
+    bool Box::RunIterator::operator==(const RunIterator& other) const {
+        return (m_box == other.m_box) && (m_runIndex == other.m_runIndex);
+    }
+
+
+    bool Box::RunIterator::operator!=(const RunIterator& other) const {
+        return !(*this == other);
+    }
+
+
     bool Box::equal(const Box& other) const {
         
         if (size() != other.size())
@@ -24,28 +24,70 @@
 #include <vector>
 #include <cstddef>
 
+/*
+  The cells of a box are visited as a sequence of runs, where each run
+  is a contiguous range [begin, end) of global indices. For a box which
+  does not span the full i range of the global grid every (j,k) row is
+  one run; when the full i range is covered the rows of a k-layer are
+  merged, and when the full i and j ranges are covered the whole box is
+  one run. The runs are ordered as the cells in the box, i.e. with the
+  i index running fastest, so the n'th cell visited is also the n'th
+  value of a deck keyword applied to the box.
+
+  The list of global indices is only created when explicitly asked for
+  with getIndexList(); iterating over the runs does not allocate.
+*/
+
 namespace Opm {
     
     class Box {
     public:
+        struct IndexRun {
+            size_t begin;
+            size_t end;
+
+            size_t size() const {
+                return end - begin;
+            }
+        };
+
+        class RunIterator {
+        public:
+            RunIterator(const Box& box , size_t runIndex);
+
+            IndexRun operator*() const;
+            RunIterator& operator++();
+            bool operator==(const RunIterator& other) const;
+            bool operator!=(const RunIterator& other) const;
+
+        private:
+            const Box* m_box;
+            size_t m_runIndex;
+        };
+
         Box(int nx , int ny , int nz);
         Box(const Box& globalBox , int i1 , int i2 , int j1 , int j2 , int k1 , int k2); // Zero offset coordinates.
         size_t size() const;
         bool   isGlobal() const;
         size_t getDim(size_t idim) const;
-        const std::vector<size_t>& getIndexList() const;
+        std::vector<size_t> getIndexList() const;
         bool equal(const Box& other) const;
 
+        size_t numRuns() const;
+        IndexRun getRun(size_t runIndex) const;
+        RunIterator runsBegin() const;
+        RunIterator runsEnd() const;
 
     private:
-        void initIndexList();
+        void initRuns();
         static void assertDims(const Box& globalBox, size_t idim , int l1 , int l2);
         size_t m_dims[3];
         size_t m_offset[3];
         size_t m_stride[3];
 
         bool   m_isGlobal;
-        std::vector<size_t> m_indexList;
+        size_t m_runLength;
+        size_t m_numRuns;
     };
 }
 
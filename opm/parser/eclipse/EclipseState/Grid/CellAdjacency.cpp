@@ -0,0 +1,271 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include <opm/parser/eclipse/EclipseState/Grid/CellAdjacency.hpp>
+#include <opm/parser/eclipse/EclipseState/Util/Parallel.hpp>
+
+namespace Opm {
+
+namespace {
+
+    /*
+      The Cartesian neighbours of a cell in increasing global index:
+      Z-, Y-, X-, X+, Y+, Z+. The slots of a cell record which of them
+      are connected.
+    */
+    const unsigned char minusSlot[3] = { 1 << 2 , 1 << 1 , 1 << 0 };
+    const unsigned char plusSlot[3] = { 1 << 3 , 1 << 4 , 1 << 5 };
+
+    int countSlots(unsigned char slots) {
+        int count = 0;
+        for (; slots; slots &= slots - 1)
+            count++;
+        return count;
+    }
+
+    // The number of connected slots in front of slot.
+    int slotOffset(unsigned char slots , unsigned char slot) {
+        return countSlots( slots & (slot - 1) );
+    }
+}
+
+
+    CellAdjacency::CellAdjacency(const ActiveIndexMap& activeIndexMap ,
+                                 const Transmissibility& transmissibility) {
+        build( activeIndexMap , transmissibility , nullptr , nullptr );
+    }
+
+
+    CellAdjacency::CellAdjacency(const ActiveIndexMap& activeIndexMap ,
+                                 const Transmissibility& transmissibility ,
+                                 const NNC& nnc ,
+                                 const std::vector<double>& nncWeights) {
+        if (nncWeights.size() != nnc.size())
+            throw std::invalid_argument("The number of NNC weights does not match the number of NNCs");
+
+        if (nnc.getCartesianSize() != activeIndexMap.getCartesianSize())
+            throw std::invalid_argument("The NNCs do not match the size of the grid");
+
+        build( activeIndexMap , transmissibility , &nnc , &nncWeights );
+    }
+
+
+    void CellAdjacency::build(const ActiveIndexMap& activeIndexMap ,
+                              const Transmissibility& transmissibility ,
+                              const NNC* nnc ,
+                              const std::vector<double>* nncWeights) {
+        const long numVertices = static_cast<long>(activeIndexMap.getNumActive());
+        const long cartesianSize = static_cast<long>(activeIndexMap.getCartesianSize());
+        const int* globalToActive = activeIndexMap.getGlobalToActive().data();
+        const int* cell1 = transmissibility.getCell1().data();
+        const int* cell2 = transmissibility.getCell2().data();
+        const double* trans = transmissibility.getTrans().data();
+        const bool parallel = (transmissibility.size() >= parallelThreshold);
+        const FaceDir::DirEnum directions[3] = { FaceDir::XPlus , FaceDir::YPlus , FaceDir::ZPlus };
+
+        {
+            const long numConnections = static_cast<long>(transmissibility.size());
+            long invalid = 0;
+#pragma omp parallel for schedule(static) reduction(+:invalid) if (parallel)
+            for (long n = 0; n < numConnections; n++) {
+                if (cell1[n] < 0 || cell1[n] >= cartesianSize || cell2[n] < 0 || cell2[n] >= cartesianSize)
+                    invalid++;
+                else if (globalToActive[cell1[n]] < 0 || globalToActive[cell2[n]] < 0)
+                    invalid++;
+            }
+
+            if (invalid > 0)
+                throw std::invalid_argument("The transmissibilities contain connections to inactive cells");
+        }
+
+        // Slots; the cells of one side of a direction are all different.
+        std::vector<unsigned char> slots( numVertices , 0 );
+        for (int d = 0; d < 3; d++) {
+            const std::pair<size_t , size_t> range = transmissibility.getConnectionRange( directions[d] );
+            const long begin = static_cast<long>(range.first);
+            const long end = static_cast<long>(range.second);
+
+#pragma omp parallel for schedule(static) if (parallel)
+            for (long n = begin; n < end; n++)
+                slots[ globalToActive[cell1[n]] ] |= plusSlot[d];
+
+#pragma omp parallel for schedule(static) if (parallel)
+            for (long n = begin; n < end; n++)
+                slots[ globalToActive[cell2[n]] ] |= minusSlot[d];
+        }
+
+        std::vector<size_t> rowSize( numVertices + 1 , 0 );
+#pragma omp parallel for schedule(static) if (parallel)
+        for (long v = 0; v < numVertices; v++)
+            rowSize[v + 1] = countSlots( slots[v] );
+
+        std::vector< std::pair<int , int> > nncVertices;
+        if (nnc) {
+            std::vector< std::pair<size_t , size_t> > connections;
+            nnc->exportConnections( connections );
+            nncVertices.resize( connections.size() );
+            for (size_t n = 0; n < connections.size(); n++) {
+                const int v1 = globalToActive[connections[n].first];
+                const int v2 = globalToActive[connections[n].second];
+                if (v1 < 0 || v2 < 0)
+                    throw std::invalid_argument("The NNCs contain connections to inactive cells");
+
+                nncVertices[n] = std::make_pair( v1 , v2 );
+                rowSize[v1 + 1]++;
+                rowSize[v2 + 1]++;
+            }
+        }
+
+        for (long v = 0; v < numVertices; v++)
+            rowSize[v + 1] += rowSize[v];
+
+        if (rowSize[numVertices] > static_cast<size_t>(std::numeric_limits<int>::max()))
+            throw std::invalid_argument("The adjacency graph is too large for int row pointers");
+
+        m_rowStart.assign( rowSize.begin() , rowSize.end() );
+        m_columns.resize( rowSize[numVertices] );
+        m_weights.resize( rowSize[numVertices] );
+
+        for (int d = 0; d < 3; d++) {
+            const std::pair<size_t , size_t> range = transmissibility.getConnectionRange( directions[d] );
+            const long begin = static_cast<long>(range.first);
+            const long end = static_cast<long>(range.second);
+
+#pragma omp parallel for schedule(static) if (parallel)
+            for (long n = begin; n < end; n++) {
+                const int v1 = globalToActive[cell1[n]];
+                const int v2 = globalToActive[cell2[n]];
+                const size_t position1 = m_rowStart[v1] + slotOffset( slots[v1] , plusSlot[d] );
+                const size_t position2 = m_rowStart[v2] + slotOffset( slots[v2] , minusSlot[d] );
+
+                m_columns[position1] = v2;
+                m_weights[position1] = trans[n];
+                m_columns[position2] = v1;
+                m_weights[position2] = trans[n];
+            }
+        }
+
+        if (!nncVertices.empty()) {
+            // The NNCs go behind the Cartesian neighbours, and the rows
+            // with NNCs are sorted afterwards.
+            std::vector<int> fill( numVertices );
+            for (long v = 0; v < numVertices; v++)
+                fill[v] = m_rowStart[v] + countSlots( slots[v] );
+
+            for (size_t n = 0; n < nncVertices.size(); n++) {
+                const int v1 = nncVertices[n].first;
+                const int v2 = nncVertices[n].second;
+                m_columns[fill[v1]] = v2;
+                m_weights[fill[v1]++] = (*nncWeights)[n];
+                m_columns[fill[v2]] = v1;
+                m_weights[fill[v2]++] = (*nncWeights)[n];
+            }
+
+#pragma omp parallel for schedule(dynamic , 1024) if (parallel)
+            for (long v = 0; v < numVertices; v++) {
+                const int begin = m_rowStart[v];
+                const int end = m_rowStart[v + 1];
+                if (end - begin == countSlots( slots[v] ))
+                    continue;
+
+                std::vector< std::pair<int , double> > row;
+                for (int position = begin; position < end; position++)
+                    row.push_back( std::make_pair( m_columns[position] , m_weights[position] ));
+
+                std::sort( row.begin() , row.end() );
+                for (int position = begin; position < end; position++) {
+                    m_columns[position] = row[position - begin].first;
+                    m_weights[position] = row[position - begin].second;
+                }
+            }
+        }
+    }
+
+
+    size_t CellAdjacency::numVertices() const {
+        return m_rowStart.size() - 1;
+    }
+
+
+    size_t CellAdjacency::numEdges() const {
+        return m_columns.size() / 2;
+    }
+
+
+    const std::vector<int>& CellAdjacency::getRowStart() const {
+        return m_rowStart;
+    }
+
+
+    const std::vector<int>& CellAdjacency::getColumns() const {
+        return m_columns;
+    }
+
+
+    const std::vector<double>& CellAdjacency::getWeights() const {
+        return m_weights;
+    }
+
+
+    std::vector<int> CellAdjacency::getIntegerWeights(int maxWeight) const {
+        if (maxWeight < 1)
+            throw std::invalid_argument("The maximum integer weight must be positive");
+
+        double largest = 0;
+        for (auto weight = m_weights.begin(); weight != m_weights.end(); ++weight)
+            largest = std::max( largest , *weight );
+
+        const double scale = (largest > 0) ? maxWeight / largest : 0;
+        std::vector<int> integerWeights( m_weights.size() );
+        for (size_t n = 0; n < m_weights.size(); n++) {
+            const double scaled = std::min( static_cast<double>(maxWeight) , std::round( m_weights[n] * scale ));
+            integerWeights[n] = std::max( 1 , static_cast<int>(scaled) );
+        }
+        return integerWeights;
+    }
+
+
+    void CellAdjacency::exportMETIS(std::ostream& stream , bool withWeights , int maxWeight) const {
+        std::vector<int> integerWeights;
+        if (withWeights)
+            integerWeights = getIntegerWeights( maxWeight );
+
+        stream << numVertices() << " " << numEdges();
+        if (withWeights)
+            stream << " 001";
+        stream << "\n";
+
+        for (size_t v = 0; v < numVertices(); v++) {
+            for (int position = m_rowStart[v]; position < m_rowStart[v + 1]; position++) {
+                if (position > m_rowStart[v])
+                    stream << " ";
+                stream << m_columns[position] + 1;
+                if (withWeights)
+                    stream << " " << integerWeights[position];
+            }
+            stream << "\n";
+        }
+    }
+}
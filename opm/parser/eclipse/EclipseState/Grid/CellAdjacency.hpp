@@ -0,0 +1,91 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CELL_ADJACENCY_HPP_
+#define CELL_ADJACENCY_HPP_
+
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+#include <opm/parser/eclipse/EclipseState/Grid/ActiveIndexMap.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/NNC.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/Transmissibility.hpp>
+
+/*
+  The CellAdjacency class is the connectivity graph of the active cells
+  in compressed sparse row form, as used by graph partitioners like
+  METIS: the vertices are the active indices, the neighbours of vertex
+  v are getColumns()[getRowStart()[v] .. getRowStart()[v + 1]) in
+  increasing order, and every connection is stored in the rows of both
+  its cells. The edge weights are the transmissibilities of the
+  connections; connections with zero transmissibility are kept. The
+  row pointers and columns are int, i.e. METIS idx_t with the default
+  32 bit build.
+
+  The graph is assembled from the connection lists of Transmissibility
+  and NNC. The position of a Cartesian connection within its rows
+  follows from which of the six neighbours of the cells are connected,
+  so the rows are filled in parallel with OpenMP without any further
+  lookups.
+*/
+
+namespace Opm {
+
+    class CellAdjacency {
+    public:
+        CellAdjacency(const ActiveIndexMap& activeIndexMap ,
+                      const Transmissibility& transmissibility);
+
+        // nncWeights holds one weight per NNC, see Transmissibility::computeNNCTrans()
+        CellAdjacency(const ActiveIndexMap& activeIndexMap ,
+                      const Transmissibility& transmissibility ,
+                      const NNC& nnc ,
+                      const std::vector<double>& nncWeights);
+
+        size_t numVertices() const;
+        // every connection counts once
+        size_t numEdges() const;
+
+        const std::vector<int>& getRowStart() const;
+        const std::vector<int>& getColumns() const;
+        const std::vector<double>& getWeights() const;
+
+        /*
+          The weights scaled linearly to integers in [1, maxWeight], as
+          METIS only accepts integer weights.
+        */
+        std::vector<int> getIntegerWeights(int maxWeight) const;
+
+        // The graph in the METIS graph file format, with 1-based vertices.
+        void exportMETIS(std::ostream& stream , bool withWeights = true , int maxWeight = 1000000) const;
+
+    private:
+        void build(const ActiveIndexMap& activeIndexMap ,
+                   const Transmissibility& transmissibility ,
+                   const NNC* nnc ,
+                   const std::vector<double>* nncWeights);
+
+        std::vector<int> m_rowStart;
+        std::vector<int> m_columns;
+        std::vector<double> m_weights;
+    };
+}
+
+#endif
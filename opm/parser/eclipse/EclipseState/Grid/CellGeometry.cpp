@@ -0,0 +1,292 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cmath>
+#include <stdexcept>
+
+#include <opm/parser/eclipse/EclipseState/Grid/CellGeometry.hpp>
+#include <opm/parser/eclipse/EclipseState/Util/Parallel.hpp>
+
+namespace Opm {
+
+namespace {
+
+    /*
+      The corners of a cell are numbered with the i offset in bit 0,
+      the j offset in bit 1 and the k offset in bit 2. The x and y
+      coordinates of a corner are interpolated linearly along its
+      pillar at the depth given by ZCORN.
+    */
+    struct Corners {
+        double x[8];
+        double y[8];
+        double z[8];
+    };
+
+    void cellCorners(size_t nx , size_t ny , size_t i , size_t j , size_t k ,
+                     const double* coord , const double* zcorn , Corners& corners) {
+        for (int c = 0; c < 8; c++) {
+            const size_t di = c & 1;
+            const size_t dj = (c >> 1) & 1;
+            const size_t dk = (c >> 2) & 1;
+            const size_t zIndex = k*8*nx*ny + dk*4*nx*ny + j*4*nx + dj*2*nx + 2*i + di;
+            const double* pillar = coord + ((j + dj)*(nx + 1) + (i + di))*6;
+
+            const double z = zcorn[zIndex];
+            const double pillarHeight = pillar[5] - pillar[2];
+            const double t = (pillarHeight == 0) ? 0 : (z - pillar[2]) / pillarHeight;
+
+            corners.x[c] = pillar[0] + t * (pillar[3] - pillar[0]);
+            corners.y[c] = pillar[1] + t * (pillar[4] - pillar[1]);
+            corners.z[c] = z;
+        }
+    }
+
+    double tetrahedronVolume(const Corners& corners , int a , int b , int c , int d) {
+        const double u[3] = { corners.x[b] - corners.x[a] , corners.y[b] - corners.y[a] , corners.z[b] - corners.z[a] };
+        const double v[3] = { corners.x[c] - corners.x[a] , corners.y[c] - corners.y[a] , corners.z[c] - corners.z[a] };
+        const double w[3] = { corners.x[d] - corners.x[a] , corners.y[d] - corners.y[a] , corners.z[d] - corners.z[a] };
+
+        return (u[0]*(v[1]*w[2] - v[2]*w[1]) - u[1]*(v[0]*w[2] - v[2]*w[0]) + u[2]*(v[0]*w[1] - v[1]*w[0])) / 6.0;
+    }
+
+    void cornerAverage(const Corners& corners , double& x , double& y , double& z) {
+        x = 0;
+        y = 0;
+        z = 0;
+        for (int c = 0; c < 8; c++) {
+            x += corners.x[c];
+            y += corners.y[c];
+            z += corners.z[c];
+        }
+        x /= 8;
+        y /= 8;
+        z /= 8;
+    }
+
+    double cornerVolume(const Corners& corners) {
+        static const int tetrahedra[6][4] = {{0,1,3,7},{0,3,2,7},{0,2,6,7},{0,6,4,7},{0,4,5,7},{0,5,1,7}};
+        double volume = 0;
+        for (int t = 0; t < 6; t++)
+            volume += tetrahedronVolume( corners , tetrahedra[t][0] , tetrahedra[t][1] , tetrahedra[t][2] , tetrahedra[t][3] );
+
+        return std::fabs( volume );
+    }
+
+    // The area of the quadrilateral face (c0, c1, c3, c2) is half the
+    // length of the cross product of its diagonals.
+    double faceArea(const Corners& corners , int c0 , int c1 , int c2 , int c3) {
+        const double d1[3] = { corners.x[c3] - corners.x[c0] , corners.y[c3] - corners.y[c0] , corners.z[c3] - corners.z[c0] };
+        const double d2[3] = { corners.x[c2] - corners.x[c1] , corners.y[c2] - corners.y[c1] , corners.z[c2] - corners.z[c1] };
+        const double n[3] = { d1[1]*d2[2] - d1[2]*d2[1] , d1[2]*d2[0] - d1[0]*d2[2] , d1[0]*d2[1] - d1[1]*d2[0] };
+
+        return 0.5 * std::sqrt( n[0]*n[0] + n[1]*n[1] + n[2]*n[2] );
+    }
+
+    // The distance between the centers of the faces (c0, c1, c2, c3)
+    // and (c4, c5, c6, c7).
+    double faceDistance(const Corners& corners , const int (&face1)[4] , const int (&face2)[4]) {
+        double d[3] = { 0 , 0 , 0 };
+        for (int c = 0; c < 4; c++) {
+            d[0] += corners.x[face2[c]] - corners.x[face1[c]];
+            d[1] += corners.y[face2[c]] - corners.y[face1[c]];
+            d[2] += corners.z[face2[c]] - corners.z[face1[c]];
+        }
+        return 0.25 * std::sqrt( d[0]*d[0] + d[1]*d[1] + d[2]*d[2] );
+    }
+}
+
+
+    CellGeometry::CellGeometry(size_t nx , size_t ny , size_t nz ,
+                               const std::vector<double>& coord ,
+                               const std::vector<double>& zcorn) {
+        const size_t numCells = nx * ny * nz;
+        if (coord.size() != 6*(nx + 1)*(ny + 1))
+            throw std::invalid_argument("Wrong size of the COORD vector for the cell geometry");
+
+        if (zcorn.size() != 8*numCells)
+            throw std::invalid_argument("Wrong size of the ZCORN vector for the cell geometry");
+
+        m_centerX.resize( numCells );
+        m_centerY.resize( numCells );
+        m_depth.resize( numCells );
+        m_volume.resize( numCells );
+        m_dx.resize( numCells );
+        m_dy.resize( numCells );
+        m_dz.resize( numCells );
+        m_faceAreaX.resize( numCells );
+        m_faceAreaY.resize( numCells );
+        m_faceAreaZ.resize( numCells );
+
+        static const int iMinus[4] = {0,2,4,6};
+        static const int iPlus[4]  = {1,3,5,7};
+        static const int jMinus[4] = {0,1,4,5};
+        static const int jPlus[4]  = {2,3,6,7};
+        static const int kMinus[4] = {0,1,2,3};
+        static const int kPlus[4]  = {4,5,6,7};
+
+        const double* coordData = coord.data();
+        const double* zcornData = zcorn.data();
+        const long numLayers = static_cast<long>(nz);
+
+#pragma omp parallel for schedule(static) if (numCells >= parallelThreshold)
+        for (long k = 0; k < numLayers; k++) {
+            Corners corners;
+            for (size_t j = 0; j < ny; j++) {
+                for (size_t i = 0; i < nx; i++) {
+                    const size_t g = i + j*nx + k*nx*ny;
+                    cellCorners( nx , ny , i , j , k , coordData , zcornData , corners );
+
+                    cornerAverage( corners , m_centerX[g] , m_centerY[g] , m_depth[g] );
+
+                    m_volume[g] = cornerVolume( corners );
+                    m_dx[g] = faceDistance( corners , iMinus , iPlus );
+                    m_dy[g] = faceDistance( corners , jMinus , jPlus );
+                    m_dz[g] = faceDistance( corners , kMinus , kPlus );
+                    m_faceAreaX[g] = faceArea( corners , 1 , 3 , 5 , 7 );
+                    m_faceAreaY[g] = faceArea( corners , 2 , 3 , 6 , 7 );
+                    m_faceAreaZ[g] = faceArea( corners , 4 , 5 , 6 , 7 );
+                }
+            }
+        }
+    }
+
+
+    /*
+      The depth is the average of the eight ZCORN values of the cell,
+      summed in the same order as in cornerAverage(), so the values
+      are identical to getDepth().
+    */
+    void CellGeometry::cellDepths(size_t nx , size_t ny , size_t nz ,
+                                  const std::vector<double>& zcorn , std::vector<double>& depths) {
+        const size_t numCells = nx * ny * nz;
+        if (zcorn.size() != 8*numCells)
+            throw std::invalid_argument("Wrong size of the ZCORN vector for the cell depths");
+
+        depths.resize( numCells );
+        const double* zcornData = zcorn.data();
+        const long numLayers = static_cast<long>(nz);
+
+#pragma omp parallel for schedule(static) if (numCells >= parallelThreshold)
+        for (long k = 0; k < numLayers; k++) {
+            for (size_t j = 0; j < ny; j++) {
+                for (size_t i = 0; i < nx; i++) {
+                    double z = 0;
+                    for (int c = 0; c < 8; c++) {
+                        const size_t di = c & 1;
+                        const size_t dj = (c >> 1) & 1;
+                        const size_t dk = (c >> 2) & 1;
+                        z += zcornData[k*8*nx*ny + dk*4*nx*ny + j*4*nx + dj*2*nx + 2*i + di];
+                    }
+                    depths[i + j*nx + k*nx*ny] = z / 8;
+                }
+            }
+        }
+    }
+
+
+    void CellGeometry::cellCenter(size_t nx , size_t ny , size_t i , size_t j , size_t k ,
+                                  const double* coord , const double* zcorn ,
+                                  double& x , double& y , double& z) {
+        Corners corners;
+        cellCorners( nx , ny , i , j , k , coord , zcorn , corners );
+        cornerAverage( corners , x , y , z );
+    }
+
+
+    double CellGeometry::cellVolume(size_t nx , size_t ny , size_t i , size_t j , size_t k ,
+                                    const double* coord , const double* zcorn) {
+        Corners corners;
+        cellCorners( nx , ny , i , j , k , coord , zcorn , corners );
+        return cornerVolume( corners );
+    }
+
+
+    void CellGeometry::halfTransFactors(size_t nx , size_t ny , size_t i , size_t j , size_t k ,
+                                        const double* coord , const double* zcorn ,
+                                        double* factors) {
+        static const int faces[6][4] = {{0,2,4,6},{1,3,5,7},{0,1,4,5},{2,3,6,7},{0,1,2,3},{4,5,6,7}};
+        Corners corners;
+        cellCorners( nx , ny , i , j , k , coord , zcorn , corners );
+
+        double center[3];
+        cornerAverage( corners , center[0] , center[1] , center[2] );
+
+        for (int f = 0; f < 6; f++) {
+            const int* c = faces[f];
+            const double d[3] = { 0.25*(corners.x[c[0]] + corners.x[c[1]] + corners.x[c[2]] + corners.x[c[3]]) - center[0] ,
+                                  0.25*(corners.y[c[0]] + corners.y[c[1]] + corners.y[c[2]] + corners.y[c[3]]) - center[1] ,
+                                  0.25*(corners.z[c[0]] + corners.z[c[1]] + corners.z[c[2]] + corners.z[c[3]]) - center[2] };
+
+            // The area vector of the quadrilateral (c0, c1, c3, c2) is
+            // half the cross product of its diagonals.
+            const double d1[3] = { corners.x[c[3]] - corners.x[c[0]] , corners.y[c[3]] - corners.y[c[0]] , corners.z[c[3]] - corners.z[c[0]] };
+            const double d2[3] = { corners.x[c[2]] - corners.x[c[1]] , corners.y[c[2]] - corners.y[c[1]] , corners.z[c[2]] - corners.z[c[1]] };
+            const double area[3] = { 0.5*(d1[1]*d2[2] - d1[2]*d2[1]) , 0.5*(d1[2]*d2[0] - d1[0]*d2[2]) , 0.5*(d1[0]*d2[1] - d1[1]*d2[0]) };
+
+            const double dd = d[0]*d[0] + d[1]*d[1] + d[2]*d[2];
+            factors[f] = (dd > 0) ? std::fabs( area[0]*d[0] + area[1]*d[1] + area[2]*d[2] ) / dd : 0;
+        }
+    }
+
+
+    size_t CellGeometry::size() const {
+        return m_volume.size();
+    }
+
+    const std::vector<double>& CellGeometry::getCenterX() const {
+        return m_centerX;
+    }
+
+    const std::vector<double>& CellGeometry::getCenterY() const {
+        return m_centerY;
+    }
+
+    const std::vector<double>& CellGeometry::getDepth() const {
+        return m_depth;
+    }
+
+    const std::vector<double>& CellGeometry::getVolume() const {
+        return m_volume;
+    }
+
+    const std::vector<double>& CellGeometry::getDX() const {
+        return m_dx;
+    }
+
+    const std::vector<double>& CellGeometry::getDY() const {
+        return m_dy;
+    }
+
+    const std::vector<double>& CellGeometry::getDZ() const {
+        return m_dz;
+    }
+
+    const std::vector<double>& CellGeometry::getFaceAreaX() const {
+        return m_faceAreaX;
+    }
+
+    const std::vector<double>& CellGeometry::getFaceAreaY() const {
+        return m_faceAreaY;
+    }
+
+    const std::vector<double>& CellGeometry::getFaceAreaZ() const {
+        return m_faceAreaZ;
+    }
+}
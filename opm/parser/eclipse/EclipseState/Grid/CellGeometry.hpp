@@ -0,0 +1,125 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CELL_GEOMETRY_HPP_
+#define CELL_GEOMETRY_HPP_
+
+#include <cstddef>
+#include <vector>
+
+/*
+  The CellGeometry class holds the geometry of all the cells of a
+  corner point grid as a structure of arrays, in global index order:
+
+    centerX, centerY, depth : The center of the cell, i.e. the average
+        of the eight corners.
+
+    volume : The volume of the cell, from a decomposition in six
+        tetrahedra around the diagonal from corner 0 to corner 7.
+
+    dx, dy, dz : The distance between the centers of the two opposite
+        faces in the i, j and k directions.
+
+    faceAreaX, faceAreaY, faceAreaZ : The area of the I+, J+ and K+
+        faces of the cell.
+
+  The geometry is computed from COORD and ZCORN in one pass, which is
+  parallelized over the layers of the grid with OpenMP. The same
+  functions are used by EclipseGrid::getCellCenter() and
+  EclipseGrid::getCellVolume(). Use EclipseGrid::getCellGeometry() to
+  get the cached geometry of a grid, and ActiveIndexMap::compress() to
+  get the values of the active cells.
+
+  The coordinates are those of COORD, i.e. MAPAXES is not applied;
+  the geometric quantities do not depend on it.
+
+  The values are not taken from ert, and need not be identical to
+  those of ecl_grid, which works on single precision coordinates and
+  may use another tetrahedral decomposition:
+
+    - The centers are computed in double precision, and agree with a
+      single precision calculation to a relative accuracy of about
+      1e-7.
+
+    - The volume is exact for cells with planar faces. The faces of a
+      corner point cell are in general bilinear surfaces, and the six
+      tetrahedra replace each face by two triangles. For a face whose
+      corners are at most a fraction f of the cell size away from a
+      plane, the volume differs from that of the trilinear cell by up
+      to about f, e.g. 1% for f = 0.01. Other decompositions differ by
+      the same order.
+*/
+
+namespace Opm {
+
+    class CellGeometry {
+    public:
+        CellGeometry(size_t nx , size_t ny , size_t nz ,
+                     const std::vector<double>& coord ,
+                     const std::vector<double>& zcorn);
+
+        size_t size() const;
+
+        const std::vector<double>& getCenterX() const;
+        const std::vector<double>& getCenterY() const;
+        const std::vector<double>& getDepth() const;
+        const std::vector<double>& getVolume() const;
+        const std::vector<double>& getDX() const;
+        const std::vector<double>& getDY() const;
+        const std::vector<double>& getDZ() const;
+        const std::vector<double>& getFaceAreaX() const;
+        const std::vector<double>& getFaceAreaY() const;
+        const std::vector<double>& getFaceAreaZ() const;
+
+        // the depths of all the cells, without the rest of the geometry
+        static void cellDepths(size_t nx , size_t ny , size_t nz ,
+                               const std::vector<double>& zcorn , std::vector<double>& depths);
+
+        // the center and volume of a single cell (i,j,k)
+        static void cellCenter(size_t nx , size_t ny , size_t i , size_t j , size_t k ,
+                               const double* coord , const double* zcorn ,
+                               double& x , double& y , double& z);
+        static double cellVolume(size_t nx , size_t ny , size_t i , size_t j , size_t k ,
+                                 const double* coord , const double* zcorn);
+
+        /*
+          The geometric part of the half transmissibilities of the six
+          faces of cell (i,j,k), in the order I-, I+, J-, J+, K-, K+:
+          |A . d| / (d . d), where A is the area vector of the face and d
+          the vector from the cell center to the face center.
+        */
+        static void halfTransFactors(size_t nx , size_t ny , size_t i , size_t j , size_t k ,
+                                     const double* coord , const double* zcorn ,
+                                     double* factors);
+
+    private:
+        std::vector<double> m_centerX;
+        std::vector<double> m_centerY;
+        std::vector<double> m_depth;
+        std::vector<double> m_volume;
+        std::vector<double> m_dx;
+        std::vector<double> m_dy;
+        std::vector<double> m_dz;
+        std::vector<double> m_faceAreaX;
+        std::vector<double> m_faceAreaY;
+        std::vector<double> m_faceAreaZ;
+    };
+}
+
+#endif
@@ -0,0 +1,72 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <limits>
+
+#include <opm/parser/eclipse/EclipseState/Grid/CompactIntArray.hpp>
+
+namespace Opm {
+
+    std::shared_ptr<const CompactIntArray> CompactIntArray::compress(const std::vector<int>& values) {
+        if (values.empty())
+            return std::shared_ptr<const CompactIntArray>();
+
+        const auto minmax = std::minmax_element( values.begin() , values.end() );
+        const int minValue = *minmax.first;
+        const int maxValue = *minmax.second;
+
+        if (minValue < 0 || maxValue > std::numeric_limits<uint16_t>::max())
+            return std::shared_ptr<const CompactIntArray>();
+
+        std::shared_ptr<CompactIntArray> array( new CompactIntArray() );
+        if (maxValue <= std::numeric_limits<uint8_t>::max()) {
+            array->m_bytesPerValue = 1;
+            array->m_data8.assign( values.begin() , values.end() );
+        } else {
+            array->m_bytesPerValue = 2;
+            array->m_data16.assign( values.begin() , values.end() );
+        }
+
+        return array;
+    }
+
+
+    size_t CompactIntArray::size() const {
+        if (m_bytesPerValue == 1)
+            return m_data8.size();
+        else
+            return m_data16.size();
+    }
+
+
+    size_t CompactIntArray::bytesPerValue() const {
+        return m_bytesPerValue;
+    }
+
+
+    const uint8_t* CompactIntArray::data8() const {
+        return m_data8.data();
+    }
+
+
+    const uint16_t* CompactIntArray::data16() const {
+        return m_data16.data();
+    }
+}
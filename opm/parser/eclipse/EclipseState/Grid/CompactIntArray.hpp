@@ -0,0 +1,80 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef COMPACT_INT_ARRAY_HPP_
+#define COMPACT_INT_ARRAY_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/*
+  The CompactIntArray class is an immutable array of non-negative
+  integers, stored with 8 or 16 bits per value. It is used to store
+  region properties like SATNUM and FIPNUM, where the values are
+  small, with a fraction of the memory of a std::vector<int>.
+*/
+
+namespace Opm {
+
+    class CompactIntArray {
+    public:
+        /*
+          Returns a compact copy of the values, using the narrowest
+          width which can represent all of them, or an empty pointer if
+          some of the values do not fit in 16 unsigned bits.
+        */
+        static std::shared_ptr<const CompactIntArray> compress(const std::vector<int>& values);
+
+        size_t size() const;
+        size_t bytesPerValue() const;
+
+        int operator[](size_t index) const {
+            if (m_bytesPerValue == 1)
+                return m_data8[index];
+            else
+                return m_data16[index];
+        }
+
+        // Only valid when bytesPerValue() is 1 or 2 respectively.
+        const uint8_t* data8() const;
+        const uint16_t* data16() const;
+
+        template <typename T>
+        void expand(T* target) const {
+            if (m_bytesPerValue == 1) {
+                for (size_t i = 0; i < m_data8.size(); ++i)
+                    target[i] = static_cast<T>(m_data8[i]);
+            } else {
+                for (size_t i = 0; i < m_data16.size(); ++i)
+                    target[i] = static_cast<T>(m_data16[i]);
+            }
+        }
+
+    private:
+        CompactIntArray() {}
+
+        size_t m_bytesPerValue;
+        std::vector<uint8_t> m_data8;
+        std::vector<uint16_t> m_data16;
+    };
+}
+
+#endif
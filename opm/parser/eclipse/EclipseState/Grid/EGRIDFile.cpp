@@ -0,0 +1,347 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <opm/parser/eclipse/EclipseState/Grid/EGRIDFile.hpp>
+#include <opm/parser/eclipse/EclipseState/Util/Parallel.hpp>
+
+namespace Opm {
+
+namespace {
+
+    const size_t headerLength = 16;
+
+    // the grid type in GRIDHEAD[0]; only corner point grids are read
+    const int cornerPointGridType = 1;
+
+    uint32_t bigEndian32(const unsigned char* data) {
+        uint32_t value;
+        std::memcpy( &value , data , sizeof value );
+        return __builtin_bswap32( value );
+    }
+
+    uint64_t bigEndian64(const unsigned char* data) {
+        uint64_t value;
+        std::memcpy( &value , data , sizeof value );
+        return __builtin_bswap64( value );
+    }
+
+    std::string trimmedName(const unsigned char* data) {
+        std::string name( reinterpret_cast<const char*>(data) , 8 );
+        return name.substr( 0 , name.find_last_not_of(' ') + 1 );
+    }
+
+    size_t elementSize(const std::string& type) {
+        if (type == "CHAR")
+            return 8;
+        else if (type == "DOUB")
+            return 8;
+        else if (type == "INTE" || type == "REAL" || type == "LOGI")
+            return 4;
+        else if (type == "MESS")
+            return 0;
+        else
+            throw std::invalid_argument("Unsupported EGRID data type: " + type);
+    }
+
+    // The conversion loops work on one record at a time; they are
+    // plain elementwise loops which the compiler can vectorize.
+    void convertREAL(const unsigned char* src , size_t numElements , double* target) {
+        for (size_t i = 0; i < numElements; i++) {
+            const uint32_t bits = bigEndian32( src + 4*i );
+            float value;
+            std::memcpy( &value , &bits , sizeof value );
+            target[i] = value;
+        }
+    }
+
+    void convertDOUB(const unsigned char* src , size_t numElements , double* target) {
+        for (size_t i = 0; i < numElements; i++) {
+            const uint64_t bits = bigEndian64( src + 8*i );
+            std::memcpy( &target[i] , &bits , sizeof bits );
+        }
+    }
+
+    void convertINTE(const unsigned char* src , size_t numElements , int* target) {
+        for (size_t i = 0; i < numElements; i++) {
+            const uint32_t bits = bigEndian32( src + 4*i );
+            std::memcpy( &target[i] , &bits , sizeof bits );
+        }
+    }
+}
+
+
+    EGRIDFile::EGRIDFile(const std::string& filename)
+        : m_filename( filename ),
+          m_data( nullptr ),
+          m_fileSize( 0 ),
+          m_nx( 0 ),
+          m_ny( 0 ),
+          m_nz( 0 )
+    {
+        int fd = open( filename.c_str() , O_RDONLY );
+        if (fd < 0)
+            throw std::invalid_argument("Could not open the EGRID file: " + filename);
+
+        struct stat fileStat;
+        if (fstat( fd , &fileStat ) != 0 || fileStat.st_size == 0) {
+            close( fd );
+            throw std::invalid_argument("Could not read the EGRID file: " + filename);
+        }
+
+        m_fileSize = static_cast<size_t>(fileStat.st_size);
+        void* data = mmap( nullptr , m_fileSize , PROT_READ , MAP_PRIVATE , fd , 0 );
+        close( fd );
+        if (data == MAP_FAILED)
+            throw std::invalid_argument("Could not map the EGRID file: " + filename);
+
+        m_data = static_cast<const unsigned char*>(data);
+        try {
+            scanKeywords();
+        } catch (...) {
+            munmap( const_cast<unsigned char*>(m_data) , m_fileSize );
+            throw;
+        }
+    }
+
+
+    EGRIDFile::~EGRIDFile() {
+        munmap( const_cast<unsigned char*>(m_data) , m_fileSize );
+    }
+
+
+    bool EGRIDFile::isEGRIDFile(const std::string& filename) {
+        std::ifstream stream( filename.c_str() , std::ios::binary );
+        unsigned char head[4 + headerLength];
+        if (!stream.read( reinterpret_cast<char*>(head) , sizeof head ))
+            return false;
+
+        return bigEndian32( head ) == headerLength && trimmedName( head + 4 ) == "FILEHEAD";
+    }
+
+
+    /*
+      A record is the length in bytes, the data and the length again.
+      Returns the length of the record at offset after checking that
+      the whole record is inside the file and that the two length
+      markers are equal.
+    */
+    uint32_t EGRIDFile::readRecordLength(size_t offset) const {
+        if (offset + 4 > m_fileSize)
+            throw std::invalid_argument("Unexpected end of the EGRID file: " + m_filename);
+
+        const uint32_t recordLength = bigEndian32( m_data + offset );
+        if (static_cast<size_t>(recordLength) + 8 > m_fileSize - offset)
+            throw std::invalid_argument("Unexpected end of the EGRID file: " + m_filename);
+
+        if (bigEndian32( m_data + offset + 4 + recordLength ) != recordLength)
+            throw std::invalid_argument("Mismatched record markers in the EGRID file: " + m_filename);
+
+        return recordLength;
+    }
+
+
+    /*
+      Every keyword is a header record - the name, the number of
+      elements and the data type - followed by the data records. Only
+      the keywords of the main grid, i.e. up to ENDGRID, are indexed.
+      The data records must hold exactly the number of elements given
+      in the header.
+    */
+    void EGRIDFile::scanKeywords() {
+        size_t offset = 0;
+        while (offset < m_fileSize) {
+            if (readRecordLength( offset ) != headerLength)
+                throw std::invalid_argument("Invalid keyword header in the EGRID file: " + m_filename);
+
+            const unsigned char* header = m_data + offset + 4;
+            const std::string name = trimmedName( header );
+            offset += 4 + headerLength + 4;
+
+            Keyword keyword;
+            keyword.size = bigEndian32( header + 8 );
+            keyword.type = std::string( reinterpret_cast<const char*>(header) + 12 , 4 );
+            const size_t typeSize = elementSize( keyword.type );
+            if (typeSize == 0 && keyword.size > 0)
+                throw std::invalid_argument("The keyword " + name + " of type " + keyword.type + " can not have data in the EGRID file: " + m_filename);
+
+            size_t numElements = 0;
+            while (numElements < keyword.size) {
+                const size_t recordLength = readRecordLength( offset );
+                if (recordLength == 0 || recordLength % typeSize != 0)
+                    throw std::invalid_argument("Invalid data record for keyword " + name + " in the EGRID file: " + m_filename);
+
+                if (recordLength / typeSize > keyword.size - numElements)
+                    throw std::invalid_argument("The data records of keyword " + name + " are larger than its header in the EGRID file: " + m_filename);
+
+                Block block = { offset + 4 , numElements , recordLength / typeSize };
+                keyword.blocks.push_back( block );
+                numElements += block.numElements;
+                offset += 4 + recordLength + 4;
+            }
+
+            m_keywords[name] = keyword;
+            if (name == "ENDGRID")
+                break;
+        }
+
+        if (!hasKeyword("GRIDHEAD") || !hasKeyword("COORD") || !hasKeyword("ZCORN"))
+            throw std::invalid_argument("The EGRID file must have the GRIDHEAD, COORD and ZCORN keywords: " + m_filename);
+
+        const std::vector<int> gridhead = readIntKeyword("GRIDHEAD");
+        if (gridhead.size() < 4)
+            throw std::invalid_argument("Invalid GRIDHEAD keyword in the EGRID file: " + m_filename);
+
+        if (gridhead[0] != cornerPointGridType)
+            throw std::invalid_argument("Only corner point grids are supported in the EGRID file: " + m_filename);
+
+        if (gridhead[1] <= 0 || gridhead[2] <= 0 || gridhead[3] <= 0)
+            throw std::invalid_argument("Invalid grid dimensions in the EGRID file: " + m_filename);
+
+        m_nx = static_cast<size_t>(gridhead[1]);
+        m_ny = static_cast<size_t>(gridhead[2]);
+        m_nz = static_cast<size_t>(gridhead[3]);
+
+        // the keyword sizes are 32 bit, so the products of the
+        // dimensions are compared by division to avoid overflow.
+        const size_t zcornSize = getKeywordSize("ZCORN");
+        const size_t numCells = zcornSize / 8;
+        if (zcornSize % 8 != 0 || numCells / m_nx / m_ny != m_nz || numCells % (m_nx*m_ny) != 0 ||
+            getKeywordSize("COORD") != 6*(m_nx + 1)*(m_ny + 1) ||
+            (hasKeyword("ACTNUM") && getKeywordSize("ACTNUM") != numCells))
+            throw std::invalid_argument("The keyword sizes do not match the dimensions in the EGRID file: " + m_filename);
+    }
+
+
+    size_t EGRIDFile::getNX() const {
+        return m_nx;
+    }
+
+    size_t EGRIDFile::getNY() const {
+        return m_ny;
+    }
+
+    size_t EGRIDFile::getNZ() const {
+        return m_nz;
+    }
+
+
+    bool EGRIDFile::hasKeyword(const std::string& keyword) const {
+        return m_keywords.count( keyword ) > 0;
+    }
+
+
+    size_t EGRIDFile::getKeywordSize(const std::string& keyword) const {
+        return getKeyword( keyword ).size;
+    }
+
+
+    const EGRIDFile::Keyword& EGRIDFile::getKeyword(const std::string& keyword) const {
+        auto iter = m_keywords.find( keyword );
+        if (iter == m_keywords.end())
+            throw std::invalid_argument("The EGRID file " + m_filename + " has no keyword: " + keyword);
+
+        return iter->second;
+    }
+
+
+    std::vector<double> EGRIDFile::readDoubleKeyword(const std::string& name) const {
+        const Keyword& keyword = getKeyword( name );
+        if (keyword.type != "REAL" && keyword.type != "DOUB")
+            throw std::invalid_argument("The keyword " + name + " is not a floating point keyword");
+
+        std::vector<double> values( keyword.size );
+        const bool isDouble = (keyword.type == "DOUB");
+        const long numBlocks = static_cast<long>(keyword.blocks.size());
+
+#pragma omp parallel for schedule(static) if (keyword.size >= parallelThreshold)
+        for (long blockIdx = 0; blockIdx < numBlocks; blockIdx++) {
+            const Block& block = keyword.blocks[blockIdx];
+            if (isDouble)
+                convertDOUB( m_data + block.fileOffset , block.numElements , values.data() + block.firstElement );
+            else
+                convertREAL( m_data + block.fileOffset , block.numElements , values.data() + block.firstElement );
+        }
+
+        return values;
+    }
+
+
+    std::vector<int> EGRIDFile::readIntKeyword(const std::string& name) const {
+        const Keyword& keyword = getKeyword( name );
+        if (keyword.type != "INTE")
+            throw std::invalid_argument("The keyword " + name + " is not an integer keyword");
+
+        std::vector<int> values( keyword.size );
+        const long numBlocks = static_cast<long>(keyword.blocks.size());
+
+#pragma omp parallel for schedule(static) if (keyword.size >= parallelThreshold)
+        for (long blockIdx = 0; blockIdx < numBlocks; blockIdx++) {
+            const Block& block = keyword.blocks[blockIdx];
+            convertINTE( m_data + block.fileOffset , block.numElements , values.data() + block.firstElement );
+        }
+
+        return values;
+    }
+
+
+    std::shared_ptr<const std::vector<double> > EGRIDFile::getCOORD() const {
+        std::call_once( m_coordFlag , [this]() {
+                m_coord = std::make_shared<const std::vector<double> >( readDoubleKeyword("COORD") );
+            });
+        return m_coord;
+    }
+
+
+    std::shared_ptr<const std::vector<double> > EGRIDFile::getZCORN() const {
+        std::call_once( m_zcornFlag , [this]() {
+                m_zcorn = std::make_shared<const std::vector<double> >( readDoubleKeyword("ZCORN") );
+            });
+        return m_zcorn;
+    }
+
+
+    std::shared_ptr<const std::vector<int> > EGRIDFile::getACTNUM() const {
+        std::call_once( m_actnumFlag , [this]() {
+                if (hasKeyword("ACTNUM"))
+                    m_actnum = std::make_shared<const std::vector<int> >( readIntKeyword("ACTNUM") );
+                else
+                    m_actnum = std::make_shared<const std::vector<int> >();
+            });
+        return m_actnum;
+    }
+
+
+    std::vector<double> EGRIDFile::getMAPAXES() const {
+        if (hasKeyword("MAPAXES"))
+            return readDoubleKeyword("MAPAXES");
+        else
+            return std::vector<double>();
+    }
+}
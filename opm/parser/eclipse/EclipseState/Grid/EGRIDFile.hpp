@@ -0,0 +1,108 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef EGRID_FILE_HPP_
+#define EGRID_FILE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+  The EGRIDFile class reads binary (unformatted) EGRID files without
+  ert. The file is memory mapped, and when it is opened only the
+  keyword headers of the main grid are scanned; the data of a keyword
+  is converted from big-endian on the first request and then cached.
+  Reading the dimensions and ACTNUM of a grid therefore never touches
+  the COORD and ZCORN data. The conversion is done one Fortran record
+  - i.e. block of up to 1000 elements - at a time, with the records of
+  large keywords distributed over threads with OpenMP.
+
+  Local grid refinements and the formatted and old GRID formats are
+  not supported.
+*/
+
+namespace Opm {
+
+    class EGRIDFile {
+    public:
+        explicit EGRIDFile(const std::string& filename);
+        ~EGRIDFile();
+
+        EGRIDFile(const EGRIDFile&) = delete;
+        EGRIDFile& operator=(const EGRIDFile&) = delete;
+
+        // true if the file starts with the FILEHEAD keyword of a
+        // binary EGRID file.
+        static bool isEGRIDFile(const std::string& filename);
+
+        size_t getNX() const;
+        size_t getNY() const;
+        size_t getNZ() const;
+
+        bool hasKeyword(const std::string& keyword) const;
+        size_t getKeywordSize(const std::string& keyword) const;
+
+        std::shared_ptr<const std::vector<double> > getCOORD() const;
+        std::shared_ptr<const std::vector<double> > getZCORN() const;
+        // empty if the file has no ACTNUM keyword, i.e. all the cells
+        // are active
+        std::shared_ptr<const std::vector<int> > getACTNUM() const;
+        // empty if the file has no MAPAXES keyword
+        std::vector<double> getMAPAXES() const;
+
+    private:
+        struct Block {
+            size_t fileOffset;
+            size_t firstElement;
+            size_t numElements;
+        };
+
+        struct Keyword {
+            std::string type;
+            size_t size;
+            std::vector<Block> blocks;
+        };
+
+        void scanKeywords();
+        uint32_t readRecordLength(size_t offset) const;
+        const Keyword& getKeyword(const std::string& keyword) const;
+        std::vector<double> readDoubleKeyword(const std::string& keyword) const;
+        std::vector<int> readIntKeyword(const std::string& keyword) const;
+
+        std::string m_filename;
+        const unsigned char* m_data;
+        size_t m_fileSize;
+        size_t m_nx, m_ny, m_nz;
+        std::map<std::string , Keyword> m_keywords;
+
+        mutable std::once_flag m_coordFlag;
+        mutable std::once_flag m_zcornFlag;
+        mutable std::once_flag m_actnumFlag;
+        mutable std::shared_ptr<const std::vector<double> > m_coord;
+        mutable std::shared_ptr<const std::vector<double> > m_zcorn;
+        mutable std::shared_ptr<const std::vector<int> > m_actnum;
+    };
+}
+
+#endif
@@ -18,8 +18,11 @@
 */
 
 
+#include <cmath>
 #include <iostream>
 #include <tuple>
+#include <memory>
+#include <stdexcept>
 
 #include <boost/lexical_cast.hpp>
 
@@ -30,26 +33,151 @@
 #include <ert/ecl/ecl_grid.h>
 namespace Opm {
 
+namespace {
+
+    /*
+      MAPAXES gives a point on the y axis, the origin and a point on
+      the x axis of the grid in map coordinates; (x,y) is transformed
+      from grid to map coordinates as in ecl_grid, with the axes
+      normalised.
+    */
+    void applyMAPAXES(const std::vector<double>& mapaxes , double& x , double& y) {
+        double unitX[2] = { mapaxes[4] - mapaxes[2] , mapaxes[5] - mapaxes[3] };
+        double unitY[2] = { mapaxes[0] - mapaxes[2] , mapaxes[1] - mapaxes[3] };
+        const double lengthX = std::sqrt( unitX[0]*unitX[0] + unitX[1]*unitX[1] );
+        const double lengthY = std::sqrt( unitY[0]*unitY[0] + unitY[1]*unitY[1] );
+        if (lengthX == 0 || lengthY == 0)
+            throw std::invalid_argument("MAPAXES does not define two axes");
+
+        for (int d = 0; d < 2; d++) {
+            unitX[d] /= lengthX;
+            unitY[d] /= lengthY;
+        }
+
+        const double mapX = mapaxes[2] + x*unitX[0] + y*unitY[0];
+        const double mapY = mapaxes[3] + x*unitX[1] + y*unitY[1];
+        x = mapX;
+        y = mapY;
+    }
+}
+
     /**
        Will create an EclipseGrid instance based on an existing
-       GRID/EGRID file.
+       GRID/EGRID file. Binary EGRID files are read natively, see
+       EGRIDFile; other formats are loaded with ert.
     */
     EclipseGrid::EclipseGrid(const std::string& filename )
-        : m_minpv("MINPV"), 
-          m_pinch("PINCH")
+        : m_nx(0),
+          m_ny(0),
+          m_nz(0),
+          m_numActive(0),
+          m_minpv("MINPV"), 
+          m_pinch("PINCH"),
+          m_eclGrid( std::make_shared<EclGridHolder>() )
     {
+        if (EGRIDFile::isEGRIDFile( filename )) {
+            initFromEGRIDFile( std::make_shared<const EGRIDFile>( filename ));
+            return;
+        }
+
         ecl_grid_type * new_ptr = ecl_grid_load_case( filename.c_str() );
         if (new_ptr)
-            m_grid.reset( new_ptr , ecl_grid_free );
+            initFromEclGrid( new_ptr );
         else
             throw std::invalid_argument("Could not load grid from binary file: " + filename);
     }
 
     EclipseGrid::EclipseGrid(const ecl_grid_type * src_ptr)
-        : m_minpv("MINPV"),
-          m_pinch("PINCH")
+        : m_nx(0),
+          m_ny(0),
+          m_nz(0),
+          m_numActive(0),
+          m_minpv("MINPV"),
+          m_pinch("PINCH"),
+          m_eclGrid( std::make_shared<EclGridHolder>() )
     {
-        m_grid.reset( ecl_grid_alloc_copy( src_ptr ) , ecl_grid_free );
+        initFromEclGrid( ecl_grid_alloc_copy( src_ptr ));
+    }
+
+
+    EclipseGrid::EclipseGrid(std::shared_ptr<const EGRIDFile> file)
+        : m_nx(0),
+          m_ny(0),
+          m_nz(0),
+          m_numActive(0),
+          m_minpv("MINPV"),
+          m_pinch("PINCH"),
+          m_eclGrid( std::make_shared<EclGridHolder>() )
+    {
+        initFromEGRIDFile( file );
+    }
+
+
+    /*
+      Only the dimensions, ACTNUM and MAPAXES are read here; COORD and
+      ZCORN are decoded by the file when they are first needed.
+    */
+    void EclipseGrid::initFromEGRIDFile(std::shared_ptr<const EGRIDFile> file) {
+        m_file = file;
+        m_nx = file->getNX();
+        m_ny = file->getNY();
+        m_nz = file->getNZ();
+        m_mapaxes = file->getMAPAXES();
+
+        std::shared_ptr<const std::vector<int> > actnum = file->getACTNUM();
+        setACTNUM( actnum->empty() ? NULL : actnum->data() );
+    }
+
+
+    /*
+      Takes ownership of the ert grid and imports its corner point
+      representation.
+    */
+    void EclipseGrid::initFromEclGrid(ecl_grid_type * grid) {
+        m_eclGrid->grid.reset( grid , ecl_grid_free );
+        m_nx = static_cast<size_t>(ecl_grid_get_nx( grid ));
+        m_ny = static_cast<size_t>(ecl_grid_get_ny( grid ));
+        m_nz = static_cast<size_t>(ecl_grid_get_nz( grid ));
+
+        {
+            auto coord = std::make_shared<std::vector<double> >( ecl_grid_get_coord_size( grid ));
+            auto zcorn = std::make_shared<std::vector<double> >( ecl_grid_get_zcorn_size( grid ));
+            ecl_grid_init_coord_data_double( grid , coord->data() );
+            ecl_grid_init_zcorn_data_double( grid , zcorn->data() );
+            m_coord = coord;
+            m_zcorn = zcorn;
+        }
+
+        m_numActive = static_cast<size_t>(ecl_grid_get_nactive( grid ));
+        if (m_numActive < getCartesianSize()) {
+            m_actnum.resize( getCartesianSize() );
+            ecl_grid_init_actnum_data( grid , m_actnum.data() );
+        } else
+            m_actnum.clear();
+
+        if (ecl_grid_use_mapaxes( grid )) {
+            m_mapaxes.resize(6);
+            ecl_grid_init_mapaxes_data_double( grid , m_mapaxes.data() );
+        } else
+            m_mapaxes.clear();
+    }
+
+
+    void EclipseGrid::setACTNUM(const int * actnum) {
+        const size_t cartesianSize = getCartesianSize();
+        m_actnum.clear();
+        m_numActive = cartesianSize;
+        if (actnum) {
+            m_actnum.resize( cartesianSize );
+            m_numActive = 0;
+            for (size_t g = 0; g < cartesianSize; g++) {
+                m_actnum[g] = (actnum[g] > 0) ? 1 : 0;
+                m_numActive += m_actnum[g];
+            }
+
+            if (m_numActive == cartesianSize)
+                m_actnum.clear();
+        }
     }
 
 
@@ -68,8 +196,13 @@ namespace Opm {
 
     
     EclipseGrid::EclipseGrid(std::shared_ptr<const Deck> deck)
-        : m_minpv("MINPV"), 
-          m_pinch("PINCH")
+        : m_nx(0),
+          m_ny(0),
+          m_nz(0),
+          m_numActive(0),
+          m_minpv("MINPV"), 
+          m_pinch("PINCH"),
+          m_eclGrid( std::make_shared<EclGridHolder>() )
     {
         const bool hasRUNSPEC = Section::hasRUNSPEC(deck);
         const bool hasGRID = Section::hasGRID(deck);
@@ -133,28 +266,28 @@ namespace Opm {
     bool EclipseGrid::equal(const EclipseGrid& other) const {
         return (m_pinch.equal( other.m_pinch ) &&
                 m_minpv.equal( other.m_minpv ) &&
-                ecl_grid_compare( m_grid.get() , other.m_grid.get() , true , false , false ));
+                ecl_grid_compare( c_ptr() , other.c_ptr() , true , false , false ));
     }
             
 
     size_t EclipseGrid::getNumActive( ) const {
-        return static_cast<size_t>(ecl_grid_get_nactive( m_grid.get() ));
+        return m_numActive;
     }
 
     size_t EclipseGrid::getNX( ) const {
-        return static_cast<size_t>(ecl_grid_get_nx( m_grid.get() ));
+        return m_nx;
     }
 
     size_t EclipseGrid::getNY( ) const {
-        return static_cast<size_t>(ecl_grid_get_ny( m_grid.get() ));
+        return m_ny;
     }
 
     size_t EclipseGrid::getNZ( ) const {
-        return static_cast<size_t>(ecl_grid_get_nz( m_grid.get() ));
+        return m_nz;
     }
 
     size_t EclipseGrid::getCartesianSize( ) const {
-        return static_cast<size_t>( ecl_grid_get_global_size( m_grid.get() ));
+        return m_nx * m_ny * m_nz;
     }
     
     bool EclipseGrid::isPinchActive( ) const {
@@ -186,22 +319,18 @@ namespace Opm {
 
     double EclipseGrid::getCellVolume(size_t globalIndex) const {
         assertGlobalIndex( globalIndex );
-        return ecl_grid_get_cell_volume1( m_grid.get() , static_cast<int>(globalIndex));
+        return getCellVolume( globalIndex % m_nx , (globalIndex / m_nx) % m_ny , globalIndex / (m_nx * m_ny));
     }
 
 
     double EclipseGrid::getCellVolume(size_t i , size_t j , size_t k) const {
         assertIJK(i,j,k);
-        return ecl_grid_get_cell_volume3( m_grid.get() , static_cast<int>(i),static_cast<int>(j),static_cast<int>(k));
+        return CellGeometry::cellVolume( m_nx , m_ny , i , j , k , getCOORD().data() , getZCORN().data() );
     }
 
     std::tuple<double,double,double> EclipseGrid::getCellCenter(size_t globalIndex) const {
         assertGlobalIndex( globalIndex );
-        {
-            double x,y,z;
-            ecl_grid_get_xyz1( m_grid.get() , static_cast<int>(globalIndex) , &x , &y , &z);
-            return std::tuple<double,double,double> {x,y,z};
-        }
+        return getCellCenter( globalIndex % m_nx , (globalIndex / m_nx) % m_ny , globalIndex / (m_nx * m_ny));
     }
 
 
@@ -209,7 +338,9 @@ namespace Opm {
         assertIJK(i,j,k);
         {
             double x,y,z;
-            ecl_grid_get_xyz3( m_grid.get() , static_cast<int>(i),static_cast<int>(j),static_cast<int>(k), &x , &y , &z);
+            CellGeometry::cellCenter( m_nx , m_ny , i , j , k , getCOORD().data() , getZCORN().data() , x , y , z );
+            if (!m_mapaxes.empty())
+                applyMAPAXES( m_mapaxes , x , y );
             return std::tuple<double,double,double> {x,y,z};
         }
     }
@@ -250,50 +381,36 @@ namespace Opm {
 
 
 
+    /*
+      The COORD and ZCORN arrays are shared with the deck keywords; the
+      aliasing shared_ptr keeps the keyword alive as long as the grid.
+    */
     void EclipseGrid::initCornerPointGrid(const std::vector<int>& dims , DeckConstPtr deck) {
         assertCornerPointKeywords( dims , deck );
         {
             DeckKeywordConstPtr ZCORNKeyWord = deck->getKeyword("ZCORN");
             DeckKeywordConstPtr COORDKeyWord = deck->getKeyword("COORD");
-            const std::vector<double>& zcorn = ZCORNKeyWord->getSIDoubleData();
-            const std::vector<double>& coord = COORDKeyWord->getSIDoubleData();
-            const int * actnum = NULL;
-            double    * mapaxes = NULL;
-            
+
+            m_nx = static_cast<size_t>(dims[0]);
+            m_ny = static_cast<size_t>(dims[1]);
+            m_nz = static_cast<size_t>(dims[2]);
+            m_zcorn = std::shared_ptr<const std::vector<double> >( ZCORNKeyWord , &ZCORNKeyWord->getSIDoubleData() );
+            m_coord = std::shared_ptr<const std::vector<double> >( COORDKeyWord , &COORDKeyWord->getSIDoubleData() );
+
             if (deck->hasKeyword("ACTNUM")) {
                 DeckKeywordConstPtr actnumKeyword = deck->getKeyword("ACTNUM");
                 const std::vector<int>& actnumVector = actnumKeyword->getIntData();
-                actnum = actnumVector.data();
-                
-            }
-            
+                setACTNUM( actnumVector.data() );
+            } else
+                setACTNUM( NULL );
+
             if (deck->hasKeyword("MAPAXES")) {
                 DeckKeywordConstPtr mapaxesKeyword = deck->getKeyword("MAPAXES");
                 DeckRecordConstPtr record = mapaxesKeyword->getRecord(0);
-                mapaxes = new double[6];
+                m_mapaxes.resize(6);
                 for (size_t i = 0; i < 6; i++) {
                     DeckItemConstPtr item = record->getItem(i);
-                    mapaxes[i] = item->getSIDouble(0);
-                }
-            }
-            
-            
-            {
-                const std::vector<float> zcorn_float( zcorn.begin() , zcorn.end() );
-                const std::vector<float> coord_float( coord.begin() , coord.end() );
-                float * mapaxes_float = NULL;
-                if (mapaxes) {
-                    mapaxes_float = new float[6];
-                    for (size_t i=0; i < 6; i++)
-                        mapaxes_float[i] = mapaxes[i];
-                }
-                
-                ecl_grid_type * ecl_grid = ecl_grid_alloc_GRDECL_data(dims[0] , dims[1] , dims[2] , zcorn_float.data() , coord_float.data() , actnum , mapaxes_float);
-                m_grid.reset( ecl_grid , ecl_grid_free);    
-                
-                if (mapaxes) {
-                    delete[] mapaxes_float;
-                    delete[] mapaxes;
+                    m_mapaxes[i] = item->getSIDouble(0);
                 }
             }
         }
@@ -355,7 +472,7 @@ namespace Opm {
         assertVectorSize( DYV    , static_cast<size_t>( dims[1] ) , "DYV");
         assertVectorSize( DZV    , static_cast<size_t>( dims[2] ) , "DZV");
         
-        m_grid.reset( ecl_grid_alloc_dxv_dyv_dzv_depthz( dims[0] , dims[1] , dims[2] , DXV.data() , DYV.data() , DZV.data() , DEPTHZ.data() , NULL ) , ecl_grid_free);
+        initFromEclGrid( ecl_grid_alloc_dxv_dyv_dzv_depthz( dims[0] , dims[1] , dims[2] , DXV.data() , DYV.data() , DZV.data() , DEPTHZ.data() , NULL ));
     }
 
 
@@ -365,7 +482,7 @@ namespace Opm {
         std::vector<double> DZ = createDVector( dims , 2 , "DZ" , "DZV" , deck);
         std::vector<double> TOPS = createTOPSVector( dims , DZ , deck );
         
-        m_grid.reset( ecl_grid_alloc_dx_dy_dz_tops( dims[0] , dims[1] , dims[2] , DX.data() , DY.data() , DZ.data() , TOPS.data() , NULL ) , ecl_grid_free);
+        initFromEclGrid( ecl_grid_alloc_dx_dy_dz_tops( dims[0] , dims[1] , dims[2] , DX.data() , DY.data() , DZ.data() , TOPS.data() , NULL ));
     }
 
     
@@ -441,48 +558,112 @@ namespace Opm {
     } 
 
     void EclipseGrid::exportACTNUM( std::vector<int>& actnum) const {
-        size_t volume = getNX() * getNY() * getNZ();
-        if (getNumActive() == volume)
-            actnum.resize(0);
-        else {
-            actnum.resize( volume );
-            ecl_grid_init_actnum_data( m_grid.get() , actnum.data() );
-        }
+        actnum = m_actnum;
+    }
+
+    void EclipseGrid::exportCellDepths( std::vector<double>& depths) const {
+        std::shared_ptr<const CellGeometry> cellGeometry = std::atomic_load( &m_cellGeometry );
+        if (cellGeometry)
+            depths = cellGeometry->getDepth();
+        else
+            CellGeometry::cellDepths( m_nx , m_ny , m_nz , getZCORN() , depths );
     }
 
     void EclipseGrid::exportMAPAXES( std::vector<double>& mapaxes) const {
-        if (ecl_grid_use_mapaxes( m_grid.get())) {
-            mapaxes.resize(6);
-            ecl_grid_init_mapaxes_data_double( m_grid.get() , mapaxes.data() );
-        } else {
-            mapaxes.resize(0);
-        }
+        mapaxes = m_mapaxes;
     }
         
     void EclipseGrid::exportCOORD( std::vector<double>& coord) const {
-        coord.resize( ecl_grid_get_coord_size( m_grid.get() ));
-        ecl_grid_init_coord_data_double( m_grid.get() , coord.data() );
+        coord = getCOORD();
     }
 
     void EclipseGrid::exportZCORN( std::vector<double>& zcorn) const {
-        zcorn.resize( ecl_grid_get_zcorn_size( m_grid.get() ));
-        ecl_grid_init_zcorn_data_double( m_grid.get() , zcorn.data() );
+        zcorn = getZCORN();
+    }
+
+    const std::vector<double>& EclipseGrid::getCOORD() const {
+        if (m_coord)
+            return *m_coord;
+        else
+            return *m_file->getCOORD();
+    }
+
+    const std::vector<double>& EclipseGrid::getZCORN() const {
+        if (m_zcorn)
+            return *m_zcorn;
+        else
+            return *m_file->getZCORN();
     }
 
     
     
     void EclipseGrid::resetACTNUM( const int * actnum) {
-        ecl_grid_reset_actnum( m_grid.get() , actnum );
+        setACTNUM( actnum );
+        if (m_eclGrid.use_count() > 1)
+            m_eclGrid = std::make_shared<EclGridHolder>();
+        else {
+            std::lock_guard<std::mutex> lock( m_eclGrid->mutex );
+            if (m_eclGrid->grid)
+                ecl_grid_reset_actnum( m_eclGrid->grid.get() , actnum );
+        }
+        std::atomic_store( &m_activeIndexMap , std::shared_ptr<const ActiveIndexMap>() );
+    }
+
+
+    /*
+      Concurrent first calls may both build the map; they build
+      identical maps and one of them is kept. The same holds for the
+      cell geometry below.
+    */
+    std::shared_ptr<const ActiveIndexMap> EclipseGrid::getActiveIndexMap() const {
+        std::shared_ptr<const ActiveIndexMap> activeIndexMap = std::atomic_load( &m_activeIndexMap );
+        if (!activeIndexMap) {
+            std::vector<int> actnum;
+            exportACTNUM( actnum );
+            activeIndexMap = std::make_shared<const ActiveIndexMap>( getCartesianSize() , actnum );
+            std::atomic_store( &m_activeIndexMap , activeIndexMap );
+        }
+        return activeIndexMap;
+    }
+
+
+    std::shared_ptr<const CellGeometry> EclipseGrid::getCellGeometry() const {
+        std::shared_ptr<const CellGeometry> cellGeometry = std::atomic_load( &m_cellGeometry );
+        if (!cellGeometry) {
+            cellGeometry = std::make_shared<const CellGeometry>( getNX() , getNY() , getNZ() , getCOORD() , getZCORN() );
+            std::atomic_store( &m_cellGeometry , cellGeometry );
+        }
+        return cellGeometry;
     }
 
 
     void EclipseGrid::fwriteEGRID( const std::string& filename ) const {
-        ecl_grid_fwrite_EGRID( m_grid.get() , filename.c_str() );
+        ecl_grid_fwrite_EGRID( c_ptr() , filename.c_str() );
     }
 
 
+    /*
+      The ert grid of a grid built from COORD/ZCORN keywords is created
+      on the first call; ert stores the corner point data in single
+      precision.
+    */
     const ecl_grid_type * EclipseGrid::c_ptr() const {
-        return m_grid.get();
+        std::lock_guard<std::mutex> lock( m_eclGrid->mutex );
+        std::shared_ptr<ecl_grid_type>& grid = m_eclGrid->grid;
+        if (!grid) {
+            const std::vector<double>& zcorn = getZCORN();
+            const std::vector<double>& coord = getCOORD();
+            const std::vector<float> zcorn_float( zcorn.begin() , zcorn.end() );
+            const std::vector<float> coord_float( coord.begin() , coord.end() );
+            const std::vector<float> mapaxes_float( m_mapaxes.begin() , m_mapaxes.end() );
+            const int * actnum = m_actnum.empty() ? NULL : m_actnum.data();
+            const float * mapaxes = mapaxes_float.empty() ? NULL : mapaxes_float.data();
+
+            ecl_grid_type * ecl_grid = ecl_grid_alloc_GRDECL_data( static_cast<int>(m_nx) , static_cast<int>(m_ny) , static_cast<int>(m_nz) ,
+                                                                  zcorn_float.data() , coord_float.data() , actnum , mapaxes );
+            grid.reset( ecl_grid , ecl_grid_free );
+        }
+        return grid.get();
     }
 
 
@@ -25,18 +25,35 @@
 #include <opm/parser/eclipse/Deck/Section.hpp>
 
 #include <opm/parser/eclipse/EclipseState/Util/Value.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/ActiveIndexMap.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/CellGeometry.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/EGRIDFile.hpp>
 
 #include <ert/ecl/ecl_grid.h>
 
 #include <memory>
+#include <mutex>
 
 namespace Opm {
 
+
+    /*
+      The EclipseGrid class holds the corner point representation of
+      the grid - COORD, ZCORN and ACTNUM - in double precision. For a
+      grid built from COORD/ZCORN keywords the arrays are shared with
+      the Deck, i.e. they are not copied. The cell geometry is computed
+      from these arrays, and the ert grid is only created - on demand -
+      for c_ptr() and for export paths like fwriteEGRID(). For a grid
+      read from a binary EGRID file COORD and ZCORN stay in the file
+      until they are first used. Cartesian grids and grids loaded from
+      other file formats are built with ert and imported.
+    */
     class EclipseGrid {
     public:
         explicit EclipseGrid(const std::string& filename);
         explicit EclipseGrid(const ecl_grid_type * src_ptr);
         explicit EclipseGrid(std::shared_ptr<const Deck> deck);
+        explicit EclipseGrid(std::shared_ptr<const EGRIDFile> file);
 
         static bool hasCornerPointKeywords(std::shared_ptr<const Deck> deck);
         static bool hasCartesianKeywords(std::shared_ptr<const Deck> deck);
@@ -52,6 +69,9 @@ namespace Opm {
 
         void assertGlobalIndex(size_t globalIndex) const;
         void assertIJK(size_t i , size_t j , size_t k) const;
+        // computed from COORD/ZCORN as in CellGeometry, which also
+        // describes how the values compare to those of ert. Unlike the
+        // CellGeometry centers, x and y are transformed with MAPAXES.
         std::tuple<double,double,double> getCellCenter(size_t i,size_t j, size_t k) const;
         std::tuple<double,double,double> getCellCenter(size_t globalIndex) const;
         double getCellVolume(size_t globalIndex) const;
@@ -60,16 +80,64 @@ namespace Opm {
         void exportMAPAXES( std::vector<double>& mapaxes) const;
         void exportCOORD( std::vector<double>& coord) const;
         void exportZCORN( std::vector<double>& zcorn) const;
+        // direct read access to the corner point arrays, without copy
+        const std::vector<double>& getCOORD() const;
+        const std::vector<double>& getZCORN() const;
         void exportACTNUM( std::vector<int>& actnum) const;
+        // the depth of the center of every cell, in global index order.
+        void exportCellDepths( std::vector<double>& depths) const;
         void resetACTNUM( const int * actnum);
+
+        /*
+          The mapping between global and active cell indices; built on
+          the first call and rebuilt after resetACTNUM().
+        */
+        std::shared_ptr<const ActiveIndexMap> getActiveIndexMap() const;
+
+        /*
+          The centers, volumes, sizes and face areas of all the cells,
+          computed from COORD/ZCORN on the first call.
+        */
+        std::shared_ptr<const CellGeometry> getCellGeometry() const;
+
         bool equal(const EclipseGrid& other) const;
         void fwriteEGRID( const std::string& filename ) const;
         const ecl_grid_type * c_ptr() const;
     private:
-        std::shared_ptr<ecl_grid_type> m_grid;
+        size_t m_nx;
+        size_t m_ny;
+        size_t m_nz;
+        size_t m_numActive;
+        std::shared_ptr<const std::vector<double> > m_coord;
+        std::shared_ptr<const std::vector<double> > m_zcorn;
+        // empty if all the cells are active
+        std::vector<int> m_actnum;
+        // empty if the grid has no MAPAXES
+        std::vector<double> m_mapaxes;
+        // set for grids read from an EGRID file; m_coord and m_zcorn
+        // are then empty
+        std::shared_ptr<const EGRIDFile> m_file;
+
+        /*
+          The ert grid is created on demand by c_ptr(). The holder is
+          shared by the copies of a grid, which keeps EclipseGrid
+          copyable; resetACTNUM() gives a grid a holder of its own
+          when the holder is shared.
+        */
+        struct EclGridHolder {
+            std::mutex mutex;
+            std::shared_ptr<ecl_grid_type> grid;
+        };
+
         Value<double> m_minpv;
         Value<double> m_pinch;
+        std::shared_ptr<EclGridHolder> m_eclGrid;
+        mutable std::shared_ptr<const ActiveIndexMap> m_activeIndexMap;
+        mutable std::shared_ptr<const CellGeometry> m_cellGeometry;
 
+        void initFromEclGrid(ecl_grid_type * grid);
+        void initFromEGRIDFile(std::shared_ptr<const EGRIDFile> file);
+        void setACTNUM(const int * actnum);
         void initCartesianGrid(const std::vector<int>& dims , DeckConstPtr deck);
         void initCornerPointGrid(const std::vector<int>& dims , DeckConstPtr deck);
         void assertCornerPointKeywords( const std::vector<int>& dims , DeckConstPtr deck ) const ;
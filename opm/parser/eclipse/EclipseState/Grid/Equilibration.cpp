@@ -0,0 +1,514 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include <opm/parser/eclipse/Utility/EquilWrapper.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/Equilibration.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/GridPropertyInitializers.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/RegionIndex.hpp>
+#include <opm/parser/eclipse/EclipseState/Util/Parallel.hpp>
+
+namespace Opm {
+
+namespace {
+
+    const double gravity = 9.80665;
+
+
+    // Linear interpolation in a table with increasing x; constant
+    // extrapolation outside the table.
+    double interpolate(const std::vector<double>& x , const std::vector<double>& y , double xPos) {
+        if (xPos <= x.front())
+            return y.front();
+        if (xPos >= x.back())
+            return y.back();
+
+        const size_t upper = std::upper_bound( x.begin() , x.end() , xPos ) - x.begin();
+        const double weight = (xPos - x[upper - 1]) / (x[upper] - x[upper - 1]);
+        return y[upper - 1] + weight * (y[upper] - y[upper - 1]);
+    }
+
+
+    /*
+      Inverts a monotonic capillary pressure column; capillary pressures
+      outside the column give the saturation at the end with the
+      nearest capillary pressure. Returns NaN if the capillary pressure
+      is constant, i.e. the contact is sharp. A column which is not
+      monotonic gives the first saturation with the capillary pressure,
+      and is clamped to the saturations of its extreme values.
+    */
+    double saturationFromPc(const std::vector<double>& saturation , const std::vector<double>& pc , double pcValue) {
+        const auto range = std::minmax_element( pc.begin() , pc.end() );
+        if (*range.first == *range.second)
+            return std::nan("");
+
+        if (pc.front() != pc.back()) {
+            const bool increasing = (pc.back() > pc.front());
+            if (pcValue <= std::min( pc.front() , pc.back() ))
+                return increasing ? saturation.front() : saturation.back();
+            if (pcValue >= std::max( pc.front() , pc.back() ))
+                return increasing ? saturation.back() : saturation.front();
+        } else {
+            if (pcValue <= *range.first)
+                return saturation[ range.first - pc.begin() ];
+            if (pcValue >= *range.second)
+                return saturation[ range.second - pc.begin() ];
+        }
+
+        for (size_t i = 0; i + 1 < pc.size(); i++) {
+            if (pc[i] != pc[i + 1] && (pcValue - pc[i]) * (pcValue - pc[i + 1]) <= 0)
+                return saturation[i] + (saturation[i + 1] - saturation[i]) * (pcValue - pc[i]) / (pc[i + 1] - pc[i]);
+        }
+        return saturation.back();
+    }
+
+
+    // The table of a region; the last table is used for regions beyond
+    // the number of tables, and nullptr if there are no tables.
+    template <class Table>
+    const Table* selectTable(const std::vector<Table>& tables , size_t index) {
+        if (tables.empty())
+            return nullptr;
+
+        return &tables[ std::min( index , tables.size() - 1 ) ];
+    }
+
+
+    struct DepthGrid {
+        double top;
+        double dz;
+        size_t size;
+
+        double depth(size_t node) const {
+            return top + node * dz;
+        }
+
+        double interpolate(const std::vector<double>& values , double z) const {
+            const double position = std::min( std::max( (z - top) / dz , 0.0 ) , static_cast<double>(size - 1) );
+            const size_t node = std::min( static_cast<size_t>(position) , size - 2 );
+            const double weight = position - node;
+            return values[node] + weight * (values[node + 1] - values[node]);
+        }
+    };
+
+
+    /*
+      Integrates dp/dz = g * density(p, z) from (z0, p0) to all the
+      nodes of the depth grid, with the midpoint rule: first to the
+      node nearest to z0, and then node by node up and down.
+    */
+    template <class Density>
+    void integrate(const DepthGrid& grid , double z0 , double p0 , const Density& density , std::vector<double>& pressure) {
+        auto step = [&density](double z , double p , double h) {
+            const double midPressure = p + 0.5 * h * gravity * density( p , z );
+            return p + h * gravity * density( midPressure , z + 0.5 * h );
+        };
+
+        pressure.resize( grid.size );
+        const double position = std::min( std::max( (z0 - grid.top) / grid.dz , 0.0 ) , static_cast<double>(grid.size - 1) );
+        const size_t start = static_cast<size_t>( std::floor( position + 0.5 ));
+
+        pressure[start] = step( z0 , p0 , grid.depth( start ) - z0 );
+        for (size_t node = start + 1; node < grid.size; node++)
+            pressure[node] = step( grid.depth( node - 1 ) , pressure[node - 1] , grid.dz );
+
+        for (size_t node = start; node > 0; node--)
+            pressure[node - 1] = step( grid.depth( node ) , pressure[node] , -grid.dz );
+    }
+
+
+    // The phase densities at reservoir conditions in one equilibration region.
+    class RegionFluid {
+    public:
+        RegionFluid(const Equilibration::PvtParameters& pvt , bool dissolvedGas ,
+                    const PvdoTable* pvdo , const PvtoTable* pvto ,
+                    const PvdgTable* pvdg , const PvtgTable* pvtg ,
+                    const RsvdTable* rsvd)
+            : m_pvt( pvt ),
+              m_pvdo( pvdo ),
+              m_pvto( dissolvedGas ? pvto : nullptr ),
+              m_pvdg( pvdg ),
+              m_pvtg( pvtg ),
+              m_rsvd( rsvd ),
+              m_rsConstant( 0 )
+        { }
+
+        bool isLive() const {
+            return m_pvto != nullptr;
+        }
+
+        bool hasRsvd() const {
+            return m_rsvd != nullptr;
+        }
+
+        void setRsConstant(double rs) {
+            m_rsConstant = rs;
+        }
+
+        double rsSaturated(double pressure) const {
+            if (!m_pvto)
+                return 0;
+
+            const auto outerTable = m_pvto->getOuterTable();
+            return interpolate( outerTable->getPressureColumn() , outerTable->getGasSolubilityColumn() , pressure );
+        }
+
+        double rs(double z , double oilPressure) const {
+            if (!m_pvto)
+                return 0;
+
+            const double rs = m_rsvd ? interpolate( m_rsvd->getDepthColumn() , m_rsvd->getRsColumn() , z ) : m_rsConstant;
+            return std::min( rs , rsSaturated( oilPressure ));
+        }
+
+        double oilDensity(double pressure , double z) const {
+            if (m_pvto) {
+                const auto outerTable = m_pvto->getOuterTable();
+                const double dissolvedGas = rs( z , pressure );
+                const double bo = interpolate( outerTable->getGasSolubilityColumn() , outerTable->getOilFormationFactorColumn() , dissolvedGas );
+                return (m_pvt.oilSurfaceDensity + dissolvedGas * m_pvt.gasSurfaceDensity) / bo;
+            } else if (m_pvdo)
+                return m_pvt.oilSurfaceDensity / interpolate( m_pvdo->getPressureColumn() , m_pvdo->getFormationFactorColumn() , pressure );
+            else
+                return m_pvt.oilSurfaceDensity;
+        }
+
+        // Bw = Bw(ref) / (1 + X + X^2/2) with X = c (p - p(ref)), as for PVTW
+        double waterDensity(double pressure) const {
+            const double x = m_pvt.waterCompressibility * (pressure - m_pvt.waterReferencePressure);
+            return m_pvt.waterSurfaceDensity * (1 + x + 0.5 * x * x) / m_pvt.waterFormationFactor;
+        }
+
+        double gasDensity(double pressure) const {
+            if (m_pvtg) {
+                const auto outerTable = m_pvtg->getOuterTable();
+                return m_pvt.gasSurfaceDensity / interpolate( outerTable->getPressureColumn() , outerTable->getGasFormationFactorColumn() , pressure );
+            } else if (m_pvdg)
+                return m_pvt.gasSurfaceDensity / interpolate( m_pvdg->getPressureColumn() , m_pvdg->getFormationFactorColumn() , pressure );
+            else
+                return m_pvt.gasSurfaceDensity;
+        }
+
+    private:
+        Equilibration::PvtParameters m_pvt;
+        const PvdoTable* m_pvdo;
+        const PvtoTable* m_pvto;
+        const PvdgTable* m_pvdg;
+        const PvtgTable* m_pvtg;
+        const RsvdTable* m_rsvd;
+        double m_rsConstant;
+    };
+
+
+    struct Profile {
+        DepthGrid grid;
+        std::vector<double> oil;
+        std::vector<double> water;
+        std::vector<double> gas;
+    };
+
+
+    /*
+      The phase pressures of a region on a depth grid spanning
+      [minDepth, maxDepth], the datum and the contacts of the phases
+      present.
+    */
+    void computeProfile(const Equilibration::EquilRecord& record , RegionFluid& fluid ,
+                        bool hasWater , bool hasGas ,
+                        double minDepth , double maxDepth , size_t numDepthNodes ,
+                        Profile& profile) {
+        double top = std::min( minDepth , record.datumDepth );
+        double bottom = std::max( maxDepth , record.datumDepth );
+        if (hasWater) {
+            top = std::min( top , record.owcDepth );
+            bottom = std::max( bottom , record.owcDepth );
+        }
+        if (hasGas) {
+            top = std::min( top , record.gocDepth );
+            bottom = std::max( bottom , record.gocDepth );
+        }
+        if (bottom <= top)
+            bottom = top + 1;
+
+        DepthGrid& grid = profile.grid;
+        grid.top = top;
+        grid.size = numDepthNodes;
+        grid.dz = (bottom - top) / (numDepthNodes - 1);
+
+        auto oilDensity = [&fluid](double p , double z) { return fluid.oilDensity( p , z ); };
+        auto waterDensity = [&fluid](double p , double) { return fluid.waterDensity( p ); };
+        auto gasDensity = [&fluid](double p , double) { return fluid.gasDensity( p ); };
+
+        // Live oil without RSVD is saturated at the gas-oil contact;
+        // the oil is integrated once more with the dissolved gas at the
+        // contact pressure of the first pass.
+        auto integrateOil = [&](double z0 , double p0) {
+            if (fluid.isLive() && !fluid.hasRsvd()) {
+                fluid.setRsConstant( fluid.rsSaturated( p0 ));
+                integrate( grid , z0 , p0 , oilDensity , profile.oil );
+                fluid.setRsConstant( fluid.rsSaturated( grid.interpolate( profile.oil , record.gocDepth )));
+            }
+            integrate( grid , z0 , p0 , oilDensity , profile.oil );
+        };
+
+        if (hasWater && record.datumDepth > record.owcDepth) {
+            integrate( grid , record.datumDepth , record.datumPressure , waterDensity , profile.water );
+            integrateOil( record.owcDepth , grid.interpolate( profile.water , record.owcDepth ) + record.owcCapillaryPressure );
+            if (hasGas)
+                integrate( grid , record.gocDepth , grid.interpolate( profile.oil , record.gocDepth ) + record.gocCapillaryPressure , gasDensity , profile.gas );
+        } else if (hasGas && record.datumDepth < record.gocDepth) {
+            integrate( grid , record.datumDepth , record.datumPressure , gasDensity , profile.gas );
+            integrateOil( record.gocDepth , grid.interpolate( profile.gas , record.gocDepth ) - record.gocCapillaryPressure );
+            if (hasWater)
+                integrate( grid , record.owcDepth , grid.interpolate( profile.oil , record.owcDepth ) - record.owcCapillaryPressure , waterDensity , profile.water );
+        } else {
+            integrateOil( record.datumDepth , record.datumPressure );
+            if (hasWater)
+                integrate( grid , record.owcDepth , grid.interpolate( profile.oil , record.owcDepth ) - record.owcCapillaryPressure , waterDensity , profile.water );
+            if (hasGas)
+                integrate( grid , record.gocDepth , grid.interpolate( profile.oil , record.gocDepth ) + record.gocCapillaryPressure , gasDensity , profile.gas );
+        }
+    }
+
+
+    std::shared_ptr<const GridProperty<double> > createProperty(const EclipseGrid& grid , const std::string& name , const std::string& dimension ,
+                                                                std::shared_ptr<const std::vector<double> > values) {
+        std::shared_ptr<const GridPropertyBaseInitializer<double> > initializer = std::make_shared<const GridPropertyVectorInitializer<double> >( values );
+        return std::make_shared<const GridProperty<double> >( grid.getNX() , grid.getNY() , grid.getNZ() ,
+                                                              GridPropertySupportedKeywordInfo<double>( name , initializer , dimension ));
+    }
+}
+
+
+    Equilibration::Equilibration(DeckConstPtr deck , const EclipseState& state , size_t numDepthNodes) {
+        equilibrate( state , readEquil( deck ) , readPvtParameters( deck ) , numDepthNodes );
+    }
+
+
+    Equilibration::Equilibration(const EclipseState& state ,
+                                 const std::vector<EquilRecord>& equil ,
+                                 const std::vector<PvtParameters>& pvt ,
+                                 size_t numDepthNodes) {
+        equilibrate( state , equil , pvt , numDepthNodes );
+    }
+
+
+    std::vector<Equilibration::EquilRecord> Equilibration::readEquil(DeckConstPtr deck) {
+        if (!deck->hasKeyword("EQUIL"))
+            throw std::invalid_argument("The equilibration requires the EQUIL keyword");
+
+        EquilWrapper equilWrapper( deck->getKeyword("EQUIL") );
+        std::vector<EquilRecord> equil( equilWrapper.numRegions() );
+        for (int regionIdx = 0; regionIdx < equilWrapper.numRegions(); regionIdx++) {
+            EquilRecord& record = equil[regionIdx];
+            record.datumDepth = equilWrapper.datumDepth( regionIdx );
+            record.datumPressure = equilWrapper.datumDepthPressure( regionIdx );
+            record.owcDepth = equilWrapper.waterOilContactDepth( regionIdx );
+            record.owcCapillaryPressure = equilWrapper.waterOilContactCapillaryPressure( regionIdx );
+            record.gocDepth = equilWrapper.gasOilContactDepth( regionIdx );
+            record.gocCapillaryPressure = equilWrapper.gasOilContactCapillaryPressure( regionIdx );
+        }
+        return equil;
+    }
+
+
+    /*
+      One set of parameters per record of DENSITY or PVTW, whichever
+      has more; without the keywords the defaults of DENSITY and an
+      incompressible water with Bw = 1 are used.
+    */
+    std::vector<Equilibration::PvtParameters> Equilibration::readPvtParameters(DeckConstPtr deck) {
+        DeckKeywordConstPtr densityKeyword = deck->hasKeyword("DENSITY") ? deck->getKeyword("DENSITY") : DeckKeywordConstPtr();
+        DeckKeywordConstPtr pvtwKeyword = deck->hasKeyword("PVTW") ? deck->getKeyword("PVTW") : DeckKeywordConstPtr();
+        const size_t numDensity = densityKeyword ? densityKeyword->size() : 0;
+        const size_t numPvtw = pvtwKeyword ? pvtwKeyword->size() : 0;
+
+        std::vector<PvtParameters> pvt( std::max( static_cast<size_t>(1) , std::max( numDensity , numPvtw )));
+        for (size_t pvtIdx = 0; pvtIdx < pvt.size(); pvtIdx++) {
+            PvtParameters& parameters = pvt[pvtIdx];
+            parameters.oilSurfaceDensity = 600;
+            parameters.waterSurfaceDensity = 999.014;
+            parameters.gasSurfaceDensity = 1;
+            parameters.waterReferencePressure = 0;
+            parameters.waterFormationFactor = 1;
+            parameters.waterCompressibility = 0;
+
+            if (numDensity > 0) {
+                DeckRecordConstPtr record = densityKeyword->getRecord( std::min( pvtIdx , numDensity - 1 ));
+                parameters.oilSurfaceDensity = record->getItem("OIL")->getSIDouble(0);
+                parameters.waterSurfaceDensity = record->getItem("WATER")->getSIDouble(0);
+                parameters.gasSurfaceDensity = record->getItem("GAS")->getSIDouble(0);
+            }
+
+            if (numPvtw > 0) {
+                DeckRecordConstPtr record = pvtwKeyword->getRecord( std::min( pvtIdx , numPvtw - 1 ));
+                parameters.waterReferencePressure = record->getItem("P_REF")->getSIDouble(0);
+                parameters.waterFormationFactor = record->getItem("WATER_VOL_FACTOR")->getSIDouble(0);
+                parameters.waterCompressibility = record->getItem("WATER_COMPRESSIBILITY")->getSIDouble(0);
+            }
+        }
+        return pvt;
+    }
+
+
+    void Equilibration::equilibrate(const EclipseState& state ,
+                                    const std::vector<EquilRecord>& equil ,
+                                    const std::vector<PvtParameters>& pvt ,
+                                    size_t numDepthNodes) {
+        if (equil.empty() || pvt.empty())
+            throw std::invalid_argument("The equilibration requires at least one EQUIL record and one set of PVT parameters");
+
+        if (numDepthNodes < 2)
+            throw std::invalid_argument("The depth grid of the equilibration must have at least two nodes");
+
+        if (!state.hasPhase( Phase::OIL ))
+            throw std::invalid_argument("The equilibration requires an oil phase");
+
+        const bool hasWater = state.hasPhase( Phase::WATER );
+        const bool hasGas = state.hasPhase( Phase::GAS );
+        // live oil, i.e. PVTO and the dissolved gas ratio, requires DISGAS
+        const bool dissolvedGas = hasGas && state.hasDissolvedGas();
+
+        EclipseGridConstPtr grid = state.getEclipseGrid();
+        const size_t cartesianSize = grid->getCartesianSize();
+        std::shared_ptr<const CellGeometry> cellGeometry = grid->getCellGeometry();
+        const std::vector<double>& depth = cellGeometry->getDepth();
+
+        // Absent region keywords are not created in the state; all the
+        // cells are then in region 1.
+        const bool hasEQLNUM = state.hasIntGridProperty( "EQLNUM" );
+        const GridPropertyView<int> eqlnum = hasEQLNUM ? state.getIntGridProperty( "EQLNUM" )->getView() : GridPropertyView<int>( cartesianSize , 1 );
+        const GridPropertyView<int> pvtnum = state.hasIntGridProperty( "PVTNUM" ) ? state.getIntGridProperty( "PVTNUM" )->getView() : GridPropertyView<int>( cartesianSize , 1 );
+        const GridPropertyView<int> satnum = state.hasIntGridProperty( "SATNUM" ) ? state.getIntGridProperty( "SATNUM" )->getView() : GridPropertyView<int>( cartesianSize , 1 );
+
+        std::shared_ptr<const RegionIndex> regionIndex = hasEQLNUM ? state.getRegionIndex( "EQLNUM" ) :
+            std::make_shared<const RegionIndex>( grid->getNX() , grid->getNY() , grid->getNZ() , eqlnum );
+        const std::vector<int>& regions = regionIndex->getRegions();
+        if (regions.empty())
+            throw std::invalid_argument("The equilibration requires a grid with cells");
+
+        if (regions.front() < 1 || static_cast<size_t>(regions.back()) > equil.size())
+            throw std::invalid_argument("The EQLNUM values must refer to the records of EQUIL");
+
+        // The fluid of a region is given by the PVT region of its first cell.
+        std::vector<RegionFluid> fluids;
+        fluids.reserve( equil.size() );
+        for (size_t regionIdx = 0; regionIdx < equil.size(); regionIdx++) {
+            const std::pair<size_t , size_t> cellRange = regionIndex->getCellRange( static_cast<int>(regionIdx + 1) );
+            size_t pvtIdx = 0;
+            if (cellRange.second > cellRange.first)
+                pvtIdx = static_cast<size_t>( std::max( pvtnum[ regionIndex->getCells()[cellRange.first] ] , 1 ) - 1 );
+
+            fluids.push_back( RegionFluid( pvt[ std::min( pvtIdx , pvt.size() - 1 ) ] , dissolvedGas ,
+                                           selectTable( state.getPvdoTables() , pvtIdx ) ,
+                                           selectTable( state.getPvtoTables() , pvtIdx ) ,
+                                           selectTable( state.getPvdgTables() , pvtIdx ) ,
+                                           selectTable( state.getPvtgTables() , pvtIdx ) ,
+                                           selectTable( state.getRsvdTables() , regionIdx )));
+        }
+
+        std::vector<Profile> profiles( equil.size() );
+#pragma omp parallel for schedule(dynamic)
+        for (long r = 0; r < static_cast<long>(regions.size()); r++) {
+            const size_t regionIdx = static_cast<size_t>( regions[r] - 1 );
+            const std::vector<int>& cells = regionIndex->getCells();
+            double minDepth = std::numeric_limits<double>::max();
+            double maxDepth = -std::numeric_limits<double>::max();
+            for (size_t n = regionIndex->getRowStart()[r]; n < regionIndex->getRowStart()[r + 1]; n++) {
+                minDepth = std::min( minDepth , depth[cells[n]] );
+                maxDepth = std::max( maxDepth , depth[cells[n]] );
+            }
+
+            computeProfile( equil[regionIdx] , fluids[regionIdx] , hasWater , hasGas , minDepth , maxDepth , numDepthNodes , profiles[regionIdx] );
+        }
+
+        const std::vector<SwofTable>& swofTables = state.getSwofTables();
+        const std::vector<SgofTable>& sgofTables = state.getSgofTables();
+        auto pressure = std::make_shared<std::vector<double> >( cartesianSize );
+        auto swat = std::make_shared<std::vector<double> >( cartesianSize );
+        auto sgas = std::make_shared<std::vector<double> >( cartesianSize );
+        auto rs = std::make_shared<std::vector<double> >( cartesianSize );
+
+#pragma omp parallel for schedule(static) if (cartesianSize >= parallelThreshold)
+        for (long g = 0; g < static_cast<long>(cartesianSize); g++) {
+            const size_t regionIdx = static_cast<size_t>( eqlnum[g] - 1 );
+            const Profile& profile = profiles[regionIdx];
+            const EquilRecord& record = equil[regionIdx];
+            const size_t satIdx = static_cast<size_t>( std::max( satnum[g] , 1 ) - 1 );
+            const double z = depth[g];
+            const double oilPressure = profile.grid.interpolate( profile.oil , z );
+
+            double sw = 0;
+            if (hasWater) {
+                const SwofTable* swof = selectTable( swofTables , satIdx );
+                if (swof)
+                    sw = saturationFromPc( swof->getSwColumn() , swof->getPcowColumn() , oilPressure - profile.grid.interpolate( profile.water , z ));
+                if (!swof || std::isnan( sw )) {
+                    if (z > record.owcDepth)
+                        sw = swof ? swof->getSwColumn().back() : 1.0;
+                    else
+                        sw = swof ? swof->getSwColumn().front() : 0.0;
+                }
+            }
+
+            double sg = 0;
+            if (hasGas) {
+                const SgofTable* sgof = selectTable( sgofTables , satIdx );
+                if (sgof)
+                    sg = saturationFromPc( sgof->getSgColumn() , sgof->getPcogColumn() , profile.grid.interpolate( profile.gas , z ) - oilPressure );
+                if (!sgof || std::isnan( sg ))
+                    sg = (z < record.gocDepth) ? (sgof ? sgof->getSgColumn().back() : 1.0) : 0.0;
+            }
+
+            (*pressure)[g] = oilPressure;
+            (*swat)[g] = sw;
+            (*sgas)[g] = std::min( sg , 1 - sw );
+            (*rs)[g] = fluids[regionIdx].rs( z , oilPressure );
+        }
+
+        m_pressure = createProperty( *grid , "PRESSURE" , "Pressure" , pressure );
+        m_swat = createProperty( *grid , "SWAT" , "1" , swat );
+        m_sgas = createProperty( *grid , "SGAS" , "1" , sgas );
+        m_rs = createProperty( *grid , "RS" , "GasDissolutionFactor" , rs );
+    }
+
+
+    std::shared_ptr<const GridProperty<double> > Equilibration::getPressure() const {
+        return m_pressure;
+    }
+
+
+    std::shared_ptr<const GridProperty<double> > Equilibration::getSwat() const {
+        return m_swat;
+    }
+
+
+    std::shared_ptr<const GridProperty<double> > Equilibration::getSgas() const {
+        return m_sgas;
+    }
+
+
+    std::shared_ptr<const GridProperty<double> > Equilibration::getRs() const {
+        return m_rs;
+    }
+}
@@ -0,0 +1,116 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef EQUILIBRATION_HPP_
+#define EQUILIBRATION_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <opm/parser/eclipse/Deck/Deck.hpp>
+#include <opm/parser/eclipse/EclipseState/EclipseState.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/GridProperty.hpp>
+
+/*
+  The Equilibration class computes the initial pressure, saturations
+  and dissolved gas of a black oil model in hydrostatic equilibrium,
+  from the EQUIL records of the EQLNUM regions:
+
+    1. For every region the phase pressures are integrated - with a
+       second order Runge-Kutta scheme - on a fine, uniform depth grid
+       spanning the cells of the region, the datum depth and the
+       contacts. The phase present at the datum depth is integrated
+       from the datum pressure; the other phases start from the
+       contacts, offset by the capillary pressures of the EQUIL
+       record. The phase densities are computed from the surface
+       densities (DENSITY), PVTW and the PVDO/PVTO and PVDG/PVTG
+       tables of the PVTNUM region of the first cell of the region.
+
+    2. The cell values are interpolated in the depth grid of their
+       region at the cell center depths. The water and gas saturations
+       are found by inverting the capillary pressure columns of the
+       SWOF and SGOF tables of the SATNUM region of the cell; a table
+       without capillary pressure gives a sharp contact.
+
+  For live oil, i.e. with DISGAS, the dissolved gas ratio is taken
+  from the RSVD table of the region, or - without RSVD - is the
+  saturated value at the gas-oil contact; it is limited by the
+  saturated value at the oil pressure of the cell. The saturated oil
+  formation volume factor of PVTO is used, i.e. the compressibility of
+  undersaturated oil is neglected.
+
+  The regions are integrated in parallel, and the cells interpolated in
+  parallel, with OpenMP. PRESSURE is the oil pressure.
+*/
+
+namespace Opm {
+
+    class Equilibration {
+    public:
+        static const size_t defaultNumDepthNodes = 2000;
+
+        struct EquilRecord {
+            double datumDepth;
+            double datumPressure;
+            double owcDepth;
+            double owcCapillaryPressure;
+            double gocDepth;
+            double gocCapillaryPressure;
+        };
+
+        // one per PVT region, from DENSITY and PVTW
+        struct PvtParameters {
+            double oilSurfaceDensity;
+            double waterSurfaceDensity;
+            double gasSurfaceDensity;
+            double waterReferencePressure;
+            double waterFormationFactor;
+            double waterCompressibility;
+        };
+
+        // Reads EQUIL, DENSITY and PVTW from the deck; the rest is taken from the state.
+        Equilibration(DeckConstPtr deck , const EclipseState& state , size_t numDepthNodes = defaultNumDepthNodes);
+        Equilibration(const EclipseState& state ,
+                      const std::vector<EquilRecord>& equil ,
+                      const std::vector<PvtParameters>& pvt ,
+                      size_t numDepthNodes = defaultNumDepthNodes);
+
+        std::shared_ptr<const GridProperty<double> > getPressure() const;
+        std::shared_ptr<const GridProperty<double> > getSwat() const;
+        std::shared_ptr<const GridProperty<double> > getSgas() const;
+        std::shared_ptr<const GridProperty<double> > getRs() const;
+
+        static std::vector<EquilRecord> readEquil(DeckConstPtr deck);
+        static std::vector<PvtParameters> readPvtParameters(DeckConstPtr deck);
+
+    private:
+        void equilibrate(const EclipseState& state ,
+                         const std::vector<EquilRecord>& equil ,
+                         const std::vector<PvtParameters>& pvt ,
+                         size_t numDepthNodes);
+
+        std::shared_ptr<const GridProperty<double> > m_pressure;
+        std::shared_ptr<const GridProperty<double> > m_swat;
+        std::shared_ptr<const GridProperty<double> > m_sgas;
+        std::shared_ptr<const GridProperty<double> > m_rs;
+    };
+}
+
+#endif
@@ -0,0 +1,196 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <numeric>
+#include <stdexcept>
+
+#include <opm/parser/eclipse/EclipseState/Grid/FaceMultiplierStore.hpp>
+#include <opm/parser/eclipse/EclipseState/Util/Parallel.hpp>
+
+namespace Opm {
+
+    FaceMultiplierStore::FaceMultiplierStore(size_t size)
+        : m_size( size ),
+          m_baseValue( 1.0 )
+    {
+    }
+
+
+    size_t FaceMultiplierStore::size() const {
+        return m_size;
+    }
+
+
+    FaceMultiplierStore::StorageType FaceMultiplierStore::getStorageType() const {
+        if (!m_dense.empty())
+            return Dense;
+        else if (!m_indices.empty())
+            return Sparse;
+        else
+            return Constant;
+    }
+
+
+    bool FaceMultiplierStore::isDefault() const {
+        return getStorageType() == Constant && m_baseValue == 1.0;
+    }
+
+
+    void FaceMultiplierStore::get(const size_t * indices , size_t numIndices , double * multipliers) const {
+        const long numFaces = static_cast<long>(numIndices);
+        switch (getStorageType()) {
+        case Dense:
+#pragma omp parallel for schedule(static) if (numIndices >= parallelThreshold)
+            for (long i = 0; i < numFaces; i++)
+                multipliers[i] = m_dense[ indices[i] ];
+            break;
+        case Sparse:
+#pragma omp parallel for schedule(static) if (numIndices >= parallelThreshold)
+            for (long i = 0; i < numFaces; i++)
+                multipliers[i] = get( indices[i] );
+            break;
+        default:
+            std::fill( multipliers , multipliers + numIndices , m_baseValue );
+        }
+    }
+
+
+    void FaceMultiplierStore::exportAll(double * multipliers) const {
+        if (!m_dense.empty())
+            std::copy( m_dense.begin() , m_dense.end() , multipliers );
+        else {
+            std::fill( multipliers , multipliers + m_size , m_baseValue );
+            for (size_t i = 0; i < m_indices.size(); i++)
+                multipliers[ m_indices[i] ] = m_values[i];
+        }
+    }
+
+
+    void FaceMultiplierStore::scale(double factor) {
+        if (!m_dense.empty()) {
+            const long size = static_cast<long>(m_size);
+#pragma omp parallel for schedule(static) if (m_size >= parallelThreshold)
+            for (long i = 0; i < size; i++)
+                m_dense[i] *= factor;
+        } else {
+            m_baseValue *= factor;
+            for (auto iter = m_values.begin(); iter != m_values.end(); ++iter)
+                *iter *= factor;
+        }
+    }
+
+
+    /*
+      In sparse storage the factors are sorted on face index - keeping
+      the input order for repeated faces - and merged with the existing
+      multipliers.
+    */
+    void FaceMultiplierStore::multiply(const std::vector<size_t>& indices , const std::vector<double>& factors) {
+        if (indices.size() != factors.size())
+            throw std::invalid_argument("The number of face indices and multipliers must agree");
+
+        for (auto iter = indices.begin(); iter != indices.end(); ++iter) {
+            if (*iter >= m_size)
+                throw std::invalid_argument("Face index out of range");
+        }
+
+        if (!m_dense.empty()) {
+            for (size_t i = 0; i < indices.size(); i++)
+                m_dense[ indices[i] ] *= factors[i];
+            return;
+        }
+
+        std::vector<size_t> order( indices.size() );
+        std::iota( order.begin() , order.end() , 0 );
+        std::stable_sort( order.begin() , order.end() , [&indices](size_t a , size_t b) { return indices[a] < indices[b]; });
+
+        std::vector<size_t> mergedIndices;
+        std::vector<double> mergedValues;
+        mergedIndices.reserve( m_indices.size() + indices.size() );
+        mergedValues.reserve( m_indices.size() + indices.size() );
+
+        size_t oldPos = 0;
+        size_t newPos = 0;
+        while (oldPos < m_indices.size() || newPos < order.size()) {
+            const size_t oldIndex = (oldPos < m_indices.size()) ? m_indices[oldPos] : m_size;
+            const size_t newIndex = (newPos < order.size()) ? indices[ order[newPos] ] : m_size;
+
+            if (oldIndex < newIndex) {
+                mergedIndices.push_back( oldIndex );
+                mergedValues.push_back( m_values[oldPos] );
+                oldPos++;
+            } else {
+                double value = m_baseValue;
+                if (oldIndex == newIndex) {
+                    value = m_values[oldPos];
+                    oldPos++;
+                }
+
+                while (newPos < order.size() && indices[ order[newPos] ] == newIndex) {
+                    value *= factors[ order[newPos] ];
+                    newPos++;
+                }
+                mergedIndices.push_back( newIndex );
+                mergedValues.push_back( value );
+            }
+        }
+
+        m_indices.swap( mergedIndices );
+        m_values.swap( mergedValues );
+        if (4 * m_indices.size() > m_size)
+            makeDense();
+    }
+
+
+    void FaceMultiplierStore::multiplyWith(const GridPropertyView<double>& factors) {
+        if (factors.size() != m_size)
+            throw std::invalid_argument("Size mismatch between the multipliers and the grid property");
+
+        if (factors.isConstant()) {
+            scale( factors.getConstantValue() );
+            return;
+        }
+
+        makeDense();
+        const long size = static_cast<long>(m_size);
+#pragma omp parallel for schedule(static) if (m_size >= parallelThreshold)
+        for (long i = 0; i < size; i++)
+            m_dense[i] *= factors[i];
+    }
+
+
+    double * FaceMultiplierStore::getDenseData() {
+        makeDense();
+        return m_dense.data();
+    }
+
+
+    void FaceMultiplierStore::makeDense() {
+        if (!m_dense.empty() || m_size == 0)
+            return;
+
+        std::vector<double> dense( m_size );
+        exportAll( dense.data() );
+        m_dense.swap( dense );
+        m_indices.clear();
+        m_indices.shrink_to_fit();
+        m_values.clear();
+        m_values.shrink_to_fit();
+    }
+}
@@ -0,0 +1,104 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FACE_MULTIPLIER_STORE_HPP_
+#define FACE_MULTIPLIER_STORE_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include <opm/parser/eclipse/EclipseState/Grid/GridPropertyView.hpp>
+
+/*
+  The FaceMultiplierStore class holds the transmissibility multipliers
+  of all the faces of the grid in one direction. The storage depends
+  on the multipliers which have been applied:
+
+    Constant: all the faces have the same multiplier - e.g. the
+       default 1.0 - and no memory is used.
+
+    Sparse: the faces which differ from a constant base value are
+       kept in a sorted array of face indices with a parallel array of
+       multipliers; this is what MULTFLT and MULTREGT typically
+       produce.
+
+    Dense: one multiplier per face, as soon as a cellwise multiplier
+       like MULTX has been applied or more than a quarter of the faces
+       differ from the base value.
+
+  The multipliers are applied in the order they are given, so the
+  result is bitwise identical to multiplying a full array one factor
+  at a time.
+*/
+
+namespace Opm {
+
+    class FaceMultiplierStore {
+    public:
+        enum StorageType {
+            Constant = 0,
+            Sparse = 1,
+            Dense = 2
+        };
+
+        explicit FaceMultiplierStore(size_t size);
+
+        size_t size() const;
+        StorageType getStorageType() const;
+        // true if all the multipliers are 1.0
+        bool isDefault() const;
+
+        double get(size_t index) const {
+            if (!m_dense.empty())
+                return m_dense[index];
+            else if (!m_indices.empty()) {
+                auto iter = std::lower_bound( m_indices.begin() , m_indices.end() , index );
+                if (iter != m_indices.end() && *iter == index)
+                    return m_values[ iter - m_indices.begin() ];
+            }
+            return m_baseValue;
+        }
+
+        void get(const size_t * indices , size_t numIndices , double * multipliers) const;
+        void exportAll(double * multipliers) const;
+
+        void scale(double factor);
+        // face indices may be repeated, the factors are applied in order
+        void multiply(const std::vector<size_t>& indices , const std::vector<double>& factors);
+        void multiplyWith(const GridPropertyView<double>& factors);
+
+        // converts to dense storage and returns the multipliers for in
+        // place updates
+        double * getDenseData();
+
+    private:
+        void makeDense();
+
+        size_t m_size;
+        double m_baseValue;
+        // the sparse storage
+        std::vector<size_t> m_indices;
+        std::vector<double> m_values;
+        // the dense storage
+        std::vector<double> m_dense;
+    };
+}
+
+#endif
@@ -27,7 +27,15 @@ namespace Opm {
                          size_t J1 , size_t J2,
                          size_t K1 , size_t K2,
                          FaceDir::DirEnum faceDir) 
-        : m_faceDir( faceDir )
+        : m_faceDir( faceDir ),
+          m_nx( nx ),
+          m_ny( ny ),
+          m_I1( I1 ),
+          m_I2( I2 ),
+          m_J1( J1 ),
+          m_J2( J2 ),
+          m_K1( K1 ),
+          m_K2( K2 )
     {
         checkCoord(nx , I1,I2);
         checkCoord(ny , J1,J2);
@@ -45,14 +53,6 @@ namespace Opm {
         if ((faceDir == FaceDir::ZPlus) || (faceDir == FaceDir::ZMinus))
             if (K1 != K2)
                 throw std::invalid_argument("When the face is in Z direction we must have K1 == K2");
-
-
-        for (size_t k=K1; k <= K2; k++)
-            for (size_t j=J1; j <= J2; j++)
-                for (size_t i=I1; i <= I2; i++) {
-                    size_t globalIndex = i + j*nx + k*nx*ny;
-                    m_indexList.push_back( globalIndex );
-                }
     }
 
     
@@ -65,17 +65,98 @@ namespace Opm {
     }
 
 
-    std::vector<size_t>::const_iterator FaultFace::begin() const {
-        return m_indexList.begin();
+    FaultFace::const_iterator FaultFace::begin() const {
+        return const_iterator( *this , 0 );
     }
     
-    std::vector<size_t>::const_iterator FaultFace::end() const {
-        return m_indexList.end();
+    FaultFace::const_iterator FaultFace::end() const {
+        return const_iterator( *this , size() );
+    }
+
+
+    size_t FaultFace::size() const {
+        return (m_I2 - m_I1 + 1) * (m_J2 - m_J1 + 1) * (m_K2 - m_K1 + 1);
     }
     
 
+    size_t FaultFace::getNX() const {
+        return m_nx;
+    }
+
+    size_t FaultFace::getNY() const {
+        return m_ny;
+    }
+
+    size_t FaultFace::getI1() const {
+        return m_I1;
+    }
+
+    size_t FaultFace::getI2() const {
+        return m_I2;
+    }
+
+    size_t FaultFace::getJ1() const {
+        return m_J1;
+    }
+
+    size_t FaultFace::getJ2() const {
+        return m_J2;
+    }
+
+    size_t FaultFace::getK1() const {
+        return m_K1;
+    }
+
+    size_t FaultFace::getK2() const {
+        return m_K2;
+    }
+
+
     FaceDir::DirEnum FaultFace::getDir() const {
         return m_faceDir;
     }
 
+
+
+    /*****************************************************************/
+
+    FaultFace::const_iterator::const_iterator(const FaultFace& face , size_t position)
+        : m_face( &face ),
+          m_position( position )
+    {
+    }
+
+
+    size_t FaultFace::const_iterator::operator*() const {
+        const size_t ni = m_face->m_I2 - m_face->m_I1 + 1;
+        const size_t nj = m_face->m_J2 - m_face->m_J1 + 1;
+        const size_t i = m_face->m_I1 + m_position % ni;
+        const size_t j = m_face->m_J1 + (m_position / ni) % nj;
+        const size_t k = m_face->m_K1 + m_position / (ni * nj);
+
+        return i + j*m_face->m_nx + k*m_face->m_nx*m_face->m_ny;
+    }
+
+
+    FaultFace::const_iterator& FaultFace::const_iterator::operator++() {
+        ++m_position;
+        return *this;
+    }
+
+
+    FaultFace::const_iterator FaultFace::const_iterator::operator++(int) {
+        const_iterator copy( *this );
+        ++m_position;
+        return copy;
+    }
+
+
+    bool FaultFace::const_iterator::operator==(const const_iterator& other) const {
+        return m_face == other.m_face && m_position == other.m_position;
+    }
+
+
+    bool FaultFace::const_iterator::operator!=(const const_iterator& other) const {
+        return !(*this == other);
+    }
 }
@@ -20,29 +20,71 @@
 #define FAULT_FACE_HPP_
 
 #include <cstddef>
-#include <vector>
+#include <iterator>
 
 #include <opm/parser/eclipse/EclipseState/Grid/FaceDir.hpp>
 
 namespace Opm {
 
 
+/*
+  A fault face is an IJK box of cell faces in one direction. Only the
+  box limits are stored; the global indices of the cells are computed
+  when iterating, with the i index running fastest.
+*/
 class FaultFace {
 public:
+    // The global indices are computed on dereference, so the iterator
+    // returns them by value.
+    class const_iterator {
+    public:
+        typedef std::input_iterator_tag iterator_category;
+        typedef size_t value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const size_t* pointer;
+        typedef size_t reference;
+
+        const_iterator(const FaultFace& face , size_t position);
+
+        size_t operator*() const;
+        const_iterator& operator++();
+        const_iterator operator++(int);
+        bool operator==(const const_iterator& other) const;
+        bool operator!=(const const_iterator& other) const;
+
+    private:
+        const FaultFace* m_face;
+        size_t m_position;
+    };
+
     FaultFace(size_t nx , size_t ny , size_t nz,
               size_t I1 , size_t I2,
               size_t J1 , size_t J2,
               size_t K1 , size_t K2,
               FaceDir::DirEnum faceDir);
     
-    std::vector<size_t>::const_iterator begin() const;
-    std::vector<size_t>::const_iterator end() const;
+    const_iterator begin() const;
+    const_iterator end() const;
     FaceDir::DirEnum getDir() const;
+    // the number of cells in the face
+    size_t size() const;
+
+    size_t getNX() const;
+    size_t getNY() const;
+    size_t getI1() const;
+    size_t getI2() const;
+    size_t getJ1() const;
+    size_t getJ2() const;
+    size_t getK1() const;
+    size_t getK2() const;
     
 private:    
     static void checkCoord(size_t dim , size_t l1 , size_t l2);
     FaceDir::DirEnum m_faceDir;
-    std::vector<size_t> m_indexList;
+    size_t m_nx , m_ny;
+    size_t m_I1 , m_I2;
+    size_t m_J1 , m_J2;
+    size_t m_K1 , m_K2;
 };
 
 
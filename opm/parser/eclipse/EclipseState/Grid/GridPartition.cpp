@@ -0,0 +1,287 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <unordered_set>
+
+#include <opm/parser/eclipse/EclipseState/Grid/GridPartition.hpp>
+#include <opm/parser/eclipse/EclipseState/Schedule/Schedule.hpp>
+
+namespace Opm {
+
+namespace {
+
+    // A set of cells in [begin, end) of the cell list which is to be
+    // split into numPartitions partitions, starting at firstPartition.
+    struct Segment {
+        size_t begin;
+        size_t end;
+        size_t firstPartition;
+        size_t numPartitions;
+    };
+}
+
+
+    GridPartition::GridPartition(const EclipseGrid& grid , size_t numPartitions , size_t overlapLayers)
+        : m_nx( grid.getNX() ),
+          m_ny( grid.getNY() ),
+          m_nz( grid.getNZ() ),
+          m_numPartitions( numPartitions ),
+          m_overlapLayers( overlapLayers )
+    {
+        bisect( grid , numPartitions );
+        addOverlap( grid , nullptr );
+    }
+
+
+    GridPartition::GridPartition(const EclipseGrid& grid , const CellAdjacency& adjacency , size_t numPartitions , size_t overlapLayers)
+        : m_nx( grid.getNX() ),
+          m_ny( grid.getNY() ),
+          m_nz( grid.getNZ() ),
+          m_numPartitions( numPartitions ),
+          m_overlapLayers( overlapLayers )
+    {
+        if (adjacency.numVertices() != grid.getNumActive())
+            throw std::invalid_argument("The adjacency graph does not match the active cells of the grid");
+
+        bisect( grid , numPartitions );
+        addOverlap( grid , &adjacency );
+    }
+
+
+    void GridPartition::bisect(const EclipseGrid& grid , size_t numPartitions) {
+        if (numPartitions == 0)
+            throw std::invalid_argument("The number of partitions must be positive");
+
+        std::shared_ptr<const ActiveIndexMap> activeIndexMap = grid.getActiveIndexMap();
+        std::shared_ptr<const CellGeometry> cellGeometry = grid.getCellGeometry();
+        const std::vector<double>* coordinates[3] = { &cellGeometry->getCenterX() , &cellGeometry->getCenterY() , &cellGeometry->getDepth() };
+
+        const std::vector<int>& activeToGlobal = activeIndexMap->getActiveToGlobal();
+        std::vector<int> cells( activeToGlobal.begin() , activeToGlobal.end() );
+
+        std::vector<Segment> segments( 1 , Segment{ 0 , cells.size() , 0 , numPartitions } );
+        while (segments.size() < numPartitions) {
+            std::vector<Segment> next( 2 * segments.size() );
+            const long numSegments = static_cast<long>(segments.size());
+
+#pragma omp parallel for schedule(dynamic) if (cells.size() >= parallelThreshold)
+            for (long s = 0; s < numSegments; s++) {
+                const Segment& segment = segments[s];
+                const size_t leftPartitions = segment.numPartitions / 2;
+                if (leftPartitions == 0) {
+                    next[2*s] = segment;
+                    next[2*s + 1] = Segment{ segment.end , segment.end , segment.firstPartition + 1 , 0 };
+                    continue;
+                }
+
+                int axis = 0;
+                double largestExtent = -1;
+                for (int d = 0; d < 3; d++) {
+                    const std::vector<double>& coordinate = *coordinates[d];
+                    double minValue = 0;
+                    double maxValue = 0;
+                    for (size_t n = segment.begin; n < segment.end; n++) {
+                        const double value = coordinate[cells[n]];
+                        if (n == segment.begin || value < minValue)
+                            minValue = value;
+                        if (n == segment.begin || value > maxValue)
+                            maxValue = value;
+                    }
+                    if (maxValue - minValue > largestExtent) {
+                        largestExtent = maxValue - minValue;
+                        axis = d;
+                    }
+                }
+
+                const std::vector<double>& coordinate = *coordinates[axis];
+                const size_t size = segment.end - segment.begin;
+                const size_t split = segment.begin + (size * leftPartitions + segment.numPartitions / 2) / segment.numPartitions;
+                std::nth_element( cells.begin() + segment.begin , cells.begin() + split , cells.begin() + segment.end ,
+                                  [&coordinate](int c1 , int c2) {
+                                      return (coordinate[c1] < coordinate[c2]) || (coordinate[c1] == coordinate[c2] && c1 < c2);
+                                  });
+
+                next[2*s] = Segment{ segment.begin , split , segment.firstPartition , leftPartitions };
+                next[2*s + 1] = Segment{ split , segment.end , segment.firstPartition + leftPartitions , segment.numPartitions - leftPartitions };
+            }
+
+            segments.clear();
+            for (auto segment = next.begin(); segment != next.end(); ++segment)
+                if (segment->numPartitions > 0)
+                    segments.push_back( *segment );
+        }
+
+        m_owner.assign( grid.getCartesianSize() , -1 );
+        for (auto segment = segments.begin(); segment != segments.end(); ++segment)
+            for (size_t n = segment->begin; n < segment->end; n++)
+                m_owner[cells[n]] = static_cast<int>(segment->firstPartition);
+    }
+
+
+    void GridPartition::addOverlap(const EclipseGrid& grid , const CellAdjacency* adjacency) {
+        const size_t cartesianSize = m_owner.size();
+        std::vector< std::vector<size_t> > partitionCells( m_numPartitions );
+        m_numOwned.assign( m_numPartitions , 0 );
+        for (size_t g = 0; g < cartesianSize; g++)
+            if (m_owner[g] >= 0)
+                m_numOwned[m_owner[g]]++;
+
+        for (size_t p = 0; p < m_numPartitions; p++)
+            partitionCells[p].reserve( m_numOwned[p] );
+        for (size_t g = 0; g < cartesianSize; g++)
+            if (m_owner[g] >= 0)
+                partitionCells[m_owner[g]].push_back( g );
+
+        std::shared_ptr<const ActiveIndexMap> activeIndexMap = grid.getActiveIndexMap();
+        const std::vector<int>& globalToActive = activeIndexMap->getGlobalToActive();
+        const std::vector<int>& activeToGlobal = activeIndexMap->getActiveToGlobal();
+        const size_t nx = m_nx, ny = m_ny, nz = m_nz;
+
+        auto forEachNeighbour = [&](size_t g , std::vector<size_t>& neighbours) {
+            neighbours.clear();
+            if (adjacency) {
+                const int v = globalToActive[g];
+                const std::vector<int>& rowStart = adjacency->getRowStart();
+                for (int position = rowStart[v]; position < rowStart[v + 1]; position++)
+                    neighbours.push_back( activeToGlobal[ adjacency->getColumns()[position] ] );
+            } else {
+                const size_t i = g % nx;
+                const size_t j = (g / nx) % ny;
+                const size_t k = g / (nx*ny);
+                if (i > 0) neighbours.push_back( g - 1 );
+                if (i + 1 < nx) neighbours.push_back( g + 1 );
+                if (j > 0) neighbours.push_back( g - nx );
+                if (j + 1 < ny) neighbours.push_back( g + nx );
+                if (k > 0) neighbours.push_back( g - nx*ny );
+                if (k + 1 < nz) neighbours.push_back( g + nx*ny );
+            }
+        };
+
+        if (m_overlapLayers > 0) {
+#pragma omp parallel for schedule(dynamic) if (cartesianSize >= parallelThreshold)
+            for (long p = 0; p < static_cast<long>(m_numPartitions); p++) {
+                std::vector<size_t>& cells = partitionCells[p];
+                std::unordered_set<size_t> overlap;
+                std::vector<size_t> frontier( cells );
+                std::vector<size_t> neighbours;
+                for (size_t layer = 0; layer < m_overlapLayers && !frontier.empty(); layer++) {
+                    std::vector<size_t> nextFrontier;
+                    for (auto cell = frontier.begin(); cell != frontier.end(); ++cell) {
+                        forEachNeighbour( *cell , neighbours );
+                        for (auto neighbour = neighbours.begin(); neighbour != neighbours.end(); ++neighbour) {
+                            const int owner = m_owner[*neighbour];
+                            if (owner >= 0 && owner != static_cast<int>(p) && overlap.insert( *neighbour ).second)
+                                nextFrontier.push_back( *neighbour );
+                        }
+                    }
+                    frontier.swap( nextFrontier );
+                }
+
+                cells.insert( cells.end() , overlap.begin() , overlap.end() );
+                std::sort( cells.begin() , cells.end() );
+            }
+        }
+
+        m_cellStart.assign( m_numPartitions + 1 , 0 );
+        for (size_t p = 0; p < m_numPartitions; p++)
+            m_cellStart[p + 1] = m_cellStart[p] + partitionCells[p].size();
+
+        m_cells.resize( m_cellStart[m_numPartitions] );
+        for (size_t p = 0; p < m_numPartitions; p++) {
+            std::copy( partitionCells[p].begin() , partitionCells[p].end() , m_cells.begin() + m_cellStart[p] );
+            std::vector<size_t>().swap( partitionCells[p] );
+        }
+    }
+
+
+    size_t GridPartition::numPartitions() const {
+        return m_numPartitions;
+    }
+
+
+    size_t GridPartition::getOverlapLayers() const {
+        return m_overlapLayers;
+    }
+
+
+    const std::vector<int>& GridPartition::getOwner() const {
+        return m_owner;
+    }
+
+
+    size_t GridPartition::numCells(size_t partition) const {
+        if (partition >= m_numPartitions)
+            throw std::invalid_argument("Partition index out of range");
+
+        return m_cellStart[partition + 1] - m_cellStart[partition];
+    }
+
+
+    size_t GridPartition::numOwnedCells(size_t partition) const {
+        if (partition >= m_numPartitions)
+            throw std::invalid_argument("Partition index out of range");
+
+        return m_numOwned[partition];
+    }
+
+
+    const size_t* GridPartition::partitionCells(size_t partition) const {
+        if (partition >= m_numPartitions)
+            throw std::invalid_argument("Partition index out of range");
+
+        return m_cells.data() + m_cellStart[partition];
+    }
+
+
+    std::vector<size_t> GridPartition::getCells(size_t partition) const {
+        const size_t* cells = partitionCells( partition );
+        return std::vector<size_t>( cells , cells + numCells( partition ));
+    }
+
+
+    void GridPartition::extractTransMult(const TransMult& transMult , size_t partition , FaceDir::DirEnum faceDir , std::vector<double>& multipliers) const {
+        transMult.getMultipliers( getCells( partition ) , faceDir , multipliers );
+    }
+
+
+    std::vector< std::pair<WellConstPtr , CompletionConstPtr> > GridPartition::extractCompletions(const Schedule& schedule , size_t partition , size_t timeStep) const {
+        if (partition >= m_numPartitions)
+            throw std::invalid_argument("Partition index out of range");
+
+        std::vector< std::pair<WellConstPtr , CompletionConstPtr> > completions;
+        const std::vector<WellConstPtr> wells = schedule.getWells( timeStep );
+        for (auto well = wells.begin(); well != wells.end(); ++well) {
+            CompletionSetConstPtr completionSet = (*well)->getCompletions( timeStep );
+            for (size_t c = 0; c < completionSet->size(); c++) {
+                CompletionConstPtr completion = completionSet->get( c );
+                const int i = completion->getI();
+                const int j = completion->getJ();
+                const int k = completion->getK();
+                if (i < 0 || j < 0 || k < 0 || static_cast<size_t>(i) >= m_nx || static_cast<size_t>(j) >= m_ny || static_cast<size_t>(k) >= m_nz)
+                    throw std::invalid_argument("The completion of well " + (*well)->name() + " is outside the grid");
+
+                const size_t globalIndex = i + j*m_nx + k*m_nx*m_ny;
+                if (m_owner[globalIndex] == static_cast<int>(partition))
+                    completions.push_back( std::make_pair( *well , completion ));
+            }
+        }
+        return completions;
+    }
+}
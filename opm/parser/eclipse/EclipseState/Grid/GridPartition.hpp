@@ -0,0 +1,117 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GRID_PARTITION_HPP_
+#define GRID_PARTITION_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <opm/parser/eclipse/EclipseState/Grid/CellAdjacency.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/EclipseGrid.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/FaceDir.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/GridProperty.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/TransMult.hpp>
+#include <opm/parser/eclipse/EclipseState/Util/Parallel.hpp>
+
+/*
+  The GridPartition class distributes the active cells of a grid over
+  a number of partitions with recursive coordinate bisection of the
+  cell centers: a set of cells is split in two along the axis of its
+  largest extent, in proportion to the number of partitions on either
+  side, until every set holds a single partition. Each level of the
+  recursion processes its sets in parallel with OpenMP; ties between
+  equal coordinates are broken on the global index, so the owners do
+  not depend on the number of threads.
+
+  Every active cell is owned by exactly one partition; the overlap
+  layers of a partition are the cells which can be reached from its
+  owned cells in at most overlapLayers steps over face neighbours, or
+  over the edges of a CellAdjacency graph, i.e. including the NNCs.
+
+  The extract methods gather the data of the cells of one partition,
+  owned and overlap cells in increasing global index, directly from the
+  global storage; the memory used is proportional to the size of the
+  partition.
+*/
+
+namespace Opm {
+
+    class Completion;
+    class Schedule;
+    class Well;
+
+    class GridPartition {
+    public:
+        GridPartition(const EclipseGrid& grid , size_t numPartitions , size_t overlapLayers = 0);
+        GridPartition(const EclipseGrid& grid , const CellAdjacency& adjacency , size_t numPartitions , size_t overlapLayers);
+
+        size_t numPartitions() const;
+        size_t getOverlapLayers() const;
+
+        // the partition owning each cell; -1 for the inactive cells
+        const std::vector<int>& getOwner() const;
+
+        size_t numCells(size_t partition) const;
+        size_t numOwnedCells(size_t partition) const;
+        // the global indices of the owned and overlap cells, increasing
+        std::vector<size_t> getCells(size_t partition) const;
+
+        template <typename T>
+        std::vector<T> extract(const GridProperty<T>& property , size_t partition) const {
+            if (property.getCartesianSize() != m_owner.size())
+                throw std::invalid_argument("The property " + property.getKeywordName() + " does not match the partitioned grid");
+
+            const GridPropertyView<T> view = property.getView();
+            const size_t* cells = partitionCells( partition );
+            const long size = static_cast<long>(numCells( partition ));
+            std::vector<T> values( size );
+
+#pragma omp parallel for schedule(static) if (numCells( partition ) >= parallelThreshold)
+            for (long n = 0; n < size; n++)
+                values[n] = view[ cells[n] ];
+
+            return values;
+        }
+
+        // the multipliers of the faceDir faces of the cells of the partition
+        void extractTransMult(const TransMult& transMult , size_t partition , FaceDir::DirEnum faceDir , std::vector<double>& multipliers) const;
+
+        // the completions at timeStep which are in the owned cells of the partition
+        std::vector< std::pair<std::shared_ptr<const Well> , std::shared_ptr<const Completion> > > extractCompletions(const Schedule& schedule , size_t partition , size_t timeStep) const;
+
+    private:
+        void bisect(const EclipseGrid& grid , size_t numPartitions);
+        void addOverlap(const EclipseGrid& grid , const CellAdjacency* adjacency);
+        const size_t* partitionCells(size_t partition) const;
+
+        size_t m_nx , m_ny , m_nz;
+        size_t m_numPartitions;
+        size_t m_overlapLayers;
+        std::vector<int> m_owner;
+        std::vector<size_t> m_cellStart;
+        std::vector<size_t> m_cells;
+        std::vector<size_t> m_numOwned;
+    };
+}
+
+#endif
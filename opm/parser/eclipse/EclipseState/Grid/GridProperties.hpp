@@ -20,12 +20,18 @@
 #define ECLIPSE_GRIDPROPERTIES_HPP_
 
 
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <tuple>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
 
 #include <opm/parser/eclipse/EclipseState/Grid/GridProperty.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/RegionIndex.hpp>
 
 /*
   This class implements a container (std::unordered_map<std::string ,
@@ -41,6 +47,15 @@
        getKeyword() method it will automatically create a new
        GridProperty object if the container does not have this
        property. 
+
+  With setDeferredEdits(true) all the properties of the container -
+  also the ones created later - record their box operations and
+  evaluate them lazily, see GridProperty.
+
+  For integer properties getRegionIndex() returns the RegionIndex of a
+  region keyword. The index is built on the first call and cached; it
+  is rebuilt when the revision of the property shows that it has been
+  modified since.
 */
 
 
@@ -56,6 +71,7 @@ public:
         m_nx = nx;
         m_ny = ny;
         m_nz = nz;
+        m_deferEdits = false;
         
         for (auto iter = supportedKeywords.begin(); iter != supportedKeywords.end(); ++iter) 
             m_supportedKeywords[iter->getKeywordName()] = *iter;
@@ -88,17 +104,59 @@ public:
         else {
             auto supportedKeyword = m_supportedKeywords.at( keywordName );
             std::shared_ptr<GridProperty<T> > newProperty(new GridProperty<T>(m_nx , m_ny , m_nz , supportedKeyword));
+            newProperty->setDeferredEdits( m_deferEdits );
 
             m_properties.insert( std::pair<std::string , std::shared_ptr<GridProperty<T> > > ( keywordName , newProperty ));
             return true;
         }
     }
 
+
+    void setDeferredEdits(bool deferEdits) {
+        m_deferEdits = deferEdits;
+        for (auto iter = m_properties.begin(); iter != m_properties.end(); ++iter)
+            iter->second->setDeferredEdits( deferEdits );
+    }
+
+    /*
+      Switches all the properties of the container to the narrowest
+      storage which can hold their values, see GridProperty::compress().
+    */
+    void compress() {
+        for (auto iter = m_properties.begin(); iter != m_properties.end(); ++iter)
+            iter->second->compress();
+    }
+
+
+    std::shared_ptr<const RegionIndex> getRegionIndex(const std::string& keyword) {
+        static_assert( std::is_same<T , int>::value , "Region indices are only available for integer properties" );
+
+        // The revision is read after the view has been created; the
+        // evaluation of pending edits in getView() increments it.
+        std::shared_ptr<GridProperty<T> > property = getKeyword( keyword );
+        const GridPropertyView<int> view = property->getView();
+        const size_t revision = property->getRevision();
+        {
+            std::lock_guard<std::mutex> lock( m_regionIndexMutex );
+            auto iter = m_regionIndices.find( keyword );
+            if (iter != m_regionIndices.end() && iter->second.first == revision)
+                return iter->second.second;
+        }
+
+        std::shared_ptr<const RegionIndex> regionIndex = std::make_shared<const RegionIndex>( m_nx , m_ny , m_nz , view );
+        std::lock_guard<std::mutex> lock( m_regionIndexMutex );
+        m_regionIndices[keyword] = std::make_pair( revision , regionIndex );
+        return regionIndex;
+    }
+
     
 private:
     size_t m_nx, m_ny, m_nz;
+    bool m_deferEdits;
     std::unordered_map<std::string, SupportedKeywordInfo> m_supportedKeywords;
     std::map<std::string , std::shared_ptr<GridProperty<T> > > m_properties;
+    std::map<std::string , std::pair<size_t , std::shared_ptr<const RegionIndex> > > m_regionIndices;
+    std::mutex m_regionIndexMutex;
 };
 
 }
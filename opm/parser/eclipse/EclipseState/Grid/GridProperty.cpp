@@ -24,12 +24,36 @@ namespace Opm {
 
 template<>
 void GridProperty<int>::setDataPoint(size_t sourceIdx, size_t targetIdx, Opm::DeckItemConstPtr deckItem) {
-    m_data[targetIdx] = deckItem->getInt(sourceIdx);
+    (*m_data)[targetIdx] = deckItem->getInt(sourceIdx);
 }
 
 template<>
 void GridProperty<double>::setDataPoint(size_t sourceIdx, size_t targetIdx, Opm::DeckItemConstPtr deckItem) {
-    m_data[targetIdx] = deckItem->getSIDouble(sourceIdx);
+    (*m_data)[targetIdx] = deckItem->getSIDouble(sourceIdx);
+}
+
+template<>
+bool GridProperty<int>::compress() {
+    evaluatePendingEdits();
+    if (m_storageType.load( std::memory_order_relaxed ) != DenseStorage)
+        return m_storageType.load( std::memory_order_relaxed ) == CompactStorage;
+
+    if (m_pinned.load( std::memory_order_acquire ))
+        return false;
+
+    std::shared_ptr<const CompactIntArray> compactData = CompactIntArray::compress( *m_data );
+    if (!compactData)
+        return false;
+
+    m_compactData = compactData;
+    setDenseData( nullptr );
+    m_storageType.store( CompactStorage , std::memory_order_release );
+    return true;
+}
+
+template<>
+bool GridProperty<double>::compress() {
+    return false;
 }
 
 }
@@ -24,11 +24,18 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <unordered_map>
 #include <boost/lexical_cast.hpp>
 
 #include <opm/parser/eclipse/Deck/DeckKeyword.hpp>
 #include <opm/parser/eclipse/EclipseState/Grid/Box.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/GridPropertyKernels.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/GridPropertyEditProgram.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/GridPropertyView.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/CompactIntArray.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/ActiveIndexMap.hpp>
 
 /*
   This class implemenents a class representing properties which are
@@ -37,6 +44,12 @@
 
   The class is implemented as a thin wrapper around std::vector<T>;
   where the most relevant specialisations of T are 'int' and 'float'.
+
+  When deferred edits are enabled with setDeferredEdits() the scale(),
+  add() and setScalar() operations are only recorded in an edit
+  program, and evaluated - fused - the first time the data is needed.
+  The evaluation is protected by a mutex, i.e. a property with pending
+  edits can be read from several threads.
 */
 namespace Opm {
 template <class DataType>
@@ -91,18 +104,33 @@ class GridProperty {
 public:
     typedef GridPropertySupportedKeywordInfo<T> SupportedKeywordInfo;
 
-    GridProperty(size_t nx , size_t ny , size_t nz , const SupportedKeywordInfo& kwInfo) {
+    GridProperty(size_t nx , size_t ny , size_t nz , const SupportedKeywordInfo& kwInfo)
+        : m_constantValue( T() ),
+          m_storageType( ConstantStorage ),
+          m_deferEdits( false ),
+          m_hasPendingEdits( false ),
+          m_pinned( false ),
+          m_revision( 0 )
+    {
         m_nx = nx;
         m_ny = ny;
         m_nz = nz;
         m_kwInfo = kwInfo;
-        m_data.resize( nx * ny * nz );
+        m_cartesianSize = nx * ny * nz;
 
-        m_kwInfo.getInitializer()->apply(m_data, m_kwInfo.getKeywordName());
+        const auto initializer = m_kwInfo.getInitializer();
+        if (!initializer->isConstant( m_constantValue )) {
+            setDenseData( std::make_shared<std::vector<T> >( m_cartesianSize ));
+            initializer->apply(*m_data, m_kwInfo.getKeywordName());
+            m_storageType = DenseStorage;
+        }
     }
 
+    GridProperty(const GridProperty<T>&) = delete;
+    GridProperty<T>& operator=(const GridProperty<T>&) = delete;
+
     size_t getCartesianSize() const {
-        return m_data.size();
+        return m_cartesianSize;
     }
 
     size_t getNX() const {
@@ -119,8 +147,16 @@ public:
     
     
     T iget(size_t index) const {
-        if (index < m_data.size()) {
-            return m_data[index];
+        evaluatePendingEdits();
+        if (index < m_cartesianSize) {
+            switch (m_storageType.load( std::memory_order_acquire )) {
+            case DenseStorage:
+                return (*m_data)[index];
+            case CompactStorage:
+                return static_cast<T>((*m_compactData)[index]);
+            default:
+                return m_constantValue;
+            }
         } else {
             throw std::invalid_argument("Index out of range \n");
         }
@@ -134,29 +170,156 @@ public:
 
 
     void multiplyValueAtIndex(size_t index, T factor) {
-        m_data[index] *= factor;
+        evaluatePendingEdits();
+        uniqueData()[index] *= factor;
+    }
+
+    /*
+      Multiplies the property cellwise with the values of another
+      property; if the factors are constant the property stays
+      constant.
+    */
+    void multiplyWith(const GridProperty<T>& factors) {
+        const GridPropertyView<T> factorView = factors.getView();
+        evaluatePendingEdits();
+
+        if (factorView.isConstant() && m_storageType.load( std::memory_order_relaxed ) == ConstantStorage) {
+            m_constantValue *= factorView.getConstantValue();
+            modified();
+        } else {
+            T* data = uniqueData();
+            for (size_t i = 0; i < m_cartesianSize; ++i)
+                data[i] *= factorView[i];
+        }
     }
 
+    /*
+      A property with constant or compact storage is expanded to a full
+      vector on the first call to getData(), and storage shared with
+      another property after a COPY is copied. From then on the property
+      keeps this vector: all writes, including a global EQUALS or COPY,
+      update it in place and compress() leaves it alone, so the returned
+      reference stays valid for the lifetime of the property. Use
+      getView() to read the values without expanding the storage.
+    */
     const std::vector<T>& getData() const {
-        return m_data;
+        evaluatePendingEdits();
+        if (!m_pinned.load( std::memory_order_acquire )) {
+            std::lock_guard<std::mutex> lock( m_editMutex );
+            if (!m_pinned.load( std::memory_order_relaxed )) {
+                if (m_storageType.load( std::memory_order_relaxed ) != DenseStorage) {
+                    setDenseData( expandedData() );
+                    m_compactData.reset();
+                    m_storageType.store( DenseStorage , std::memory_order_release );
+                } else if (m_dataOwners.use_count() > 1)
+                    setDenseData( std::make_shared<std::vector<T> >( *m_data ));
+
+                m_pinned.store( true , std::memory_order_release );
+            }
+        }
+        return *m_data;
+    }
+
+    GridPropertyView<T> getView() const {
+        evaluatePendingEdits();
+        switch (m_storageType.load( std::memory_order_acquire )) {
+        case DenseStorage:
+            return GridPropertyView<T>( std::shared_ptr<const std::vector<T> >( m_data ));
+        case CompactStorage:
+            return GridPropertyView<T>( m_compactData );
+        default:
+            return GridPropertyView<T>( m_cartesianSize , m_constantValue );
+        }
+    }
+
+    /*
+      The values of the active cells, ordered by active index. For
+      consumers which only need the active cells this avoids filtering
+      the global array; see EclipseGrid::getActiveIndexMap().
+    */
+    std::vector<T> compressedCopy(const ActiveIndexMap& activeIndexMap) const {
+        return activeIndexMap.compress( getView() );
+    }
+
+    /*
+      Returns true if all the cells of the property have the same value
+      and the property does not allocate storage for the individual
+      cells.
+    */
+    bool isConstant() const {
+        evaluatePendingEdits();
+        return m_storageType.load( std::memory_order_acquire ) == ConstantStorage;
+    }
+
+    /*
+      Integer properties with values in [0, 65535] can be stored with 8
+      or 16 bits per cell; compress() switches a property with a full
+      vector to the narrowest such storage and returns true if that was
+      possible. Writing to a compressed property expands it to a full
+      vector again. A property whose full vector has been handed out by
+      getData() is not compressed.
+    */
+    bool compress();
+
+    size_t bytesPerValue() const {
+        return getView().bytesPerValue();
+    }
+
+    // Whether the storage is currently shared with another property.
+    bool sharesData(const GridProperty<T>& other) const {
+        const int storageType = m_storageType.load( std::memory_order_acquire );
+        if (storageType != other.m_storageType.load( std::memory_order_acquire ))
+            return false;
+
+        if (storageType == DenseStorage)
+            return m_data == other.m_data;
+        else if (storageType == CompactStorage)
+            return m_compactData == other.m_compactData;
+        else
+            return false;
+    }
+
+    void setDeferredEdits(bool deferEdits) {
+        if (!deferEdits)
+            evaluatePendingEdits();
+
+        m_deferEdits = deferEdits;
+    }
+
+    bool hasPendingEdits() const {
+        return m_hasPendingEdits.load( std::memory_order_acquire );
+    }
+
+    /*
+      A counter which is incremented whenever the values of the
+      property may have changed; caches derived from the values, like
+      the RegionIndex of GridProperties<int>, compare the revision to
+      find out whether they are stale.
+    */
+    size_t getRevision() const {
+        return m_revision.load( std::memory_order_acquire );
     }
 
     void loadFromDeckKeyword(std::shared_ptr<const Box> inputBox, DeckKeywordConstPtr deckKeyword) {
         const auto deckItem = getDeckItem(deckKeyword);
-
-        const std::vector<size_t>& indexList = inputBox->getIndexList();
-        for (size_t sourceIdx = 0; sourceIdx < indexList.size(); sourceIdx++) {
-            size_t targetIdx = indexList[sourceIdx];
-            if (sourceIdx < deckItem->size()
-                && !deckItem->defaultApplied(sourceIdx))
-            {
-                setDataPoint(sourceIdx, targetIdx, deckItem);
+        evaluatePendingEdits();
+        uniqueData();
+        const size_t numValues = deckItem->size();
+
+        size_t sourceIdx = 0;
+        for (auto iter = inputBox->runsBegin(); iter != inputBox->runsEnd() && sourceIdx < numValues; ++iter) {
+            const Box::IndexRun run = *iter;
+            for (size_t targetIdx = run.begin; targetIdx < run.end && sourceIdx < numValues; ++targetIdx, ++sourceIdx) {
+                if (!deckItem->defaultApplied(sourceIdx))
+                    setDataPoint(sourceIdx, targetIdx, deckItem);
             }
         }
     }
 
     void loadFromDeckKeyword(DeckKeywordConstPtr deckKeyword) {
         const auto deckItem = getDeckItem(deckKeyword);
+        evaluatePendingEdits();
+        uniqueData();
 
         for (size_t dataPointIdx = 0; dataPointIdx < deckItem->size(); ++dataPointIdx) {
             if (!deckItem->defaultApplied(dataPointIdx))
@@ -164,59 +327,79 @@ public:
         }
     }
 
+    /*
+      The box operators are implemented by the vectorized and
+      multithreaded kernels in GridPropertyKernels. Operations on the
+      full grid keep a constant property constant.
+
+      COPY is never deferred; it acts as a barrier which evaluates the
+      pending edits of both the source and the target. Copying the full
+      grid shares the storage of the source, which is copied when one
+      of the properties is modified; when getData() has been called on
+      either property the values are copied right away instead.
+    */
     void copyFrom(const GridProperty<T>& src, std::shared_ptr<const Box> inputBox) {
-        if (inputBox->isGlobal()) {
-            for (size_t i = 0; i < src.getCartesianSize(); ++i)
-                m_data[i] = src.m_data[i];
-        } else {
-            const std::vector<size_t>& indexList = inputBox->getIndexList();
-            for (size_t i = 0; i < indexList.size(); i++) {
-                size_t targetIndex = indexList[i];
-                m_data[targetIndex] = src.m_data[targetIndex];
+        src.evaluatePendingEdits();
+        evaluatePendingEdits();
+        if (&src == this)
+            return;
+
+        const int srcStorageType = src.m_storageType.load( std::memory_order_acquire );
+        const bool pinned = m_pinned.load( std::memory_order_relaxed ) ||
+                            src.m_pinned.load( std::memory_order_acquire );
+        if (inputBox->isGlobal() && !pinned) {
+            setDenseData( nullptr );
+            m_compactData.reset();
+            if (srcStorageType == DenseStorage) {
+                m_data = src.m_data;
+                m_dataOwners = src.m_dataOwners;
+            } else if (srcStorageType == CompactStorage)
+                m_compactData = src.m_compactData;
+            else
+                m_constantValue = src.m_constantValue;
+
+            m_storageType.store( srcStorageType , std::memory_order_release );
+            modified();
+        } else if (srcStorageType == DenseStorage)
+            GridPropertyKernels::copy( uniqueData() , src.m_data->data() , *inputBox );
+        else if (srcStorageType == CompactStorage || inputBox->isGlobal()) {
+            const GridPropertyView<T> srcView = src.getView();
+            T* data = uniqueData();
+            for (auto iter = inputBox->runsBegin(); iter != inputBox->runsEnd(); ++iter) {
+                const Box::IndexRun run = *iter;
+                for (size_t g = run.begin; g < run.end; ++g)
+                    data[g] = srcView[g];
             }
-        }
+        } else
+            setScalar( src.m_constantValue , inputBox , /*deferred=*/false );
     }
     
     void scale(T scaleFactor , std::shared_ptr<const Box> inputBox) {
-        if (inputBox->isGlobal()) {
-            for (size_t i = 0; i < m_data.size(); ++i)
-                m_data[i] *= scaleFactor;
-        } else {
-            const std::vector<size_t>& indexList = inputBox->getIndexList();
-            for (size_t i = 0; i < indexList.size(); i++) {
-                size_t targetIndex = indexList[i];
-                m_data[targetIndex] *= scaleFactor;
-            }
-        }
+        if (m_deferEdits)
+            recordEdit( inputBox , EditOperation( EditOperation::Scale , scaleFactor ));
+        else if (isConstantIn( *inputBox )) {
+            m_constantValue *= scaleFactor;
+            modified();
+        } else
+            GridPropertyKernels::scale( uniqueData() , *inputBox , scaleFactor );
     }
 
 
     void add(T shiftValue , std::shared_ptr<const Box> inputBox) {
-        if (inputBox->isGlobal()) {
-            for (size_t i = 0; i < m_data.size(); ++i)
-                m_data[i] += shiftValue;
-        } else {
-            const std::vector<size_t>& indexList = inputBox->getIndexList();
-            for (size_t i = 0; i < indexList.size(); i++) {
-                size_t targetIndex = indexList[i];
-                m_data[targetIndex] += shiftValue;
-            }
-        }
+        if (m_deferEdits)
+            recordEdit( inputBox , EditOperation( EditOperation::Add , shiftValue ));
+        else if (isConstantIn( *inputBox )) {
+            m_constantValue += shiftValue;
+            modified();
+        } else
+            GridPropertyKernels::add( uniqueData() , *inputBox , shiftValue );
     }
 
 
     
 
     void setScalar(T value , std::shared_ptr<const Box> inputBox) {
-        if (inputBox->isGlobal()) {
-            std::fill(m_data.begin(), m_data.end(), value);
-        } else {
-            const std::vector<size_t>& indexList = inputBox->getIndexList();
-            for (size_t i = 0; i < indexList.size(); i++) {
-                size_t targetIndex = indexList[i];
-                m_data[targetIndex] = value;
-            }
-        }
+        setScalar( value , inputBox , m_deferEdits );
     }
 
     const std::string& getKeywordName() const {
@@ -228,6 +411,99 @@ public:
     }
 
 private:
+    typedef typename GridPropertyEditProgram<T>::Operation EditOperation;
+
+    enum StorageType {
+        ConstantStorage = 0,
+        DenseStorage = 1,
+        CompactStorage = 2
+    };
+
+    void setScalar(T value , std::shared_ptr<const Box> inputBox , bool deferred) {
+        if (deferred)
+            recordEdit( inputBox , EditOperation( EditOperation::SetScalar , value ));
+        else if (inputBox->isGlobal() && !m_pinned.load( std::memory_order_relaxed )) {
+            setDenseData( nullptr );
+            m_compactData.reset();
+            m_constantValue = value;
+            m_storageType.store( ConstantStorage , std::memory_order_release );
+            modified();
+        } else
+            GridPropertyKernels::setScalar( uniqueData() , *inputBox , value );
+    }
+
+    bool isConstantIn(const Box& box) const {
+        return box.isGlobal() && (m_storageType.load( std::memory_order_relaxed ) == ConstantStorage);
+    }
+
+    // A full vector with the values of a property with constant or
+    // compact storage.
+    std::shared_ptr<std::vector<T> > expandedData() const {
+        if (m_storageType.load( std::memory_order_relaxed ) == CompactStorage) {
+            auto data = std::make_shared<std::vector<T> >( m_cartesianSize );
+            m_compactData->expand( data->data() );
+            return data;
+        } else
+            return std::make_shared<std::vector<T> >( m_cartesianSize , m_constantValue );
+    }
+
+    /*
+      Returns the storage of the property, ready to be written: constant
+      and compact storage is expanded, and storage which is shared with
+      other properties is copied. Storage which is only shared with
+      views is written in place. The revision is incremented.
+
+      The storage is only replaced by writers, which must not run
+      concurrently with readers, or under m_editMutex when the pending
+      edits are evaluated; a property pinned by getData() is always
+      written in place.
+    */
+    T* uniqueData() const {
+        if (m_storageType.load( std::memory_order_relaxed ) != DenseStorage) {
+            setDenseData( expandedData() );
+            m_storageType.store( DenseStorage , std::memory_order_release );
+        } else if (m_dataOwners.use_count() > 1)
+            setDenseData( std::make_shared<std::vector<T> >( *m_data ));
+
+        m_compactData.reset();
+        modified();
+        return m_data->data();
+    }
+
+    // Installs new dense storage, owned by this property only.
+    void setDenseData(std::shared_ptr<std::vector<T> > data) const {
+        m_data = data;
+        if (data)
+            m_dataOwners = std::make_shared<char>( 0 );
+        else
+            m_dataOwners.reset();
+    }
+
+    void modified() const {
+        m_revision.fetch_add( 1 , std::memory_order_acq_rel );
+    }
+
+    void recordEdit(std::shared_ptr<const Box> inputBox , const EditOperation& operation) {
+        std::lock_guard<std::mutex> lock( m_editMutex );
+        m_editProgram.addOperation( inputBox , operation );
+        m_hasPendingEdits.store( true , std::memory_order_release );
+        modified();
+    }
+
+    void evaluatePendingEdits() const {
+        if (!m_hasPendingEdits.load( std::memory_order_acquire ))
+            return;
+
+        std::lock_guard<std::mutex> lock( m_editMutex );
+        if (m_hasPendingEdits.load( std::memory_order_relaxed )) {
+            const bool isConstant = (m_storageType.load( std::memory_order_relaxed ) == ConstantStorage);
+            if (!isConstant || !m_editProgram.evaluateConstant( m_constantValue ))
+                m_editProgram.evaluate( uniqueData() );
+
+            m_hasPendingEdits.store( false , std::memory_order_release );
+        }
+    }
+
     Opm::DeckItemConstPtr getDeckItem(Opm::DeckKeywordConstPtr deckKeyword) {
         if (deckKeyword->size() != 1)
             throw std::invalid_argument("Grid properties can only have a single record (keyword "
@@ -240,10 +516,10 @@ private:
 
         const auto deckItem = deckKeyword->getRecord(0)->getItem(0);
 
-        if (deckItem->size() > m_data.size())
+        if (deckItem->size() > m_cartesianSize)
             throw std::invalid_argument("Size mismatch when setting data for:" + getKeywordName() +
                                         " keyword size: " + boost::lexical_cast<std::string>(deckItem->size())
-                                        + " input size: " + boost::lexical_cast<std::string>(m_data.size()));
+                                        + " input size: " + boost::lexical_cast<std::string>(m_cartesianSize));
 
         return deckItem;
     }
@@ -251,8 +527,30 @@ private:
     void setDataPoint(size_t sourceIdx, size_t targetIdx, Opm::DeckItemConstPtr deckItem);
 
     size_t      m_nx,m_ny,m_nz;
+    size_t      m_cartesianSize;
     SupportedKeywordInfo m_kwInfo;
-    std::vector<T> m_data;
+
+    // The values are either all equal to m_constantValue, stored in
+    // m_data - which may be shared with other properties after a COPY -
+    // or, for integer properties, in the immutable m_compactData. The
+    // storage and the edit program are mutable because the pending
+    // edits are evaluated, and the storage expanded, on the first read.
+    //
+    // m_dataOwners is shared by the properties sharing m_data, but not
+    // by the views of m_data; its use count decides whether a write
+    // must copy the storage first. m_pinned is set by getData(), after
+    // which m_data is never replaced nor shared.
+    mutable std::shared_ptr<std::vector<T> > m_data;
+    mutable std::shared_ptr<const char> m_dataOwners;
+    mutable std::shared_ptr<const CompactIntArray> m_compactData;
+    mutable T m_constantValue;
+    mutable std::atomic<int> m_storageType;
+    mutable GridPropertyEditProgram<T> m_editProgram;
+    mutable std::mutex m_editMutex;
+    bool m_deferEdits;
+    mutable std::atomic<bool> m_hasPendingEdits;
+    mutable std::atomic<bool> m_pinned;
+    mutable std::atomic<size_t> m_revision;
 };
 
 }
@@ -0,0 +1,141 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GRIDPROPERTY_EDIT_PROGRAM_HPP_
+#define GRIDPROPERTY_EDIT_PROGRAM_HPP_
+
+#include <memory>
+#include <vector>
+
+#include <opm/parser/eclipse/EclipseState/Grid/Box.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/GridPropertyKernels.hpp>
+
+/*
+  The GridPropertyEditProgram class records the EQUALS / MULTIPLY / ADD
+  operations applied to one grid property, so that they can be
+  evaluated later in as few passes over the data as possible:
+
+    1. Consecutive operations on the same box are collected in one
+       group, which is evaluated in a single (cache blocked) pass.
+
+    2. Setting a scalar value discards the preceding operations in the
+       same group, and operations following a scalar assignment are
+       folded into the assigned value.
+
+  Both rewrites are exact; every cell sees the same sequence of
+  arithmetic operations as with sequential evaluation. COPY and
+  loading data from the deck are not recorded; the owning GridProperty
+  evaluates the program before performing them.
+*/
+
+namespace Opm {
+
+    template <typename T>
+    class GridPropertyEditProgram {
+    public:
+        typedef GridPropertyKernels::Operation<T> Operation;
+
+        void addOperation(std::shared_ptr<const Box> box , const Operation& operation) {
+            if (m_groups.empty() || !sameBox( *m_groups.back().box , *box )) {
+                Group group;
+                group.box = box;
+                m_groups.push_back( group );
+            }
+
+            std::vector<Operation>& operations = m_groups.back().operations;
+            if (operation.type == Operation::SetScalar)
+                operations.clear();
+
+            if (!operations.empty() && operations[0].type == Operation::SetScalar) {
+                T& value = operations[0].value;
+                if (operation.type == Operation::Scale)
+                    value *= operation.value;
+                else
+                    value += operation.value;
+            } else
+                operations.push_back( operation );
+        }
+
+
+        void evaluate(T* data) {
+            for (auto iter = m_groups.begin(); iter != m_groups.end(); ++iter)
+                GridPropertyKernels::apply( data , *iter->box , iter->operations );
+
+            m_groups.clear();
+        }
+
+
+        /*
+          Evaluates the program for a property which has the same value
+          in all cells. That is only possible if all the operations
+          apply to the full grid; otherwise false is returned and the
+          program is left unchanged.
+        */
+        bool evaluateConstant(T& value) {
+            for (auto iter = m_groups.begin(); iter != m_groups.end(); ++iter) {
+                if (!iter->box->isGlobal())
+                    return false;
+            }
+
+            for (auto iter = m_groups.begin(); iter != m_groups.end(); ++iter) {
+                const std::vector<Operation>& operations = iter->operations;
+                for (auto opIter = operations.begin(); opIter != operations.end(); ++opIter) {
+                    switch (opIter->type) {
+                    case Operation::Scale:
+                        value *= opIter->value;
+                        break;
+                    case Operation::Add:
+                        value += opIter->value;
+                        break;
+                    case Operation::SetScalar:
+                        value = opIter->value;
+                        break;
+                    }
+                }
+            }
+
+            m_groups.clear();
+            return true;
+        }
+
+
+        bool empty() const {
+            return m_groups.empty();
+        }
+
+        // The number of passes over the data needed by evaluate().
+        size_t numPasses() const {
+            return m_groups.size();
+        }
+
+    private:
+        struct Group {
+            std::shared_ptr<const Box> box;
+            std::vector<Operation> operations;
+        };
+
+        static bool sameBox(const Box& box1 , const Box& box2) {
+            return (&box1 == &box2) || box1.equal( box2 );
+        }
+
+        std::vector<Group> m_groups;
+    };
+}
+
+#endif
@@ -21,6 +21,9 @@
 
 #include <opm/parser/eclipse/EclipseState/Tables/SwofTable.hpp>
 #include <opm/parser/eclipse/EclipseState/Tables/SgofTable.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/GridPropertyView.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/CellGeometry.hpp>
+#include <opm/parser/eclipse/EclipseState/Util/Parallel.hpp>
 
 #include <vector>
 #include <string>
@@ -28,6 +31,9 @@
 #include <limits>
 #include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
 
 #include <cassert>
 
@@ -54,6 +60,13 @@ protected:
 public:
     virtual void apply(std::vector<ValueType>& values,
                        const std::string& propertyName) const = 0;
+
+    // returns true if the initializer assigns the same value to all
+    // cells; the value is then returned in the argument. This allows
+    // GridProperty to avoid allocating storage for the cells.
+    virtual bool isConstant(ValueType& /* value */) const {
+        return false;
+    }
 };
 
 template <class ValueType>
@@ -71,10 +84,57 @@ public:
         std::fill(values.begin(), values.end(), m_value);
     }
 
+    bool isConstant(ValueType& value) const {
+        value = m_value;
+        return true;
+    }
+
 private:
     ValueType m_value;
 };
 
+
+/*
+  Assigns the values of a vector, e.g. for properties which are
+  computed rather than read from the deck. The vector is shared with
+  the initializer, and only copied when a property is created.
+*/
+template <class ValueType>
+class GridPropertyVectorInitializer
+    : public GridPropertyBaseInitializer<ValueType>
+{
+public:
+    explicit GridPropertyVectorInitializer(std::shared_ptr<const std::vector<ValueType> > values)
+        : m_values(values)
+    { }
+
+    void apply(std::vector<ValueType>& values,
+               const std::string& propertyName) const
+    {
+        if (values.size() != m_values->size())
+            throw std::invalid_argument("Wrong number of values for the property " + propertyName);
+
+        std::copy(m_values->begin(), m_values->end(), values.begin());
+    }
+
+private:
+    std::shared_ptr<const std::vector<ValueType> > m_values;
+};
+
+/*
+  Assigns the default values of the endpoint scaling properties (SWL,
+  ISGU, SOWCR, ...) from the saturation tables. One initializer is
+  shared by all the endpoint properties of an EclipseState: the
+  endpoints of every table are computed on the first call to apply()
+  and reused for all the following properties. The SATNUM, IMBNUM and
+  ENDNUM regions are read again for every property, because the
+  endpoint keywords can be created before the REGIONS section is
+  processed; the cells of each ENDNUM table, which are only needed for
+  ENPTVD and IMPTVD, are cached on the revision of ENDNUM. Filling a
+  property is then a gather over the cells followed by a batched
+  evaluation of the depth tables, both multithreaded with OpenMP for
+  large grids.
+*/
 template <class EclipseState=Opm::EclipseState,
           class Deck=Opm::Deck>
 class GridPropertyEndpointTableLookupInitializer
@@ -89,45 +149,230 @@ public:
     void apply(std::vector<double>& values,
                const std::string& propertyName) const
     {
-        auto eclipseGrid = m_eclipseState.getEclipseGrid();
+        std::call_once(m_initFlag, [this]() { this->initTables(); });
+
+        int family = getFamily(propertyName);
+        bool imbibition = (propertyName[0] == 'I');
+        const std::vector<double>& tableValues = m_endpoints[family];
+        const GridPropertyView<int> tableNum = imbibition ? getImbnum(values.size()) : getSatnum(values.size());
+
+        assert(tableNum.size() == values.size());
+
+        // the cells of the depth tables are found - and their number
+        // checked - before any values are assigned.
+        const bool useDepthTables = m_deck.hasKeyword(imbibition ? "IMPTVD" : "ENPTVD");
+        std::shared_ptr<const EndnumCells> endnumCells;
+        if (useDepthTables) {
+            endnumCells = getEndnumCells(values.size());
+            const size_t numDepthTables = imbibition ? m_eclipseState.getImptvdTables().size() : m_eclipseState.getEnptvdTables().size();
+            if (endnumCells->maxEndNum > static_cast<int>(numDepthTables))
+                throw std::invalid_argument("Not enough tables!");
+        }
 
-        // calculate drainage and imbibition saturation table of each cell
-        std::vector<int> satnumData(values.size(), 1);
+        // acctually assign the defaults: first the values of the saturation tables, then -
+        // if the ENPTVD (or IMPTVD) keyword was specified in the deck - the values of the
+        // depth tables evaluated at the depth of the cell centers. How the simulator wants
+        // to interpolate between the sampling points is outside the scope of opm-parser;
+        // the tables are interpolated linearly.
+        if (tableNum.isConstant())
+            std::fill(values.begin(), values.end(), tableValues[tableIndex(tableNum.getConstantValue())]);
+        else if (tableNum.bytesPerValue() == 1)
+            gather(values, tableValues, tableNum.data8());
+        else if (tableNum.bytesPerValue() == 2)
+            gather(values, tableValues, tableNum.data16());
+        else
+            gather(values, tableValues, tableNum.data());
+
+        if (useDepthTables && imbibition)
+            applyDepthTables(values, m_eclipseState.getImptvdTables(), family, *endnumCells);
+        else if (useDepthTables)
+            applyDepthTables(values, m_eclipseState.getEnptvdTables(), family, *endnumCells);
+    }
+
+private:
+    // the endpoint keyword families; the imbibition variants are
+    // prefixed with an 'I'.
+    enum Family {
+        SGL, SWL, SGU, SWU, SGCR, SWCR, SOGCR, SOWCR,
+        NumFamilies
+    };
+
+    // the cells of each ENDNUM table; the cells of table n are
+    // cells[offset[n - 1]] ... cells[offset[n] - 1].
+    struct EndnumCells {
+        int maxEndNum;
+        std::vector<size_t> offset;
+        std::vector<int> cells;
+    };
+
+    static int getFamily(const std::string& propertyName) {
+        static const char* const names[NumFamilies] = { "SGL", "SWL", "SGU", "SWU", "SGCR", "SWCR", "SOGCR", "SOWCR" };
+
+        const size_t offset = (propertyName[0] == 'I') ? 1 : 0;
+        for (int family = 0; family < NumFamilies; ++family)
+            if (propertyName.compare(offset, std::strlen(names[family]), names[family]) == 0)
+                return family;
+
+        throw std::invalid_argument("The keyword " + propertyName + " is not an endpoint scaling keyword");
+    }
+
+    // the column of the ENPTVD/IMPTVD tables for each family and
+    // whether the table holds one minus the value of the family.
+    static const char* depthTableColumn(int family) {
+        static const char* const columns[NumFamilies] = { "SGCO", "SWCO", "SGMAX", "SWCO", "SGCRIT", "SWCRIT", "SOGCRIT", "SOWCRIT" };
+        return columns[family];
+    }
+
+    int tableIndex(int tableNum) const {
+        int tableIdx = tableNum - 1;
+        assert(0 <= tableIdx && tableIdx < m_numSatTables);
+        return tableIdx;
+    }
+
+    // the drainage, imbibition and endpoint table of each cell.
+    GridPropertyView<int> getSatnum(size_t numCells) const {
         if (m_eclipseState.hasIntGridProperty("SATNUM"))
-            satnumData = m_eclipseState.getIntGridProperty("SATNUM")->getData();
+            return m_eclipseState.getIntGridProperty("SATNUM")->getView();
+        return GridPropertyView<int>(numCells, 1);
+    }
 
-        // TODO (?): IMBNUM[XYZ]-?
-        std::vector<int> imbnumData(satnumData);
+    // TODO (?): IMBNUM[XYZ]-?
+    GridPropertyView<int> getImbnum(size_t numCells) const {
         if (m_eclipseState.hasIntGridProperty("IMBNUM"))
-            imbnumData = m_eclipseState.getIntGridProperty("IMBNUM")->getData();
+            return m_eclipseState.getIntGridProperty("IMBNUM")->getView();
+        return getSatnum(numCells);
+    }
 
-        assert(satnumData.size() == values.size());
-        assert(imbnumData.size() == values.size());
+    /*
+      The cells of each ENDNUM table are rebuilt when ENDNUM has been
+      created or modified since the last call. Cells with an ENDNUM of
+      zero do not use the depth tables.
+    */
+    std::shared_ptr<const EndnumCells> getEndnumCells(size_t numCells) const {
+        const void* endnumProperty = nullptr;
+        size_t revision = 0;
+        GridPropertyView<int> endnumData(numCells, 1);
+        if (m_eclipseState.hasIntGridProperty("ENDNUM")) {
+            const auto endnum = m_eclipseState.getIntGridProperty("ENDNUM");
+            endnumProperty = endnum.get();
+            revision = endnum->getRevision();
+            endnumData = endnum->getView();
+        }
 
-        // calculate drainage and imbibition saturation table of each cell
-        std::vector<int> endnumData(values.size(), 1);
-        if (m_eclipseState.hasIntGridProperty("ENDNUM"))
-            satnumData = m_eclipseState.getIntGridProperty("ENDNUM")->getData();
+        std::lock_guard<std::mutex> lock(m_endnumMutex);
+        if (m_endnumCells && m_endnumProperty == endnumProperty && m_endnumRevision == revision)
+            return m_endnumCells;
 
-        // create the SWOF tables
-        const std::vector<SwofTable>& swofTables = m_eclipseState.getSwofTables();
-        int numSatTables = swofTables.size();
+        auto endnumCells = std::make_shared<EndnumCells>();
+
+        endnumCells->maxEndNum = 0;
+        for (size_t cellIdx = 0; cellIdx < numCells; ++cellIdx)
+            endnumCells->maxEndNum = std::max(endnumCells->maxEndNum, endnumData[cellIdx]);
+
+        std::vector<size_t>& offset = endnumCells->offset;
+        offset.assign(endnumCells->maxEndNum + 1, 0);
+        for (size_t cellIdx = 0; cellIdx < numCells; ++cellIdx)
+            if (endnumData[cellIdx] > 0)
+                offset[endnumData[cellIdx]]++;
+
+        for (int tableIdx = 0; tableIdx < endnumCells->maxEndNum; ++tableIdx)
+            offset[tableIdx + 1] += offset[tableIdx];
+
+        std::vector<size_t> position(offset.begin(), offset.end() - 1);
+        endnumCells->cells.resize(offset.back());
+        for (size_t cellIdx = 0; cellIdx < numCells; ++cellIdx)
+            if (endnumData[cellIdx] > 0)
+                endnumCells->cells[position[endnumData[cellIdx] - 1]++] = static_cast<int>(cellIdx);
 
-        // create the SGOF tables
+        m_endnumCells = endnumCells;
+        m_endnumProperty = endnumProperty;
+        m_endnumRevision = revision;
+        return m_endnumCells;
+    }
+
+    template <typename RegionType>
+    void gather(std::vector<double>& values,
+                const std::vector<double>& tableValues,
+                const RegionType* tableNum) const {
+        const long numCells = static_cast<long>(values.size());
+        double* target = values.data();
+        const double* source = tableValues.data();
+
+#pragma omp parallel for schedule(static) if (values.size() >= parallelThreshold)
+        for (long cellIdx = 0; cellIdx < numCells; ++cellIdx) {
+            assert(1 <= tableNum[cellIdx] && tableNum[cellIdx] <= m_numSatTables);
+            target[cellIdx] = source[ tableNum[cellIdx] - 1 ];
+        }
+    }
+
+    /*
+      The cells are grouped by their ENDNUM table, and every table is
+      evaluated for the depths of its cells in one batch. A defaulted
+      column evaluates to NaN; these cells keep the values of the
+      SWOF/SGOF tables. The number of tables has been checked by
+      apply().
+    */
+    template <class TableType>
+    void applyDepthTables(std::vector<double>& values,
+                          const std::vector<TableType>& depthTables,
+                          int family,
+                          const EndnumCells& endnumCells) const {
+        const std::string columnName = depthTableColumn(family);
+        const bool useOneMinusTableValue = (family == SWU);
+        const std::vector<double>& cellDepth = m_eclipseState.getEclipseGrid()->getCellGeometry()->getDepth();
+        std::vector<double> depths;
+        std::vector<double> tableValues;
+
+        for (int tableIdx = 0; tableIdx < endnumCells.maxEndNum; ++tableIdx) {
+            const long begin = endnumCells.offset[tableIdx];
+            const long numCells = endnumCells.offset[tableIdx + 1] - begin;
+            if (numCells == 0)
+                continue;
+
+            const int* cells = endnumCells.cells.data() + begin;
+            depths.resize(numCells);
+#pragma omp parallel for schedule(static) if (static_cast<size_t>(numCells) >= parallelThreshold)
+            for (long i = 0; i < numCells; ++i)
+                depths[i] = cellDepth[cells[i]];
+
+            depthTables[tableIdx].evaluate(columnName, depths, tableValues);
+
+#pragma omp parallel for schedule(static) if (static_cast<size_t>(numCells) >= parallelThreshold)
+            for (long i = 0; i < numCells; ++i) {
+                const double value = tableValues[i];
+                if (std::isfinite(value))
+                    values[cells[i]] = useOneMinusTableValue ? 1 - value : value;
+            }
+        }
+    }
+
+    void initTables() const {
+        // the SWOF and SGOF tables
+        const std::vector<SwofTable>& swofTables = m_eclipseState.getSwofTables();
         const std::vector<SgofTable>& sgofTables = m_eclipseState.getSgofTables();
         assert(swofTables.size() == sgofTables.size());
+        m_numSatTables = swofTables.size();
 
         // find the critical saturations for each table
-        std::vector<double> criticalGasSat(numSatTables, 0.0);
-        std::vector<double> criticalWaterSat(numSatTables, 0.0);
-        std::vector<double> criticalOilOWSat(numSatTables, 0.0);
-        std::vector<double> criticalOilOGSat(numSatTables, 0.0);
-
-        std::vector<double> minGasSat(numSatTables, 1.0);
-        std::vector<double> maxGasSat(numSatTables, 0.0);
-        std::vector<double> minWaterSat(numSatTables, 1.0);
-        std::vector<double> maxWaterSat(numSatTables, 0.0);
-        for (int tableIdx = 0; tableIdx < numSatTables; ++tableIdx) {
+        std::vector<double>& criticalGasSat = m_endpoints[SGCR];
+        std::vector<double>& criticalWaterSat = m_endpoints[SWCR];
+        std::vector<double>& criticalOilOWSat = m_endpoints[SOWCR];
+        std::vector<double>& criticalOilOGSat = m_endpoints[SOGCR];
+        std::vector<double>& minGasSat = m_endpoints[SGL];
+        std::vector<double>& maxGasSat = m_endpoints[SGU];
+        std::vector<double>& minWaterSat = m_endpoints[SWL];
+        std::vector<double>& maxWaterSat = m_endpoints[SWU];
+
+        criticalGasSat.assign(m_numSatTables, 0.0);
+        criticalWaterSat.assign(m_numSatTables, 0.0);
+        criticalOilOWSat.assign(m_numSatTables, 0.0);
+        criticalOilOGSat.assign(m_numSatTables, 0.0);
+        minGasSat.assign(m_numSatTables, 1.0);
+        maxGasSat.assign(m_numSatTables, 0.0);
+        minWaterSat.assign(m_numSatTables, 1.0);
+        maxWaterSat.assign(m_numSatTables, 0.0);
+
+        for (int tableIdx = 0; tableIdx < m_numSatTables; ++tableIdx) {
             minWaterSat[tableIdx] = swofTables[tableIdx].getSwColumn().front();
             maxWaterSat[tableIdx] = swofTables[tableIdx].getSwColumn().back();
 
@@ -182,172 +427,19 @@ public:
                 }
             }
         }
-
-        // acctually assign the defaults. if the ENPVD keyword was specified in the deck,
-        // this currently cannot be done because we would need the Z-coordinate of the
-        // cell and we would need to know how the simulator wants to interpolate between
-        // sampling points. Both of these are outside the scope of opm-parser, so we just
-        // assign a NaN in this case...
-        bool useEnptvd = m_deck.hasKeyword("ENPTVD");
-        bool useImptvd = m_deck.hasKeyword("IMPTVD");
-        const auto& enptvdTables = m_eclipseState.getEnptvdTables();
-        const auto& imptvdTables = m_eclipseState.getImptvdTables();
-        for (size_t cellIdx = 0; cellIdx < satnumData.size(); ++cellIdx) {
-            int satTableIdx = satnumData.at(cellIdx) - 1;
-            int imbTableIdx = imbnumData.at(cellIdx) - 1;
-            int endNum = endnumData.at(cellIdx) - 1;
-
-            double cellDepth = std::get<2>(eclipseGrid->getCellCenter(cellIdx));
-
-            assert(0 <= satTableIdx && satTableIdx < numSatTables);
-            assert(0 <= imbTableIdx && imbTableIdx < numSatTables);
-
-            // the SGL keyword family
-            if (propertyName.find("SGL") == 0)
-                values[cellIdx] = selectValue(enptvdTables,
-                                              (useEnptvd && endNum >= 0) ? endNum : -1,
-                                              "SGCO",
-                                              cellDepth,
-                                              minGasSat[satTableIdx]);
-            else if (propertyName.find("ISGL") == 0)
-                values[cellIdx] = selectValue(imptvdTables,
-                                              (useImptvd && endNum >= 0) ? endNum : -1,
-                                              "SGCO",
-                                              cellDepth,
-                                              minGasSat[imbTableIdx]);
-
-            // the SWL keyword family
-            else if (propertyName.find("SWL") == 0)
-                values[cellIdx] = selectValue(enptvdTables,
-                                              (useEnptvd && endNum >= 0) ? endNum : -1,
-                                              "SWCO",
-                                              cellDepth,
-                                              minWaterSat[satTableIdx]);
-            else if (propertyName.find("ISWL") == 0)
-                values[cellIdx] = selectValue(imptvdTables,
-                                              (useImptvd && endNum >= 0) ? endNum : -1,
-                                              "SWCO",
-                                              cellDepth,
-                                              minWaterSat[imbTableIdx]);
-
-            // the SGU keyword family
-            else if (propertyName.find("SGU") == 0)
-                values[cellIdx] = selectValue(enptvdTables,
-                                              (useEnptvd && endNum >= 0) ? endNum : -1,
-                                              "SGMAX",
-                                              cellDepth,
-                                              maxGasSat[satTableIdx]);
-            else if (propertyName.find("ISGU") == 0)
-                values[cellIdx] = selectValue(imptvdTables,
-                                              (useImptvd && endNum >= 0) ? endNum : -1,
-                                              "SGMAX",
-                                              cellDepth,
-                                              maxGasSat[imbTableIdx]);
-
-            // the SWU keyword family
-            else if (propertyName.find("SWU") == 0)
-                values[cellIdx] = selectValue(enptvdTables,
-                                              (useEnptvd && endNum >= 0) ? endNum : -1,
-                                              "SWCO",
-                                              cellDepth,
-                                              maxWaterSat[satTableIdx],
-                                              /*useOneMinusTableValue=*/true);
-            else if (propertyName.find("ISWU") == 0)
-                values[cellIdx] = selectValue(imptvdTables,
-                                              (useEnptvd && endNum >= 0) ? endNum : -1,
-                                              "SWCO",
-                                              cellDepth,
-                                              maxWaterSat[imbTableIdx],
-                                              /*useOneMinusTableValue=*/true);
-
-            // the SGCR keyword family
-            else if (propertyName.find("SGCR") == 0)
-                values[cellIdx] = selectValue(enptvdTables,
-                                              (useEnptvd && endNum >= 0) ? endNum : -1,
-                                              "SGCRIT",
-                                              cellDepth,
-                                              criticalGasSat[satTableIdx]);
-            else if (propertyName.find("ISGCR") == 0)
-                values[cellIdx] = selectValue(imptvdTables,
-                                              (useImptvd && endNum >= 0) ? endNum : -1,
-                                              "SGCRIT",
-                                              cellDepth,
-                                              criticalGasSat[imbTableIdx]);
-
-            // the SWCR keyword family
-            else if (propertyName.find("SWCR") == 0)
-                values[cellIdx] = selectValue(enptvdTables,
-                                              (useEnptvd && endNum >= 0) ? endNum : -1,
-                                              "SWCRIT",
-                                              cellDepth,
-                                              criticalWaterSat[satTableIdx]);
-            else if (propertyName.find("ISWCR") == 0)
-                values[cellIdx] = selectValue(imptvdTables,
-                                              (useImptvd && endNum >= 0) ? endNum : -1,
-                                              "SWCRIT",
-                                              cellDepth,
-                                              criticalWaterSat[imbTableIdx]);
-
-            // the SOGCR keyword family
-            else if (propertyName.find("SOGCR") == 0)
-                values[cellIdx] = selectValue(enptvdTables,
-                                              (useEnptvd && endNum >= 0) ? endNum : -1,
-                                              "SOGCRIT",
-                                              cellDepth,
-                                              criticalOilOGSat[satTableIdx]);
-            else if (propertyName.find("ISOGCR") == 0)
-                values[cellIdx] = selectValue(imptvdTables,
-                                              (useImptvd && endNum >= 0) ? endNum : -1,
-                                              "SOGCRIT",
-                                              cellDepth,
-                                              criticalOilOGSat[imbTableIdx]);
-
-            // the SOWCR keyword family
-            else if (propertyName.find("SOWCR") == 0)
-                values[cellIdx] = selectValue(enptvdTables,
-                                              (useEnptvd && endNum >= 0) ? endNum : -1,
-                                              "SOWCRIT",
-                                              cellDepth,
-                                              criticalOilOWSat[satTableIdx]);
-            else if (propertyName.find("ISOWCR") == 0)
-                values[cellIdx] = selectValue(imptvdTables,
-                                              (useImptvd && endNum >= 0) ? endNum : -1,
-                                              "SOWCRIT",
-                                              cellDepth,
-                                              criticalOilOWSat[imbTableIdx]);
-        }
-    }
-
-private:
-    template <class TableType>
-    double selectValue(const std::vector<TableType>& depthTables,
-                       int tableIdx,
-                       const std::string& columnName,
-                       double cellDepth,
-                       double fallbackValue,
-                       bool useOneMinusTableValue = false) const {
-        double value = fallbackValue;
-
-        if (tableIdx >= 0) {
-            if (tableIdx >= static_cast<int>(depthTables.size()))
-                throw std::invalid_argument("Not enough tables!");
-
-            // evaluate the table at the cell depth
-            value = depthTables[tableIdx].evaluate(columnName, cellDepth);
-
-            if (!std::isfinite(value))
-                // a column can be fully defaulted. In this case, eval() returns a NaN
-                // and we have to use the data from SWOF/SGOF
-                value = fallbackValue;
-            else if (useOneMinusTableValue)
-                value = 1 - value;
-        }
-
-        return value;
     }
 
     const Deck& m_deck;
     const EclipseState& m_eclipseState;
+
+    mutable std::once_flag m_initFlag;
+    mutable int m_numSatTables = 0;
+    mutable std::vector<double> m_endpoints[NumFamilies];
+
+    mutable std::mutex m_endnumMutex;
+    mutable std::shared_ptr<const EndnumCells> m_endnumCells;
+    mutable const void* m_endnumProperty = nullptr;
+    mutable size_t m_endnumRevision = 0;
 };
 }
 
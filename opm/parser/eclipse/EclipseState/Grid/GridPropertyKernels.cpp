@@ -0,0 +1,220 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+
+#include <opm/parser/eclipse/EclipseState/Grid/GridPropertyKernels.hpp>
+#include <opm/parser/eclipse/EclipseState/Util/Parallel.hpp>
+
+/*
+  With GCC on x86 the kernels are cloned for several instruction sets
+  and dispatched at load time through an ifunc resolver. Elsewhere the
+  plain loops are left to the autovectorizer of the compiler.
+*/
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__)
+#define OPM_KERNEL_CLONES __attribute__((target_clones("avx512f","avx2","default")))
+#else
+#define OPM_KERNEL_CLONES
+#endif
+
+namespace Opm {
+namespace GridPropertyKernels {
+
+namespace {
+
+    // Long runs are split in blocks of this size to distribute them
+    // over the threads.
+    const size_t blockSize = 1 << 14;
+
+
+    OPM_KERNEL_CLONES
+    void scaleRun(int* __restrict__ data , size_t size , int scaleFactor) {
+        for (size_t i = 0; i < size; ++i)
+            data[i] *= scaleFactor;
+    }
+
+    OPM_KERNEL_CLONES
+    void scaleRun(double* __restrict__ data , size_t size , double scaleFactor) {
+        for (size_t i = 0; i < size; ++i)
+            data[i] *= scaleFactor;
+    }
+
+    OPM_KERNEL_CLONES
+    void addRun(int* __restrict__ data , size_t size , int shiftValue) {
+        for (size_t i = 0; i < size; ++i)
+            data[i] += shiftValue;
+    }
+
+    OPM_KERNEL_CLONES
+    void addRun(double* __restrict__ data , size_t size , double shiftValue) {
+        for (size_t i = 0; i < size; ++i)
+            data[i] += shiftValue;
+    }
+
+    OPM_KERNEL_CLONES
+    void setRun(int* __restrict__ data , size_t size , int value) {
+        for (size_t i = 0; i < size; ++i)
+            data[i] = value;
+    }
+
+    OPM_KERNEL_CLONES
+    void setRun(double* __restrict__ data , size_t size , double value) {
+        for (size_t i = 0; i < size; ++i)
+            data[i] = value;
+    }
+
+    OPM_KERNEL_CLONES
+    void copyRun(int* __restrict__ target , const int* __restrict__ src , size_t size) {
+        for (size_t i = 0; i < size; ++i)
+            target[i] = src[i];
+    }
+
+    OPM_KERNEL_CLONES
+    void copyRun(double* __restrict__ target , const double* __restrict__ src , size_t size) {
+        for (size_t i = 0; i < size; ++i)
+            target[i] = src[i];
+    }
+
+
+    /*
+      Calls kernel(begin, end) for contiguous blocks of global indices
+      covering the box. Every cell is visited exactly once, so the
+      blocks can be processed in any order.
+    */
+    template <class Kernel>
+    void forEachBlock(const Box& box , Kernel kernel) {
+        const size_t numRuns = box.numRuns();
+
+        if (box.size() < parallelThreshold) {
+            for (size_t runIdx = 0; runIdx < numRuns; ++runIdx) {
+                const Box::IndexRun run = box.getRun( runIdx );
+                kernel( run.begin , run.end );
+            }
+            return;
+        }
+
+        const size_t runLength = box.size() / numRuns;
+        const size_t blocksPerRun = (runLength + blockSize - 1) / blockSize;
+        const long numBlocks = static_cast<long>(numRuns * blocksPerRun);
+
+#pragma omp parallel for schedule(static)
+        for (long blockIdx = 0; blockIdx < numBlocks; ++blockIdx) {
+            const Box::IndexRun run = box.getRun( blockIdx / blocksPerRun );
+            const size_t begin = run.begin + (blockIdx % blocksPerRun) * blockSize;
+            const size_t end = std::min( begin + blockSize , run.end );
+
+            kernel( begin , end );
+        }
+    }
+
+
+    template <typename T>
+    void scaleBox(T* data , const Box& box , T scaleFactor) {
+        forEachBlock( box , [=](size_t begin , size_t end) {
+                scaleRun( data + begin , end - begin , scaleFactor );
+            });
+    }
+
+    template <typename T>
+    void addBox(T* data , const Box& box , T shiftValue) {
+        forEachBlock( box , [=](size_t begin , size_t end) {
+                addRun( data + begin , end - begin , shiftValue );
+            });
+    }
+
+    template <typename T>
+    void setScalarBox(T* data , const Box& box , T value) {
+        forEachBlock( box , [=](size_t begin , size_t end) {
+                setRun( data + begin , end - begin , value );
+            });
+    }
+
+    template <typename T>
+    void copyBox(T* target , const T* src , const Box& box) {
+        if (target == src)
+            return;
+
+        forEachBlock( box , [=](size_t begin , size_t end) {
+                copyRun( target + begin , src + begin , end - begin );
+            });
+    }
+
+    template <typename T>
+    void applyBox(T* data , const Box& box , const std::vector<Operation<T> >& operations) {
+        forEachBlock( box , [=, &operations](size_t begin , size_t end) {
+                for (auto iter = operations.begin(); iter != operations.end(); ++iter) {
+                    switch (iter->type) {
+                    case Operation<T>::Scale:
+                        scaleRun( data + begin , end - begin , iter->value );
+                        break;
+                    case Operation<T>::Add:
+                        addRun( data + begin , end - begin , iter->value );
+                        break;
+                    case Operation<T>::SetScalar:
+                        setRun( data + begin , end - begin , iter->value );
+                        break;
+                    }
+                }
+            });
+    }
+}
+
+
+    void scale(int* data , const Box& box , int scaleFactor) {
+        scaleBox( data , box , scaleFactor );
+    }
+
+    void scale(double* data , const Box& box , double scaleFactor) {
+        scaleBox( data , box , scaleFactor );
+    }
+
+    void add(int* data , const Box& box , int shiftValue) {
+        addBox( data , box , shiftValue );
+    }
+
+    void add(double* data , const Box& box , double shiftValue) {
+        addBox( data , box , shiftValue );
+    }
+
+    void setScalar(int* data , const Box& box , int value) {
+        setScalarBox( data , box , value );
+    }
+
+    void setScalar(double* data , const Box& box , double value) {
+        setScalarBox( data , box , value );
+    }
+
+    void copy(int* target , const int* src , const Box& box) {
+        copyBox( target , src , box );
+    }
+
+    void copy(double* target , const double* src , const Box& box) {
+        copyBox( target , src , box );
+    }
+
+    void apply(int* data , const Box& box , const std::vector<Operation<int> >& operations) {
+        applyBox( data , box , operations );
+    }
+
+    void apply(double* data , const Box& box , const std::vector<Operation<double> >& operations) {
+        applyBox( data , box , operations );
+    }
+
+}
+}
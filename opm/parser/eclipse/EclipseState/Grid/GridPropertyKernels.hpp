@@ -0,0 +1,85 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GRIDPROPERTY_KERNELS_HPP_
+#define GRIDPROPERTY_KERNELS_HPP_
+
+#include <vector>
+
+#include <opm/parser/eclipse/EclipseState/Grid/Box.hpp>
+
+/*
+  Kernels for the box operators of GridProperty<int> and
+  GridProperty<double>. The kernels work on the contiguous runs of the
+  box; on x86 the inner loops are compiled for AVX-512, AVX2 and the
+  baseline instruction set, and the best variant for the running CPU
+  is selected when the library is loaded. Large boxes are processed
+  multithreaded with OpenMP, in blocks which never straddle a run.
+
+  Only elementwise operations are performed, in the same order as in a
+  scalar loop, so the results are bit-identical to the scalar code on
+  every instruction set and for any number of threads.
+*/
+
+namespace Opm {
+namespace GridPropertyKernels {
+
+    template <typename T>
+    struct Operation {
+        enum Type {
+            Scale,
+            Add,
+            SetScalar
+        };
+
+        Operation(Type type_ , T value_)
+            : type( type_ ),
+              value( value_ )
+        { }
+
+        Type type;
+        T value;
+    };
+
+    void scale(int* data , const Box& box , int scaleFactor);
+    void scale(double* data , const Box& box , double scaleFactor);
+
+    void add(int* data , const Box& box , int shiftValue);
+    void add(double* data , const Box& box , double shiftValue);
+
+    void setScalar(int* data , const Box& box , int value);
+    void setScalar(double* data , const Box& box , double value);
+
+    void copy(int* target , const int* src , const Box& box);
+    void copy(double* target , const double* src , const Box& box);
+
+    /*
+      Applies a sequence of operations to the cells of the box in one
+      pass over the memory: the box is processed in cache sized blocks
+      and all the operations are applied to a block before moving on to
+      the next one. Every cell sees the operations in the given order,
+      i.e. the result is identical to applying them one by one.
+    */
+    void apply(int* data , const Box& box , const std::vector<Operation<int> >& operations);
+    void apply(double* data , const Box& box , const std::vector<Operation<double> >& operations);
+
+}
+}
+
+#endif
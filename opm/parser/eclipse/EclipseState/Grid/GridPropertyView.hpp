@@ -0,0 +1,131 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GRIDPROPERTY_VIEW_HPP_
+#define GRIDPROPERTY_VIEW_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <opm/parser/eclipse/EclipseState/Grid/CompactIntArray.hpp>
+
+/*
+  A GridPropertyView gives read only access to the values of a
+  GridProperty, without expanding the storage of the property: the
+  values can be a constant, a full vector or - for integer properties
+  - a CompactIntArray. The view keeps the storage alive, i.e. it
+  remains valid also when the property is modified. A view of a full
+  vector shares it with the property, and shows the writes to the
+  property until the property gets new storage, e.g. by compress() or
+  a global EQUALS; a view of a constant or compact property shows the
+  values at the time it was created. Holding a view does not make
+  the writes to the property copy its storage.
+
+  For loops over all cells use bytesPerValue() and the typed data
+  pointers to read the storage directly.
+*/
+
+namespace Opm {
+
+    template <typename T>
+    class GridPropertyView {
+    public:
+        GridPropertyView(size_t size , T constantValue)
+            : m_size( size ),
+              m_bytesPerValue( 0 ),
+              m_constantValue( constantValue ),
+              m_data( nullptr ),
+              m_data8( nullptr ),
+              m_data16( nullptr )
+        { }
+
+        explicit GridPropertyView(std::shared_ptr<const std::vector<T> > data)
+            : m_size( data->size() ),
+              m_bytesPerValue( sizeof(T) ),
+              m_constantValue( T() ),
+              m_data( data->data() ),
+              m_data8( nullptr ),
+              m_data16( nullptr ),
+              m_storage( data )
+        { }
+
+        explicit GridPropertyView(std::shared_ptr<const CompactIntArray> data)
+            : m_size( data->size() ),
+              m_bytesPerValue( data->bytesPerValue() ),
+              m_constantValue( T() ),
+              m_data( nullptr ),
+              m_data8( data->bytesPerValue() == 1 ? data->data8() : nullptr ),
+              m_data16( data->bytesPerValue() == 2 ? data->data16() : nullptr ),
+              m_storage( data )
+        { }
+
+        size_t size() const {
+            return m_size;
+        }
+
+        bool isConstant() const {
+            return m_bytesPerValue == 0;
+        }
+
+        // 0 for a constant, 1 or 2 for compact storage and sizeof(T)
+        // for a full vector.
+        size_t bytesPerValue() const {
+            return m_bytesPerValue;
+        }
+
+        T operator[](size_t index) const {
+            if (m_data)
+                return m_data[index];
+            else if (m_data8)
+                return static_cast<T>(m_data8[index]);
+            else if (m_data16)
+                return static_cast<T>(m_data16[index]);
+            else
+                return m_constantValue;
+        }
+
+        T getConstantValue() const {
+            return m_constantValue;
+        }
+
+        const T* data() const {
+            return m_data;
+        }
+
+        const uint8_t* data8() const {
+            return m_data8;
+        }
+
+        const uint16_t* data16() const {
+            return m_data16;
+        }
+
+    private:
+        size_t m_size;
+        size_t m_bytesPerValue;
+        T m_constantValue;
+        const T* m_data;
+        const uint8_t* m_data8;
+        const uint16_t* m_data16;
+        std::shared_ptr<const void> m_storage;
+    };
+}
+
+#endif
@@ -17,12 +17,15 @@
   along with OPM.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
+#include <limits>
 #include <stdexcept>
 #include <map>
 #include <set>
 
 #include <opm/parser/eclipse/EclipseState/Grid/MULTREGTScanner.hpp>
 #include <opm/parser/eclipse/EclipseState/Grid/FaceDir.hpp>
+#include <opm/parser/eclipse/EclipseState/Util/Parallel.hpp>
 
 namespace Opm {
 
@@ -100,23 +103,14 @@ namespace Opm {
     }
 
 
+    /*
+      All the NNC behaviours, defaulted source and target regions and
+      equal source and target regions are supported; this only checks
+      that the records can be interpreted.
+    */
     void MULTREGTScanner::assertKeywordSupported(DeckKeywordConstPtr deckKeyword) {
-        for (auto iter = deckKeyword->begin(); iter != deckKeyword->end(); ++iter) {
+        for (auto iter = deckKeyword->begin(); iter != deckKeyword->end(); ++iter)
             MULTREGTRecord record( *iter );
-            
-            if (record.m_nncBehaviour != MULTREGT::ALL)
-                throw std::invalid_argument("Sorry - currently only \'ALL\' is supported for MULTREGT NNC behaviour.");
-            
-            if (!record.m_srcRegion.hasValue())
-                throw std::invalid_argument("Sorry - currently it is not supported with a defaulted source region value.");
-
-            if (!record.m_targetRegion.hasValue())
-                throw std::invalid_argument("Sorry - currently it is not supported with a defaulted target region value.");
-
-            if (record.m_srcRegion.getValue() == record.m_targetRegion.getValue())
-                throw std::invalid_argument("Sorry - multregt applied internally to a region is not yet supported");
-            
-        }
     }
     
 
@@ -144,6 +138,102 @@ namespace Opm {
     }
     
 
+    MULTREGTRegionPairTable::MULTREGTRegionPairTable(const std::vector<const MULTREGTRecord *>& records , int minRegion , int maxRegion)
+        : m_records( records ),
+          m_maxRegion( maxRegion )
+    {
+        // The dense table is used as long as it has at most this many entries.
+        const size_t maxDenseSize = 1 << 22;
+        const size_t denseSize = static_cast<size_t>(maxRegion + 1) * static_cast<size_t>(maxRegion + 1);
+
+        if (minRegion >= 0 && maxRegion >= 0 && denseSize <= maxDenseSize) {
+            m_dense.resize( denseSize );
+            for (int recordIndex = 0; recordIndex < static_cast<int>(m_records.size()); recordIndex++) {
+                const MULTREGTRecord * record = m_records[recordIndex];
+                const bool anySource = !record->m_srcRegion.hasValue();
+                const bool anyTarget = !record->m_targetRegion.hasValue();
+                const int src1 = anySource ? 0 : record->m_srcRegion.getValue();
+                const int src2 = anySource ? maxRegion : src1;
+                const int target1 = anyTarget ? 0 : record->m_targetRegion.getValue();
+                const int target2 = anyTarget ? maxRegion : target1;
+
+                for (int src = std::max( src1 , 0 ); src <= std::min( src2 , maxRegion ); src++) {
+                    for (int target = std::max( target1 , 0 ); target <= std::min( target2 , maxRegion ); target++) {
+                        if ((anySource || anyTarget) && src == target)
+                            continue;
+
+                        setEntry( m_dense[ static_cast<size_t>(src) * (maxRegion + 1) + target ] , record , recordIndex );
+                    }
+                }
+            }
+        } else {
+            for (int recordIndex = 0; recordIndex < static_cast<int>(m_records.size()); recordIndex++) {
+                const MULTREGTRecord * record = m_records[recordIndex];
+                const bool anySource = !record->m_srcRegion.hasValue();
+                const bool anyTarget = !record->m_targetRegion.hasValue();
+
+                if (anySource && anyTarget)
+                    setEntry( m_anyPair , record , recordIndex );
+                else if (anySource)
+                    setEntry( m_anySource[ record->m_targetRegion.getValue() ] , record , recordIndex );
+                else if (anyTarget)
+                    setEntry( m_anyTarget[ record->m_srcRegion.getValue() ] , record , recordIndex );
+                else
+                    setEntry( m_sparse[ pairKey( record->m_srcRegion.getValue() , record->m_targetRegion.getValue() ) ] , record , recordIndex );
+            }
+        }
+    }
+
+
+    void MULTREGTRegionPairTable::setEntry(Entry& entry , const MULTREGTRecord * record , int recordIndex) {
+        if (record->m_nncBehaviour != MULTREGT::NNC)
+            entry.neighbour = recordIndex;
+
+        if (record->m_nncBehaviour != MULTREGT::NONNC)
+            entry.nnc = recordIndex;
+    }
+
+
+    /*
+      The last record matching the pair applies, i.e. the one with the
+      highest index among the exact and the wildcard matches.
+    */
+    const MULTREGTRecord * MULTREGTRegionPairTable::getSparse(int region1 , int region2 , bool nnc) const {
+        int recordIndex = -1;
+        auto update = [&recordIndex , nnc](const Entry& entry) {
+            recordIndex = std::max( recordIndex , nnc ? entry.nnc : entry.neighbour );
+        };
+
+        {
+            auto iter = m_sparse.find( pairKey( region1 , region2 ));
+            if (iter != m_sparse.end())
+                update( iter->second );
+        }
+
+        if (region1 != region2) {
+            auto sourceIter = m_anySource.find( region2 );
+            if (sourceIter != m_anySource.end())
+                update( sourceIter->second );
+
+            auto targetIter = m_anyTarget.find( region1 );
+            if (targetIter != m_anyTarget.end())
+                update( targetIter->second );
+
+            update( m_anyPair );
+        }
+
+        return getRecord( recordIndex );
+    }
+
+
+    bool MULTREGTRegionPairTable::isDense() const {
+        return !m_dense.empty();
+    }
+
+    /*****************************************************************/
+
+namespace {
+
     /*
       This function will check the region values in globalIndex1 and
       globalIndex and see if they match the regionvalues specified in
@@ -165,29 +255,132 @@ namespace Opm {
          | 2  | 1  |   =>  MultTrans( i+1,j,k,FaceDir::XMinus ) *= 0.50
          -----------
 
+      For a record with equal source and target regions the multiplier
+      is assigned to the face of the first cell only. A record which
+      matches both directions, e.g. a wildcard record like (* -> *), is
+      also applied once per connection only. The connections
+      found are passed to the emit functor, which
+      either counts or stores them.
     */
-    void MULTREGTScanner::checkConnection( MULTREGTSearchMap& map , std::vector< MULTREGTConnection >& connections, std::shared_ptr<GridProperty<int> > region, size_t globalIndex1 , size_t globalIndex2 , FaceDir::DirEnum faceDir1 ,FaceDir::DirEnum faceDir2) {
-        int regionValue1 = region->iget(globalIndex1);
-        int regionValue2 = region->iget(globalIndex2);
-        
-        std::pair<int,int> pair{regionValue1 , regionValue2};
-        if (map.count(pair) == 1) {
-            const MULTREGTRecord * record = map[pair];
-            if (record->m_directions & faceDir1) {
-                connections.push_back( MULTREGTConnection{ globalIndex1 , faceDir1 , record->m_transMultiplier } );
-            }
+    template <class Emit>
+    void checkConnection( const MULTREGTRegionPairTable& table , int regionValue1 , int regionValue2 , size_t globalIndex1 , size_t globalIndex2 , FaceDir::DirEnum faceDir1 , FaceDir::DirEnum faceDir2 , Emit& emit) {
+        const MULTREGTRecord * record1 = table.get( regionValue1 , regionValue2 , false );
+        if (record1 && (record1->m_directions & faceDir1))
+            emit( MULTREGTConnection{ globalIndex1 , faceDir1 , record1->m_transMultiplier } );
+
+        // Within a region the multiplier is only applied once.
+        if (regionValue1 == regionValue2)
+            return;
+
+        const MULTREGTRecord * record2 = table.get( regionValue2 , regionValue1 , false );
+        if (record2 && (record2 != record1) && (record2->m_directions & faceDir2))
+            emit( MULTREGTConnection{ globalIndex2 , faceDir2 , record2->m_transMultiplier } );
+    }
+
+
+    void regionRange( const GridPropertyView<int>& region , size_t size , int& minRegion , int& maxRegion) {
+        int minValue = std::numeric_limits<int>::max();
+        int maxValue = std::numeric_limits<int>::min();
+
+#pragma omp parallel for schedule(static) reduction(min:minValue) reduction(max:maxValue) if (size >= parallelThreshold)
+        for (long g = 0; g < static_cast<long>(size); g++) {
+            minValue = std::min( minValue , region[g] );
+            maxValue = std::max( maxValue , region[g] );
         }
-        
-        pair = std::pair<int,int>{regionValue2 , regionValue1};
-        if (map.count(pair) == 1) {
-            const MULTREGTRecord * record = map[pair];
-            if (record->m_directions & faceDir2) {
-                connections.push_back( MULTREGTConnection{ globalIndex2 , faceDir2 , record->m_transMultiplier } );
+
+        minRegion = minValue;
+        maxRegion = maxValue;
+    }
+
+
+    /*
+      Visits all the faces between the cells of layer k and their
+      X+, Y+ and Z+ neighbours, in the order of the global index.
+    */
+    template <class Emit>
+    void scanLayer( const MULTREGTRegionPairTable& table , const GridPropertyView<int>& region , size_t nx , size_t ny , size_t nz , size_t k , Emit& emit) {
+        for (size_t j = 0; j < ny; j++) {
+            for (size_t i = 0; i < nx; i++) {
+                const size_t globalIndex1 = i + j*nx + k*nx*ny;
+                const int regionValue1 = region[globalIndex1];
+
+                if ((i + 1) < nx)
+                    checkConnection( table , regionValue1 , region[globalIndex1 + 1] , globalIndex1 , globalIndex1 + 1 , FaceDir::XPlus , FaceDir::XMinus , emit);
+
+                if ((j + 1) < ny)
+                    checkConnection( table , regionValue1 , region[globalIndex1 + nx] , globalIndex1 , globalIndex1 + nx , FaceDir::YPlus , FaceDir::YMinus , emit);
+
+                if ((k + 1) < nz)
+                    checkConnection( table , regionValue1 , region[globalIndex1 + nx*ny] , globalIndex1 , globalIndex1 + nx*ny , FaceDir::ZPlus , FaceDir::ZMinus , emit);
             }
         }
     }
+}
+
+
+    /*
+      The layers are scanned in parallel in two passes: the first pass
+      counts the connections of every layer, and the second pass
+      writes them into their final position in the pre-sized
+      connections vector. The result is therefore the same as for a
+      sequential scan.
+    */
+    void MULTREGTScanner::scanRegion( const MULTREGTRegionPairTable& table , const GridProperty<int>& region , std::vector< MULTREGTConnection >& connections) {
+        const GridPropertyView<int> regionView = region.getView();
+        const size_t nx = region.getNX();
+        const size_t ny = region.getNY();
+        const size_t nz = region.getNZ();
+        const bool parallel = (nx*ny*nz >= parallelThreshold);
+
+        std::vector<size_t> offsets( nz + 1 , 0 );
+#pragma omp parallel for schedule(dynamic) if (parallel)
+        for (long k = 0; k < static_cast<long>(nz); k++) {
+            size_t count = 0;
+            auto countConnection = [&count](const MULTREGTConnection&) { count++; };
+            scanLayer( table , regionView , nx , ny , nz , static_cast<size_t>(k) , countConnection );
+            offsets[k + 1] = count;
+        }
+
+        const size_t first = connections.size();
+        for (size_t k = 0; k < nz; k++)
+            offsets[k + 1] += offsets[k];
+        connections.resize( first + offsets[nz] );
+
+#pragma omp parallel for schedule(dynamic) if (parallel)
+        for (long k = 0; k < static_cast<long>(nz); k++) {
+            MULTREGTConnection * target = connections.data() + first + offsets[k];
+            auto storeConnection = [&target](const MULTREGTConnection& connection) { *target++ = connection; };
+            scanLayer( table , regionView , nx , ny , nz , static_cast<size_t>(k) , storeConnection );
+        }
+    }
 
 
+    /*
+      The multipliers of the NNCs are independent, and are updated in
+      parallel.
+    */
+    void MULTREGTScanner::scanRegionNNC( const MULTREGTRegionPairTable& table , const GridProperty<int>& region ,
+                                         const std::vector< std::pair<size_t , size_t> >& nncs , std::vector<double>& nncMultipliers) {
+        const GridPropertyView<int> regionView = region.getView();
+        const long numNNC = static_cast<long>(nncs.size());
+
+#pragma omp parallel for schedule(static) if (nncs.size() >= parallelThreshold)
+        for (long nncIdx = 0; nncIdx < numNNC; nncIdx++) {
+            const int regionValue1 = regionView[ nncs[nncIdx].first ];
+            const int regionValue2 = regionView[ nncs[nncIdx].second ];
+
+            const MULTREGTRecord * record1 = table.get( regionValue1 , regionValue2 , true );
+            if (record1)
+                nncMultipliers[nncIdx] *= record1->m_transMultiplier;
+
+            // as for the neighbour connections a record is applied once
+            if (regionValue1 != regionValue2) {
+                const MULTREGTRecord * record2 = table.get( regionValue2 , regionValue1 , true );
+                if (record2 && (record2 != record1))
+                    nncMultipliers[nncIdx] *= record2->m_transMultiplier;
+            }
+        }
+    }
 
 
 
@@ -200,97 +393,103 @@ namespace Opm {
           2  4   2.50   XY   ALL    F / 
         /   
 
-      The first record is completely overweritten by the second
+      The first record is completely overwritten by the second
       record, this is because the both have the (2 -> 4) region
-      identifiers. This behaviourt is ensured by using a map with
-      std::pair<region1,region2> as key.
+      identifiers. A defaulted region is part of the key as a
+      wildcard, i.e. (2 -> *) is a different key than (2 -> 4). The
+      neighbour connections and the NNCs are keyed separately, so an
+      NNC record only overwrites the NNC part of an earlier ALL record.
+
+      This function starts with some initial preprocessing where the
+      records which are overwritten are removed, and the remaining
+      records are grouped on region keyword:
+
+         searchMap = {"MULTNUM" : [record(1,2) , record(4,7) , ...],
+                      "FLUXNUM" : [record(4,8) , record(1,*) , ...]}
+
+      Then it will go through the different regions, with a
+      MULTREGTRegionPairTable for each of them, and look for neighbour
+      connections and NNCs with the wanted region values; both are
+      handled by the same function call for each region keyword.
+    */
 
-      This function starts with some initial preprocessing to create a
-      map which looks like this:
+    const std::vector< MULTREGTConnection > MULTREGTScanner::scanRegions( std::shared_ptr<Opm::GridProperties<int> > regions) {
+        std::vector<double> nncMultipliers;
+        return scanRegions( regions , std::vector< std::pair<size_t , size_t> >() , nncMultipliers );
+    }
 
 
-         searchMap = {"MULTNUM" : {std::pair(1,2) : std::tuple(TransFactor , Face , Region),
-                                   std::pair(4,7) : std::tuple(TransFactor , Face , Region),
-                                   ...},
-                      "FLUXNUM" : {std::pair(4,8) : std::tuple(TransFactor , Face , Region),
-                                   std::pair(1,4) : std::tuple(TransFactor , Face , Region),
-                                   ...}}     
+    const std::vector< MULTREGTConnection > MULTREGTScanner::scanRegions( std::shared_ptr<Opm::GridProperties<int> > regions ,
+                                                                          const std::vector< std::pair<size_t , size_t> >& nncs ,
+                                                                          std::vector<double>& nncMultipliers) {
+        std::vector< MULTREGTConnection > connections;
+        scan( regions , nncs , nncMultipliers , &connections );
+        return connections;
+    }
 
-      Then it will go through the different regions and looking for
-      interface with the wanted region values.
-    */
 
-    const std::vector< MULTREGTConnection > MULTREGTScanner::scanRegions( std::shared_ptr<Opm::GridProperties<int> > regions) {
-        std::vector< MULTREGTConnection > connections;
-        std::map<std::string , MULTREGTSearchMap> searchMap;
+    void MULTREGTScanner::scanNNC( std::shared_ptr<Opm::GridProperties<int> > regions ,
+                                   const std::vector< std::pair<size_t , size_t> >& nncs ,
+                                   std::vector<double>& nncMultipliers) {
+        scan( regions , nncs , nncMultipliers , nullptr );
+    }
+
+
+    void MULTREGTScanner::scan( std::shared_ptr<Opm::GridProperties<int> > regions ,
+                                const std::vector< std::pair<size_t , size_t> >& nncs ,
+                                std::vector<double>& nncMultipliers ,
+                                std::vector< MULTREGTConnection > * connections) {
+        nncMultipliers.assign( nncs.size() , 1.0 );
+
+        // The records which are not overwritten; the NNC behaviour is
+        // narrowed to the connection types where the record still applies.
+        std::vector<MULTREGTRecord> effectiveRecords;
+        effectiveRecords.reserve( m_records.size() );
         {
-            MULTREGTSearchMap searchPairs;
-            for (std::vector<MULTREGTRecord>::const_iterator record = m_records.begin(); record != m_records.end(); ++record) {
-                if (regions->hasKeyword( record->m_region.getValue())) {
-                    if (record->m_srcRegion.hasValue() && record->m_targetRegion.hasValue()) {
-                        int srcRegion    = record->m_srcRegion.getValue();
-                        int targetRegion = record->m_targetRegion.getValue();
-                        if (srcRegion != targetRegion) {
-                            std::pair<int,int> pair{ srcRegion, targetRegion };
-                            searchPairs[pair] = &(*record);
-                        }
-                    }
-                }
-                else
+            const int anyRegion = std::numeric_limits<int>::min();
+            std::set< std::pair<int,int> > neighbourKeys;
+            std::set< std::pair<int,int> > nncKeys;
+            for (auto record = m_records.rbegin(); record != m_records.rend(); ++record) {
+                if (!regions->hasKeyword( record->m_region.getValue()))
                     throw std::logic_error("MULTREGT record is based on region: " + record->m_region.getValue() + " which is not in the deck");
-            }
 
-
-            for (auto iter = searchPairs.begin(); iter != searchPairs.end(); ++iter) {
-                const MULTREGTRecord * record = (*iter).second;
-                std::pair<int,int> pair = (*iter).first;
-                const std::string& keyword = record->m_region.getValue();
-                if (searchMap.count(keyword) == 0) 
-                    searchMap[keyword] = MULTREGTSearchMap();
-                
-                searchMap[keyword][pair] = record;
+                const std::pair<int,int> key{ record->m_srcRegion.hasValue() ? record->m_srcRegion.getValue() : anyRegion ,
+                                              record->m_targetRegion.hasValue() ? record->m_targetRegion.getValue() : anyRegion };
+                const bool neighbour = (record->m_nncBehaviour != MULTREGT::NNC) && neighbourKeys.insert( key ).second;
+                const bool nnc = (record->m_nncBehaviour != MULTREGT::NONNC) && nncKeys.insert( key ).second;
+
+                if (neighbour || nnc) {
+                    effectiveRecords.push_back( *record );
+                    if (!nnc)
+                        effectiveRecords.back().m_nncBehaviour = MULTREGT::NONNC;
+                    else if (!neighbour)
+                        effectiveRecords.back().m_nncBehaviour = MULTREGT::NNC;
+                }
             }
+            std::reverse( effectiveRecords.begin() , effectiveRecords.end() );
         }
 
+        std::map<std::string , std::vector<const MULTREGTRecord *> > searchMap;
+        for (auto record = effectiveRecords.begin(); record != effectiveRecords.end(); ++record)
+            searchMap[ record->m_region.getValue() ].push_back( &(*record) );
+
         // Iterate through the different regions
         for (auto iter = searchMap.begin(); iter != searchMap.end(); iter++) {
             std::shared_ptr<GridProperty<int> > region = regions->getKeyword( (*iter).first );
-            MULTREGTSearchMap map = (*iter).second;
-            
-
-            // Iterate through all the cells in the region.
-            for (size_t k=0; k < region->getNZ(); k++) {
-                for (size_t j = 0; j < region->getNY(); j++) {
-                    for (size_t i = 0; i < region->getNX(); i++) {
-                        size_t globalIndex1 = i + j*region->getNX() + k*region->getNY() * region->getNX();
-
-                        // X Direction
-                        if ((i + 1) < region->getNX()) {
-                            size_t globalIndex2 = globalIndex1 + 1;
-
-                            checkConnection( map , connections, region , globalIndex1 , globalIndex2 , FaceDir::XPlus , FaceDir::XMinus);
-                        }
-
-                        // Y Direction
-                        if ((j + 1) < region->getNY()) {
-                            size_t globalIndex2 = globalIndex1 + region->getNX();
-
-                            checkConnection( map , connections, region , globalIndex1 , globalIndex2 , FaceDir::YPlus , FaceDir::YMinus);
-                        }
-
-                        // Z Direction
-                        if ((k + 1) < region->getNZ()) {
-                            size_t globalIndex2 = globalIndex1 + region->getNX() * region->getNY();
-
-                            checkConnection( map , connections, region , globalIndex1 , globalIndex2 , FaceDir::ZPlus , FaceDir::ZMinus);
-                        }
-                    }
-                }
+            int minRegion = 0;
+            int maxRegion = 0;
+            regionRange( region->getView() , region->getCartesianSize() , minRegion , maxRegion );
+            for (auto nnc = nncs.begin(); nnc != nncs.end(); ++nnc) {
+                if (std::max( nnc->first , nnc->second ) >= region->getCartesianSize())
+                    throw std::invalid_argument("NNC cell index out of range");
             }
-                
+
+            const MULTREGTRegionPairTable table( (*iter).second , minRegion , maxRegion );
+            if (connections)
+                scanRegion( table , *region , *connections );
+            if (!nncs.empty())
+                scanRegionNNC( table , *region , nncs , nncMultipliers );
         }
-        
-        return connections;
     }
 
 }
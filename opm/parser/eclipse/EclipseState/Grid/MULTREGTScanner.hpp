@@ -26,6 +26,9 @@
 #include <opm/parser/eclipse/EclipseState/Grid/FaceDir.hpp>
 #include <opm/parser/eclipse/EclipseState/Util/Value.hpp>
 
+#include <cstdint>
+#include <unordered_map>
+
 
 namespace Opm {
 
@@ -58,10 +61,76 @@ namespace Opm {
         Value<std::string>  m_region;
     };
 
-    typedef std::map< std::pair<int , int> , const MULTREGTRecord * >  MULTREGTSearchMap;
     typedef std::tuple<size_t , FaceDir::DirEnum , double> MULTREGTConnection;
 
 
+    /*
+      Constant time lookup of the MULTREGT record which applies to a
+      connection from a cell in region1 to a cell in region2. The
+      records are given in deck order, and when several records match
+      a region pair the last one applies. A defaulted source or target
+      region matches all the other regions, i.e. not region1 ==
+      region2, whereas an explicit record with equal source and target
+      applies to the connections within that region.
+
+      Neighbour connections and non-neighbour connections (NNC) are
+      looked up separately: records with the NNC behaviour only apply
+      to NNCs, records with NONNC only to neighbour connections, and
+      ALL and NOAQUNNC records to both - there are no numerical
+      aquifers, so NOAQUNNC is equivalent to ALL.
+
+      When the region values are in [0, maxRegion] for a small
+      maxRegion the records are expanded into a dense (maxRegion + 1) x
+      (maxRegion + 1) table, otherwise they are kept in hash maps keyed
+      on the region pair.
+    */
+    class MULTREGTRegionPairTable {
+    public:
+        MULTREGTRegionPairTable(const std::vector<const MULTREGTRecord *>& records , int minRegion , int maxRegion);
+
+        bool isDense() const;
+        const MULTREGTRecord * get(int region1 , int region2 , bool nnc) const {
+            if (isDense()) {
+                if (region1 < 0 || region2 < 0 || region1 > m_maxRegion || region2 > m_maxRegion)
+                    return nullptr;
+
+                const Entry& entry = m_dense[ static_cast<size_t>(region1) * (m_maxRegion + 1) + region2 ];
+                return getRecord( nnc ? entry.nnc : entry.neighbour );
+            } else
+                return getSparse( region1 , region2 , nnc );
+        }
+
+    private:
+        // indices into m_records; -1 if no record applies
+        struct Entry {
+            Entry() : neighbour(-1) , nnc(-1) {}
+            int neighbour;
+            int nnc;
+        };
+
+        static uint64_t pairKey(int region1 , int region2) {
+            return (static_cast<uint64_t>(static_cast<uint32_t>(region1)) << 32) | static_cast<uint32_t>(region2);
+        }
+
+        const MULTREGTRecord * getRecord(int recordIndex) const {
+            return (recordIndex < 0) ? nullptr : m_records[recordIndex];
+        }
+
+        static void setEntry(Entry& entry , const MULTREGTRecord * record , int recordIndex);
+        const MULTREGTRecord * getSparse(int region1 , int region2 , bool nnc) const;
+
+        std::vector<const MULTREGTRecord *> m_records;
+        int m_maxRegion;
+        std::vector<Entry> m_dense;
+        std::unordered_map<uint64_t , Entry> m_sparse;
+        // records with a defaulted source region, keyed on the target
+        std::unordered_map<int , Entry> m_anySource;
+        // records with a defaulted target region, keyed on the source
+        std::unordered_map<int , Entry> m_anyTarget;
+        Entry m_anyPair;
+    };
+
+
 
     class MULTREGTScanner {
 
@@ -69,11 +138,35 @@ namespace Opm {
         MULTREGTScanner();
         void addKeyword(DeckKeywordConstPtr deckKeyword);
         const std::vector< std::tuple<size_t , FaceDir::DirEnum , double> > scanRegions( std::shared_ptr<Opm::GridProperties<int> > regions);
+
+        /*
+          As scanRegions() above; in addition the region multipliers
+          of the non-neighbour connections (globalIndex1, globalIndex2)
+          in nncs are returned in nncMultipliers. The directions item
+          of the records does not apply to NNCs.
+        */
+        const std::vector< MULTREGTConnection > scanRegions( std::shared_ptr<Opm::GridProperties<int> > regions ,
+                                                             const std::vector< std::pair<size_t , size_t> >& nncs ,
+                                                             std::vector<double>& nncMultipliers);
+
+        /*
+          Only the region multipliers of the NNCs, without scanning
+          the neighbour connections of the grid.
+        */
+        void scanNNC( std::shared_ptr<Opm::GridProperties<int> > regions ,
+                      const std::vector< std::pair<size_t , size_t> >& nncs ,
+                      std::vector<double>& nncMultipliers);
         static void assertKeywordSupported(DeckKeywordConstPtr deckKeyword);
   
     private:
-        void checkConnection( MULTREGTSearchMap& map , std::vector< MULTREGTConnection >& connections, std::shared_ptr<GridProperty<int> > region , size_t globalIndex1 , size_t globalIndex2 , FaceDir::DirEnum faceDir1 ,FaceDir::DirEnum faceDir2);
-
+        // The neighbour connections are only scanned when connections is not null.
+        void scan( std::shared_ptr<Opm::GridProperties<int> > regions ,
+                   const std::vector< std::pair<size_t , size_t> >& nncs ,
+                   std::vector<double>& nncMultipliers ,
+                   std::vector< MULTREGTConnection > * connections);
+        static void scanRegion( const MULTREGTRegionPairTable& table , const GridProperty<int>& region , std::vector< MULTREGTConnection >& connections);
+        static void scanRegionNNC( const MULTREGTRegionPairTable& table , const GridProperty<int>& region ,
+                                   const std::vector< std::pair<size_t , size_t> >& nncs , std::vector<double>& nncMultipliers);
 
         std::vector< MULTREGTRecord > m_records;
     };
@@ -0,0 +1,175 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include <opm/parser/eclipse/EclipseState/Grid/MinpvProcessor.hpp>
+#include <opm/parser/eclipse/EclipseState/Util/Parallel.hpp>
+
+namespace Opm {
+
+namespace {
+
+    // The reason a cell is inactive.
+    enum CellStatus {
+        Active,
+        InputInactive,
+        MinpvInactive,
+        PinchedOut
+    };
+
+    double cellThickness(const std::vector<double>& zcorn , size_t nx , size_t ny , size_t i , size_t j , size_t k) {
+        const size_t top = k*8*nx*ny + j*4*nx + 2*i;
+        const size_t bottom = top + 4*nx*ny;
+        double thickness = 0;
+        for (size_t dj = 0; dj < 2; dj++)
+            for (size_t di = 0; di < 2; di++)
+                thickness += zcorn[bottom + dj*2*nx + di] - zcorn[top + dj*2*nx + di];
+
+        return thickness / 4;
+    }
+}
+
+
+    MinpvProcessor::MinpvProcessor(size_t nx , size_t ny , size_t nz ,
+                                   const std::vector<double>& zcorn ,
+                                   const std::vector<int>& actnum ,
+                                   const std::vector<double>& poreVolume ,
+                                   double minpv ,
+                                   const PinchOptions& pinch)
+        : m_actnum( nx * ny * nz , 1 ),
+          m_numMinpvDeactivated( 0 ),
+          m_numPinchedOut( 0 )
+    {
+        const size_t numCells = nx * ny * nz;
+        if (zcorn.size() != 8*numCells)
+            throw std::invalid_argument("The size of ZCORN does not match the grid dimensions");
+
+        if (!actnum.empty() && actnum.size() != numCells)
+            throw std::invalid_argument("The size of ACTNUM does not match the grid dimensions");
+
+        if (minpv > 0 && poreVolume.size() != numCells)
+            throw std::invalid_argument("The size of the pore volume does not match the grid dimensions");
+
+        const long numColumns = static_cast<long>(nx * ny);
+        std::vector< std::vector< std::pair<size_t , size_t> > > columnConnections( numColumns );
+        size_t numMinpvDeactivated = 0;
+        size_t numPinchedOut = 0;
+
+#pragma omp parallel for schedule(static) reduction(+:numMinpvDeactivated , numPinchedOut) if (numCells >= parallelThreshold)
+        for (long column = 0; column < numColumns; column++) {
+            const size_t i = column % nx;
+            const size_t j = column / nx;
+            std::vector<CellStatus> status( nz );
+            std::vector<double> thickness( nz );
+
+            for (size_t k = 0; k < nz; k++) {
+                const size_t g = column + k*nx*ny;
+                thickness[k] = cellThickness( zcorn , nx , ny , i , j , k );
+                if (!actnum.empty() && actnum[g] <= 0)
+                    status[k] = InputInactive;
+                else if (pinch.active && thickness[k] < pinch.thresholdThickness) {
+                    status[k] = PinchedOut;
+                    numPinchedOut++;
+                } else if (minpv > 0 && poreVolume[g] < minpv) {
+                    status[k] = MinpvInactive;
+                    numMinpvDeactivated++;
+                } else
+                    status[k] = Active;
+
+                m_actnum[g] = (status[k] == Active) ? 1 : 0;
+            }
+
+            if (!pinch.active)
+                continue;
+
+            // The runs of MINPV and pinched out cells between two active cells.
+            size_t upper = nz;
+            double gapThickness = 0;
+            for (size_t k = 0; k < nz; k++) {
+                if (status[k] == Active) {
+                    const bool bridged = (upper < nz) && (k > upper + 1);
+                    const bool thinEnough = pinch.gap ? (gapThickness <= pinch.maxEmptyGap) : (gapThickness < pinch.thresholdThickness);
+                    if (bridged && thinEnough)
+                        columnConnections[column].push_back( std::make_pair( column + upper*nx*ny , column + k*nx*ny ));
+
+                    upper = k;
+                    gapThickness = 0;
+                } else if (status[k] == InputInactive)
+                    upper = nz;
+                else
+                    gapThickness += thickness[k];
+            }
+        }
+
+        m_numMinpvDeactivated = numMinpvDeactivated;
+        m_numPinchedOut = numPinchedOut;
+        for (auto connections = columnConnections.begin(); connections != columnConnections.end(); ++connections)
+            m_pinchConnections.insert( m_pinchConnections.end() , connections->begin() , connections->end() );
+
+        std::sort( m_pinchConnections.begin() , m_pinchConnections.end() );
+    }
+
+
+    void MinpvProcessor::computePoreVolume(const CellGeometry& cellGeometry ,
+                                           const GridPropertyView<double>& poro ,
+                                           const GridPropertyView<double>& ntg ,
+                                           const GridPropertyView<double>& multpv ,
+                                           const GridPropertyView<double>* porv ,
+                                           std::vector<double>& poreVolume) {
+        const long numCells = static_cast<long>(cellGeometry.size());
+        if (poro.size() != cellGeometry.size() || ntg.size() != cellGeometry.size() || multpv.size() != cellGeometry.size())
+            throw std::invalid_argument("The size of PORO, NTG or MULTPV does not match the grid");
+
+        if (porv && porv->size() != cellGeometry.size())
+            throw std::invalid_argument("The size of PORV does not match the grid");
+
+        const double* volume = cellGeometry.getVolume().data();
+        poreVolume.resize( numCells );
+        double* target = poreVolume.data();
+
+#pragma omp parallel for schedule(static) if (cellGeometry.size() >= parallelThreshold)
+        for (long g = 0; g < numCells; g++) {
+            const double given = porv ? (*porv)[g] : std::nan("");
+            target[g] = (std::isnan( given ) ? volume[g] * poro[g] * ntg[g] : given) * multpv[g];
+        }
+    }
+
+
+    const std::vector<int>& MinpvProcessor::getACTNUM() const {
+        return m_actnum;
+    }
+
+
+    size_t MinpvProcessor::numMinpvDeactivated() const {
+        return m_numMinpvDeactivated;
+    }
+
+
+    size_t MinpvProcessor::numPinchedOut() const {
+        return m_numPinchedOut;
+    }
+
+
+    const std::vector< std::pair<size_t , size_t> >& MinpvProcessor::getPinchConnections() const {
+        return m_pinchConnections;
+    }
+}
@@ -0,0 +1,102 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MINPV_PROCESSOR_HPP_
+#define MINPV_PROCESSOR_HPP_
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <opm/parser/eclipse/EclipseState/Grid/CellGeometry.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/GridPropertyView.hpp>
+
+/*
+  The MinpvProcessor class applies MINPV and PINCH to the ACTNUM of a
+  grid, and finds the vertical pinch-out connections:
+
+    MINPV : cells with a pore volume below the MINPV value are made
+        inactive.
+
+    PINCH : cells thinner than the threshold thickness are made
+        inactive, i.e. pinched out. Two active cells in a column get a
+        pinch-out connection when all the cells between them were made
+        inactive by MINPV or PINCH; cells which are inactive in the
+        input ACTNUM end the run. With the GAP option the total
+        thickness of the inactive cells must not exceed the max empty
+        gap; with NOGAP it must be below the threshold thickness.
+
+  The thickness of a cell is the average over its four pillars of the
+  difference between the bottom and the top corner. The columns are
+  processed independently, in parallel with OpenMP.
+*/
+
+namespace Opm {
+
+    class MinpvProcessor {
+    public:
+        struct PinchOptions {
+            PinchOptions()
+                : active( false ),
+                  thresholdThickness( 0 ),
+                  gap( true ),
+                  maxEmptyGap( 1e20 )
+            { }
+
+            bool active;
+            double thresholdThickness;
+            bool gap;
+            double maxEmptyGap;
+        };
+
+        // minpv <= 0 disables MINPV; actnum may be empty, i.e. all the cells are active
+        MinpvProcessor(size_t nx , size_t ny , size_t nz ,
+                       const std::vector<double>& zcorn ,
+                       const std::vector<int>& actnum ,
+                       const std::vector<double>& poreVolume ,
+                       double minpv ,
+                       const PinchOptions& pinch);
+
+        const std::vector<int>& getACTNUM() const;
+        size_t numMinpvDeactivated() const;
+        size_t numPinchedOut() const;
+        // (upper cell , lower cell) global indices, in increasing order
+        const std::vector< std::pair<size_t , size_t> >& getPinchConnections() const;
+
+        /*
+          The pore volume of every cell: PORV where it is given, i.e.
+          not NaN, and the bulk volume times PORO and NTG otherwise;
+          both are multiplied with MULTPV. porv may be null.
+        */
+        static void computePoreVolume(const CellGeometry& cellGeometry ,
+                                      const GridPropertyView<double>& poro ,
+                                      const GridPropertyView<double>& ntg ,
+                                      const GridPropertyView<double>& multpv ,
+                                      const GridPropertyView<double>* porv ,
+                                      std::vector<double>& poreVolume);
+
+    private:
+        std::vector<int> m_actnum;
+        size_t m_numMinpvDeactivated;
+        size_t m_numPinchedOut;
+        std::vector< std::pair<size_t , size_t> > m_pinchConnections;
+    };
+}
+
+#endif
@@ -0,0 +1,299 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include <opm/parser/eclipse/EclipseState/Grid/NNC.hpp>
+#include <opm/parser/eclipse/EclipseState/Util/Parallel.hpp>
+
+namespace Opm {
+
+namespace {
+
+    struct Connection {
+        size_t cell1;
+        size_t cell2;
+        double area;
+    };
+
+    /*
+      The two cells of a column pair touch the shared pillars with the
+      corners (di , dj) of their own cell; pillarStep is the ZCORN step
+      from the first to the second shared pillar.
+    */
+    struct ColumnFace {
+        size_t zcornOffset;
+        size_t pillarStep;
+    };
+
+    // The depth interval of a cell face on the two shared pillars.
+    struct FaceInterval {
+        double top[2];
+        double bottom[2];
+    };
+
+    FaceInterval faceInterval(const double* zcorn , const ColumnFace& face , size_t k , size_t layerStride) {
+        const double* z = zcorn + face.zcornOffset + k*2*layerStride;
+        FaceInterval interval;
+        interval.top[0] = z[0];
+        interval.top[1] = z[face.pillarStep];
+        interval.bottom[0] = z[layerStride];
+        interval.bottom[1] = z[layerStride + face.pillarStep];
+        return interval;
+    }
+
+    double overlapHeight(const FaceInterval& a , const FaceInterval& b , double s) {
+        const double top = std::max( a.top[0] + s*(a.top[1] - a.top[0]) , b.top[0] + s*(b.top[1] - b.top[0]) );
+        const double bottom = std::min( a.bottom[0] + s*(a.bottom[1] - a.bottom[0]) , b.bottom[0] + s*(b.bottom[1] - b.bottom[0]) );
+        return std::max( 0.0 , bottom - top );
+    }
+
+    /*
+      The average over the face of the overlap in depth of the two
+      intervals. The overlap is linear between the points where two of
+      the four boundary lines cross, so the trapezoidal rule on those
+      points is exact.
+    */
+    double averageOverlap(const FaceInterval& a , const FaceInterval& b) {
+        const double lines[4][2] = {{ a.top[0] , a.top[1] } , { a.bottom[0] , a.bottom[1] } ,
+                                    { b.top[0] , b.top[1] } , { b.bottom[0] , b.bottom[1] }};
+        double points[8] = { 0 , 1 };
+        int numPoints = 2;
+        for (int l1 = 0; l1 < 4; l1++) {
+            for (int l2 = l1 + 1; l2 < 4; l2++) {
+                const double d0 = lines[l1][0] - lines[l2][0];
+                const double d1 = lines[l1][1] - lines[l2][1];
+                if ((d0 < 0 && d1 > 0) || (d0 > 0 && d1 < 0))
+                    points[numPoints++] = d0 / (d0 - d1);
+            }
+        }
+        std::sort( points , points + numPoints );
+
+        double average = 0;
+        double previousHeight = overlapHeight( a , b , points[0] );
+        for (int p = 1; p < numPoints; p++) {
+            const double height = overlapHeight( a , b , points[p] );
+            average += 0.5 * (points[p] - points[p - 1]) * (height + previousHeight);
+            previousHeight = height;
+        }
+        return average;
+    }
+
+    // The horizontal distance between two pillars at the given depth.
+    double pillarDistance(const double* pillar1 , const double* pillar2 , double z) {
+        double xy[2][2];
+        const double* pillars[2] = { pillar1 , pillar2 };
+        for (int p = 0; p < 2; p++) {
+            const double* pillar = pillars[p];
+            const double height = pillar[5] - pillar[2];
+            const double t = (height == 0) ? 0 : (z - pillar[2]) / height;
+            xy[p][0] = pillar[0] + t * (pillar[3] - pillar[0]);
+            xy[p][1] = pillar[1] + t * (pillar[4] - pillar[1]);
+        }
+        return std::sqrt( (xy[1][0] - xy[0][0])*(xy[1][0] - xy[0][0]) + (xy[1][1] - xy[0][1])*(xy[1][1] - xy[0][1]) );
+    }
+
+    /*
+      Sweeps down the columns A and B. The B cells entirely above the
+      current A cell are skipped for good, and the scan of B stops at
+      the first cell entirely below it.
+    */
+    void sweepColumns(size_t nz , size_t layerSize , size_t layerStride ,
+                      size_t columnA , size_t columnB ,
+                      const ColumnFace& faceA , const ColumnFace& faceB ,
+                      const double* zcorn , const double* pillar1 , const double* pillar2 ,
+                      const std::vector<int>& actnum , std::vector<Connection>& connections) {
+        size_t m0 = 0;
+        for (size_t k = 0; k < nz; k++) {
+            const FaceInterval a = faceInterval( zcorn , faceA , k , layerStride );
+            while (m0 < nz) {
+                const FaceInterval b = faceInterval( zcorn , faceB , m0 , layerStride );
+                if (b.bottom[0] <= a.top[0] && b.bottom[1] <= a.top[1])
+                    m0++;
+                else
+                    break;
+            }
+
+            const size_t cellA = columnA + k*layerSize;
+            if (!actnum.empty() && actnum[cellA] <= 0)
+                continue;
+
+            for (size_t m = m0; m < nz; m++) {
+                const FaceInterval b = faceInterval( zcorn , faceB , m , layerStride );
+                if (b.top[0] >= a.bottom[0] && b.top[1] >= a.bottom[1])
+                    break;
+
+                const size_t cellB = columnB + m*layerSize;
+                if (m == k || (!actnum.empty() && actnum[cellB] <= 0))
+                    continue;
+
+                const double overlap = averageOverlap( a , b );
+                if (overlap > 0) {
+                    const double depth = 0.25 * (a.top[0] + a.top[1] + a.bottom[0] + a.bottom[1]);
+                    Connection connection;
+                    connection.cell1 = std::min( cellA , cellB );
+                    connection.cell2 = std::max( cellA , cellB );
+                    connection.area = overlap * pillarDistance( pillar1 , pillar2 , depth );
+                    connections.push_back( connection );
+                }
+            }
+        }
+    }
+}
+
+
+    NNC::NNC(const EclipseGrid& grid) {
+        std::vector<int> actnum;
+        grid.exportACTNUM( actnum );
+        detect( grid.getNX() , grid.getNY() , grid.getNZ() , grid.getCOORD() , grid.getZCORN() , actnum );
+    }
+
+
+    NNC::NNC(size_t nx , size_t ny , size_t nz ,
+             const std::vector<double>& coord ,
+             const std::vector<double>& zcorn ,
+             const std::vector<int>& actnum) {
+        detect( nx , ny , nz , coord , zcorn , actnum );
+    }
+
+
+    void NNC::detect(size_t nx , size_t ny , size_t nz ,
+                     const std::vector<double>& coord ,
+                     const std::vector<double>& zcorn ,
+                     const std::vector<int>& actnum) {
+        m_cartesianSize = nx * ny * nz;
+        if (coord.size() != 6*(nx + 1)*(ny + 1) || zcorn.size() != 8*m_cartesianSize)
+            throw std::invalid_argument("The size of COORD or ZCORN does not match the grid dimensions");
+
+        if (!actnum.empty() && actnum.size() != m_cartesianSize)
+            throw std::invalid_argument("The size of ACTNUM does not match the grid dimensions");
+
+        if (m_cartesianSize > static_cast<size_t>(std::numeric_limits<int>::max()))
+            throw std::invalid_argument("The grid is too large for the NNC detection");
+
+        const size_t layerSize = nx * ny;
+        const size_t layerStride = 4 * layerSize;
+        const double* zcornData = zcorn.data();
+        std::vector< std::vector<Connection> > rowConnections( ny );
+
+        // Row j handles the column pairs (i,j)-(i+1,j) and (i,j)-(i,j+1).
+#pragma omp parallel for schedule(dynamic) if (m_cartesianSize >= parallelThreshold)
+        for (long j = 0; j < static_cast<long>(ny); j++) {
+            std::vector<Connection>& connections = rowConnections[j];
+            for (size_t i = 0; i < nx; i++) {
+                const size_t column = i + j*nx;
+                if (i + 1 < nx) {
+                    const ColumnFace faceA = { j*4*nx + 2*i + 1 , 2*nx };
+                    const ColumnFace faceB = { j*4*nx + 2*(i + 1) , 2*nx };
+                    const double* pillar1 = coord.data() + (j*(nx + 1) + i + 1)*6;
+                    const double* pillar2 = coord.data() + ((j + 1)*(nx + 1) + i + 1)*6;
+                    sweepColumns( nz , layerSize , layerStride , column , column + 1 , faceA , faceB ,
+                                  zcornData , pillar1 , pillar2 , actnum , connections );
+                }
+
+                if (static_cast<size_t>(j + 1) < ny) {
+                    const ColumnFace faceA = { j*4*nx + 2*nx + 2*i , 1 };
+                    const ColumnFace faceB = { (j + 1)*4*nx + 2*i , 1 };
+                    const double* pillar1 = coord.data() + ((j + 1)*(nx + 1) + i)*6;
+                    const double* pillar2 = coord.data() + ((j + 1)*(nx + 1) + i + 1)*6;
+                    sweepColumns( nz , layerSize , layerStride , column , column + nx , faceA , faceB ,
+                                  zcornData , pillar1 , pillar2 , actnum , connections );
+                }
+            }
+        }
+
+        m_rowStart.assign( m_cartesianSize + 1 , 0 );
+        for (auto row = rowConnections.begin(); row != rowConnections.end(); ++row)
+            for (auto connection = row->begin(); connection != row->end(); ++connection)
+                m_rowStart[connection->cell1 + 1]++;
+
+        for (size_t g = 0; g < m_cartesianSize; g++)
+            m_rowStart[g + 1] += m_rowStart[g];
+
+        const size_t numConnections = m_rowStart[m_cartesianSize];
+        std::vector<std::pair<int , double> > entries( numConnections );
+        {
+            std::vector<size_t> position( m_rowStart.begin() , m_rowStart.end() - 1 );
+            for (auto row = rowConnections.begin(); row != rowConnections.end(); ++row)
+                for (auto connection = row->begin(); connection != row->end(); ++connection)
+                    entries[position[connection->cell1]++] = std::make_pair( static_cast<int>(connection->cell2) , connection->area );
+        }
+
+        for (size_t g = 0; g < m_cartesianSize; g++) {
+            if (m_rowStart[g + 1] - m_rowStart[g] > 1)
+                std::sort( entries.begin() + m_rowStart[g] , entries.begin() + m_rowStart[g + 1] );
+        }
+
+        m_cell2.resize( numConnections );
+        m_area.resize( numConnections );
+        for (size_t n = 0; n < numConnections; n++) {
+            m_cell2[n] = entries[n].first;
+            m_area[n] = entries[n].second;
+        }
+        m_multipliers.assign( numConnections , 1.0 );
+    }
+
+
+    size_t NNC::size() const {
+        return m_cell2.size();
+    }
+
+
+    size_t NNC::getCartesianSize() const {
+        return m_cartesianSize;
+    }
+
+
+    const std::vector<size_t>& NNC::getRowStart() const {
+        return m_rowStart;
+    }
+
+
+    const std::vector<int>& NNC::getCell2() const {
+        return m_cell2;
+    }
+
+
+    const std::vector<double>& NNC::getArea() const {
+        return m_area;
+    }
+
+
+    const std::vector<double>& NNC::getMultipliers() const {
+        return m_multipliers;
+    }
+
+
+    void NNC::exportConnections(std::vector< std::pair<size_t , size_t> >& connections) const {
+        connections.resize( size() );
+        for (size_t cell1 = 0; cell1 < m_cartesianSize; cell1++)
+            for (size_t n = m_rowStart[cell1]; n < m_rowStart[cell1 + 1]; n++)
+                connections[n] = std::make_pair( cell1 , static_cast<size_t>(m_cell2[n]) );
+    }
+
+
+    void NNC::applyMULTREGT(std::shared_ptr<MULTREGTScanner> multregtScanner , std::shared_ptr<GridProperties<int> > regions) {
+        std::vector< std::pair<size_t , size_t> > connections;
+        exportConnections( connections );
+        multregtScanner->scanNNC( regions , connections , m_multipliers );
+    }
+}
@@ -0,0 +1,94 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef NNC_HPP_
+#define NNC_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <opm/parser/eclipse/EclipseState/Grid/EclipseGrid.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/GridProperties.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/MULTREGTScanner.hpp>
+
+/*
+  The NNC class holds the non-neighbour connections created by the
+  faults of a corner point grid, i.e. the connections between active
+  cells in neighbouring pillar columns whose faces overlap although the
+  cells are in different layers.
+
+  The faces between two neighbouring columns are compared with a merge
+  sweep down the columns; the layers of a column are assumed to be
+  ordered in depth, as required by ECLIPSE. The overlap of two faces is
+  measured in depth along the two shared pillars, integrated exactly
+  over the face, and multiplied with the horizontal distance between
+  the pillars. The detection is parallelized over the pillar rows with
+  OpenMP.
+
+  The connections are stored in compressed sparse row form: the
+  connections of cell1 are [getRowStart()[cell1], getRowStart()[cell1 +
+  1]), cell1 is always smaller than cell2 and the connections of a cell
+  are sorted on cell2. Cell indices are global indices.
+*/
+
+namespace Opm {
+
+    class NNC {
+    public:
+        explicit NNC(const EclipseGrid& grid);
+
+        // actnum may be empty, i.e. all the cells are active
+        NNC(size_t nx , size_t ny , size_t nz ,
+            const std::vector<double>& coord ,
+            const std::vector<double>& zcorn ,
+            const std::vector<int>& actnum);
+
+        size_t size() const;
+        size_t getCartesianSize() const;
+
+        const std::vector<size_t>& getRowStart() const;
+        const std::vector<int>& getCell2() const;
+        const std::vector<double>& getArea() const;
+        void exportConnections(std::vector< std::pair<size_t , size_t> >& connections) const;
+
+        /*
+          The MULTREGT multipliers of the connections; the records with
+          the NNC behaviour NONNC do not apply. All the multipliers are
+          1 until applyMULTREGT() is called.
+        */
+        const std::vector<double>& getMultipliers() const;
+        void applyMULTREGT(std::shared_ptr<MULTREGTScanner> multregtScanner , std::shared_ptr<GridProperties<int> > regions);
+
+    private:
+        void detect(size_t nx , size_t ny , size_t nz ,
+                    const std::vector<double>& coord ,
+                    const std::vector<double>& zcorn ,
+                    const std::vector<int>& actnum);
+
+        size_t m_cartesianSize;
+        std::vector<size_t> m_rowStart;
+        std::vector<int> m_cell2;
+        std::vector<double> m_area;
+        std::vector<double> m_multipliers;
+    };
+}
+
+#endif
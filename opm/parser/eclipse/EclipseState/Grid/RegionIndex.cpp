@@ -0,0 +1,212 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include <opm/parser/eclipse/EclipseState/Grid/RegionIndex.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/RegionSlotMap.hpp>
+#include <opm/parser/eclipse/EclipseState/Util/Parallel.hpp>
+
+namespace Opm {
+
+namespace {
+
+    const size_t maxBlocks = 64;
+
+    struct Bounds {
+        int lower[3];
+        int upper[3];
+    };
+}
+
+
+    RegionIndex::RegionIndex(size_t nx , size_t ny , size_t nz , const GridPropertyView<int>& regions)
+        : m_nx( nx ),
+          m_ny( ny ),
+          m_nz( nz ),
+          m_rowStart( 1 , 0 )
+    {
+        const size_t size = nx*ny*nz;
+        if (regions.size() != size)
+            throw std::invalid_argument("The region property does not match the grid dimensions");
+
+        if (size == 0)
+            return;
+
+        const Box globalBox( static_cast<int>(nx) , static_cast<int>(ny) , static_cast<int>(nz) );
+        if (regions.isConstant()) {
+            m_regions.push_back( regions.getConstantValue() );
+            m_rowStart.push_back( size );
+            m_cells.resize( size );
+            for (size_t g = 0; g < size; g++)
+                m_cells[g] = static_cast<int>(g);
+
+            m_boundingBoxes.push_back( globalBox );
+            return;
+        }
+
+        const RegionSlotMap slotMap( regions , size );
+        const size_t numSlots = slotMap.numSlots();
+
+        // The per block counts and bounds take numBlocks * numSlots
+        // entries; the number of blocks is limited to keep that below a
+        // quarter of the size of the grid.
+        size_t numBlocks = std::min( maxBlocks , (size + parallelThreshold - 1) / parallelThreshold );
+        numBlocks = std::max( static_cast<size_t>(1) , std::min( numBlocks , size / (4 * numSlots) ));
+
+        Bounds emptyBounds;
+        for (size_t d = 0; d < 3; d++) {
+            emptyBounds.lower[d] = std::numeric_limits<int>::max();
+            emptyBounds.upper[d] = -1;
+        }
+
+        std::vector<size_t> counts( numBlocks * numSlots , 0 );
+        std::vector<Bounds> bounds( numBlocks * numSlots , emptyBounds );
+
+#pragma omp parallel for schedule(static) if (numBlocks > 1)
+        for (long b = 0; b < static_cast<long>(numBlocks); b++) {
+            const size_t begin = size * b / numBlocks;
+            const size_t end = size * (b + 1) / numBlocks;
+            size_t* blockCounts = &counts[b * numSlots];
+            Bounds* blockBounds = &bounds[b * numSlots];
+
+            int ijk[3] = { static_cast<int>(begin % nx) , static_cast<int>((begin / nx) % ny) , static_cast<int>(begin / (nx*ny)) };
+            for (size_t g = begin; g < end; g++) {
+                const size_t slot = slotMap.slot( regions[g] );
+                Bounds& cellBounds = blockBounds[slot];
+                blockCounts[slot]++;
+                for (size_t d = 0; d < 3; d++) {
+                    cellBounds.lower[d] = std::min( cellBounds.lower[d] , ijk[d] );
+                    cellBounds.upper[d] = std::max( cellBounds.upper[d] , ijk[d] );
+                }
+
+                if (++ijk[0] == static_cast<int>(nx)) {
+                    ijk[0] = 0;
+                    if (++ijk[1] == static_cast<int>(ny)) {
+                        ijk[1] = 0;
+                        ++ijk[2];
+                    }
+                }
+            }
+        }
+
+        // Merge the blocks; the counts are turned into the position of
+        // the first cell of every block in the cell list.
+        for (size_t slot = 0; slot < numSlots; slot++) {
+            Bounds regionBounds = emptyBounds;
+            size_t offset = m_rowStart.back();
+            for (size_t b = 0; b < numBlocks; b++) {
+                const Bounds& blockBounds = bounds[b * numSlots + slot];
+                const size_t count = counts[b * numSlots + slot];
+                counts[b * numSlots + slot] = offset;
+                offset += count;
+
+                for (size_t d = 0; d < 3; d++) {
+                    regionBounds.lower[d] = std::min( regionBounds.lower[d] , blockBounds.lower[d] );
+                    regionBounds.upper[d] = std::max( regionBounds.upper[d] , blockBounds.upper[d] );
+                }
+            }
+
+            if (offset > m_rowStart.back()) {
+                m_regions.push_back( slotMap.value( slot ));
+                m_rowStart.push_back( offset );
+                m_boundingBoxes.push_back( Box( globalBox ,
+                                                regionBounds.lower[0] , regionBounds.upper[0] ,
+                                                regionBounds.lower[1] , regionBounds.upper[1] ,
+                                                regionBounds.lower[2] , regionBounds.upper[2] ));
+            }
+        }
+
+        m_cells.resize( size );
+#pragma omp parallel for schedule(static) if (numBlocks > 1)
+        for (long b = 0; b < static_cast<long>(numBlocks); b++) {
+            const size_t begin = size * b / numBlocks;
+            const size_t end = size * (b + 1) / numBlocks;
+            size_t* blockOffsets = &counts[b * numSlots];
+
+            for (size_t g = begin; g < end; g++)
+                m_cells[ blockOffsets[ slotMap.slot( regions[g] ) ]++ ] = static_cast<int>(g);
+        }
+    }
+
+
+    size_t RegionIndex::getCartesianSize() const {
+        return m_nx * m_ny * m_nz;
+    }
+
+
+    size_t RegionIndex::numRegions() const {
+        return m_regions.size();
+    }
+
+
+    const std::vector<int>& RegionIndex::getRegions() const {
+        return m_regions;
+    }
+
+
+    size_t RegionIndex::position(int region) const {
+        auto iter = std::lower_bound( m_regions.begin() , m_regions.end() , region );
+        if (iter != m_regions.end() && *iter == region)
+            return iter - m_regions.begin();
+        else
+            return m_regions.size();
+    }
+
+
+    bool RegionIndex::hasRegion(int region) const {
+        return position( region ) < m_regions.size();
+    }
+
+
+    size_t RegionIndex::numCells(int region) const {
+        const std::pair<size_t , size_t> range = getCellRange( region );
+        return range.second - range.first;
+    }
+
+
+    std::pair<size_t , size_t> RegionIndex::getCellRange(int region) const {
+        const size_t pos = position( region );
+        if (pos == m_regions.size())
+            return std::make_pair( static_cast<size_t>(0) , static_cast<size_t>(0) );
+        else
+            return std::make_pair( m_rowStart[pos] , m_rowStart[pos + 1] );
+    }
+
+
+    const std::vector<size_t>& RegionIndex::getRowStart() const {
+        return m_rowStart;
+    }
+
+
+    const std::vector<int>& RegionIndex::getCells() const {
+        return m_cells;
+    }
+
+
+    const Box& RegionIndex::getBoundingBox(int region) const {
+        const size_t pos = position( region );
+        if (pos == m_regions.size())
+            throw std::invalid_argument("The region is not present in the region property");
+
+        return m_boundingBoxes[pos];
+    }
+}
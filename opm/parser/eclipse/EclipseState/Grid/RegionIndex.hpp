@@ -0,0 +1,82 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef REGION_INDEX_HPP_
+#define REGION_INDEX_HPP_
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <opm/parser/eclipse/EclipseState/Grid/Box.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/GridPropertyView.hpp>
+
+/*
+  The RegionIndex class is an inverted index of a region property like
+  SATNUM, FIPNUM or MULTNUM: for every region value found in the
+  property it holds the list of cells with that value, the number of
+  cells and the bounding box of the cells.
+
+  The cell lists are stored in compressed sparse row form: the cells of
+  the n'th region of getRegions() are [getRowStart()[n],
+  getRowStart()[n + 1]) of getCells(), in increasing global index. The
+  index is built with a parallel counting sort over blocks of cells; the
+  blocks are counted and filled with OpenMP, and the result does not
+  depend on the number of threads.
+
+  Use GridProperties<int>::getRegionIndex() to get a cached index which
+  is rebuilt when the property is modified.
+*/
+
+namespace Opm {
+
+    class RegionIndex {
+    public:
+        RegionIndex(size_t nx , size_t ny , size_t nz , const GridPropertyView<int>& regions);
+
+        size_t getCartesianSize() const;
+        size_t numRegions() const;
+
+        // the distinct region values, increasing
+        const std::vector<int>& getRegions() const;
+        bool hasRegion(int region) const;
+
+        // 0 and an empty range for a region which is not present
+        size_t numCells(int region) const;
+        std::pair<size_t , size_t> getCellRange(int region) const;
+
+        const std::vector<size_t>& getRowStart() const;
+        const std::vector<int>& getCells() const;
+
+        // the smallest box containing all the cells of the region
+        const Box& getBoundingBox(int region) const;
+
+    private:
+        // the position of the region in m_regions; numRegions() if not present
+        size_t position(int region) const;
+
+        size_t m_nx, m_ny, m_nz;
+        std::vector<int> m_regions;
+        std::vector<size_t> m_rowStart;
+        std::vector<int> m_cells;
+        std::vector<Box> m_boundingBoxes;
+    };
+}
+
+#endif
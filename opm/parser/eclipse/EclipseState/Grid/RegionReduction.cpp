@@ -0,0 +1,230 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+#include <opm/parser/eclipse/EclipseState/Grid/RegionReduction.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/RegionSlotMap.hpp>
+#include <opm/parser/eclipse/EclipseState/Util/Parallel.hpp>
+
+namespace Opm {
+
+namespace {
+
+    const size_t maxBlocks = 64;
+
+    struct Partial {
+        size_t count;
+        double sum;
+        double min;
+        double max;
+        double weightSum;
+        double weightedSum;
+    };
+
+
+    /*
+      Accumulates the cells [begin, end) into the partial histogram of
+      a block. The region, value and weight arrays are either views or
+      - when the storage is a full vector - plain pointers, which keeps
+      the storage dispatch of the views out of the inner loop.
+    */
+    template <bool Weighted , class Regions , class Values>
+    void accumulate(const Regions& regions , const Values& values , const Values& weights , const int* actnum ,
+                    const RegionSlotMap& slotMap , size_t begin , size_t end , Partial* partials) {
+        for (size_t g = begin; g < end; g++) {
+            if (actnum && !actnum[g])
+                continue;
+
+            const double value = values[g];
+            Partial& partial = partials[ slotMap.slot( regions[g] ) ];
+            partial.count++;
+            partial.sum += value;
+            partial.min = std::min( partial.min , value );
+            partial.max = std::max( partial.max , value );
+            if (Weighted) {
+                const double weight = weights[g];
+                partial.weightSum += weight;
+                partial.weightedSum += weight * value;
+            }
+        }
+    }
+}
+
+
+    RegionReduction::RegionReduction(const GridPropertyView<int>& regions ,
+                                     const GridPropertyView<double>& values ,
+                                     const GridPropertyView<double>* weights ,
+                                     const std::vector<int>& actnum)
+    {
+        reduce( regions , values , weights , actnum );
+    }
+
+
+    RegionReduction::RegionReduction(const GridProperty<int>& regions ,
+                                     const GridProperty<double>& values ,
+                                     const GridProperty<double>* weights ,
+                                     const std::vector<int>& actnum)
+    {
+        std::unique_ptr<GridPropertyView<double> > weightView;
+        if (weights)
+            weightView.reset( new GridPropertyView<double>( weights->getView() ));
+
+        reduce( regions.getView() , values.getView() , weightView.get() , actnum );
+    }
+
+
+    void RegionReduction::reduce(const GridPropertyView<int>& regions ,
+                                 const GridPropertyView<double>& values ,
+                                 const GridPropertyView<double>* weights ,
+                                 const std::vector<int>& actnum) {
+        const size_t size = regions.size();
+        if (values.size() != size || (weights && weights->size() != size))
+            throw std::invalid_argument("The values and weights must have the same size as the region property");
+
+        if (!actnum.empty() && actnum.size() != size)
+            throw std::invalid_argument("The ACTNUM vector must have the same size as the region property");
+
+        m_hasWeights = (weights != nullptr);
+        if (size == 0)
+            return;
+
+        const RegionSlotMap slotMap( regions , size );
+        const size_t numSlots = slotMap.numSlots();
+
+        // The partial histograms take numBlocks * numSlots entries; the
+        // number of blocks is limited to keep that below a quarter of
+        // the size of the grid.
+        size_t numBlocks = std::min( maxBlocks , (size + parallelThreshold - 1) / parallelThreshold );
+        numBlocks = std::max( static_cast<size_t>(1) , std::min( numBlocks , size / (4 * numSlots) ));
+
+        const Partial emptyPartial = { 0 , 0 , std::numeric_limits<double>::max() , -std::numeric_limits<double>::max() , 0 , 0 };
+        std::vector<Partial> partials( numBlocks * numSlots , emptyPartial );
+        const int* actnumData = actnum.empty() ? nullptr : actnum.data();
+        const bool dense = regions.data() && values.data() && (!weights || weights->data());
+
+#pragma omp parallel for schedule(static) if (numBlocks > 1)
+        for (long b = 0; b < static_cast<long>(numBlocks); b++) {
+            const size_t begin = size * b / numBlocks;
+            const size_t end = size * (b + 1) / numBlocks;
+            Partial* blockPartials = &partials[b * numSlots];
+
+            if (dense) {
+                if (weights)
+                    accumulate<true>( regions.data() , values.data() , weights->data() , actnumData , slotMap , begin , end , blockPartials );
+                else
+                    accumulate<false>( regions.data() , values.data() , values.data() , actnumData , slotMap , begin , end , blockPartials );
+            } else {
+                if (weights)
+                    accumulate<true>( regions , values , *weights , actnumData , slotMap , begin , end , blockPartials );
+                else
+                    accumulate<false>( regions , values , values , actnumData , slotMap , begin , end , blockPartials );
+            }
+        }
+
+        for (size_t slot = 0; slot < numSlots; slot++) {
+            Partial total = emptyPartial;
+            for (size_t b = 0; b < numBlocks; b++) {
+                const Partial& partial = partials[b * numSlots + slot];
+                total.count += partial.count;
+                total.sum += partial.sum;
+                total.min = std::min( total.min , partial.min );
+                total.max = std::max( total.max , partial.max );
+                total.weightSum += partial.weightSum;
+                total.weightedSum += partial.weightedSum;
+            }
+
+            if (total.count > 0) {
+                m_regions.push_back( slotMap.value( slot ));
+                m_count.push_back( total.count );
+                m_sum.push_back( total.sum );
+                m_min.push_back( total.min );
+                m_max.push_back( total.max );
+                m_weightSum.push_back( total.weightSum );
+                m_weightedSum.push_back( total.weightedSum );
+            }
+        }
+    }
+
+
+    size_t RegionReduction::numRegions() const {
+        return m_regions.size();
+    }
+
+
+    const std::vector<int>& RegionReduction::getRegions() const {
+        return m_regions;
+    }
+
+
+    bool RegionReduction::hasRegion(int region) const {
+        auto iter = std::lower_bound( m_regions.begin() , m_regions.end() , region );
+        return iter != m_regions.end() && *iter == region;
+    }
+
+
+    size_t RegionReduction::position(int region) const {
+        if (!hasRegion( region ))
+            throw std::invalid_argument("The region has no cells in the reduction");
+
+        return std::lower_bound( m_regions.begin() , m_regions.end() , region ) - m_regions.begin();
+    }
+
+
+    size_t RegionReduction::getCount(int region) const {
+        return m_count[position( region )];
+    }
+
+
+    double RegionReduction::getSum(int region) const {
+        return m_sum[position( region )];
+    }
+
+
+    double RegionReduction::getMin(int region) const {
+        return m_min[position( region )];
+    }
+
+
+    double RegionReduction::getMax(int region) const {
+        return m_max[position( region )];
+    }
+
+
+    double RegionReduction::getMean(int region) const {
+        const size_t pos = position( region );
+        return m_sum[pos] / m_count[pos];
+    }
+
+
+    double RegionReduction::getWeightSum(int region) const {
+        const size_t pos = position( region );
+        return m_hasWeights ? m_weightSum[pos] : std::nan("");
+    }
+
+
+    double RegionReduction::getWeightedMean(int region) const {
+        const size_t pos = position( region );
+        return m_hasWeights ? m_weightedSum[pos] / m_weightSum[pos] : std::nan("");
+    }
+}
@@ -0,0 +1,93 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef REGION_REDUCTION_HPP_
+#define REGION_REDUCTION_HPP_
+
+#include <cstddef>
+#include <vector>
+
+#include <opm/parser/eclipse/EclipseState/Grid/GridProperty.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/GridPropertyView.hpp>
+
+/*
+  The RegionReduction class computes per region statistics of a double
+  property, grouped by the values of an integer region property like
+  FIPNUM, EQLNUM or SATNUM: the number of cells, the sum, minimum,
+  maximum and mean of the values and - if weights are given - the
+  weighted mean sum(w*v) / sum(w).
+
+  The cells are reduced in blocks with OpenMP; every block accumulates
+  a partial histogram over the regions, and the partial histograms are
+  merged in block order. The number of blocks only depends on the size
+  of the grid and the number of regions, i.e. the results do not depend
+  on the number of threads.
+
+  Only the regions with at least one included cell are present.
+*/
+
+namespace Opm {
+
+    class RegionReduction {
+    public:
+        // weights may be null; actnum may be empty, i.e. all the cells are included
+        RegionReduction(const GridPropertyView<int>& regions ,
+                        const GridPropertyView<double>& values ,
+                        const GridPropertyView<double>* weights ,
+                        const std::vector<int>& actnum);
+
+        RegionReduction(const GridProperty<int>& regions ,
+                        const GridProperty<double>& values ,
+                        const GridProperty<double>* weights ,
+                        const std::vector<int>& actnum);
+
+        size_t numRegions() const;
+        // the region values, increasing
+        const std::vector<int>& getRegions() const;
+        bool hasRegion(int region) const;
+
+        size_t getCount(int region) const;
+        double getSum(int region) const;
+        double getMin(int region) const;
+        double getMax(int region) const;
+        double getMean(int region) const;
+
+        // the sum of the weights, and the weighted mean; NaN if no weights were given
+        double getWeightSum(int region) const;
+        double getWeightedMean(int region) const;
+
+    private:
+        void reduce(const GridPropertyView<int>& regions ,
+                    const GridPropertyView<double>& values ,
+                    const GridPropertyView<double>* weights ,
+                    const std::vector<int>& actnum);
+        size_t position(int region) const;
+
+        bool m_hasWeights;
+        std::vector<int> m_regions;
+        std::vector<size_t> m_count;
+        std::vector<double> m_sum;
+        std::vector<double> m_min;
+        std::vector<double> m_max;
+        std::vector<double> m_weightSum;
+        std::vector<double> m_weightedSum;
+    };
+}
+
+#endif
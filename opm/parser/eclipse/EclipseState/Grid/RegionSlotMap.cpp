@@ -0,0 +1,51 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <limits>
+
+#include <opm/parser/eclipse/EclipseState/Grid/RegionSlotMap.hpp>
+#include <opm/parser/eclipse/EclipseState/Util/Parallel.hpp>
+
+namespace Opm {
+
+    RegionSlotMap::RegionSlotMap(const GridPropertyView<int>& regions , size_t size) {
+        int minValue = std::numeric_limits<int>::max();
+        int maxValue = std::numeric_limits<int>::min();
+
+#pragma omp parallel for schedule(static) reduction(min:minValue) reduction(max:maxValue) if (size >= parallelThreshold)
+        for (long g = 0; g < static_cast<long>(size); g++) {
+            minValue = std::min( minValue , regions[g] );
+            maxValue = std::max( maxValue , regions[g] );
+        }
+
+        m_minValue = minValue;
+        const size_t range = static_cast<size_t>(static_cast<long>(maxValue) - static_cast<long>(minValue)) + 1;
+        if (range <= size)
+            m_numSlots = range;
+        else {
+            m_values.resize( size );
+            for (size_t g = 0; g < size; g++)
+                m_values[g] = regions[g];
+
+            std::sort( m_values.begin() , m_values.end() );
+            m_values.erase( std::unique( m_values.begin() , m_values.end() ) , m_values.end() );
+            m_numSlots = m_values.size();
+        }
+    }
+}
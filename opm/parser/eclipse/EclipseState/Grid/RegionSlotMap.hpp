@@ -0,0 +1,69 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef REGION_SLOT_MAP_HPP_
+#define REGION_SLOT_MAP_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include <opm/parser/eclipse/EclipseState/Grid/GridPropertyView.hpp>
+
+/*
+  Maps the values of a region property to slots [0, numSlots()), for
+  the per region histograms of RegionIndex and RegionReduction. When
+  the values span at most as many integers as there are cells the slot
+  is the offset from the smallest value, otherwise the slot is the
+  position in the sorted list of distinct values. Slots may be empty,
+  i.e. not correspond to any cell.
+*/
+
+namespace Opm {
+
+    class RegionSlotMap {
+    public:
+        RegionSlotMap(const GridPropertyView<int>& regions , size_t size);
+
+        size_t numSlots() const {
+            return m_numSlots;
+        }
+
+        size_t slot(int value) const {
+            if (m_values.empty())
+                return static_cast<size_t>(static_cast<long>(value) - static_cast<long>(m_minValue));
+            else
+                return std::lower_bound( m_values.begin() , m_values.end() , value ) - m_values.begin();
+        }
+
+        int value(size_t slot) const {
+            if (m_values.empty())
+                return static_cast<int>(static_cast<long>(m_minValue) + static_cast<long>(slot));
+            else
+                return m_values[slot];
+        }
+
+    private:
+        int m_minValue;
+        size_t m_numSlots;
+        std::vector<int> m_values;
+    };
+}
+
+#endif
@@ -20,20 +20,39 @@
 #include <iostream>
 
 #include <opm/parser/eclipse/EclipseState/Grid/TransMult.hpp>
+#include <opm/parser/eclipse/EclipseState/Util/Parallel.hpp>
 
 namespace Opm {
 
+namespace {
+
+    const char * directionNames[6] = {"MULTX" , "MULTX-" , "MULTY" , "MULTY-" , "MULTZ" , "MULTZ-"};
+}
+
     TransMult::TransMult(size_t nx , size_t ny , size_t nz) :
         m_nx(nx),
         m_ny(ny),
-        m_nz(nz) 
+        m_nz(nz),
+        m_trans{{ FaceMultiplierStore(nx*ny*nz) , FaceMultiplierStore(nx*ny*nz) ,
+                  FaceMultiplierStore(nx*ny*nz) , FaceMultiplierStore(nx*ny*nz) ,
+                  FaceMultiplierStore(nx*ny*nz) , FaceMultiplierStore(nx*ny*nz) }},
+        m_hasProperty{{ false , false , false , false , false , false }},
+        m_propertyRevision{{ 0 , 0 , 0 , 0 , 0 , 0 }},
+        m_syncMutex( std::make_shared<std::mutex>() )
+    {
+    }
+
+
+    TransMult::TransMult(const TransMult& other) :
+        m_nx(other.m_nx),
+        m_ny(other.m_ny),
+        m_nz(other.m_nz),
+        m_trans{{ other.syncStore(0) , other.syncStore(1) , other.syncStore(2) ,
+                  other.syncStore(3) , other.syncStore(4) , other.syncStore(5) }},
+        m_hasProperty(other.m_hasProperty),
+        m_propertyRevision{{ 0 , 0 , 0 , 0 , 0 , 0 }},
+        m_syncMutex( std::make_shared<std::mutex>() )
     {
-        m_names[FaceDir::XPlus]  = "MULTX";
-        m_names[FaceDir::YPlus]  = "MULTY";
-        m_names[FaceDir::ZPlus]  = "MULTZ";
-        m_names[FaceDir::XMinus] = "MULTX-";
-        m_names[FaceDir::YMinus] = "MULTY-";
-        m_names[FaceDir::ZMinus] = "MULTZ-";
     }
     
 
@@ -50,6 +69,26 @@ namespace Opm {
     }
 
 
+    size_t TransMult::directionIndex(FaceDir::DirEnum faceDir) {
+        switch (faceDir) {
+        case FaceDir::XPlus:
+            return 0;
+        case FaceDir::XMinus:
+            return 1;
+        case FaceDir::YPlus:
+            return 2;
+        case FaceDir::YMinus:
+            return 3;
+        case FaceDir::ZPlus:
+            return 4;
+        case FaceDir::ZMinus:
+            return 5;
+        default:
+            throw std::invalid_argument("Invalid face direction");
+        }
+    }
+
+
     double TransMult::getMultiplier(size_t globalIndex,  FaceDir::DirEnum faceDir) const {
         if (globalIndex < m_nx * m_ny * m_nz)
             return getMultiplier__(globalIndex , faceDir);
@@ -58,11 +97,7 @@ namespace Opm {
     }
 
     double TransMult::getMultiplier__(size_t globalIndex,  FaceDir::DirEnum faceDir) const {
-        if (hasDirectionProperty( faceDir )) {
-            std::shared_ptr<const GridProperty<double> > property = m_trans.at(faceDir);
-            return property->iget( globalIndex );
-        } else
-            return 1.0;
+        return syncStore( directionIndex( faceDir ) ).get( globalIndex );
     }
     
     
@@ -73,55 +108,228 @@ namespace Opm {
         return getMultiplier__( globalIndex , faceDir );
     }
 
-    
-    bool TransMult::hasDirectionProperty(FaceDir::DirEnum faceDir) const {
-        if (m_trans.count(faceDir) == 1)
-            return true;
-        else
-            return false;
+
+    void TransMult::getMultipliers(const std::vector<size_t>& globalIndices , FaceDir::DirEnum faceDir , std::vector<double>& multipliers) const {
+        const size_t cartesianSize = m_nx * m_ny * m_nz;
+        for (auto iter = globalIndices.begin(); iter != globalIndices.end(); ++iter) {
+            if (*iter >= cartesianSize)
+                throw std::invalid_argument("Invalid global index");
+        }
+
+        multipliers.resize( globalIndices.size() );
+        getDirectionStore( faceDir ).get( globalIndices.data() , globalIndices.size() , multipliers.data() );
     }
 
-    void TransMult::insertNewProperty(FaceDir::DirEnum faceDir) {
-        GridPropertySupportedKeywordInfo<double> kwInfo(m_names[faceDir] , 1.0 , "1");
-        std::shared_ptr<GridProperty<double> > property = std::make_shared<GridProperty<double> >( m_nx , m_ny , m_nz , kwInfo );
-        std::pair<FaceDir::DirEnum , std::shared_ptr<GridProperty<double> > > pair(faceDir , property); 
-        
-        m_trans.insert( pair );
+
+    /*
+      The faces are grouped on direction, so that each direction store
+      is queried once.
+    */
+    void TransMult::getMultipliers(const std::vector< std::pair<size_t , FaceDir::DirEnum> >& faces , std::vector<double>& multipliers) const {
+        const size_t cartesianSize = m_nx * m_ny * m_nz;
+        std::array<std::vector<size_t> , 6> positions;
+        std::array<std::vector<size_t> , 6> globalIndices;
+        for (size_t faceIdx = 0; faceIdx < faces.size(); faceIdx++) {
+            if (faces[faceIdx].first >= cartesianSize)
+                throw std::invalid_argument("Invalid global index");
+
+            const size_t dirIdx = directionIndex( faces[faceIdx].second );
+            if (!syncStore( dirIdx ).isDefault()) {
+                positions[dirIdx].push_back( faceIdx );
+                globalIndices[dirIdx].push_back( faces[faceIdx].first );
+            }
+        }
+
+        multipliers.assign( faces.size() , 1.0 );
+        std::vector<double> dirMultipliers;
+        for (size_t dirIdx = 0; dirIdx < 6; dirIdx++) {
+            dirMultipliers.resize( globalIndices[dirIdx].size() );
+            m_trans[dirIdx].get( globalIndices[dirIdx].data() , globalIndices[dirIdx].size() , dirMultipliers.data() );
+            for (size_t i = 0; i < positions[dirIdx].size(); i++)
+                multipliers[ positions[dirIdx][i] ] = dirMultipliers[i];
+        }
+    }
+
+
+    void TransMult::getMultipliers(FaceDir::DirEnum faceDir , std::vector<double>& multipliers) const {
+        multipliers.resize( m_nx * m_ny * m_nz );
+        getDirectionStore( faceDir ).exportAll( multipliers.data() );
     }
 
     
+    bool TransMult::hasDirectionProperty(FaceDir::DirEnum faceDir) const {
+        return m_hasProperty[ directionIndex( faceDir ) ];
+    }
+
+
     std::shared_ptr<GridProperty<double> > TransMult::getDirectionProperty(FaceDir::DirEnum faceDir) {
-        if (m_trans.count(faceDir) == 0) 
-            insertNewProperty(faceDir);
-        
-        return m_trans.at( faceDir );
+        const size_t dirIdx = directionIndex( faceDir );
+        if (!m_properties[dirIdx]) {
+            std::shared_ptr<GridProperty<double> > property = std::const_pointer_cast<GridProperty<double> >( copyDirectionProperty( faceDir ));
+            m_properties[dirIdx] = property;
+            m_propertyRevision[dirIdx] = property->getRevision();
+            m_hasProperty[dirIdx] = true;
+        }
+        return m_properties[dirIdx];
     }
 
+
+    std::shared_ptr<const GridProperty<double> > TransMult::copyDirectionProperty(FaceDir::DirEnum faceDir) const {
+        const size_t dirIdx = directionIndex( faceDir );
+        const FaceMultiplierStore& store = syncStore( dirIdx );
+        if (store.isDefault()) {
+            GridPropertySupportedKeywordInfo<double> kwInfo( directionNames[dirIdx] , 1.0 , "1");
+            return std::make_shared<GridProperty<double> >( m_nx , m_ny , m_nz , kwInfo );
+        }
+
+        auto multipliers = std::make_shared<std::vector<double> >( store.size() );
+        store.exportAll( multipliers->data() );
+        std::shared_ptr<const GridPropertyBaseInitializer<double> > initializer = std::make_shared<GridPropertyVectorInitializer<double> >( multipliers );
+        GridPropertySupportedKeywordInfo<double> kwInfo( directionNames[dirIdx] , initializer , "1");
+        return std::make_shared<GridProperty<double> >( m_nx , m_ny , m_nz , kwInfo );
+    }
+
+
+    const FaceMultiplierStore& TransMult::getDirectionStore(FaceDir::DirEnum faceDir) const {
+        return syncStore( directionIndex( faceDir ));
+    }
+
+
+    /*
+      The store of a direction with a property is rebuilt when the
+      property has been modified through the pointer returned by
+      getDirectionProperty(). The returned reference is valid until
+      the property is modified again, which must not happen while
+      another thread holds it.
+    */
+    const FaceMultiplierStore& TransMult::syncStore(size_t dirIdx) const {
+        const std::shared_ptr<GridProperty<double> >& property = m_properties[dirIdx];
+        if (property) {
+            std::lock_guard<std::mutex> lock( *m_syncMutex );
+            const size_t revision = property->getRevision();
+            if (revision != m_propertyRevision[dirIdx]) {
+                FaceMultiplierStore store( property->getCartesianSize() );
+                store.multiplyWith( property->getView() );
+                m_trans[dirIdx] = store;
+                m_propertyRevision[dirIdx] = revision;
+            }
+        }
+        return m_trans[dirIdx];
+    }
+
+
+    // The store of a direction, ready to have multipliers applied.
+    FaceMultiplierStore& TransMult::getStore(size_t dirIdx) {
+        syncStore( dirIdx );
+        m_hasProperty[dirIdx] = true;
+        return m_trans[dirIdx];
+    }
+
+
+    // Applies the factors also to the property of a direction, in the
+    // same order as to the store.
+    void TransMult::multiplyProperty(size_t dirIdx , const std::vector<size_t>& globalIndices , const std::vector<double>& factors) {
+        const std::shared_ptr<GridProperty<double> >& property = m_properties[dirIdx];
+        if (property) {
+            for (size_t n = 0; n < globalIndices.size(); n++)
+                property->multiplyValueAtIndex( globalIndices[n] , factors[n] );
+            m_propertyRevision[dirIdx] = property->getRevision();
+        }
+    }
+
+
     void TransMult::applyMULT(std::shared_ptr<const GridProperty<double> > srcProp, FaceDir::DirEnum faceDir)
     {
-        std::shared_ptr<GridProperty<double> > dstProp = getDirectionProperty(faceDir);
+        const size_t dirIdx = directionIndex( faceDir );
+        getStore( dirIdx ).multiplyWith( srcProp->getView() );
 
-        const std::vector<double> &srcData = srcProp->getData();
-        for (size_t i = 0; i < srcData.size(); ++i)
-            dstProp->multiplyValueAtIndex(i, srcData[i]);
+        const std::shared_ptr<GridProperty<double> >& property = m_properties[dirIdx];
+        if (property) {
+            property->multiplyWith( *srcProp );
+            m_propertyRevision[dirIdx] = property->getRevision();
+        }
     }
 
+
+    /*
+      The fault faces are collected per direction, in the order of the
+      faults. When the faces of a direction cover a large part of the
+      grid the multipliers are made dense and the faces are applied
+      with strided loops over their IJK ranges, with the k layers
+      distributed over threads; otherwise the face indices are merged
+      into the sparse storage. In both cases every face sees the fault
+      multipliers in fault order, so the result does not depend on the
+      number of threads.
+    */
     void TransMult::applyMULTFLT( std::shared_ptr<const FaultCollection> faults) {
+        typedef std::pair<const FaultFace * , double> FaceMult;
+        std::array<std::vector<FaceMult> , 6> faceMults;
+        std::array<size_t , 6> numCells = {{0 , 0 , 0 , 0 , 0 , 0}};
         for (size_t faultIndex = 0; faultIndex < faults->size(); faultIndex++) {
             std::shared_ptr<const Fault> fault = faults->getFault( faultIndex );
             double transMult = fault->getTransMult();
 
             for (auto face_iter = fault->begin(); face_iter != fault->end(); ++face_iter) {
-                std::shared_ptr<const FaultFace> face = *face_iter;
-                FaceDir::DirEnum faceDir = face->getDir();
-                std::shared_ptr<GridProperty<double> > multProperty = getDirectionProperty(faceDir);
-                                
-                for (auto cell_iter = face->begin(); cell_iter != face->end(); ++cell_iter) {
-                    size_t globalIndex = *cell_iter;
-                    multProperty->multiplyValueAtIndex( globalIndex , transMult);
+                const FaultFace * face = face_iter->get();
+                if (face->getNX() != m_nx || face->getNY() != m_ny || face->getK2() >= m_nz)
+                    throw std::invalid_argument("The fault face does not fit the grid");
+
+                const size_t dirIdx = directionIndex( face->getDir() );
+                faceMults[dirIdx].push_back( FaceMult( face , transMult ));
+                numCells[dirIdx] += face->size();
+            }
+        }
+
+        const size_t cartesianSize = m_nx * m_ny * m_nz;
+        for (size_t dirIdx = 0; dirIdx < 6; dirIdx++) {
+            if (faceMults[dirIdx].empty())
+                continue;
+
+            FaceMultiplierStore& store = getStore( dirIdx );
+            const bool dense = (store.getStorageType() == FaceMultiplierStore::Dense || 4 * numCells[dirIdx] > cartesianSize);
+            if (dense) {
+                // The faces touching each layer, in fault order.
+                std::vector<std::vector<size_t> > layerFaces( m_nz );
+                for (size_t faceIdx = 0; faceIdx < faceMults[dirIdx].size(); faceIdx++) {
+                    const FaultFace * face = faceMults[dirIdx][faceIdx].first;
+                    for (size_t k = face->getK1(); k <= face->getK2(); k++)
+                        layerFaces[k].push_back( faceIdx );
                 }
+
+                double * data = store.getDenseData();
+                const std::vector<FaceMult>& dirFaceMults = faceMults[dirIdx];
+                const size_t nx = m_nx;
+                const size_t nxny = m_nx * m_ny;
+#pragma omp parallel for schedule(dynamic) if (numCells[dirIdx] >= parallelThreshold)
+                for (long k = 0; k < static_cast<long>(m_nz); k++) {
+                    for (auto faceIter = layerFaces[k].begin(); faceIter != layerFaces[k].end(); ++faceIter) {
+                        const FaultFace * face = dirFaceMults[*faceIter].first;
+                        const double transMult = dirFaceMults[*faceIter].second;
+                        for (size_t j = face->getJ1(); j <= face->getJ2(); j++) {
+                            double * row = data + k*nxny + j*nx;
+                            for (size_t i = face->getI1(); i <= face->getI2(); i++)
+                                row[i] *= transMult;
+                        }
+                    }
+                }
+            }
+
+            if (!dense || m_properties[dirIdx]) {
+                std::vector<size_t> globalIndices;
+                std::vector<double> factors;
+                globalIndices.reserve( numCells[dirIdx] );
+                factors.reserve( numCells[dirIdx] );
+                for (auto iter = faceMults[dirIdx].begin(); iter != faceMults[dirIdx].end(); ++iter) {
+                    for (auto cell_iter = iter->first->begin(); cell_iter != iter->first->end(); ++cell_iter) {
+                        globalIndices.push_back( *cell_iter );
+                        factors.push_back( iter->second );
+                    }
+                }
+
+                if (!dense)
+                    store.multiply( globalIndices , factors );
+                multiplyProperty( dirIdx , globalIndices , factors );
             }
-            
         }
     }
 
@@ -129,15 +337,18 @@ namespace Opm {
 
     void TransMult::applyMULTREGT( std::shared_ptr<MULTREGTScanner> multregtScanner , std::shared_ptr<GridProperties<int> > regions) {
         const std::vector< MULTREGTConnection > connections = multregtScanner->scanRegions( regions );
+        std::array<std::vector<size_t> , 6> globalIndices;
+        std::array<std::vector<double> , 6> factors;
         for (auto iter = connections.begin(); iter != connections.end(); ++iter) {
-            MULTREGTConnection connection = *iter;
-            FaceDir::DirEnum faceDir = std::get<1>( connection );
-            std::shared_ptr<GridProperty<double> > multProperty = getDirectionProperty(faceDir);
-            {
-                size_t globalIndex = std::get<0>( connection );
-                double transMult = std::get<2>( connection );
-                
-                multProperty->multiplyValueAtIndex( globalIndex , transMult);
+            const size_t dirIdx = directionIndex( std::get<1>( *iter ));
+            globalIndices[dirIdx].push_back( std::get<0>( *iter ));
+            factors[dirIdx].push_back( std::get<2>( *iter ));
+        }
+
+        for (size_t dirIdx = 0; dirIdx < 6; dirIdx++) {
+            if (!globalIndices[dirIdx].empty()) {
+                getStore( dirIdx ).multiply( globalIndices[dirIdx] , factors[dirIdx] );
+                multiplyProperty( dirIdx , globalIndices[dirIdx] , factors[dirIdx] );
             }
         }
     }
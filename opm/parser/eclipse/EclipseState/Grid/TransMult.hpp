@@ -25,16 +25,36 @@
 
       {MULTX , MULTX- , MULTY , MULTY- , MULTZ , MULTZ-, MULTFLT , MULTREGT}
 
+   The multipliers of each direction are kept in a FaceMultiplierStore;
+   a direction without multipliers does not use any memory. Several
+   multipliers can be fetched in one call with the getMultipliers()
+   methods.
+
+   getDirectionProperty() hands out the multipliers of a direction as a
+   MULTX, ... GridProperty which can be modified. From then on the
+   property holds the multipliers of the direction: the store is
+   refreshed from it when it has been modified, and the multipliers
+   applied later are applied to both. copyDirectionProperty() returns a
+   read only copy instead, and leaves the storage alone.
+
+   A copy of a TransMult holds the multipliers at the time of the copy;
+   the properties handed out by getDirectionProperty() stay with the
+   original. As for GridProperty the multipliers must not be modified,
+   also not through such a property, while other threads read them.
 */
 #ifndef TRANSMULT_HPP
 #define TRANSMULT_HPP
 
 
+#include <array>
 #include <cstddef>
-#include <map>
 #include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
 
 #include <opm/parser/eclipse/EclipseState/Grid/FaceDir.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/FaceMultiplierStore.hpp>
 #include <opm/parser/eclipse/EclipseState/Grid/GridProperty.hpp>
 #include <opm/parser/eclipse/EclipseState/Grid/GridProperties.hpp>
 #include <opm/parser/eclipse/EclipseState/Grid/FaultCollection.hpp>
@@ -46,10 +66,25 @@ namespace Opm {
 
     public:
         TransMult(size_t nx , size_t ny , size_t nz);
+        TransMult(const TransMult& other);
+        TransMult& operator=(const TransMult&) = delete;
         double getMultiplier(size_t globalIndex, FaceDir::DirEnum faceDir) const;
         double getMultiplier(size_t i , size_t j , size_t k, FaceDir::DirEnum faceDir) const;
+
+        // the multipliers of the faces faceDir of the cells in globalIndices
+        void getMultipliers(const std::vector<size_t>& globalIndices , FaceDir::DirEnum faceDir , std::vector<double>& multipliers) const;
+        // the multipliers of a list of (globalIndex , faceDir) faces
+        void getMultipliers(const std::vector< std::pair<size_t , FaceDir::DirEnum> >& faces , std::vector<double>& multipliers) const;
+        // the multipliers of the faces faceDir of all the cells
+        void getMultipliers(FaceDir::DirEnum faceDir , std::vector<double>& multipliers) const;
+
+        // true if multipliers have been applied in the direction, or
+        // its property has been requested with getDirectionProperty()
         bool hasDirectionProperty(FaceDir::DirEnum faceDir) const;
         std::shared_ptr<GridProperty<double> > getDirectionProperty(FaceDir::DirEnum faceDir);
+        // a copy of the multipliers in the direction, as a MULTX,... property
+        std::shared_ptr<const GridProperty<double> > copyDirectionProperty(FaceDir::DirEnum faceDir) const;
+        const FaceMultiplierStore& getDirectionStore(FaceDir::DirEnum faceDir) const;
         void applyMULT(std::shared_ptr<const GridProperty<double> > srcMultProp, FaceDir::DirEnum faceDir);
         void applyMULTFLT( std::shared_ptr<const FaultCollection> faults);
         void applyMULTREGT( std::shared_ptr<MULTREGTScanner> multregtScanner , std::shared_ptr<GridProperties<int> > regions);
@@ -58,11 +93,19 @@ namespace Opm {
         size_t getGlobalIndex(size_t i , size_t j , size_t k) const;
         void assertIJK(size_t i , size_t j , size_t k) const;
         double getMultiplier__(size_t globalIndex , FaceDir::DirEnum faceDir) const;
-        void insertNewProperty(FaceDir::DirEnum faceDir);
+        static size_t directionIndex(FaceDir::DirEnum faceDir);
+        FaceMultiplierStore& getStore(size_t dirIdx);
+        const FaceMultiplierStore& syncStore(size_t dirIdx) const;
+        void multiplyProperty(size_t dirIdx , const std::vector<size_t>& globalIndices , const std::vector<double>& factors);
 
         size_t m_nx , m_ny , m_nz;
-        std::map<FaceDir::DirEnum , std::shared_ptr<GridProperty<double> > > m_trans;
-        std::map<FaceDir::DirEnum , std::string> m_names;
+        mutable std::array<FaceMultiplierStore , 6> m_trans;
+        std::array<bool , 6> m_hasProperty;
+        // the properties handed out by getDirectionProperty(), and
+        // their revision when m_trans was last refreshed from them
+        std::array<std::shared_ptr<GridProperty<double> > , 6> m_properties;
+        mutable std::array<size_t , 6> m_propertyRevision;
+        std::shared_ptr<std::mutex> m_syncMutex;
     };
 
 }
@@ -0,0 +1,408 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include <opm/parser/eclipse/EclipseState/Grid/CellGeometry.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/Transmissibility.hpp>
+#include <opm/parser/eclipse/EclipseState/Util/Parallel.hpp>
+
+namespace Opm {
+
+namespace {
+
+    // The layers are processed in blocks; the half transmissibility
+    // factors of the layer above a block are computed twice.
+    const size_t layersPerBlock = 8;
+
+    // The half transmissibility factors of all the cells of a layer,
+    // one array per face in the order I-, I+, J-, J+, K-, K+.
+    struct LayerFactors {
+        explicit LayerFactors(size_t layerSize) {
+            for (int f = 0; f < 6; f++)
+                face[f].resize( layerSize );
+        }
+
+        std::vector<double> face[6];
+    };
+
+    void computeLayer(size_t nx , size_t ny , size_t k , const double* coord , const double* zcorn , LayerFactors& layer) {
+        double factors[6];
+        for (size_t j = 0; j < ny; j++) {
+            for (size_t i = 0; i < nx; i++) {
+                CellGeometry::halfTransFactors( nx , ny , i , j , k , coord , zcorn , factors );
+                for (int f = 0; f < 6; f++)
+                    layer.face[f][i + j*nx] = factors[f];
+            }
+        }
+    }
+
+    // The integral of max(0 , h) over an interval of length, for h
+    // linear between h0 and h1.
+    double positiveIntegral(double h0 , double h1 , double length) {
+        if (h0 >= 0 && h1 >= 0)
+            return 0.5 * (h0 + h1) * length;
+        else if (h0 <= 0 && h1 <= 0)
+            return 0;
+        else {
+            const double h = std::max( h0 , h1 );
+            return 0.5 * h * h / std::fabs( h1 - h0 ) * length;
+        }
+    }
+
+    /*
+      The X or Y face between cell (i,j,k) and its neighbour in
+      direction d lies on two pillars, where either cell has a top and
+      a bottom depth. Across a fault the depths of the two cells differ
+      and only the overlap of their faces connects them. Returns false
+      if the depths are equal; otherwise the fraction of the face of
+      either cell which overlaps the other. The overlap is measured
+      along the face between the pillars, which is exact for vertical
+      pillars.
+    */
+    bool faceOverlap(size_t nx , size_t ny , size_t i , size_t j , size_t k , int d , const double* zcorn ,
+                     double& fraction1 , double& fraction2) {
+        double depth1[2][2];
+        double depth2[2][2];
+        bool equal = true;
+        for (size_t p = 0; p < 2; p++) {
+            for (size_t dk = 0; dk < 2; dk++) {
+                // the corner of cell 1 on its + face, and the same corner
+                // of the neighbour on its - face
+                const size_t base = k*8*nx*ny + dk*4*nx*ny + j*4*nx + 2*i;
+                const size_t z1 = (d == 0) ? base + p*2*nx + 1 : base + 2*nx + p;
+                const size_t z2 = (d == 0) ? z1 + 1 : z1 + 2*nx;
+                depth1[dk][p] = zcorn[z1];
+                depth2[dk][p] = zcorn[z2];
+                equal = equal && (zcorn[z1] == zcorn[z2]);
+            }
+        }
+        if (equal)
+            return false;
+
+        // The top of the overlap is the deeper of the two tops and its
+        // bottom the shallower of the bottoms; the thickness is linear
+        // between the points where the tops or the bottoms cross.
+        double s[4] = { 0 , 1 , 1 , 1 };
+        for (int dk = 0; dk < 2; dk++) {
+            const double f0 = depth1[dk][0] - depth2[dk][0];
+            const double f1 = depth1[dk][1] - depth2[dk][1];
+            if (f0 * f1 < 0)
+                s[2 + dk] = f0 / (f0 - f1);
+        }
+        std::sort( s , s + 4 );
+
+        // the top (dk = 0) and bottom (dk = 1) of either face at t
+        auto thickness = [&depth1 , &depth2](double t) {
+            double cell1[2] , cell2[2];
+            for (int dk = 0; dk < 2; dk++) {
+                cell1[dk] = depth1[dk][0] + t*(depth1[dk][1] - depth1[dk][0]);
+                cell2[dk] = depth2[dk][0] + t*(depth2[dk][1] - depth2[dk][0]);
+            }
+            return std::min( cell1[1] , cell2[1] ) - std::max( cell1[0] , cell2[0] );
+        };
+
+        double overlap = 0;
+        for (int n = 0; n < 3; n++) {
+            if (s[n + 1] > s[n])
+                overlap += positiveIntegral( thickness( s[n] ) , thickness( s[n + 1] ) , s[n + 1] - s[n] );
+        }
+
+        const double area1 = 0.5 * ((depth1[1][0] - depth1[0][0]) + (depth1[1][1] - depth1[0][1]));
+        const double area2 = 0.5 * ((depth2[1][0] - depth2[0][0]) + (depth2[1][1] - depth2[0][1]));
+        fraction1 = (area1 > 0) ? std::min( 1.0 , overlap / area1 ) : 0;
+        fraction2 = (area2 > 0) ? std::min( 1.0 , overlap / area2 ) : 0;
+        return true;
+    }
+
+    double faceTrans(double halfTrans1 , double halfTrans2 , double multiplier) {
+        if (halfTrans1 > 0 && halfTrans2 > 0)
+            return multiplier * halfTrans1 * halfTrans2 / (halfTrans1 + halfTrans2);
+        else
+            return 0;
+    }
+}
+
+
+    Transmissibility::Transmissibility(const EclipseGrid& grid ,
+                                       const GridProperty<double>& permx ,
+                                       const GridProperty<double>& permy ,
+                                       const GridProperty<double>& permz ,
+                                       const GridProperty<double>& ntg ,
+                                       const TransMult& transMult) {
+        std::vector<int> actnum;
+        grid.exportACTNUM( actnum );
+        compute( grid.getNX() , grid.getNY() , grid.getNZ() , grid.getCOORD() , grid.getZCORN() , actnum ,
+                 permx.getView() , permy.getView() , permz.getView() , ntg.getView() , transMult );
+    }
+
+
+    Transmissibility::Transmissibility(size_t nx , size_t ny , size_t nz ,
+                                       const std::vector<double>& coord ,
+                                       const std::vector<double>& zcorn ,
+                                       const std::vector<int>& actnum ,
+                                       const GridPropertyView<double>& permx ,
+                                       const GridPropertyView<double>& permy ,
+                                       const GridPropertyView<double>& permz ,
+                                       const GridPropertyView<double>& ntg ,
+                                       const TransMult& transMult) {
+        compute( nx , ny , nz , coord , zcorn , actnum , permx , permy , permz , ntg , transMult );
+    }
+
+
+    /*
+      The connections are first counted per direction and layer, which
+      gives the position of every layer in the output arrays; the
+      blocks of layers are then filled independently.
+    */
+    void Transmissibility::compute(size_t nx , size_t ny , size_t nz ,
+                                   const std::vector<double>& coord ,
+                                   const std::vector<double>& zcorn ,
+                                   const std::vector<int>& actnum ,
+                                   const GridPropertyView<double>& permx ,
+                                   const GridPropertyView<double>& permy ,
+                                   const GridPropertyView<double>& permz ,
+                                   const GridPropertyView<double>& ntg ,
+                                   const TransMult& transMult) {
+        const size_t numCells = nx * ny * nz;
+        const size_t layerSize = nx * ny;
+        if (coord.size() != 6*(nx + 1)*(ny + 1) || zcorn.size() != 8*numCells)
+            throw std::invalid_argument("The size of COORD or ZCORN does not match the grid dimensions");
+
+        if (!actnum.empty() && actnum.size() != numCells)
+            throw std::invalid_argument("The size of ACTNUM does not match the grid dimensions");
+
+        if (permx.size() != numCells || permy.size() != numCells || permz.size() != numCells || ntg.size() != numCells)
+            throw std::invalid_argument("The size of the permeability or NTG does not match the grid dimensions");
+
+        if (numCells > static_cast<size_t>(std::numeric_limits<int>::max()))
+            throw std::invalid_argument("The grid is too large for the transmissibility computation");
+
+        const bool parallel = (numCells >= parallelThreshold);
+        auto isActive = [&actnum](size_t g) { return actnum.empty() || actnum[g] > 0; };
+
+        // The number of connections of each layer, per direction.
+        std::vector<size_t> layerOffset[3];
+        for (int d = 0; d < 3; d++)
+            layerOffset[d].assign( nz + 1 , 0 );
+
+#pragma omp parallel for schedule(static) if (parallel)
+        for (long k = 0; k < static_cast<long>(nz); k++) {
+            size_t count[3] = {0 , 0 , 0};
+            for (size_t j = 0; j < ny; j++) {
+                for (size_t i = 0; i < nx; i++) {
+                    const size_t g = i + j*nx + k*layerSize;
+                    if (!isActive( g ))
+                        continue;
+
+                    count[0] += ((i + 1) < nx && isActive( g + 1 ));
+                    count[1] += ((j + 1) < ny && isActive( g + nx ));
+                    count[2] += (static_cast<size_t>(k + 1) < nz && isActive( g + layerSize ));
+                }
+            }
+            for (int d = 0; d < 3; d++)
+                layerOffset[d][k + 1] = count[d];
+        }
+
+        m_directionOffset[0] = 0;
+        for (int d = 0; d < 3; d++) {
+            layerOffset[d][0] = m_directionOffset[d];
+            for (size_t k = 0; k < nz; k++)
+                layerOffset[d][k + 1] += layerOffset[d][k];
+            m_directionOffset[d + 1] = layerOffset[d][nz];
+        }
+
+        const size_t numConnections = m_directionOffset[3];
+        m_cell1.resize( numConnections );
+        m_cell2.resize( numConnections );
+        m_halfTrans1.resize( numConnections );
+        m_halfTrans2.resize( numConnections );
+        m_trans.resize( numConnections );
+
+        const FaceMultiplierStore* plusMult[3] = { &transMult.getDirectionStore( FaceDir::XPlus ) ,
+                                                   &transMult.getDirectionStore( FaceDir::YPlus ) ,
+                                                   &transMult.getDirectionStore( FaceDir::ZPlus ) };
+        const FaceMultiplierStore* minusMult[3] = { &transMult.getDirectionStore( FaceDir::XMinus ) ,
+                                                    &transMult.getDirectionStore( FaceDir::YMinus ) ,
+                                                    &transMult.getDirectionStore( FaceDir::ZMinus ) };
+        const GridPropertyView<double>* perm[3] = { &permx , &permy , &permz };
+        const double* coordData = coord.data();
+        const double* zcornData = zcorn.data();
+        const long numBlocks = static_cast<long>((nz + layersPerBlock - 1) / layersPerBlock);
+
+#pragma omp parallel for schedule(dynamic) if (parallel)
+        for (long block = 0; block < numBlocks; block++) {
+            const size_t k1 = block * layersPerBlock;
+            const size_t k2 = std::min( nz , k1 + layersPerBlock );
+            LayerFactors current( layerSize );
+            LayerFactors above( layerSize );
+            computeLayer( nx , ny , k1 , coordData , zcornData , current );
+
+            for (size_t k = k1; k < k2; k++) {
+                if (k + 1 < nz)
+                    computeLayer( nx , ny , k + 1 , coordData , zcornData , above );
+
+                size_t pos[3] = { layerOffset[0][k] , layerOffset[1][k] , layerOffset[2][k] };
+                for (size_t j = 0; j < ny; j++) {
+                    for (size_t i = 0; i < nx; i++) {
+                        const size_t c = i + j*nx;
+                        const size_t g1 = c + k*layerSize;
+                        if (!isActive( g1 ))
+                            continue;
+
+                        const bool hasNeighbour[3] = { (i + 1) < nx , (j + 1) < ny , (k + 1) < nz };
+                        const size_t stride[3] = { 1 , nx , layerSize };
+                        for (int d = 0; d < 3; d++) {
+                            const size_t g2 = g1 + stride[d];
+                            if (!hasNeighbour[d] || !isActive( g2 ))
+                                continue;
+
+                            const double ntg1 = (d < 2) ? ntg[g1] : 1.0;
+                            const double ntg2 = (d < 2) ? ntg[g2] : 1.0;
+                            const double factor2 = (d < 2) ? current.face[2*d][c + stride[d]] : above.face[4][c];
+                            double halfTrans1 = (*perm[d])[g1] * ntg1 * current.face[2*d + 1][c];
+                            double halfTrans2 = (*perm[d])[g2] * ntg2 * factor2;
+
+                            double fraction1 , fraction2;
+                            if (d < 2 && faceOverlap( nx , ny , i , j , k , d , zcornData , fraction1 , fraction2 )) {
+                                halfTrans1 *= fraction1;
+                                halfTrans2 *= fraction2;
+                            }
+                            const double multiplier = plusMult[d]->get( g1 ) * minusMult[d]->get( g2 );
+
+                            const size_t n = pos[d]++;
+                            m_cell1[n] = static_cast<int>(g1);
+                            m_cell2[n] = static_cast<int>(g2);
+                            m_halfTrans1[n] = halfTrans1;
+                            m_halfTrans2[n] = halfTrans2;
+                            m_trans[n] = faceTrans( halfTrans1 , halfTrans2 , multiplier );
+                        }
+                    }
+                }
+                std::swap( current , above );
+            }
+        }
+    }
+
+
+    void Transmissibility::computeNNCTrans(size_t nx ,
+                                           size_t ny ,
+                                           const NNC& nnc ,
+                                           const CellGeometry& cellGeometry ,
+                                           const GridPropertyView<double>& permx ,
+                                           const GridPropertyView<double>& permy ,
+                                           const GridPropertyView<double>& ntg ,
+                                           const TransMult& transMult ,
+                                           std::vector<double>& nncTrans) {
+        const size_t numCells = nnc.getCartesianSize();
+        if (cellGeometry.size() != numCells || permx.size() != numCells || permy.size() != numCells || ntg.size() != numCells)
+            throw std::invalid_argument("The size of the cell geometry, the permeability or NTG does not match the NNCs");
+
+        const FaceMultiplierStore& multXPlus = transMult.getDirectionStore( FaceDir::XPlus );
+        const FaceMultiplierStore& multXMinus = transMult.getDirectionStore( FaceDir::XMinus );
+        const FaceMultiplierStore& multYPlus = transMult.getDirectionStore( FaceDir::YPlus );
+        const FaceMultiplierStore& multYMinus = transMult.getDirectionStore( FaceDir::YMinus );
+
+        const std::vector<size_t>& rowStart = nnc.getRowStart();
+        const std::vector<int>& cell2 = nnc.getCell2();
+        const std::vector<double>& area = nnc.getArea();
+        const std::vector<double>& multipliers = nnc.getMultipliers();
+        const std::vector<double>& centerX = cellGeometry.getCenterX();
+        const std::vector<double>& centerY = cellGeometry.getCenterY();
+        const std::vector<double>& depth = cellGeometry.getDepth();
+
+        nncTrans.resize( nnc.size() );
+        for (size_t g1 = 0; g1 < numCells; g1++) {
+            for (size_t n = rowStart[g1]; n < rowStart[g1 + 1]; n++) {
+                const size_t g2 = cell2[n];
+                const size_t i1 = g1 % nx;
+                const size_t i2 = g2 % nx;
+                const bool xFault = (i1 != i2);
+                const GridPropertyView<double>& perm = xFault ? permx : permy;
+
+                double multiplier = multipliers[n];
+                if (xFault) {
+                    const size_t lower = (i1 < i2) ? g1 : g2;
+                    const size_t upper = (i1 < i2) ? g2 : g1;
+                    multiplier *= multXPlus.get( lower ) * multXMinus.get( upper );
+                } else {
+                    const bool lowerFirst = ((g1 / nx) % ny) < ((g2 / nx) % ny);
+                    const size_t lower = lowerFirst ? g1 : g2;
+                    const size_t upper = lowerFirst ? g2 : g1;
+                    multiplier *= multYPlus.get( lower ) * multYMinus.get( upper );
+                }
+
+                const double dx = centerX[g2] - centerX[g1];
+                const double dy = centerY[g2] - centerY[g1];
+                const double dz = depth[g2] - depth[g1];
+                const double halfDistance = 0.5 * std::sqrt( dx*dx + dy*dy + dz*dz );
+
+                if (halfDistance > 0) {
+                    const double halfTrans1 = perm[g1] * ntg[g1] * area[n] / halfDistance;
+                    const double halfTrans2 = perm[g2] * ntg[g2] * area[n] / halfDistance;
+                    nncTrans[n] = faceTrans( halfTrans1 , halfTrans2 , multiplier );
+                } else
+                    nncTrans[n] = 0;
+            }
+        }
+    }
+
+
+    size_t Transmissibility::size() const {
+        return m_trans.size();
+    }
+
+
+    std::pair<size_t , size_t> Transmissibility::getConnectionRange(FaceDir::DirEnum faceDir) const {
+        switch (faceDir) {
+        case FaceDir::XPlus:
+            return std::make_pair( m_directionOffset[0] , m_directionOffset[1] );
+        case FaceDir::YPlus:
+            return std::make_pair( m_directionOffset[1] , m_directionOffset[2] );
+        case FaceDir::ZPlus:
+            return std::make_pair( m_directionOffset[2] , m_directionOffset[3] );
+        default:
+            throw std::invalid_argument("The connections are only stored for the XPlus, YPlus and ZPlus directions");
+        }
+    }
+
+
+    const std::vector<int>& Transmissibility::getCell1() const {
+        return m_cell1;
+    }
+
+    const std::vector<int>& Transmissibility::getCell2() const {
+        return m_cell2;
+    }
+
+    const std::vector<double>& Transmissibility::getHalfTrans1() const {
+        return m_halfTrans1;
+    }
+
+    const std::vector<double>& Transmissibility::getHalfTrans2() const {
+        return m_halfTrans2;
+    }
+
+    const std::vector<double>& Transmissibility::getTrans() const {
+        return m_trans;
+    }
+}
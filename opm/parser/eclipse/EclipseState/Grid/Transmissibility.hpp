@@ -0,0 +1,145 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRANSMISSIBILITY_HPP_
+#define TRANSMISSIBILITY_HPP_
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <opm/parser/eclipse/EclipseState/Grid/CellGeometry.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/EclipseGrid.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/FaceDir.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/GridProperty.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/GridPropertyView.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/NNC.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/TransMult.hpp>
+
+/*
+  The Transmissibility class computes the transmissibilities of all
+  the connections between active Cartesian neighbours of a corner
+  point grid, i.e. the TRANX, TRANY and TRANZ of ECLIPSE without NNCs.
+
+  The half transmissibility of a cell towards a face is
+
+      T_half = K * NTG * |A . d| / (d . d)
+
+  where K is PERMX, PERMY or PERMZ, A is the area vector of the face
+  of the cell and d the vector from the cell center to the face
+  center; NTG only applies in the X and Y directions. The
+  transmissibility of the connection between cell1 and its neighbour
+  cell2 in the positive direction is
+
+      T = M / (1 / T_half1 + 1 / T_half2)
+
+  where M is the product of the multiplier on the + face of cell1 and
+  the - face of cell2 from TransMult, i.e. MULTX/Y/Z, MULTX-/Y-/Z-,
+  MULTFLT and MULTREGT. Everything is in SI units.
+
+  Across a fault the X and Y faces of two neighbours are displaced
+  along their pillars; the half transmissibilities are then scaled by
+  the fraction of either face which overlaps the other, measured along
+  the pillars. The connections of a cell to the cells beyond its
+  neighbour across the fault are NNCs, and are not computed here.
+
+  The connections are stored as a structure of arrays: first all the
+  X connections, then the Y and the Z connections, each in the order of
+  the global index of cell1. The computation is a single pass over the
+  grid, parallelized over blocks of layers with OpenMP; every cell
+  geometry is evaluated once per block.
+*/
+
+namespace Opm {
+
+    class Transmissibility {
+    public:
+        Transmissibility(const EclipseGrid& grid ,
+                         const GridProperty<double>& permx ,
+                         const GridProperty<double>& permy ,
+                         const GridProperty<double>& permz ,
+                         const GridProperty<double>& ntg ,
+                         const TransMult& transMult);
+
+        // actnum may be empty, i.e. all the cells are active
+        Transmissibility(size_t nx , size_t ny , size_t nz ,
+                         const std::vector<double>& coord ,
+                         const std::vector<double>& zcorn ,
+                         const std::vector<int>& actnum ,
+                         const GridPropertyView<double>& permx ,
+                         const GridPropertyView<double>& permy ,
+                         const GridPropertyView<double>& permz ,
+                         const GridPropertyView<double>& ntg ,
+                         const TransMult& transMult);
+
+        size_t size() const;
+        // [begin, end) of the connections in direction XPlus, YPlus or ZPlus
+        std::pair<size_t , size_t> getConnectionRange(FaceDir::DirEnum faceDir) const;
+
+        // global indices of the two cells of every connection
+        const std::vector<int>& getCell1() const;
+        const std::vector<int>& getCell2() const;
+        const std::vector<double>& getHalfTrans1() const;
+        const std::vector<double>& getHalfTrans2() const;
+        // the transmissibility including the multipliers
+        const std::vector<double>& getTrans() const;
+
+        /*
+          An estimate of the transmissibilities of the non-neighbour
+          connections: the half transmissibilities are K * NTG * A /
+          (d / 2), where A is the overlap area, d the distance between
+          the cell centers and K PERMX or PERMY for a fault in the X or
+          Y direction. The MULTREGT multipliers of the NNCs are applied,
+          and the multipliers of transMult on the faces of the two cells
+          towards each other, e.g. the + face of the cell with the lower
+          I and the - face of the other cell for a fault in the X
+          direction. As the NNCs have their own MULTREGT multipliers,
+          transMult should only hold MULTX/Y(-) and MULTFLT.
+        */
+        static void computeNNCTrans(size_t nx ,
+                                    size_t ny ,
+                                    const NNC& nnc ,
+                                    const CellGeometry& cellGeometry ,
+                                    const GridPropertyView<double>& permx ,
+                                    const GridPropertyView<double>& permy ,
+                                    const GridPropertyView<double>& ntg ,
+                                    const TransMult& transMult ,
+                                    std::vector<double>& nncTrans);
+
+    private:
+        void compute(size_t nx , size_t ny , size_t nz ,
+                     const std::vector<double>& coord ,
+                     const std::vector<double>& zcorn ,
+                     const std::vector<int>& actnum ,
+                     const GridPropertyView<double>& permx ,
+                     const GridPropertyView<double>& permy ,
+                     const GridPropertyView<double>& permz ,
+                     const GridPropertyView<double>& ntg ,
+                     const TransMult& transMult);
+
+        size_t m_directionOffset[4];
+        std::vector<int> m_cell1;
+        std::vector<int> m_cell2;
+        std::vector<double> m_halfTrans1;
+        std::vector<double> m_halfTrans2;
+        std::vector<double> m_trans;
+    };
+}
+
+#endif
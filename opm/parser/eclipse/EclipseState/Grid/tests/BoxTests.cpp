@@ -114,3 +114,50 @@ BOOST_AUTO_TEST_CASE(BoxEqual) {
 }
 
 
+
+
+static std::vector<size_t> runIndices(const Opm::Box& box) {
+    std::vector<size_t> indices;
+    for (auto iter = box.runsBegin(); iter != box.runsEnd(); ++iter) {
+        const Opm::Box::IndexRun run = *iter;
+        for (size_t g = run.begin; g < run.end; g++)
+            indices.push_back( g );
+    }
+    return indices;
+}
+
+
+BOOST_AUTO_TEST_CASE(BoxRuns) {
+    Opm::Box globalBox( 10,10,10 );
+    BOOST_CHECK_EQUAL( 1U , globalBox.numRuns() );
+    BOOST_CHECK_EQUAL( 0U , globalBox.getRun(0).begin );
+    BOOST_CHECK_EQUAL( 1000U , globalBox.getRun(0).end );
+    BOOST_CHECK_THROW( globalBox.getRun(1) , std::invalid_argument );
+
+    // Full i and j range: the layers are contiguous.
+    Opm::Box layerBox( globalBox , 0,9,0,9,2,4 );
+    BOOST_CHECK_EQUAL( 1U , layerBox.numRuns() );
+    BOOST_CHECK_EQUAL( 200U , layerBox.getRun(0).begin );
+    BOOST_CHECK_EQUAL( 500U , layerBox.getRun(0).end );
+
+    // Full i range: one run per layer of the selected rows.
+    Opm::Box slabBox( globalBox , 0,9,3,4,2,4 );
+    BOOST_CHECK_EQUAL( 3U , slabBox.numRuns() );
+    BOOST_CHECK_EQUAL( 230U , slabBox.getRun(0).begin );
+    BOOST_CHECK_EQUAL( 20U , slabBox.getRun(0).size() );
+
+    // General sub box: one run per row.
+    Opm::Box subBox( globalBox , 1,3,1,4,1,5 );
+    BOOST_CHECK_EQUAL( 20U , subBox.numRuns() );
+    BOOST_CHECK_EQUAL( 3U , subBox.getRun(0).size() );
+
+    {
+        Opm::Box boxes[] = { globalBox , layerBox , slabBox , subBox };
+        for (size_t b = 0; b < 4; b++) {
+            const std::vector<size_t> indexList = boxes[b].getIndexList();
+            const std::vector<size_t> indices = runIndices( boxes[b] );
+            BOOST_CHECK_EQUAL( boxes[b].size() , indexList.size() );
+            BOOST_CHECK_EQUAL_COLLECTIONS( indexList.begin() , indexList.end() , indices.begin() , indices.end() );
+        }
+    }
+}
@@ -0,0 +1,167 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sstream>
+#include <stdexcept>
+#include <iostream>
+#include <boost/filesystem.hpp>
+
+#define BOOST_TEST_MODULE CellAdjacencyTests
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+#include <opm/parser/eclipse/EclipseState/Grid/CellAdjacency.hpp>
+
+
+/*
+  A grid of unit cubes with vertical pillars, where the column i is
+  displaced throw * i down.
+*/
+static void createGrid(size_t nx , size_t ny , size_t nz , double throwDepth ,
+                       std::vector<double>& coord , std::vector<double>& zcorn) {
+    coord.clear();
+    for (size_t j = 0; j <= ny; j++) {
+        for (size_t i = 0; i <= nx; i++) {
+            const double pillar[6] = { double(i) , double(j) , 0 , double(i) , double(j) , 100 };
+            coord.insert( coord.end() , pillar , pillar + 6 );
+        }
+    }
+
+    zcorn.resize( 8*nx*ny*nz );
+    for (size_t k = 0; k < nz; k++)
+        for (size_t dk = 0; dk < 2; dk++)
+            for (size_t j = 0; j < 2*ny; j++)
+                for (size_t i = 0; i < 2*nx; i++)
+                    zcorn[(2*k + dk)*4*nx*ny + j*2*nx + i] = k + dk + throwDepth * (i / 2);
+}
+
+
+BOOST_AUTO_TEST_CASE(CartesianGraph) {
+    const size_t nx = 3, ny = 2, nz = 2;
+    std::vector<double> coord , zcorn;
+    createGrid( nx , ny , nz , 0 , coord , zcorn );
+
+    std::vector<int> actnum( nx*ny*nz , 1 );
+    actnum[4] = 0;
+    Opm::ActiveIndexMap activeIndexMap( nx*ny*nz , actnum );
+    Opm::TransMult transMult( nx , ny , nz );
+    Opm::GridPropertyView<double> perm( nx*ny*nz , 1.0 );
+    Opm::Transmissibility trans( nx , ny , nz , coord , zcorn , actnum , perm , perm , perm , perm , transMult );
+    Opm::CellAdjacency graph( activeIndexMap , trans );
+
+    BOOST_CHECK_EQUAL( 11U , graph.numVertices() );
+    BOOST_CHECK_EQUAL( trans.size() , graph.numEdges() );
+
+    // Global cell 5 (1 inactive cell before) has the neighbours 2, 11
+    // and the inactive 4.
+    const std::vector<int>& rowStart = graph.getRowStart();
+    const std::vector<int>& columns = graph.getColumns();
+    BOOST_CHECK_EQUAL( 2 , rowStart[5] - rowStart[4] );
+    BOOST_CHECK_EQUAL( 2 , columns[rowStart[4]] );
+    BOOST_CHECK_EQUAL( 10 , columns[rowStart[4] + 1] );
+
+    // Global cell 1 has the neighbours 0, 2 and 7; not 4.
+    BOOST_CHECK_EQUAL( 3 , rowStart[2] - rowStart[1] );
+    BOOST_CHECK_EQUAL( 0 , columns[rowStart[1]] );
+    BOOST_CHECK_EQUAL( 2 , columns[rowStart[1] + 1] );
+    BOOST_CHECK_EQUAL( 6 , columns[rowStart[1] + 2] );
+
+    // Symmetric, sorted and weighted with the transmissibility of unit cubes.
+    for (size_t v = 0; v < graph.numVertices(); v++) {
+        for (int position = rowStart[v]; position < rowStart[v + 1]; position++) {
+            const int u = columns[position];
+            if (position > rowStart[v])
+                BOOST_CHECK( columns[position - 1] < u );
+            BOOST_CHECK( std::count( columns.begin() + rowStart[u] , columns.begin() + rowStart[u + 1] , static_cast<int>(v)) == 1 );
+            BOOST_CHECK_CLOSE( 1.0 , graph.getWeights()[position] , 1e-10 );
+        }
+    }
+
+    // Transmissibilities with a different ACTNUM are rejected.
+    Opm::ActiveIndexMap otherMap( nx*ny*nz , std::vector<int>( nx*ny*nz , 0 ));
+    BOOST_CHECK_THROW( Opm::CellAdjacency( otherMap , trans ) , std::invalid_argument );
+}
+
+
+BOOST_AUTO_TEST_CASE(GraphWithNNC) {
+    const size_t nx = 2, ny = 1, nz = 3;
+    std::vector<double> coord , zcorn;
+    createGrid( nx , ny , nz , 0.5 , coord , zcorn );
+
+    Opm::ActiveIndexMap activeIndexMap( nx*ny*nz , std::vector<int>() );
+    Opm::TransMult transMult( nx , ny , nz );
+    Opm::GridPropertyView<double> perm( nx*ny*nz , 1.0 );
+    Opm::Transmissibility trans( nx , ny , nz , coord , zcorn , std::vector<int>() , perm , perm , perm , perm , transMult );
+    Opm::NNC nnc( nx , ny , nz , coord , zcorn , std::vector<int>() );
+    BOOST_CHECK_EQUAL( 2U , nnc.size() );
+
+    Opm::CellGeometry cellGeometry( nx , ny , nz , coord , zcorn );
+    std::vector<double> nncTrans;
+    Opm::Transmissibility::computeNNCTrans( nx , ny , nnc , cellGeometry , perm , perm , perm , transMult , nncTrans );
+    BOOST_CHECK_EQUAL( 2U , nncTrans.size() );
+    // overlap 0.5, the centers are sqrt(1 + 0.25) apart
+    BOOST_CHECK_CLOSE( 0.5 * 0.5 / (0.5 * std::sqrt( 1.25 )) , nncTrans[0] , 1e-10 );
+
+    // The NNC from cell 1 to cell 2 gets the + face of cell 2 and the - face of cell 1.
+    Opm::TransMult faultMult( nx , ny , nz );
+    std::shared_ptr<Opm::GridProperty<double> > multx = faultMult.getDirectionProperty( Opm::FaceDir::XPlus );
+    multx->multiplyValueAtIndex( 2 , 0.5 );
+    multx->multiplyValueAtIndex( 1 , 0.1 );
+    faultMult.getDirectionProperty( Opm::FaceDir::XMinus )->multiplyValueAtIndex( 1 , 0.4 );
+    std::vector<double> faultTrans;
+    Opm::Transmissibility::computeNNCTrans( nx , ny , nnc , cellGeometry , perm , perm , perm , faultMult , faultTrans );
+    BOOST_CHECK_CLOSE( 0.5 * 0.4 * nncTrans[0] , faultTrans[0] , 1e-10 );
+    BOOST_CHECK_CLOSE( nncTrans[1] , faultTrans[1] , 1e-10 );
+
+    BOOST_CHECK_THROW( Opm::CellAdjacency( activeIndexMap , trans , nnc , std::vector<double>( 1 )) , std::invalid_argument );
+    Opm::CellAdjacency graph( activeIndexMap , trans , nnc , nncTrans );
+    BOOST_CHECK_EQUAL( trans.size() + 2 , graph.numEdges() );
+
+    // Cell 2: Z- 0, NNC 1, X+ 3, Z+ 4
+    const std::vector<int>& rowStart = graph.getRowStart();
+    const std::vector<int> expected = { 0 , 1 , 3 , 4 };
+    BOOST_CHECK_EQUAL_COLLECTIONS( expected.begin() , expected.end() ,
+                                   graph.getColumns().begin() + rowStart[2] , graph.getColumns().begin() + rowStart[3] );
+    BOOST_CHECK_EQUAL( nncTrans[0] , graph.getWeights()[rowStart[2] + 1] );
+}
+
+
+BOOST_AUTO_TEST_CASE(ExportMETIS) {
+    std::vector<double> coord , zcorn;
+    createGrid( 3 , 1 , 1 , 0 , coord , zcorn );
+
+    Opm::ActiveIndexMap activeIndexMap( 3 , std::vector<int>() );
+    Opm::TransMult transMult( 3 , 1 , 1 );
+    std::vector<double> permx = { 1.0 , 1.0 , 0.5 };
+    Opm::GridPropertyView<double> permxView( std::make_shared<const std::vector<double> >( permx ));
+    Opm::GridPropertyView<double> perm( 3 , 1.0 );
+    Opm::Transmissibility trans( 3 , 1 , 1 , coord , zcorn , std::vector<int>() , permxView , perm , perm , perm , transMult );
+    Opm::CellAdjacency graph( activeIndexMap , trans );
+
+    // T(0,1) = 1, T(1,2) = 2/3
+    std::ostringstream weighted;
+    graph.exportMETIS( weighted , true , 300 );
+    BOOST_CHECK_EQUAL( "3 2 001\n2 300\n1 300 3 200\n2 200\n" , weighted.str() );
+
+    std::ostringstream unweighted;
+    graph.exportMETIS( unweighted , false );
+    BOOST_CHECK_EQUAL( "3 2\n2\n1 3\n2\n" , unweighted.str() );
+
+    BOOST_CHECK_THROW( graph.getIntegerWeights( 0 ) , std::invalid_argument );
+}
@@ -20,7 +20,10 @@
 #include <stdexcept>
 #include <iostream>
 #include <boost/filesystem.hpp>
+#include <cstdint>
 #include <cstdio>
+#include <fstream>
+#include <iterator>
 
 #define BOOST_TEST_MODULE EclipseGridTests
 #include <boost/test/unit_test.hpp>
@@ -576,6 +579,276 @@ BOOST_AUTO_TEST_CASE(ResetACTNUM) {
 }
 
 
+BOOST_AUTO_TEST_CASE(CopyGrid) {
+    const char *deckData =
+        "RUNSPEC\n"
+        "\n"
+        "DIMENS\n"
+        " 10 10 10 /\n"
+        "GRID\n"
+        "COORD\n"
+        "  726*1 / \n"
+        "ZCORN \n"
+        "  8000*1 / \n"
+        "EDIT\n"
+        "\n";
+
+    Opm::ParserPtr parser(new Opm::Parser());
+    Opm::DeckConstPtr deck = parser->parseString(deckData) ;
+
+    Opm::EclipseGrid grid(deck);
+    BOOST_CHECK_EQUAL( 1000 , ecl_grid_get_nactive( grid.c_ptr() ));
+
+    // the copy shares the ert grid until its ACTNUM is reset.
+    Opm::EclipseGrid copy( grid );
+    BOOST_CHECK( copy.equal( grid ));
+    BOOST_CHECK_EQUAL( grid.c_ptr() , copy.c_ptr() );
+
+    std::vector<int> actnum(1000);
+    actnum[0] = 1;
+    copy.resetACTNUM( actnum.data() );
+    BOOST_CHECK_EQUAL( 1U , copy.getNumActive() );
+    BOOST_CHECK_EQUAL( 1000U , grid.getNumActive() );
+    BOOST_CHECK_EQUAL( 1 , ecl_grid_get_nactive( copy.c_ptr() ));
+    BOOST_CHECK_EQUAL( 1000 , ecl_grid_get_nactive( grid.c_ptr() ));
+
+    Opm::EclipseGrid moved( std::move( copy ));
+    BOOST_CHECK_EQUAL( 1U , moved.getNumActive() );
+}
+
+
+BOOST_AUTO_TEST_CASE(ActiveIndexMap) {
+    const char *deckData =
+        "RUNSPEC\n"
+        "\n"
+        "DIMENS\n"
+        " 10 10 10 /\n"
+        "GRID\n"
+        "COORD\n"
+        "  726*1 / \n"
+        "ZCORN \n"
+        "  8000*1 / \n"
+        "EDIT\n"
+        "\n";
+
+    Opm::ParserPtr parser(new Opm::Parser());
+    Opm::DeckConstPtr deck = parser->parseString(deckData) ;
+
+    Opm::EclipseGrid grid(deck);
+    auto allActive = grid.getActiveIndexMap();
+    BOOST_CHECK_EQUAL( 1000U , allActive->getNumActive() );
+    BOOST_CHECK_EQUAL( 537 , allActive->getActiveIndex( 537 ));
+    BOOST_CHECK( allActive == grid.getActiveIndexMap() );
+
+    std::vector<int> actnum(1000);
+    actnum[3] = 1;
+    actnum[10] = 1;
+    actnum[999] = 1;
+    grid.resetACTNUM( actnum.data() );
+
+    auto activeIndexMap = grid.getActiveIndexMap();
+    BOOST_CHECK_EQUAL( 1000U , activeIndexMap->getCartesianSize() );
+    BOOST_CHECK_EQUAL( 3U , activeIndexMap->getNumActive() );
+    BOOST_CHECK( !activeIndexMap->isActive( 0 ));
+    BOOST_CHECK_EQUAL( -1 , activeIndexMap->getActiveIndex( 4 ));
+    BOOST_CHECK_EQUAL( 1 , activeIndexMap->getActiveIndex( 10 ));
+    BOOST_CHECK_EQUAL( 999U , activeIndexMap->getGlobalIndex( 2 ));
+    BOOST_CHECK_THROW( activeIndexMap->getGlobalIndex( 3 ) , std::invalid_argument );
+    BOOST_CHECK_THROW( activeIndexMap->getActiveIndex( 1000 ) , std::invalid_argument );
+
+    // the map of the full grid is still valid for the old ACTNUM.
+    BOOST_CHECK_EQUAL( 1000U , allActive->getNumActive() );
+}
+
+
+BOOST_AUTO_TEST_CASE(LargeActiveIndexMap) {
+    const size_t cartesianSize = 300000;
+    std::vector<int> actnum( cartesianSize );
+    for (size_t g = 0; g < cartesianSize; ++g)
+        actnum[g] = (g % 7 == 0 || g % 5 == 0) ? 1 : 0;
+
+    Opm::ActiveIndexMap activeIndexMap( cartesianSize , actnum );
+    size_t activeIndex = 0;
+    bool ok = true;
+    for (size_t g = 0; g < cartesianSize; ++g) {
+        if (actnum[g]) {
+            ok = ok && (activeIndexMap.getActiveIndex( g ) == static_cast<int>(activeIndex));
+            ok = ok && (activeIndexMap.getGlobalIndex( activeIndex ) == g);
+            activeIndex++;
+        } else
+            ok = ok && !activeIndexMap.isActive( g );
+    }
+    BOOST_CHECK( ok );
+    BOOST_CHECK_EQUAL( activeIndex , activeIndexMap.getNumActive() );
+    BOOST_CHECK_THROW( Opm::ActiveIndexMap( 10 , actnum ) , std::invalid_argument );
+}
+
+
+BOOST_AUTO_TEST_CASE(CornerPointGridSharesDeckData) {
+    const char *deckData =
+        "RUNSPEC\n"
+        "\n"
+        "DIMENS\n"
+        " 10 10 10 /\n"
+        "GRID\n"
+        "COORD\n"
+        "  726*1 / \n"
+        "ZCORN \n"
+        "  4000*2000.0000001 4000*2010.0000001 / \n"
+        "ACTNUM\n"
+        "  999*1 0 / \n"
+        "EDIT\n"
+        "\n";
+
+    Opm::ParserPtr parser(new Opm::Parser());
+    Opm::DeckConstPtr deck = parser->parseString(deckData) ;
+    Opm::EclipseGrid grid(deck);
+
+    // COORD and ZCORN are not copied from the deck, and keep their
+    // double precision.
+    BOOST_CHECK( grid.getZCORN().data() == deck->getKeyword("ZCORN")->getSIDoubleData().data() );
+    BOOST_CHECK( grid.getCOORD().data() == deck->getKeyword("COORD")->getSIDoubleData().data() );
+    BOOST_CHECK_EQUAL( 2000.0000001 , grid.getZCORN()[0] );
+    BOOST_CHECK_EQUAL( 999U , grid.getNumActive() );
+
+    std::vector<int> actnum;
+    grid.exportACTNUM( actnum );
+    BOOST_CHECK_EQUAL( 1000U , actnum.size() );
+    BOOST_CHECK_EQUAL( 0 , actnum[999] );
+
+    // the ert grid is created on demand for the export paths.
+    Opm::EclipseGrid copy( grid.c_ptr() );
+    BOOST_CHECK( grid.equal( copy ));
+    BOOST_CHECK_EQUAL( 999U , copy.getNumActive() );
+}
+
+
+static Opm::DeckPtr createDVDEPTHZDeck(const std::string& depthz) {
+    const std::string deckData =
+        "RUNSPEC\n"
+        "\n"
+        "DIMENS\n"
+        " 4 3 2 /\n"
+        "GRID\n"
+        "DXV\n"
+        "1 2 3 4 /\n"
+        "DYV\n"
+        "1 2 3 /\n"
+        "DZV\n"
+        "5 10 /\n"
+        "DEPTHZ\n" + depthz + " /\n"
+        "EDIT\n"
+        "\n";
+
+    Opm::ParserPtr parser(new Opm::Parser());
+    return parser->parseString(deckData) ;
+}
+
+
+BOOST_AUTO_TEST_CASE(CellGeometry) {
+    {
+        Opm::EclipseGrid grid( createDVDEPTHZDeck( "20*100" ));
+        auto geometry = grid.getCellGeometry();
+        const double dxv[] = {1, 2, 3, 4};
+        const double dyv[] = {1, 2, 3};
+        const double dzv[] = {5, 10};
+
+        BOOST_CHECK_EQUAL( 24U , geometry->size() );
+        BOOST_CHECK( geometry == grid.getCellGeometry() );
+        for (size_t k = 0; k < 2; k++) {
+            for (size_t j = 0; j < 3; j++) {
+                for (size_t i = 0; i < 4; i++) {
+                    size_t g = i + j*4 + k*12;
+                    BOOST_CHECK_CLOSE( dxv[i]*dyv[j]*dzv[k] , geometry->getVolume()[g] , 1e-10 );
+                    BOOST_CHECK_CLOSE( dxv[i] , geometry->getDX()[g] , 1e-10 );
+                    BOOST_CHECK_CLOSE( dyv[j] , geometry->getDY()[g] , 1e-10 );
+                    BOOST_CHECK_CLOSE( dzv[k] , geometry->getDZ()[g] , 1e-10 );
+                    BOOST_CHECK_CLOSE( dyv[j]*dzv[k] , geometry->getFaceAreaX()[g] , 1e-10 );
+                    BOOST_CHECK_CLOSE( dxv[i]*dzv[k] , geometry->getFaceAreaY()[g] , 1e-10 );
+                    BOOST_CHECK_CLOSE( dxv[i]*dyv[j] , geometry->getFaceAreaZ()[g] , 1e-10 );
+                }
+            }
+        }
+        BOOST_CHECK_EQUAL( 102.5 , geometry->getDepth()[0] );
+        BOOST_CHECK_EQUAL( 110.0 , geometry->getDepth()[23] );
+    }
+
+    // a grid with sloping layers; the cached geometry agrees with the
+    // single cell queries of EclipseGrid.
+    {
+        std::string depthz;
+        for (int j = 0; j <= 3; j++)
+            for (int i = 0; i <= 4; i++)
+                depthz += " " + std::to_string(100 + i + 2*j);
+
+        // the depths are computed directly when the geometry has not
+        // been cached.
+        Opm::EclipseGrid grid( createDVDEPTHZDeck( depthz ));
+        std::vector<double> directDepths;
+        grid.exportCellDepths( directDepths );
+
+        auto geometry = grid.getCellGeometry();
+        BOOST_CHECK( directDepths == geometry->getDepth() );
+        for (size_t g = 0; g < 24; g++) {
+            auto center = grid.getCellCenter( g );
+            BOOST_CHECK_EQUAL( std::get<0>(center) , geometry->getCenterX()[g] );
+            BOOST_CHECK_EQUAL( std::get<1>(center) , geometry->getCenterY()[g] );
+            BOOST_CHECK_EQUAL( std::get<2>(center) , geometry->getDepth()[g] );
+            BOOST_CHECK_CLOSE( grid.getCellVolume( g ) , geometry->getVolume()[g] , 1e-10 );
+        }
+
+        std::vector<double> depths;
+        grid.exportCellDepths( depths );
+        BOOST_CHECK( depths == geometry->getDepth() );
+
+        std::vector<int> actnum( 24 , 0 );
+        actnum[5] = 1;
+        actnum[20] = 1;
+        grid.resetACTNUM( actnum.data() );
+        std::vector<double> activeVolume = grid.getActiveIndexMap()->compress( geometry->getVolume() );
+        BOOST_CHECK_EQUAL( 2U , activeVolume.size() );
+        BOOST_CHECK_EQUAL( geometry->getVolume()[20] , activeVolume[1] );
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(CellCenterMAPAXES) {
+    // a single cell [0,1]x[0,1]x[0,10]; the x axis of the grid points
+    // along the map y axis, and the y axis along the negative map x
+    // axis, with the origin at (100,200).
+    const char *deckData =
+        "RUNSPEC\n"
+        "\n"
+        "DIMENS\n"
+        " 1 1 1 /\n"
+        "GRID\n"
+        "MAPAXES\n"
+        " 99 200 100 200 100 203 /\n"
+        "COORD\n"
+        " 0 0 0 0 0 10\n"
+        " 1 0 0 1 0 10\n"
+        " 0 1 0 0 1 10\n"
+        " 1 1 0 1 1 10 /\n"
+        "ZCORN\n"
+        " 4*0 4*10 /\n"
+        "EDIT\n"
+        "\n";
+
+    Opm::ParserPtr parser(new Opm::Parser());
+    Opm::EclipseGrid grid( parser->parseString(deckData) );
+    auto center = grid.getCellCenter( 0 );
+    BOOST_CHECK_CLOSE( 99.5 , std::get<0>(center) , 1e-10 );
+    BOOST_CHECK_CLOSE( 200.5 , std::get<1>(center) , 1e-10 );
+    BOOST_CHECK_CLOSE( 5.0 , std::get<2>(center) , 1e-10 );
+
+    // the cached geometry is in grid coordinates.
+    auto geometry = grid.getCellGeometry();
+    BOOST_CHECK_CLOSE( 0.5 , geometry->getCenterX()[0] , 1e-10 );
+    BOOST_CHECK_CLOSE( 0.5 , geometry->getCenterY()[0] , 1e-10 );
+    BOOST_CHECK_CLOSE( 10.0 , geometry->getVolume()[0] , 1e-10 );
+}
+
+
 BOOST_AUTO_TEST_CASE(LoadFromBinary) {
     BOOST_CHECK_THROW(Opm::EclipseGrid( "No/does/not/exist" ) , std::invalid_argument);
 }
@@ -609,6 +882,181 @@ BOOST_AUTO_TEST_CASE(Fwrite) {
 }
 
 
+BOOST_AUTO_TEST_CASE(ReadEGRIDFile) {
+    std::string depthz;
+    for (int j = 0; j <= 3; j++)
+        for (int i = 0; i <= 4; i++)
+            depthz += " " + std::to_string(100 + i + 2*j);
+
+    Opm::EclipseGrid grid1( createDVDEPTHZDeck( depthz ));
+    std::vector<int> actnum( 24 , 1 );
+    actnum[3] = 0;
+    actnum[17] = 0;
+    grid1.resetACTNUM( actnum.data() );
+    grid1.fwriteEGRID( "TEST2.EGRID" );
+
+    BOOST_CHECK( Opm::EGRIDFile::isEGRIDFile( "TEST2.EGRID" ));
+    BOOST_CHECK( !Opm::EGRIDFile::isEGRIDFile( "No/does/not/exist" ));
+    BOOST_CHECK_THROW( Opm::EGRIDFile( "No/does/not/exist" ) , std::invalid_argument );
+
+    {
+        auto file = std::make_shared<const Opm::EGRIDFile>( "TEST2.EGRID" );
+        BOOST_CHECK_EQUAL( 4U , file->getNX() );
+        BOOST_CHECK_EQUAL( 3U , file->getNY() );
+        BOOST_CHECK_EQUAL( 2U , file->getNZ() );
+        BOOST_CHECK( file->hasKeyword( "ACTNUM" ));
+        BOOST_CHECK( !file->hasKeyword( "PORO" ));
+        BOOST_CHECK_EQUAL( 192U , file->getKeywordSize( "ZCORN" ));
+        BOOST_CHECK_THROW( file->getKeywordSize( "PORO" ) , std::invalid_argument );
+        BOOST_CHECK( *file->getACTNUM() == actnum );
+        BOOST_CHECK( file->getCOORD() == file->getCOORD() );
+
+        // ert stores the corner point data in single precision
+        const std::vector<double>& coord = grid1.getCOORD();
+        const std::vector<double>& zcorn = grid1.getZCORN();
+        auto fileCoord = file->getCOORD();
+        auto fileZcorn = file->getZCORN();
+        BOOST_CHECK_EQUAL( coord.size() , fileCoord->size() );
+        BOOST_CHECK_EQUAL( zcorn.size() , fileZcorn->size() );
+        for (size_t i = 0; i < coord.size(); i++)
+            BOOST_CHECK_EQUAL( static_cast<float>(coord[i]) , (*fileCoord)[i] );
+        for (size_t i = 0; i < zcorn.size(); i++)
+            BOOST_CHECK_EQUAL( static_cast<float>(zcorn[i]) , (*fileZcorn)[i] );
+
+        Opm::EclipseGrid grid2( file );
+        BOOST_CHECK_EQUAL( 22U , grid2.getNumActive() );
+        BOOST_CHECK_EQUAL( &grid2.getZCORN() , fileZcorn.get() );
+        BOOST_CHECK( grid1.equal( grid2 ));
+    }
+
+    Opm::EclipseGrid grid3( "TEST2.EGRID" );
+    BOOST_CHECK( grid1.equal( grid3 ));
+    for (size_t g = 0; g < 24; g++)
+        BOOST_CHECK_CLOSE( grid1.getCellVolume( g ) , grid3.getCellVolume( g ) , 1e-4 );
+
+    remove("TEST2.EGRID");
+}
+
+
+BOOST_AUTO_TEST_CASE(ReadTruncatedEGRIDFile) {
+    Opm::EclipseGrid grid( createDVDEPTHZDeck( "20*100" ));
+    grid.fwriteEGRID( "TEST3.EGRID" );
+
+    std::vector<char> content;
+    {
+        std::ifstream stream( "TEST3.EGRID" , std::ios::binary );
+        content.assign( std::istreambuf_iterator<char>( stream ) , std::istreambuf_iterator<char>() );
+    }
+    BOOST_CHECK_NO_THROW( Opm::EGRIDFile( "TEST3.EGRID" ));
+
+    // cut inside the first keyword header, inside a data record and
+    // just before the trailing marker of the last record.
+    const size_t lengths[] = { 10 , content.size() / 2 , content.size() - 2 };
+    for (size_t length : lengths) {
+        {
+            std::ofstream stream( "TEST3.EGRID" , std::ios::binary | std::ios::trunc );
+            stream.write( content.data() , length );
+        }
+        BOOST_CHECK_THROW( Opm::EGRIDFile( "TEST3.EGRID" ) , std::invalid_argument );
+    }
+
+    // a trailing record marker which does not match the leading one
+    std::vector<char> corrupt( content );
+    corrupt[ 4 + 16 + 3 ] ^= 1;
+    {
+        std::ofstream stream( "TEST3.EGRID" , std::ios::binary | std::ios::trunc );
+        stream.write( corrupt.data() , corrupt.size() );
+    }
+    BOOST_CHECK_THROW( Opm::EGRIDFile( "TEST3.EGRID" ) , std::invalid_argument );
+    remove("TEST3.EGRID");
+}
+
+
+// Appends a big endian 32 bit value, a record and a keyword to an
+// EGRID file in memory.
+static void appendInt(std::string& file , uint32_t value) {
+    for (int shift = 24; shift >= 0; shift -= 8)
+        file.push_back( static_cast<char>((value >> shift) & 0xFF ));
+}
+
+static void appendRecord(std::string& file , const std::string& data) {
+    appendInt( file , data.size() );
+    file += data;
+    appendInt( file , data.size() );
+}
+
+static void appendKeyword(std::string& file , const std::string& name , const std::string& type ,
+                          uint32_t size , const std::vector<std::string>& records) {
+    std::string header( name );
+    header.resize( 8 , ' ' );
+    appendInt( header , size );
+    header += type;
+    appendRecord( file , header );
+    for (const auto& record : records)
+        appendRecord( file , record );
+}
+
+static std::string intData(const std::vector<int>& values) {
+    std::string data;
+    for (int value : values)
+        appendInt( data , static_cast<uint32_t>(value) );
+    return data;
+}
+
+// A 1x1x1 grid with the given GRIDHEAD and extra ZCORN records; the
+// coordinates are all zero.
+static std::string createEGRID(const std::vector<int>& gridhead ,
+                               const std::vector<std::string>& zcornRecords ,
+                               const std::string& extraType = "INTE" , uint32_t extraSize = 0) {
+    std::string file;
+    appendKeyword( file , "FILEHEAD" , "INTE" , 1 , { intData( {3} ) });
+    appendKeyword( file , "GRIDHEAD" , "INTE" , gridhead.size() , { intData( gridhead ) });
+    appendKeyword( file , "COORD" , "REAL" , 24 , { std::string( 24*4 , '\0' ) });
+    appendKeyword( file , "ZCORN" , "REAL" , 8 , zcornRecords );
+    appendKeyword( file , "EXTRA" , extraType , extraSize , {} );
+    appendKeyword( file , "ENDGRID" , "INTE" , 0 , {} );
+    return file;
+}
+
+static void writeFile(const std::string& filename , const std::string& content) {
+    std::ofstream stream( filename.c_str() , std::ios::binary | std::ios::trunc );
+    stream.write( content.data() , content.size() );
+}
+
+
+BOOST_AUTO_TEST_CASE(ReadInvalidEGRIDFile) {
+    const std::string zcorn( 8*4 , '\0' );
+    writeFile( "TEST4.EGRID" , createEGRID( {1,1,1,1} , { zcorn } ));
+    {
+        Opm::EGRIDFile file( "TEST4.EGRID" );
+        BOOST_CHECK_EQUAL( 1U , file.getNZ() );
+        BOOST_CHECK_EQUAL( 8U , file.getZCORN()->size() );
+    }
+
+    // ZCORN split over two records is fine; records with more
+    // elements than the header are not.
+    writeFile( "TEST4.EGRID" , createEGRID( {1,1,1,1} , { zcorn.substr(0 , 12) , zcorn.substr(12) } ));
+    BOOST_CHECK_NO_THROW( Opm::EGRIDFile( "TEST4.EGRID" ));
+    writeFile( "TEST4.EGRID" , createEGRID( {1,1,1,1} , { zcorn + std::string( 4 , '\0' ) } ));
+    BOOST_CHECK_THROW( Opm::EGRIDFile( "TEST4.EGRID" ) , std::invalid_argument );
+    writeFile( "TEST4.EGRID" , createEGRID( {1,1,1,1} , { zcorn.substr(0 , 16) , zcorn } ));
+    BOOST_CHECK_THROW( Opm::EGRIDFile( "TEST4.EGRID" ) , std::invalid_argument );
+
+    // a MESS keyword has no data.
+    writeFile( "TEST4.EGRID" , createEGRID( {1,1,1,1} , { zcorn } , "MESS" , 0 ));
+    BOOST_CHECK_NO_THROW( Opm::EGRIDFile( "TEST4.EGRID" ));
+    writeFile( "TEST4.EGRID" , createEGRID( {1,1,1,1} , { zcorn } , "MESS" , 2 ));
+    BOOST_CHECK_THROW( Opm::EGRIDFile( "TEST4.EGRID" ) , std::invalid_argument );
+
+    // only corner point grids with positive dimensions.
+    writeFile( "TEST4.EGRID" , createEGRID( {2,1,1,1} , { zcorn } ));
+    BOOST_CHECK_THROW( Opm::EGRIDFile( "TEST4.EGRID" ) , std::invalid_argument );
+    writeFile( "TEST4.EGRID" , createEGRID( {1,1,0,1} , { zcorn } ));
+    BOOST_CHECK_THROW( Opm::EGRIDFile( "TEST4.EGRID" ) , std::invalid_argument );
+    writeFile( "TEST4.EGRID" , createEGRID( {1,1,1,-8} , { zcorn } ));
+    BOOST_CHECK_THROW( Opm::EGRIDFile( "TEST4.EGRID" ) , std::invalid_argument );
+    remove("TEST4.EGRID");
+}
 
 
 BOOST_AUTO_TEST_CASE(ConstructorNORUNSPEC) {
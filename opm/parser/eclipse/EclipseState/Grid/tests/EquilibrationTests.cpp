@@ -0,0 +1,256 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdexcept>
+#include <string>
+
+#define BOOST_TEST_MODULE EquilibrationTests
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+#include <opm/parser/eclipse/Parser/Parser.hpp>
+#include <opm/parser/eclipse/Deck/Deck.hpp>
+#include <opm/parser/eclipse/EclipseState/EclipseState.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/Equilibration.hpp>
+
+
+static const double gravity = 9.80665;
+static const double barsa = 1e5;
+
+/*
+  A column of 10 cells with a thickness of 10 m from 2000 m; the cell
+  centers are at 2005, 2015, ..., 2095 m.
+*/
+static Opm::DeckPtr createDeck(const std::string& phases , const std::string& props , const std::string& solution) {
+    const std::string deckData =
+        "RUNSPEC\n" + phases +
+        "DIMENS\n"
+        " 1 1 10 /\n"
+        "TABDIMS\n"
+        "/\n"
+        "EQLDIMS\n"
+        "/\n"
+        "GRID\n"
+        "DXV\n"
+        "100 /\n"
+        "DYV\n"
+        "100 /\n"
+        "DZV\n"
+        "10*10 /\n"
+        "DEPTHZ\n"
+        "4*2000 /\n"
+        "PORO\n"
+        "10*0.2 /\n"
+        "PROPS\n"
+        "DENSITY\n"
+        "800 1000 1 /\n"
+        "PVTW\n"
+        "200 1.0 0 0.5 0 /\n" + props +
+        "SOLUTION\n" + solution;
+
+    Opm::ParserPtr parser(new Opm::Parser());
+    return parser->parseString(deckData) ;
+}
+
+
+// Without PVDO the oil is incompressible, with the surface density.
+BOOST_AUTO_TEST_CASE(SharpOilWaterContact) {
+    Opm::DeckPtr deck = createDeck( "OIL\nWATER\n" ,
+                                    "SWOF\n"
+                                    "0.2 0 1 0\n"
+                                    "1.0 1 0 0 /\n" ,
+                                    "EQUIL\n"
+                                    "2000 200 2050 0 1000 0 /\n" );
+    Opm::EclipseState state( deck );
+    Opm::Equilibration equilibration( deck , state );
+
+    std::shared_ptr<const Opm::GridProperty<double> > pressure = equilibration.getPressure();
+    std::shared_ptr<const Opm::GridProperty<double> > swat = equilibration.getSwat();
+    BOOST_CHECK_EQUAL( "PRESSURE" , pressure->getKeywordName() );
+    for (size_t k = 0; k < 10; k++) {
+        const double z = 2005 + 10.0 * k;
+        BOOST_CHECK_CLOSE( 200 * barsa + 800 * gravity * (z - 2000) , pressure->iget( k ) , 1e-10 );
+        BOOST_CHECK_EQUAL( (z < 2050) ? 0.2 : 1.0 , swat->iget( k ));
+        BOOST_CHECK_EQUAL( 0.0 , equilibration.getSgas()->iget( k ));
+        BOOST_CHECK_EQUAL( 0.0 , equilibration.getRs()->iget( k ));
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(DatumInWaterZone) {
+    Opm::DeckPtr deck = createDeck( "OIL\nWATER\n" ,
+                                    "SWOF\n"
+                                    "0.2 0 1 0\n"
+                                    "1.0 1 0 0 /\n" ,
+                                    "EQUIL\n"
+                                    "2080 200 2050 0.5 1000 0 /\n" );
+    Opm::EclipseState state( deck );
+    Opm::Equilibration equilibration( deck , state );
+
+    // The oil pressure at the contact is the water pressure plus the
+    // capillary pressure of EQUIL.
+    const double owcPressure = 200 * barsa + 1000 * gravity * (2050 - 2080) + 0.5 * barsa;
+    for (size_t k = 0; k < 10; k++) {
+        const double z = 2005 + 10.0 * k;
+        BOOST_CHECK_CLOSE( owcPressure + 800 * gravity * (z - 2050) , equilibration.getPressure()->iget( k ) , 1e-10 );
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(CapillaryTransitionZone) {
+    // The capillary pressure is linear from 2 bar at Sw = 0.2 to 0 at Sw = 1.
+    Opm::DeckPtr deck = createDeck( "OIL\nWATER\n" ,
+                                    "SWOF\n"
+                                    "0.2 0 1 2\n"
+                                    "1.0 1 0 0 /\n" ,
+                                    "EQUIL\n"
+                                    "2000 200 2050 0 1000 0 /\n" );
+    Opm::EclipseState state( deck );
+    Opm::Equilibration equilibration( deck , state , 500 );
+
+    for (size_t k = 0; k < 10; k++) {
+        const double z = 2005 + 10.0 * k;
+        const double pcow = std::max( 0.0 , (1000 - 800) * gravity * (2050 - z) );
+        const double sw = std::max( 0.2 , 1 - 0.8 * pcow / (2 * barsa) );
+        BOOST_CHECK_CLOSE( sw , equilibration.getSwat()->iget( k ) , 1e-8 );
+    }
+}
+
+
+// A constant capillary pressure gives a sharp contact; a column which
+// is not monotonic is inverted even when its ends are equal.
+BOOST_AUTO_TEST_CASE(ConstantAndNonMonotonicPc) {
+    {
+        Opm::DeckPtr deck = createDeck( "OIL\nWATER\n" ,
+                                        "SWOF\n"
+                                        "0.2 0 1 0.5\n"
+                                        "0.6 0.5 0.5 0.5\n"
+                                        "1.0 1 0 0.5 /\n" ,
+                                        "EQUIL\n"
+                                        "2000 200 2050 0 1000 0 /\n" );
+        Opm::EclipseState state( deck );
+        Opm::Equilibration equilibration( deck , state );
+        for (size_t k = 0; k < 10; k++) {
+            const double z = 2005 + 10.0 * k;
+            BOOST_CHECK_EQUAL( (z < 2050) ? 0.2 : 1.0 , equilibration.getSwat()->iget( k ));
+        }
+
+        // the default regions are not created in the state
+        BOOST_CHECK( !state.hasIntGridProperty("EQLNUM") );
+        BOOST_CHECK( !state.hasIntGridProperty("PVTNUM") );
+        BOOST_CHECK( !state.hasIntGridProperty("SATNUM") );
+    }
+
+    {
+        Opm::DeckPtr deck = createDeck( "OIL\nWATER\n" ,
+                                        "SWOF\n"
+                                        "0.2 0 1 0\n"
+                                        "0.6 0.5 0.5 2\n"
+                                        "1.0 1 0 0 /\n" ,
+                                        "EQUIL\n"
+                                        "2000 200 2050 0 1000 0 /\n" );
+        Opm::EclipseState state( deck );
+        Opm::Equilibration equilibration( deck , state , 500 );
+        for (size_t k = 0; k < 5; k++) {
+            const double z = 2005 + 10.0 * k;
+            const double pcow = (1000 - 800) * gravity * (2050 - z);
+            BOOST_CHECK_CLOSE( 0.2 + 0.4 * pcow / (2 * barsa) , equilibration.getSwat()->iget( k ) , 1e-8 );
+        }
+    }
+}
+
+
+static const std::string gasCapProps =
+    "PVTO\n"
+    " 50 100 1.2 1.0\n"
+    "    300 1.15 1.1 /\n"
+    " 150 300 1.4 0.8\n"
+    "    400 1.35 0.9 /\n"
+    "/\n"
+    "PVDG\n"
+    "100 0.01 0.02\n"
+    "300 0.004 0.03 /\n"
+    "SWOF\n"
+    "0.2 0 1 0\n"
+    "1.0 1 0 0 /\n"
+    "SGOF\n"
+    "0.0 0 1 0\n"
+    "0.8 1 0 0 /\n";
+
+static const std::string gasCapSolution =
+    "EQUIL\n"
+    "2020 200 2050 0 2020 0 /\n"
+    "RSVD\n"
+    "2000 60\n"
+    "2100 80 /\n";
+
+
+BOOST_AUTO_TEST_CASE(LiveOilWithGasCap) {
+    Opm::DeckPtr deck = createDeck( "OIL\nWATER\nGAS\nDISGAS\n" , gasCapProps , gasCapSolution );
+    Opm::EclipseState state( deck );
+    Opm::Equilibration equilibration( deck , state );
+
+    std::shared_ptr<const Opm::GridProperty<double> > swat = equilibration.getSwat();
+    std::shared_ptr<const Opm::GridProperty<double> > sgas = equilibration.getSgas();
+    std::shared_ptr<const Opm::GridProperty<double> > rs = equilibration.getRs();
+    for (size_t k = 0; k < 10; k++) {
+        const double z = 2005 + 10.0 * k;
+        BOOST_CHECK_EQUAL( (z < 2020) ? 0.8 : 0.0 , sgas->iget( k ));
+        BOOST_CHECK_EQUAL( (z < 2050) ? 0.2 : 1.0 , swat->iget( k ));
+        BOOST_CHECK_CLOSE( 60 + 0.2 * (z - 2000) , rs->iget( k ) , 1e-10 );
+    }
+
+    // The datum is at the contact, i.e. in the oil zone; the oil
+    // density at 2012.5 m, with Bo interpolated in Rs.
+    const double bo = 1.2 + 0.2 * (62.5 - 50) / 100;
+    const double oilDensity = (800 + 62.5 * 1) / bo;
+    BOOST_CHECK_CLOSE( 200 * barsa - oilDensity * gravity * 15 , equilibration.getPressure()->iget( 0 ) , 1e-4 );
+}
+
+
+// Without DISGAS the oil is dead, and PVTO and RSVD do not apply.
+BOOST_AUTO_TEST_CASE(GasCapWithoutDisgas) {
+    Opm::DeckPtr deck = createDeck( "OIL\nWATER\nGAS\n" , gasCapProps , gasCapSolution );
+    Opm::EclipseState state( deck );
+    BOOST_CHECK( !state.hasDissolvedGas() );
+    Opm::Equilibration equilibration( deck , state );
+
+    std::shared_ptr<const Opm::GridProperty<double> > sgas = equilibration.getSgas();
+    std::shared_ptr<const Opm::GridProperty<double> > rs = equilibration.getRs();
+    for (size_t k = 0; k < 10; k++) {
+        const double z = 2005 + 10.0 * k;
+        BOOST_CHECK_EQUAL( (z < 2020) ? 0.8 : 0.0 , sgas->iget( k ));
+        BOOST_CHECK_EQUAL( 0.0 , rs->iget( k ));
+    }
+    BOOST_CHECK_CLOSE( 200 * barsa - 800 * gravity * 15 , equilibration.getPressure()->iget( 0 ) , 1e-4 );
+}
+
+
+BOOST_AUTO_TEST_CASE(MissingEquil) {
+    Opm::DeckPtr deck = createDeck( "OIL\nWATER\n" , "" , "" );
+    Opm::EclipseState state( deck );
+    BOOST_CHECK_THROW( Opm::Equilibration( deck , state ) , std::invalid_argument );
+
+    std::vector<Opm::Equilibration::EquilRecord> equil( 1 );
+    equil[0] = Opm::Equilibration::EquilRecord{ 2000 , 200 * barsa , 2050 , 0 , 1000 , 0 };
+    BOOST_CHECK_THROW( Opm::Equilibration( state , equil , Opm::Equilibration::readPvtParameters( deck ) , 1 ) , std::invalid_argument );
+
+    Opm::Equilibration equilibration( state , equil , Opm::Equilibration::readPvtParameters( deck ));
+    BOOST_CHECK_CLOSE( 200 * barsa + 800 * gravity * 5 , equilibration.getPressure()->iget( 0 ) , 1e-10 );
+}
@@ -18,6 +18,8 @@
  */
 
 #include <stdexcept>
+#include <algorithm>
+#include <iterator>
 #include <iostream>
 #include <boost/filesystem.hpp>
 
@@ -76,6 +78,35 @@ BOOST_AUTO_TEST_CASE(CreateFace) {
 }
 
 
+BOOST_AUTO_TEST_CASE(FaceRange) {
+    Opm::FaultFace face(4,5,6 , 2 , 2 , 1 , 3 , 2 , 5 , Opm::FaceDir::XMinus);
+    BOOST_CHECK_EQUAL( 12U , face.size() );
+    BOOST_CHECK_EQUAL( 2U , face.getI1() );
+    BOOST_CHECK_EQUAL( 3U , face.getJ2() );
+    BOOST_CHECK_EQUAL( 5U , face.getK2() );
+
+    std::vector<size_t> indices;
+    for (auto iter = face.begin(); iter != face.end(); ++iter)
+        indices.push_back( *iter );
+
+    std::vector<size_t> expected;
+    for (size_t k = 2; k <= 5; k++)
+        for (size_t j = 1; j <= 3; j++)
+            expected.push_back( 2 + j*4 + k*20 );
+
+    BOOST_CHECK( indices == expected );
+
+    // the iterator works with the standard algorithms
+    BOOST_CHECK( std::vector<size_t>( face.begin() , face.end() ) == expected );
+    BOOST_CHECK_EQUAL( 12 , std::distance( face.begin() , face.end() ));
+    BOOST_CHECK_EQUAL( 1U , std::count( face.begin() , face.end() , 2 + 4 + 40 ));
+
+    auto iter = face.begin();
+    BOOST_CHECK_EQUAL( expected[0] , *iter++ );
+    BOOST_CHECK_EQUAL( expected[1] , *iter );
+}
+
+
 BOOST_AUTO_TEST_CASE(CreateFault) {
     Opm::Fault fault("FAULT1");
     BOOST_CHECK_EQUAL( "FAULT1" , fault.getName());
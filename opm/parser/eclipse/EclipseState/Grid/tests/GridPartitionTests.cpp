@@ -0,0 +1,202 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <iostream>
+#include <boost/filesystem.hpp>
+
+#define BOOST_TEST_MODULE GridPartitionTests
+#include <boost/test/unit_test.hpp>
+
+#include <opm/parser/eclipse/Parser/Parser.hpp>
+#include <opm/parser/eclipse/Deck/Deck.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/GridPartition.hpp>
+#include <opm/parser/eclipse/EclipseState/Schedule/Schedule.hpp>
+
+
+static Opm::DeckPtr createDeck(size_t nx , size_t ny , size_t nz) {
+    std::ostringstream deckData;
+    deckData << "RUNSPEC\n"
+             << "DIMENS\n"
+             << " " << nx << " " << ny << " " << nz << " /\n"
+             << "GRID\n"
+             << "DXV\n" << nx << "*10 /\n"
+             << "DYV\n" << ny << "*10 /\n"
+             << "DZV\n" << nz << "*1 /\n"
+             << "DEPTHZ\n" << (nx + 1)*(ny + 1) << "*1000 /\n"
+             << "EDIT\n"
+             << "\n"
+             << "START\n"
+             << "10 MAI 2007 /\n"
+             << "SCHEDULE\n"
+             << "WELSPECS\n"
+             << "     'W_1'        'OP'   2   2  1*       'OIL'  7* /\n"
+             << "     'W_2'        'OP'   9   9  1*       'OIL'  7* /\n"
+             << "/\n"
+             << "COMPDAT\n"
+             << "     'W_1'   2   2    1    1      'OPEN'  1*     32.948      0.311   3047.839  2*         'X'     22.100 /\n"
+             << "     'W_1'   6   2    1    1      'OPEN'  1*     32.948      0.311   3047.839  2*         'X'     22.100 /\n"
+             << "     'W_2'   9   9    1    1      'OPEN'  1*     32.948      0.311   3047.839  2*         'X'     22.100 /\n"
+             << "/\n"
+             << "TSTEP\n"
+             << "10 /\n";
+
+    Opm::ParserPtr parser(new Opm::Parser());
+    return parser->parseString( deckData.str() );
+}
+
+
+BOOST_AUTO_TEST_CASE(Bisection) {
+    Opm::DeckPtr deck = createDeck( 10 , 10 , 1 );
+    Opm::EclipseGrid grid( deck );
+    BOOST_CHECK_THROW( Opm::GridPartition( grid , 0 ) , std::invalid_argument );
+
+    std::shared_ptr<const Opm::GridPartition> partition = std::make_shared<const Opm::GridPartition>( grid , 4 );
+    BOOST_CHECK_EQUAL( 4U , partition->numPartitions() );
+
+    // The grid is split in x, then both halves in y.
+    const std::vector<int>& owner = partition->getOwner();
+    for (size_t j = 0; j < 10; j++) {
+        for (size_t i = 0; i < 10; i++) {
+            const int expected = (i < 5 ? 0 : 2) + (j < 5 ? 0 : 1);
+            BOOST_CHECK_EQUAL( expected , owner[i + j*10] );
+        }
+    }
+
+    for (size_t p = 0; p < 4; p++) {
+        BOOST_CHECK_EQUAL( 25U , partition->numOwnedCells( p ));
+        BOOST_CHECK_EQUAL( 25U , partition->numCells( p ));
+    }
+    BOOST_CHECK_THROW( partition->numCells( 4 ) , std::invalid_argument );
+
+    // Uneven number of partitions
+    Opm::GridPartition three( grid , 3 );
+    size_t total = 0;
+    for (size_t p = 0; p < 3; p++) {
+        BOOST_CHECK( three.numOwnedCells( p ) >= 33U );
+        total += three.numOwnedCells( p );
+    }
+    BOOST_CHECK_EQUAL( 100U , total );
+}
+
+
+BOOST_AUTO_TEST_CASE(OverlapLayers) {
+    Opm::DeckPtr deck = createDeck( 10 , 10 , 1 );
+    Opm::EclipseGrid grid( deck );
+    Opm::GridPartition partition( grid , 4 , 1 );
+
+    // The block 0 <= i, j < 5 gets the row j = 5 and the column i = 5.
+    BOOST_CHECK_EQUAL( 25U , partition.numOwnedCells( 0 ));
+    BOOST_CHECK_EQUAL( 35U , partition.numCells( 0 ));
+    const std::vector<size_t> cells = partition.getCells( 0 );
+    BOOST_CHECK( std::is_sorted( cells.begin() , cells.end() ));
+    BOOST_CHECK( std::binary_search( cells.begin() , cells.end() , size_t(5 + 4*10) ));
+    BOOST_CHECK( std::binary_search( cells.begin() , cells.end() , size_t(4 + 5*10) ));
+    BOOST_CHECK( !std::binary_search( cells.begin() , cells.end() , size_t(5 + 5*10) ));
+
+    Opm::GridPartition twoLayers( grid , 4 , 2 );
+    // 25 + 2*5 + 2*5 + the diagonal cell (5,5)
+    BOOST_CHECK_EQUAL( 46U , twoLayers.numCells( 0 ));
+}
+
+
+BOOST_AUTO_TEST_CASE(ExtractData) {
+    Opm::DeckPtr deck = createDeck( 10 , 10 , 1 );
+    Opm::EclipseGrid grid( deck );
+    Opm::GridPartition partition( grid , 4 , 1 );
+
+    typedef Opm::GridPropertySupportedKeywordInfo<double> SupportedKeywordInfo;
+    Opm::GridProperty<double> poro( 10 , 10 , 1 , SupportedKeywordInfo( "PORO" , 0.25 , "1" ));
+    const std::vector<double> constant = partition.extract( poro , 3 );
+    BOOST_CHECK_EQUAL( partition.numCells( 3 ) , constant.size() );
+    BOOST_CHECK( std::all_of( constant.begin() , constant.end() , [](double value) { return value == 0.25; } ));
+
+    std::shared_ptr<Opm::GridProperty<double> > multx = std::make_shared<Opm::GridProperty<double> >( 10 , 10 , 1 , SupportedKeywordInfo( "MULTX" , 1.0 , "1" ));
+    multx->setScalar( 0.5 , std::make_shared<const Opm::Box>( Opm::Box( 10 , 10 , 1 ) , 4 , 4 , 0 , 9 , 0 , 0 ));
+    const std::vector<double> values = partition.extract( *multx , 0 );
+    const std::vector<size_t> cells = partition.getCells( 0 );
+    for (size_t n = 0; n < cells.size(); n++)
+        BOOST_CHECK_EQUAL( (cells[n] % 10 == 4) ? 0.5 : 1.0 , values[n] );
+
+    Opm::TransMult transMult( 10 , 10 , 1 );
+    transMult.applyMULT( multx , Opm::FaceDir::XPlus );
+    std::vector<double> multipliers;
+    partition.extractTransMult( transMult , 0 , Opm::FaceDir::XPlus , multipliers );
+    BOOST_CHECK( values == multipliers );
+
+    Opm::GridProperty<double> other( 10 , 10 , 2 , SupportedKeywordInfo( "PORO" , 0.25 , "1" ));
+    BOOST_CHECK_THROW( partition.extract( other , 0 ) , std::invalid_argument );
+}
+
+
+BOOST_AUTO_TEST_CASE(ExtractCompletions) {
+    Opm::DeckPtr deck = createDeck( 10 , 10 , 1 );
+    Opm::EclipseGrid grid( deck );
+    Opm::Schedule schedule( deck );
+    Opm::GridPartition partition( grid , 4 , 1 );
+
+    // W_1 is completed in (1,1) and (5,1), W_2 in (8,8)
+    auto completions = partition.extractCompletions( schedule , 0 , 1 );
+    BOOST_CHECK_EQUAL( 1U , completions.size() );
+    BOOST_CHECK_EQUAL( "W_1" , completions[0].first->name() );
+    BOOST_CHECK_EQUAL( 1 , completions[0].second->getI() );
+
+    completions = partition.extractCompletions( schedule , 2 , 1 );
+    BOOST_CHECK_EQUAL( 1U , completions.size() );
+    BOOST_CHECK_EQUAL( 5 , completions[0].second->getI() );
+
+    completions = partition.extractCompletions( schedule , 3 , 1 );
+    BOOST_CHECK_EQUAL( 1U , completions.size() );
+    BOOST_CHECK_EQUAL( "W_2" , completions[0].first->name() );
+
+    BOOST_CHECK_EQUAL( 0U , partition.extractCompletions( schedule , 1 , 1 ).size() );
+}
+
+
+BOOST_AUTO_TEST_CASE(LargeGridWithAdjacency) {
+    // Large enough for the parallel code path
+    Opm::DeckPtr deck = createDeck( 50 , 40 , 40 );
+    Opm::EclipseGrid grid( deck );
+    Opm::GridPartition partition( grid , 7 , 1 );
+
+    std::vector<size_t> owned( 7 , 0 );
+    const std::vector<int>& owner = partition.getOwner();
+    for (size_t g = 0; g < owner.size(); g++) {
+        BOOST_REQUIRE( owner[g] >= 0 && owner[g] < 7 );
+        owned[owner[g]]++;
+    }
+    for (size_t p = 0; p < 7; p++) {
+        BOOST_CHECK_EQUAL( owned[p] , partition.numOwnedCells( p ));
+        BOOST_CHECK( owned[p] >= 80000U / 7 - 1 && owned[p] <= 80000U / 7 + 1 );
+    }
+
+    // The graph of a Cartesian grid gives the same overlap as the face neighbours.
+    Opm::TransMult transMult( 50 , 40 , 40 );
+    Opm::GridPropertyView<double> perm( grid.getCartesianSize() , 1.0 );
+    std::vector<int> actnum;
+    grid.exportACTNUM( actnum );
+    Opm::Transmissibility trans( 50 , 40 , 40 , grid.getCOORD() , grid.getZCORN() , actnum , perm , perm , perm , perm , transMult );
+    Opm::CellAdjacency adjacency( *grid.getActiveIndexMap() , trans );
+    Opm::GridPartition graphPartition( grid , adjacency , 7 , 1 );
+    BOOST_CHECK( owner == graphPartition.getOwner() );
+    for (size_t p = 0; p < 7; p++)
+        BOOST_CHECK( partition.getCells( p ) == graphPartition.getCells( p ));
+}
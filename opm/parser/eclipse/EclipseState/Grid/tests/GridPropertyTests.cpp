@@ -351,5 +351,455 @@ BOOST_AUTO_TEST_CASE(GridPropertyInitializers) {
     BOOST_CHECK_EQUAL(sguPropData[0 * 3*3], 0.9);
     BOOST_CHECK_EQUAL(sguPropData[1 * 3*3], 0.85);
     BOOST_CHECK_EQUAL(sguPropData[2 * 3*3], 0.80);
+
+    // endpoint properties created after SATNUM has been modified use
+    // the new table numbers.
+    std::shared_ptr<Opm::Box> globalBox = std::make_shared<Opm::Box>(3 , 3 , 3);
+    eclipseState->getIntGridProperty("SATNUM")->setScalar(3 , globalBox);
+    const auto& swlPropData = eclipseState->getDoubleGridProperty("SWL")->getData();
+    BOOST_CHECK_EQUAL(swlPropData[0 * 3*3], 0.00);
+    BOOST_CHECK_EQUAL(swlPropData[1 * 3*3], 0.00);
+    BOOST_CHECK_EQUAL(swlPropData[2 * 3*3], 0.00);
 }
 
+
+
+BOOST_AUTO_TEST_CASE(EndpointDepthTablesUseENDNUM) {
+    const char *deckString =
+        "RUNSPEC\n"
+        "\n"
+        "TABDIMS\n"
+        "2 /\n"
+        "\n"
+        "ENDSCALE\n"
+        "NODIR REVERS 2 /\n"
+        "\n"
+        "METRIC\n"
+        "\n"
+        "DIMENS\n"
+        "3 3 3 /\n"
+        "\n"
+        "GRID\n"
+        "\n"
+        "DXV\n"
+        "1 1 1 /\n"
+        "\n"
+        "DYV\n"
+        "1 1 1 /\n"
+        "\n"
+        "DZV\n"
+        "1 1 1 /\n"
+        "\n"
+        "TOPS\n"
+        "9*100 /\n"
+        "\n"
+        "PROPS\n"
+        "\n"
+        "SWOF\n"
+        "  0.1    0        1.0      2.0\n"
+        "  0.93   0.91     0.0      0.0\n"
+        "/\n"
+        "  0.05   0.01     1.0      2.0\n"
+        "  0.852  1.00     0.0      0.0\n"
+        "/\n"
+        "\n"
+        "SGOF\n"
+        "  0.00   0.01     0.9      2.0\n"
+        "  0.80   1.00     0.0      0.0\n"
+        "/\n"
+        "  0.05   0.01     1.0      2\n"
+        "  0.85   1.00     0.0      0\n"
+        "/\n"
+        "\n"
+        "ENPTVD\n"
+        // depth  swco  swcrit swmax sgco sgcrit sgmax sowcrit sogcrit
+        "  100    0.1   0.2    1.0   0.0  0.05   0.9   0.2     0.2\n"
+        "  103    0.4   0.5    1.0   0.0  0.05   0.9   0.2     0.2\n"
+        "/\n"
+        "  100    0.2   0.2    1.0   0.0  0.05   0.9   0.2     0.2\n"
+        "  103    0.2   0.2    1.0   0.0  0.05   0.9   0.2     0.2\n"
+        "/\n"
+        "\n"
+        "SWL\n"
+        "* /\n"
+        "\n"
+        "ISWL\n"
+        "* /\n"
+        "\n"
+        "REGIONS\n"
+        "\n"
+        "SATNUM\n"
+        "9*2 9*1 9*2 /\n"
+        "\n"
+        "ENDNUM\n"
+        "18*1 9*2 /\n"
+        "\n"
+        "SOLUTION\n"
+        "\n"
+        "SCHEDULE\n";
+
+    Opm::ParserPtr parser(new Opm::Parser);
+    auto deck = parser->parseString(deckString);
+    auto eclipseState = std::make_shared<Opm::EclipseState>(deck);
+
+    // the ENPTVD table is selected by ENDNUM and evaluated at the cell depth.
+    const auto& swlPropData = eclipseState->getDoubleGridProperty("SWL")->getData();
+    BOOST_CHECK_CLOSE(swlPropData[0 * 3*3], 0.15, 1e-8);
+    BOOST_CHECK_CLOSE(swlPropData[1 * 3*3], 0.25, 1e-8);
+    BOOST_CHECK_CLOSE(swlPropData[2 * 3*3], 0.2, 1e-8);
+
+    // without IMPTVD the imbibition values come from the SATNUM tables.
+    const auto& iswlPropData = eclipseState->getDoubleGridProperty("ISWL")->getData();
+    BOOST_CHECK_EQUAL(iswlPropData[0 * 3*3], 0.05);
+    BOOST_CHECK_EQUAL(iswlPropData[1 * 3*3], 0.1);
+    BOOST_CHECK_EQUAL(iswlPropData[2 * 3*3], 0.05);
+
+    // the cells of the ENDNUM tables follow changes to ENDNUM.
+    std::shared_ptr<Opm::Box> globalBox = std::make_shared<Opm::Box>(3 , 3 , 3);
+    eclipseState->getIntGridProperty("ENDNUM")->setScalar(2 , globalBox);
+    const auto& swcrPropData = eclipseState->getDoubleGridProperty("SWCR")->getData();
+    BOOST_CHECK_CLOSE(swcrPropData[0 * 3*3], 0.2, 1e-8);
+    BOOST_CHECK_CLOSE(swcrPropData[1 * 3*3], 0.2, 1e-8);
+    BOOST_CHECK_CLOSE(swcrPropData[2 * 3*3], 0.2, 1e-8);
+
+    // too few depth tables for ENDNUM
+    eclipseState->getIntGridProperty("ENDNUM")->setScalar(3 , globalBox);
+    BOOST_CHECK_THROW(eclipseState->getDoubleGridProperty("SOWCR"), std::invalid_argument);
+}
+
+
+BOOST_AUTO_TEST_CASE(LargeBoxOperatorsMatchScalar) {
+    // Large enough to be processed in parallel blocks.
+    const size_t nx = 130, ny = 40, nz = 30;
+    typedef Opm::GridProperty<double>::SupportedKeywordInfo SupportedKeywordInfo;
+    SupportedKeywordInfo keywordInfo1("P1" , 0.1, "1");
+    SupportedKeywordInfo keywordInfo2("P2" , 0.7, "1");
+    Opm::GridProperty<double> prop1( nx , ny , nz , keywordInfo1 );
+    Opm::GridProperty<double> prop2( nx , ny , nz , keywordInfo2 );
+
+    std::shared_ptr<Opm::Box> globalBox = std::make_shared<Opm::Box>(nx , ny , nz);
+    std::vector<std::shared_ptr<Opm::Box> > boxes =
+        { globalBox ,
+          std::make_shared<Opm::Box>(*globalBox , 0 , nx - 1 , 3 , 37 , 1 , 28) ,
+          std::make_shared<Opm::Box>(*globalBox , 1 , 128 , 0 , ny - 1 , 0 , nz - 1) };
+
+    std::vector<double> expected( prop1.getData() );
+    for (size_t b = 0; b < boxes.size(); b++) {
+        const std::vector<size_t> indexList = boxes[b]->getIndexList();
+
+        prop1.scale( 1.0 / 3 , boxes[b] );
+        for (size_t i = 0; i < indexList.size(); i++)
+            expected[indexList[i]] *= 1.0 / 3;
+
+        prop1.add( 0.123 , boxes[b] );
+        for (size_t i = 0; i < indexList.size(); i++)
+            expected[indexList[i]] += 0.123;
+
+        const std::vector<double>& data = prop1.getData();
+        for (size_t g = 0; g < data.size(); g++)
+            BOOST_REQUIRE_EQUAL( data[g] , expected[g] );
+    }
+
+    prop1.copyFrom( prop2 , boxes[1] );
+    prop1.setScalar( 2.5 , boxes[2] );
+    {
+        const std::vector<double>& data = prop1.getData();
+        const std::vector<size_t> copyList = boxes[1]->getIndexList();
+        const std::vector<size_t> setList = boxes[2]->getIndexList();
+        for (size_t i = 0; i < copyList.size(); i++)
+            expected[copyList[i]] = 0.7;
+        for (size_t i = 0; i < setList.size(); i++)
+            expected[setList[i]] = 2.5;
+
+        for (size_t g = 0; g < data.size(); g++)
+            BOOST_REQUIRE_EQUAL( data[g] , expected[g] );
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(DeferredEditsMatchSequential) {
+    typedef Opm::GridProperty<double>::SupportedKeywordInfo SupportedKeywordInfo;
+    SupportedKeywordInfo keywordInfo("P" , 0.25, "1");
+    Opm::GridProperty<double> immediate( 10 , 10 , 10 , keywordInfo );
+    Opm::GridProperty<double> deferred( 10 , 10 , 10 , keywordInfo );
+    Opm::GridProperty<double> source( 10 , 10 , 10 , SupportedKeywordInfo("S" , 3.0 , "1"));
+    deferred.setDeferredEdits( true );
+
+    std::shared_ptr<Opm::Box> globalBox = std::make_shared<Opm::Box>(10 , 10 , 10);
+    std::shared_ptr<Opm::Box> box1 = std::make_shared<Opm::Box>(*globalBox , 1 , 5 , 0 , 9 , 2 , 3);
+    std::shared_ptr<Opm::Box> box2 = std::make_shared<Opm::Box>(*globalBox , 1 , 5 , 0 , 9 , 2 , 3);
+    std::shared_ptr<Opm::Box> box3 = std::make_shared<Opm::Box>(*globalBox , 0 , 9 , 0 , 9 , 0 , 4);
+
+    for (int pass = 0; pass < 2; pass++) {
+        Opm::GridProperty<double>& prop = (pass == 0) ? immediate : deferred;
+        prop.scale( 1.0 / 3 , globalBox );
+        prop.add( 0.1 , box1 );
+        prop.scale( 7.0 , box2 );
+        prop.setScalar( 0.3 , box3 );
+        prop.scale( 1.0 / 7 , box3 );
+        prop.add( 0.2 , box3 );
+        prop.copyFrom( source , box1 );
+        prop.scale( 0.9 , box1 );
+        prop.add( 1.0 / 3 , globalBox );
+    }
+
+    BOOST_CHECK( deferred.hasPendingEdits() );
+    {
+        const std::vector<double>& data1 = immediate.getData();
+        const std::vector<double>& data2 = deferred.getData();
+        BOOST_CHECK( !deferred.hasPendingEdits() );
+        for (size_t g = 0; g < data1.size(); g++)
+            BOOST_CHECK_EQUAL( data1[g] , data2[g] );
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(EditProgramFusesOperations) {
+    typedef Opm::GridPropertyEditProgram<int>::Operation Operation;
+    Opm::GridPropertyEditProgram<int> program;
+    std::shared_ptr<Opm::Box> globalBox = std::make_shared<Opm::Box>(4 , 4 , 2);
+    std::shared_ptr<Opm::Box> subBox1 = std::make_shared<Opm::Box>(*globalBox , 0 , 1 , 0 , 1 , 0 , 1);
+    std::shared_ptr<Opm::Box> subBox2 = std::make_shared<Opm::Box>(*globalBox , 0 , 1 , 0 , 1 , 0 , 1);
+    std::vector<int> data( 32 , 1 );
+
+    BOOST_CHECK( program.empty() );
+    program.addOperation( globalBox , Operation( Operation::Scale , 3 ));
+    program.addOperation( globalBox , Operation( Operation::Add , 2 ));
+    program.addOperation( subBox1 , Operation( Operation::Add , 1 ));
+    program.addOperation( subBox2 , Operation( Operation::SetScalar , 4 ));
+    program.addOperation( subBox2 , Operation( Operation::Scale , 2 ));
+    BOOST_CHECK_EQUAL( 2U , program.numPasses() );
+
+    program.evaluate( data.data() );
+    BOOST_CHECK( program.empty() );
+    for (size_t k = 0; k < 2; k++) {
+        for (size_t j = 0; j < 4; j++) {
+            for (size_t i = 0; i < 4; i++) {
+                size_t g = i + j*4 + k*16;
+                if (i < 2 && j < 2)
+                    BOOST_CHECK_EQUAL( 8 , data[g] );
+                else
+                    BOOST_CHECK_EQUAL( 5 , data[g] );
+            }
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(ConstantStorage) {
+    typedef Opm::GridProperty<double>::SupportedKeywordInfo SupportedKeywordInfo;
+    Opm::GridProperty<double> prop( 4 , 4 , 2 , SupportedKeywordInfo("P" , 2.0 , "1"));
+    std::shared_ptr<Opm::Box> globalBox = std::make_shared<Opm::Box>(4 , 4 , 2);
+    std::shared_ptr<Opm::Box> subBox = std::make_shared<Opm::Box>(*globalBox , 0 , 1 , 0 , 1 , 0 , 1);
+
+    BOOST_CHECK( prop.isConstant() );
+    prop.scale( 3.0 , globalBox );
+    prop.add( 1.0 , globalBox );
+    BOOST_CHECK( prop.isConstant() );
+    BOOST_CHECK_EQUAL( 7.0 , prop.iget( 31 ));
+
+    prop.add( 1.0 , subBox );
+    BOOST_CHECK( !prop.isConstant() );
+    BOOST_CHECK_EQUAL( 8.0 , prop.iget( 0 ));
+    BOOST_CHECK_EQUAL( 7.0 , prop.iget( 31 ));
+
+    prop.setScalar( 5.0 , globalBox );
+    BOOST_CHECK( prop.isConstant() );
+    BOOST_CHECK_EQUAL( 5.0 , prop.iget( 0 ));
+
+    // deferred edits on the full grid are evaluated on the constant.
+    prop.setDeferredEdits( true );
+    prop.scale( 2.0 , globalBox );
+    BOOST_CHECK( prop.isConstant() );
+    BOOST_CHECK_EQUAL( 10.0 , prop.iget( 0 ));
+
+    const std::vector<double>& data = prop.getData();
+    BOOST_CHECK_EQUAL( 32U , data.size() );
+    BOOST_CHECK_EQUAL( 10.0 , data[17] );
+}
+
+
+BOOST_AUTO_TEST_CASE(CopyOnWriteStorage) {
+    typedef Opm::GridProperty<int>::SupportedKeywordInfo SupportedKeywordInfo;
+    Opm::GridProperty<int> prop1( 4 , 4 , 2 , SupportedKeywordInfo("P1" , 1 , "1"));
+    Opm::GridProperty<int> prop2( 4 , 4 , 2 , SupportedKeywordInfo("P2" , 9 , "1"));
+    std::shared_ptr<Opm::Box> globalBox = std::make_shared<Opm::Box>(4 , 4 , 2);
+    std::shared_ptr<Opm::Box> subBox = std::make_shared<Opm::Box>(*globalBox , 0 , 1 , 0 , 1 , 0 , 1);
+
+    prop1.add( 1 , subBox );
+    prop2.copyFrom( prop1 , globalBox );
+    BOOST_CHECK( prop2.sharesData( prop1 ));
+    BOOST_CHECK_EQUAL( 2 , prop2.iget( 0 ));
+
+    prop2.scale( 10 , globalBox );
+    BOOST_CHECK( !prop2.sharesData( prop1 ));
+    BOOST_CHECK_EQUAL( 2 , prop1.iget( 0 ));
+    BOOST_CHECK_EQUAL( 1 , prop1.iget( 31 ));
+    BOOST_CHECK_EQUAL( 20 , prop2.iget( 0 ));
+    BOOST_CHECK_EQUAL( 10 , prop2.iget( 31 ));
+
+    prop1.multiplyWith( prop2 );
+    BOOST_CHECK_EQUAL( 40 , prop1.iget( 0 ));
+    BOOST_CHECK_EQUAL( 10 , prop1.iget( 31 ));
+    BOOST_CHECK_EQUAL( 20 , prop2.iget( 0 ));
+}
+
+
+BOOST_AUTO_TEST_CASE(ViewsDoNotCopyStorage) {
+    typedef Opm::GridProperty<int>::SupportedKeywordInfo SupportedKeywordInfo;
+    Opm::GridProperty<int> prop1( 4 , 4 , 2 , SupportedKeywordInfo("P1" , 1 , "1"));
+    Opm::GridProperty<int> prop2( 4 , 4 , 2 , SupportedKeywordInfo("P2" , 9 , "1"));
+    std::shared_ptr<Opm::Box> globalBox = std::make_shared<Opm::Box>(4 , 4 , 2);
+    std::shared_ptr<Opm::Box> subBox = std::make_shared<Opm::Box>(*globalBox , 0 , 1 , 0 , 1 , 0 , 1);
+
+    prop1.add( 1 , subBox );
+    const std::vector<int>& data = prop1.getData();
+    const Opm::GridPropertyView<int> view = prop1.getView();
+
+    // the view shares the storage, and sees the writes to it.
+    prop1.scale( 3 , subBox );
+    BOOST_CHECK_EQUAL( data.data() , prop1.getData().data() );
+    BOOST_CHECK_EQUAL( data.data() , view.data() );
+    BOOST_CHECK_EQUAL( 6 , view[0] );
+    BOOST_CHECK_EQUAL( 1 , view[31] );
+
+    // after getData() a COPY copies the values, so the vector of prop1
+    // - and the view of it - is still written in place.
+    prop2.copyFrom( prop1 , globalBox );
+    prop1.add( 1 , globalBox );
+    BOOST_CHECK( !prop2.sharesData( prop1 ));
+    BOOST_CHECK_EQUAL( 7 , prop1.iget( 0 ));
+    BOOST_CHECK_EQUAL( 6 , prop2.iget( 0 ));
+    BOOST_CHECK_EQUAL( 7 , view[0] );
+    BOOST_CHECK_EQUAL( data.data() , view.data() );
+}
+
+
+BOOST_AUTO_TEST_CASE(CompactIntStorage) {
+    typedef Opm::GridProperty<int>::SupportedKeywordInfo SupportedKeywordInfo;
+    Opm::GridProperty<int> prop( 4 , 4 , 2 , SupportedKeywordInfo("FIPNUM" , 1 , "1"));
+    std::shared_ptr<Opm::Box> globalBox = std::make_shared<Opm::Box>(4 , 4 , 2);
+    std::shared_ptr<Opm::Box> subBox = std::make_shared<Opm::Box>(*globalBox , 0 , 1 , 0 , 1 , 0 , 1);
+
+    // a constant property is not compressed.
+    BOOST_CHECK( !prop.compress() );
+    BOOST_CHECK_EQUAL( 0U , prop.bytesPerValue() );
+
+    prop.add( 4 , subBox );
+    BOOST_CHECK_EQUAL( sizeof(int) , prop.bytesPerValue() );
+    BOOST_CHECK( prop.compress() );
+    BOOST_CHECK_EQUAL( 1U , prop.bytesPerValue() );
+    BOOST_CHECK_EQUAL( 5 , prop.iget( 0 ));
+    BOOST_CHECK_EQUAL( 1 , prop.iget( 31 ));
+
+    {
+        const Opm::GridPropertyView<int> view = prop.getView();
+        BOOST_CHECK_EQUAL( 32U , view.size() );
+        BOOST_CHECK( view.data8() != nullptr );
+        BOOST_CHECK_EQUAL( 5 , view[17] );
+        BOOST_CHECK_EQUAL( 1 , view[2] );
+    }
+
+    // writing widens the storage again; a value above 255 is then
+    // compressed to 16 bits.
+    prop.add( 1000 , subBox );
+    BOOST_CHECK_EQUAL( sizeof(int) , prop.bytesPerValue() );
+    BOOST_CHECK_EQUAL( 1005 , prop.iget( 0 ));
+    BOOST_CHECK( prop.compress() );
+    BOOST_CHECK_EQUAL( 2U , prop.bytesPerValue() );
+    BOOST_CHECK_EQUAL( 1005 , prop.getView()[16] );
+
+    // values outside [0,65535] are kept in a full vector.
+    prop.setScalar( -1 , subBox );
+    BOOST_CHECK( !prop.compress() );
+    BOOST_CHECK_EQUAL( -1 , prop.iget( 0 ));
+
+    // COPY of the full grid shares the compact storage.
+    Opm::GridProperty<int> target( 4 , 4 , 2 , SupportedKeywordInfo("SATNUM" , 1 , "1"));
+    prop.setScalar( 3 , subBox );
+    BOOST_CHECK( prop.compress() );
+    target.copyFrom( prop , globalBox );
+    BOOST_CHECK( target.sharesData( prop ));
+    target.scale( 2 , subBox );
+    BOOST_CHECK_EQUAL( 6 , target.iget( 0 ));
+    BOOST_CHECK_EQUAL( 3 , prop.iget( 0 ));
+    BOOST_CHECK_EQUAL( 1U , prop.bytesPerValue() );
+
+    // getData() returns the widened values, and the full vector is
+    // then kept.
+    const std::vector<int>& data = prop.getData();
+    BOOST_CHECK_EQUAL( 32U , data.size() );
+    BOOST_CHECK_EQUAL( 3 , data[1] );
+    BOOST_CHECK_EQUAL( 1 , data[2] );
+    BOOST_CHECK( !prop.compress() );
+    BOOST_CHECK_EQUAL( sizeof(int) , prop.bytesPerValue() );
+}
+
+
+BOOST_AUTO_TEST_CASE(GetDataReferenceStaysValid) {
+    typedef Opm::GridProperty<int>::SupportedKeywordInfo SupportedKeywordInfo;
+    Opm::GridProperty<int> prop( 4 , 4 , 2 , SupportedKeywordInfo("P1" , 1 , "1"));
+    Opm::GridProperty<int> other( 4 , 4 , 2 , SupportedKeywordInfo("P2" , 9 , "1"));
+    std::shared_ptr<Opm::Box> globalBox = std::make_shared<Opm::Box>(4 , 4 , 2);
+    std::shared_ptr<Opm::Box> subBox = std::make_shared<Opm::Box>(*globalBox , 0 , 1 , 0 , 1 , 0 , 1);
+
+    // a COPY made before getData() is unshared by getData().
+    other.add( 1 , subBox );
+    prop.copyFrom( other , globalBox );
+    BOOST_CHECK( prop.sharesData( other ));
+    const std::vector<int>& data = prop.getData();
+    const int* values = data.data();
+    BOOST_CHECK( !prop.sharesData( other ));
+
+    // global EQUALS and COPY, into and out of the property, write the
+    // values in place.
+    prop.setScalar( 5 , globalBox );
+    BOOST_CHECK_EQUAL( values , data.data() );
+    BOOST_CHECK_EQUAL( 5 , data[0] );
+    BOOST_CHECK_EQUAL( 5 , data[31] );
+
+    prop.copyFrom( other , globalBox );
+    BOOST_CHECK_EQUAL( values , data.data() );
+    BOOST_CHECK_EQUAL( 10 , data[0] );
+    BOOST_CHECK_EQUAL( 9 , data[31] );
+
+    other.copyFrom( prop , globalBox );
+    BOOST_CHECK( !other.sharesData( prop ));
+    prop.add( 1 , globalBox );
+    other.scale( 2 , globalBox );
+    BOOST_CHECK_EQUAL( values , data.data() );
+    BOOST_CHECK_EQUAL( 11 , data[0] );
+    BOOST_CHECK_EQUAL( 20 , other.iget( 0 ));
+
+    BOOST_CHECK( !prop.compress() );
+    BOOST_CHECK_EQUAL( values , data.data() );
+    BOOST_CHECK_EQUAL( 10 , data[31] );
+}
+
+
+BOOST_AUTO_TEST_CASE(CompressedCopy) {
+    typedef Opm::GridProperty<int>::SupportedKeywordInfo SupportedKeywordInfo;
+    Opm::GridProperty<int> prop( 4 , 4 , 2 , SupportedKeywordInfo("FIPNUM" , 1 , "1"));
+    std::shared_ptr<Opm::Box> globalBox = std::make_shared<Opm::Box>(4 , 4 , 2);
+    std::shared_ptr<Opm::Box> subBox = std::make_shared<Opm::Box>(*globalBox , 0 , 1 , 0 , 1 , 0 , 1);
+
+    std::vector<int> actnum( 32 , 0 );
+    actnum[0] = 1;
+    actnum[6] = 1;
+    actnum[17] = 1;
+    Opm::ActiveIndexMap activeIndexMap( 32 , actnum );
+
+    std::vector<int> constantValues = prop.compressedCopy( activeIndexMap );
+    BOOST_CHECK_EQUAL( 3U , constantValues.size() );
+    BOOST_CHECK_EQUAL( 1 , constantValues[2] );
+
+    prop.add( 2 , subBox );
+    BOOST_CHECK( prop.compress() );
+    std::vector<int> values = prop.compressedCopy( activeIndexMap );
+    BOOST_CHECK_EQUAL( 3 , values[0] );
+    BOOST_CHECK_EQUAL( 1 , values[1] );
+    BOOST_CHECK_EQUAL( 3 , values[2] );
+
+    Opm::ActiveIndexMap wrongSize( 8 , std::vector<int>() );
+    BOOST_CHECK_THROW( prop.compressedCopy( wrongSize ) , std::invalid_argument );
+}
@@ -131,7 +131,7 @@ BOOST_AUTO_TEST_CASE(InvalidInput) {
 }
 
 
-static Opm::DeckPtr createNotSupportedMULTREGTDeck() {
+static Opm::DeckPtr createExtendedMULTREGTDeck() {
     const char *deckData =
         "RUNSPEC\n"
         "\n"
@@ -155,7 +155,7 @@ static Opm::DeckPtr createNotSupportedMULTREGTDeck() {
         "3 4 5\n"
         "/\n"
         "MULTREGT\n"  
-        "1  2   0.50   X   NNC    M / -- Not yet support NNC behaviour \n"
+        "1  2   0.50   X   NNC    M / -- NNC behaviour \n"
         "/\n"
         "MULTREGT\n"  
         "*  2   0.50   X   ALL    M / -- Defaulted from region value \n"
@@ -174,29 +174,17 @@ static Opm::DeckPtr createNotSupportedMULTREGTDeck() {
 }
 
 
-BOOST_AUTO_TEST_CASE(NotSupported) {
-    Opm::DeckPtr deck = createNotSupportedMULTREGTDeck();
-    Opm::DeckKeywordConstPtr multregtKeyword0 = deck->getKeyword("MULTREGT",0);
-    Opm::DeckKeywordConstPtr multregtKeyword1 = deck->getKeyword("MULTREGT",1);
-    Opm::DeckKeywordConstPtr multregtKeyword2 = deck->getKeyword("MULTREGT",2);
-    Opm::DeckKeywordConstPtr multregtKeyword3 = deck->getKeyword("MULTREGT",3);
+BOOST_AUTO_TEST_CASE(ExtendedRecordsSupported) {
+    Opm::DeckPtr deck = createExtendedMULTREGTDeck();
     Opm::MULTREGTScanner scanner;
 
-    // Not supported NNC behaviour
-    BOOST_CHECK_THROW( Opm::MULTREGTScanner::assertKeywordSupported(multregtKeyword0) , std::invalid_argument);
-    BOOST_CHECK_THROW( scanner.addKeyword(multregtKeyword0) , std::invalid_argument);
-
-    // Defaulted from value - not supported
-    BOOST_CHECK_THROW( Opm::MULTREGTScanner::assertKeywordSupported(multregtKeyword1) , std::invalid_argument);
-    BOOST_CHECK_THROW( scanner.addKeyword(multregtKeyword1) , std::invalid_argument);
-
-    // Defaulted to value - not supported
-    BOOST_CHECK_THROW( Opm::MULTREGTScanner::assertKeywordSupported(multregtKeyword2) , std::invalid_argument);
-    BOOST_CHECK_THROW( scanner.addKeyword(multregtKeyword2) , std::invalid_argument);
-
-    // srcValue == targetValue - not supported
-    BOOST_CHECK_THROW( Opm::MULTREGTScanner::assertKeywordSupported(multregtKeyword3) , std::invalid_argument);
-    BOOST_CHECK_THROW( scanner.addKeyword(multregtKeyword3) , std::invalid_argument);
+    // NNC behaviour, defaulted source and target regions and equal
+    // source and target regions.
+    for (size_t index = 0; index < 4; index++) {
+        Opm::DeckKeywordConstPtr multregtKeyword = deck->getKeyword("MULTREGT",index);
+        BOOST_CHECK_NO_THROW( Opm::MULTREGTScanner::assertKeywordSupported(multregtKeyword) );
+        BOOST_CHECK_NO_THROW( scanner.addKeyword(multregtKeyword) );
+    }
 }
 
 
@@ -304,3 +292,233 @@ BOOST_AUTO_TEST_CASE(SimpleMULTREGT) {
     }
 
 }
+
+
+static std::vector< Opm::MULTREGTConnection > scanReference(const std::vector<int>& region , size_t nx , size_t ny , size_t nz , const std::map< std::pair<int,int> , std::pair<int,double> >& pairs) {
+    std::vector< Opm::MULTREGTConnection > connections;
+    auto check = [&](size_t g1 , size_t g2 , Opm::FaceDir::DirEnum dir1 , Opm::FaceDir::DirEnum dir2) {
+        auto iter = pairs.find( std::make_pair( region[g1] , region[g2] ));
+        if (iter != pairs.end() && (iter->second.first & dir1))
+            connections.push_back( Opm::MULTREGTConnection{ g1 , dir1 , iter->second.second } );
+
+        iter = pairs.find( std::make_pair( region[g2] , region[g1] ));
+        if (iter != pairs.end() && (iter->second.first & dir2))
+            connections.push_back( Opm::MULTREGTConnection{ g2 , dir2 , iter->second.second } );
+    };
+
+    for (size_t k = 0; k < nz; k++)
+        for (size_t j = 0; j < ny; j++)
+            for (size_t i = 0; i < nx; i++) {
+                size_t g = i + j*nx + k*nx*ny;
+                if (i + 1 < nx)
+                    check( g , g + 1 , Opm::FaceDir::XPlus , Opm::FaceDir::XMinus );
+                if (j + 1 < ny)
+                    check( g , g + nx , Opm::FaceDir::YPlus , Opm::FaceDir::YMinus );
+                if (k + 1 < nz)
+                    check( g , g + nx*ny , Opm::FaceDir::ZPlus , Opm::FaceDir::ZMinus );
+            }
+
+    return connections;
+}
+
+
+BOOST_AUTO_TEST_CASE(ScanLargeGrid) {
+    typedef Opm::GridProperties<int>::SupportedKeywordInfo SupportedKeywordInfo;
+    std::vector<SupportedKeywordInfo> supportedKeywords = { SupportedKeywordInfo("MULTNUM" , 1 , "1") };
+    const size_t nx = 40, ny = 40, nz = 50;
+    Opm::ParserPtr parser(new Opm::Parser());
+
+    // region values up to 5 use the dense pair table, values up to
+    // 50000 the sparse one.
+    for (int scale : {1 , 10000}) {
+        auto gridProperties = std::make_shared<Opm::GridProperties<int> >( nx , ny , nz , supportedKeywords );
+        auto multnum = gridProperties->getKeyword("MULTNUM");
+        std::vector<int> region( nx*ny*nz );
+        for (size_t k = 0; k < nz; k++)
+            for (size_t j = 0; j < ny; j++)
+                for (size_t i = 0; i < nx; i++) {
+                    size_t g = i + j*nx + k*nx*ny;
+                    region[g] = scale * static_cast<int>(1 + (i/7 + j/3 + k/4) % 5);
+                    multnum->multiplyValueAtIndex( g , region[g] );
+                }
+
+        auto r = [scale](int value) { return std::to_string( value * scale ); };
+        const std::string deckData =
+            "MULTREGT\n"
+            + r(1) + " " + r(2) + " 0.50 XYZ ALL M /\n"
+            + r(3) + " " + r(5) + " 2.00 XZ  ALL M /\n"
+            + r(5) + " " + r(3) + " 4.00 Y   ALL M /\n"
+            "/\n";
+        Opm::DeckPtr deck = parser->parseString( deckData );
+
+        Opm::MULTREGTScanner scanner;
+        scanner.addKeyword( deck->getKeyword("MULTREGT") );
+        auto connections = scanner.scanRegions( gridProperties );
+
+        std::map< std::pair<int,int> , std::pair<int,double> > pairs;
+        pairs[ std::make_pair( 1*scale , 2*scale ) ] = std::make_pair( Opm::FaceDir::FromMULTREGTString("XYZ") , 0.50 );
+        pairs[ std::make_pair( 3*scale , 5*scale ) ] = std::make_pair( Opm::FaceDir::FromMULTREGTString("XZ") , 2.00 );
+        pairs[ std::make_pair( 5*scale , 3*scale ) ] = std::make_pair( Opm::FaceDir::FromMULTREGTString("Y") , 4.00 );
+        auto reference = scanReference( region , nx , ny , nz , pairs );
+
+        BOOST_CHECK( reference.size() > 0 );
+        BOOST_CHECK( connections == reference );
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(RegionPairTable) {
+    Opm::ParserPtr parser(new Opm::Parser());
+    Opm::DeckPtr deck = parser->parseString( "MULTREGT\n"
+                                             " 1 2 0.50 X ALL M /\n"
+                                             " * 2 0.30 X ALL M /\n"
+                                             " 3 * 0.20 X NNC M /\n"
+                                             " 2 2 0.10 X ALL M /\n"
+                                             " 4 5 0.25 X ALL M /\n"
+                                             "/\n" );
+    Opm::DeckKeywordConstPtr keyword = deck->getKeyword("MULTREGT");
+    std::vector<Opm::MULTREGTRecord> records;
+    for (size_t index = 0; index < keyword->size(); index++)
+        records.push_back( Opm::MULTREGTRecord( keyword->getRecord(index) ));
+
+    std::vector<const Opm::MULTREGTRecord *> recordPtrs;
+    for (size_t index = 0; index < records.size(); index++)
+        recordPtrs.push_back( &records[index] );
+
+    // the same lookups for the dense and the sparse table
+    for (int maxRegion : {5 , 100000}) {
+        Opm::MULTREGTRegionPairTable table( recordPtrs , 1 , maxRegion );
+        BOOST_CHECK_EQUAL( maxRegion == 5 , table.isDense() );
+
+        // the wildcard record comes last
+        BOOST_CHECK_EQUAL( &records[1] , table.get(1,2,false) );
+        BOOST_CHECK_EQUAL( &records[1] , table.get(5,2,false) );
+        BOOST_CHECK( table.get(2,1,false) == nullptr );
+        BOOST_CHECK( table.get(2,3,false) == nullptr );
+        BOOST_CHECK( table.get(1,3,false) == nullptr );
+
+        // NNC records
+        BOOST_CHECK_EQUAL( &records[2] , table.get(3,2,true) );
+        BOOST_CHECK_EQUAL( &records[1] , table.get(3,2,false) );
+        BOOST_CHECK_EQUAL( &records[2] , table.get(3,4,true) );
+        BOOST_CHECK( table.get(3,4,false) == nullptr );
+        BOOST_CHECK( table.get(3,3,true) == nullptr );
+
+        // within a region only an explicit record applies
+        BOOST_CHECK_EQUAL( &records[3] , table.get(2,2,false) );
+        BOOST_CHECK( table.get(1,1,false) == nullptr );
+
+        BOOST_CHECK_EQUAL( &records[4] , table.get(4,5,false) );
+        BOOST_CHECK_EQUAL( &records[4] , table.get(4,5,true) );
+    }
+}
+
+
+static std::shared_ptr<Opm::GridProperties<int> > createMULTNUM(const std::vector<int>& multnum) {
+    typedef Opm::GridProperties<int>::SupportedKeywordInfo SupportedKeywordInfo;
+    std::vector<SupportedKeywordInfo> supportedKeywords = { SupportedKeywordInfo("MULTNUM" , 1 , "1") };
+    auto gridProperties = std::make_shared<Opm::GridProperties<int> >( multnum.size() , 1 , 1 , supportedKeywords );
+    auto property = gridProperties->getKeyword("MULTNUM");
+    for (size_t g = 0; g < multnum.size(); g++)
+        property->multiplyValueAtIndex( g , multnum[g] );
+
+    return gridProperties;
+}
+
+
+BOOST_AUTO_TEST_CASE(NNCAndWildcardRecords) {
+    Opm::ParserPtr parser(new Opm::Parser());
+    auto scan = [&parser](const std::string& records , const std::vector<int>& multnum ,
+                          const std::vector< std::pair<size_t,size_t> >& nncs , std::vector<double>& nncMultipliers) {
+        Opm::DeckPtr deck = parser->parseString( "MULTREGT\n" + records + "/\n" );
+        Opm::MULTREGTScanner scanner;
+        scanner.addKeyword( deck->getKeyword("MULTREGT") );
+        return scanner.scanRegions( createMULTNUM( multnum ) , nncs , nncMultipliers );
+    };
+    std::vector<double> nncMultipliers;
+    const std::vector< std::pair<size_t,size_t> > nncs = { {0,1} , {1,0} , {0,2} };
+
+    {
+        auto connections = scan( " 2 2 0.50 X ALL M /\n" , {2,2,1} , nncs , nncMultipliers );
+        BOOST_CHECK_EQUAL( 1U , connections.size() );
+        BOOST_CHECK( connections[0] == Opm::MULTREGTConnection( 0 , Opm::FaceDir::XPlus , 0.50 ));
+        BOOST_CHECK( nncMultipliers == std::vector<double>({0.50 , 0.50 , 1.0}) );
+    }
+
+    {
+        auto connections = scan( " * 2 0.30 X ALL M /\n" , {1,2,3,2} , nncs , nncMultipliers );
+        BOOST_CHECK_EQUAL( 3U , connections.size() );
+        BOOST_CHECK( connections[0] == Opm::MULTREGTConnection( 0 , Opm::FaceDir::XPlus , 0.30 ));
+        BOOST_CHECK( connections[1] == Opm::MULTREGTConnection( 2 , Opm::FaceDir::XMinus , 0.30 ));
+        BOOST_CHECK( connections[2] == Opm::MULTREGTConnection( 2 , Opm::FaceDir::XPlus , 0.30 ));
+        BOOST_CHECK( nncMultipliers == std::vector<double>({0.30 , 0.30 , 1.0}) );
+    }
+
+    {
+        auto connections = scan( " 1 2 0.50 X NNC M /\n" , {1,2,2} , nncs , nncMultipliers );
+        BOOST_CHECK_EQUAL( 0U , connections.size() );
+        BOOST_CHECK( nncMultipliers == std::vector<double>({0.50 , 0.50 , 0.50}) );
+    }
+
+    {
+        auto connections = scan( " 1 2 0.50 X NONNC M /\n" , {1,2,2} , nncs , nncMultipliers );
+        BOOST_CHECK_EQUAL( 1U , connections.size() );
+        BOOST_CHECK( nncMultipliers == std::vector<double>({1.0 , 1.0 , 1.0}) );
+    }
+
+    // A record matching both directions is applied once per connection.
+    {
+        auto connections = scan( " * * 0.50 X ALL M /\n" , {1,2,3} , nncs , nncMultipliers );
+        BOOST_CHECK_EQUAL( 2U , connections.size() );
+        BOOST_CHECK( connections[0] == Opm::MULTREGTConnection( 0 , Opm::FaceDir::XPlus , 0.50 ));
+        BOOST_CHECK( connections[1] == Opm::MULTREGTConnection( 1 , Opm::FaceDir::XPlus , 0.50 ));
+        BOOST_CHECK( nncMultipliers == std::vector<double>({0.50 , 0.50 , 0.50}) );
+    }
+
+    // Distinct records for the two directions are both applied.
+    {
+        auto connections = scan( " * * 0.50 X ALL M /\n 2 1 0.10 X ALL M /\n" , {1,2,3} , nncs , nncMultipliers );
+        BOOST_CHECK_EQUAL( 3U , connections.size() );
+        BOOST_CHECK( connections[0] == Opm::MULTREGTConnection( 0 , Opm::FaceDir::XPlus , 0.50 ));
+        BOOST_CHECK( connections[1] == Opm::MULTREGTConnection( 1 , Opm::FaceDir::XMinus , 0.10 ));
+        BOOST_CHECK_CLOSE( 0.05 , nncMultipliers[0] , 1e-10 );
+        BOOST_CHECK_CLOSE( 0.05 , nncMultipliers[1] , 1e-10 );
+        BOOST_CHECK_EQUAL( 0.50 , nncMultipliers[2] );
+    }
+
+    // The second record only overwrites the NNC part of the first record.
+    {
+        auto connections = scan( " 1 2 0.50 X ALL M /\n 1 2 0.10 X NNC M /\n" , {1,2,2} , nncs , nncMultipliers );
+        BOOST_CHECK_EQUAL( 1U , connections.size() );
+        BOOST_CHECK( connections[0] == Opm::MULTREGTConnection( 0 , Opm::FaceDir::XPlus , 0.50 ));
+        BOOST_CHECK( nncMultipliers == std::vector<double>({0.10 , 0.10 , 0.10}) );
+    }
+
+    BOOST_CHECK_THROW( scan( " 1 2 0.50 X ALL M /\n" , {1,2} , nncs , nncMultipliers ) , std::invalid_argument );
+}
+
+
+BOOST_AUTO_TEST_CASE(ScanNNCOnly) {
+    Opm::ParserPtr parser(new Opm::Parser());
+    Opm::DeckPtr deck = parser->parseString( "MULTREGT\n 1 2 0.50 X ALL M /\n 1 2 0.10 X NNC M /\n 2 3 0.25 X NONNC M /\n/\n" );
+    Opm::MULTREGTScanner scanner;
+    scanner.addKeyword( deck->getKeyword("MULTREGT") );
+
+    const std::vector< std::pair<size_t,size_t> > nncs = { {0,1} , {1,2} , {0,2} , {2,3} };
+    std::vector<double> nncMultipliers;
+    std::vector<double> expected;
+    auto multnum = createMULTNUM( {1,2,2,3} );
+    scanner.scanRegions( multnum , nncs , expected );
+    scanner.scanNNC( multnum , nncs , nncMultipliers );
+    BOOST_CHECK( nncMultipliers == expected );
+    BOOST_CHECK( nncMultipliers == std::vector<double>({0.10 , 1.0 , 0.10 , 1.0}) );
+
+    BOOST_CHECK_THROW( scanner.scanNNC( createMULTNUM( {1,2} ) , nncs , nncMultipliers ) , std::invalid_argument );
+
+    // a (* -> *) record is applied once to every NNC between regions.
+    Opm::DeckPtr wildcardDeck = parser->parseString( "MULTREGT\n * * 0.50 X NNC M /\n/\n" );
+    Opm::MULTREGTScanner wildcardScanner;
+    wildcardScanner.addKeyword( wildcardDeck->getKeyword("MULTREGT") );
+    wildcardScanner.scanNNC( multnum , nncs , nncMultipliers );
+    BOOST_CHECK( nncMultipliers == std::vector<double>({0.50 , 1.0 , 0.50 , 0.50}) );
+}
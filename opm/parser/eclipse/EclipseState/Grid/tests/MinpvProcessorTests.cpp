@@ -0,0 +1,179 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <stdexcept>
+#include <iostream>
+#include <boost/filesystem.hpp>
+
+#define BOOST_TEST_MODULE MinpvProcessorTests
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+#include <opm/parser/eclipse/Parser/Parser.hpp>
+#include <opm/parser/eclipse/Deck/Deck.hpp>
+#include <opm/parser/eclipse/EclipseState/EclipseState.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/MinpvProcessor.hpp>
+
+
+// The layers k = 0 .. 5 have the same thickness in all the columns.
+static std::vector<double> createZCORN(size_t nx , size_t ny , const std::vector<double>& thickness) {
+    std::vector<double> zcorn;
+    double depth = 1000;
+    for (size_t k = 0; k < thickness.size(); k++) {
+        zcorn.insert( zcorn.end() , 4*nx*ny , depth );
+        depth += thickness[k];
+        zcorn.insert( zcorn.end() , 4*nx*ny , depth );
+    }
+    return zcorn;
+}
+
+
+BOOST_AUTO_TEST_CASE(MinpvAndPinch) {
+    const std::vector<double> zcorn = createZCORN( 2 , 1 , { 1 , 0.0005 , 1 , 1 , 1 , 1 } );
+    std::vector<double> poreVolume( 12 , 10.0 );
+    poreVolume[6] = 0.01;    // (0,0,3)
+    std::vector<int> actnum( 12 , 1 );
+    actnum[7] = 0;           // (1,0,3)
+
+    Opm::MinpvProcessor::PinchOptions pinch;
+    Opm::MinpvProcessor minpvOnly( 2 , 1 , 6 , zcorn , actnum , poreVolume , 1.0 , pinch );
+    BOOST_CHECK_EQUAL( 1U , minpvOnly.numMinpvDeactivated() );
+    BOOST_CHECK_EQUAL( 0U , minpvOnly.numPinchedOut() );
+    BOOST_CHECK_EQUAL( 0 , minpvOnly.getACTNUM()[6] );
+    BOOST_CHECK_EQUAL( 0 , minpvOnly.getACTNUM()[7] );
+    BOOST_CHECK_EQUAL( 1 , minpvOnly.getACTNUM()[2] );
+    BOOST_CHECK_EQUAL( 0U , minpvOnly.getPinchConnections().size() );
+
+    pinch.active = true;
+    pinch.thresholdThickness = 0.001;
+    Opm::MinpvProcessor processor( 2 , 1 , 6 , zcorn , actnum , poreVolume , 1.0 , pinch );
+    BOOST_CHECK_EQUAL( 1U , processor.numMinpvDeactivated() );
+    BOOST_CHECK_EQUAL( 2U , processor.numPinchedOut() );
+    BOOST_CHECK_EQUAL( 0 , processor.getACTNUM()[2] );
+    BOOST_CHECK_EQUAL( 0 , processor.getACTNUM()[3] );
+
+    // The input inactive cell (1,0,3) is not bridged.
+    const std::vector< std::pair<size_t , size_t> > expected = { {0 , 4} , {1 , 5} , {4 , 8} };
+    BOOST_CHECK( expected == processor.getPinchConnections() );
+
+    // NOGAP: only the pinched out layer is thinner than the threshold.
+    pinch.gap = false;
+    Opm::MinpvProcessor noGap( 2 , 1 , 6 , zcorn , actnum , poreVolume , 1.0 , pinch );
+    const std::vector< std::pair<size_t , size_t> > expectedNoGap = { {0 , 4} , {1 , 5} };
+    BOOST_CHECK( expectedNoGap == noGap.getPinchConnections() );
+
+    pinch.gap = true;
+    pinch.maxEmptyGap = 0.5;
+    Opm::MinpvProcessor maxGap( 2 , 1 , 6 , zcorn , actnum , poreVolume , 1.0 , pinch );
+    BOOST_CHECK( expectedNoGap == maxGap.getPinchConnections() );
+
+    BOOST_CHECK_THROW( Opm::MinpvProcessor( 2 , 1 , 5 , zcorn , actnum , poreVolume , 1.0 , pinch ) , std::invalid_argument );
+}
+
+
+BOOST_AUTO_TEST_CASE(PoreVolume) {
+    std::vector<double> coord;
+    for (size_t j = 0; j <= 1; j++) {
+        for (size_t i = 0; i <= 2; i++) {
+            const double pillar[6] = { i*10.0 , j*10.0 , 0 , i*10.0 , j*10.0 , 2000 };
+            coord.insert( coord.end() , pillar , pillar + 6 );
+        }
+    }
+    const std::vector<double> zcorn = createZCORN( 2 , 1 , { 2 , 2 } );
+    Opm::CellGeometry cellGeometry( 2 , 1 , 2 , coord , zcorn );
+
+    Opm::GridPropertyView<double> poro( 4 , 0.2 );
+    Opm::GridPropertyView<double> ntg( 4 , 0.5 );
+    Opm::GridPropertyView<double> multpv( 4 , 2.0 );
+    std::vector<double> poreVolume;
+    Opm::MinpvProcessor::computePoreVolume( cellGeometry , poro , ntg , multpv , nullptr , poreVolume );
+    BOOST_CHECK_EQUAL( 4U , poreVolume.size() );
+    BOOST_CHECK_CLOSE( 200 * 0.2 * 0.5 * 2 , poreVolume[3] , 1e-10 );
+
+    auto porvData = std::make_shared<const std::vector<double> >( std::vector<double>{ std::nan("") , 7.0 , std::nan("") , std::nan("") } );
+    Opm::GridPropertyView<double> porv( porvData );
+    Opm::MinpvProcessor::computePoreVolume( cellGeometry , poro , ntg , multpv , &porv , poreVolume );
+    BOOST_CHECK_EQUAL( 14.0 , poreVolume[1] );
+    BOOST_CHECK_CLOSE( 40.0 , poreVolume[0] , 1e-10 );
+}
+
+
+static Opm::DeckPtr createDeck(bool withMinpv , bool withPoro = true) {
+    std::string deckData =
+        "RUNSPEC\n"
+        "DIMENS\n"
+        " 1 1 5 /\n"
+        "GRID\n"
+        "DXV\n"
+        "10 /\n"
+        "DYV\n"
+        "10 /\n"
+        "DZV\n"
+        "1 0.0005 1 1 1 /\n"
+        "DEPTHZ\n"
+        "4*1000 /\n";
+    if (withPoro)
+        deckData +=
+            "PORO\n"
+            "0.2 0.2 0.2 0.0001 0.2 /\n";
+    if (withMinpv)
+        deckData +=
+            "MINPV\n"
+            "1.0 /\n"
+            "PINCH\n"
+            "0.001 /\n";
+    deckData += "EDIT\n\n";
+
+    Opm::ParserPtr parser(new Opm::Parser());
+    return parser->parseString(deckData) ;
+}
+
+
+BOOST_AUTO_TEST_CASE(EclipseStateMinpv) {
+    Opm::EclipseState state( createDeck( true ));
+    BOOST_CHECK_EQUAL( 3U , state.getEclipseGrid()->getNumActive() );
+    const std::vector< std::pair<size_t , size_t> > expected = { {0 , 2} , {2 , 4} };
+    BOOST_CHECK( expected == state.getPinchConnections() );
+    BOOST_CHECK_CLOSE( 20.0 , (*state.getPoreVolume())[0] , 1e-10 );
+    BOOST_CHECK_CLOSE( 0.01 , (*state.getPoreVolume())[3] , 1e-8 );
+
+    // the pore volume follows the modifications of the properties
+    std::shared_ptr<const std::vector<double> > poreVolume = state.getPoreVolume();
+    BOOST_CHECK_EQUAL( poreVolume.get() , state.getPoreVolume().get() );
+    state.getDoubleGridProperty("PORO")->multiplyValueAtIndex( 0 , 0.5 );
+    BOOST_CHECK_CLOSE( 10.0 , (*state.getPoreVolume())[0] , 1e-10 );
+    state.getDoubleGridProperty("NTG")->multiplyValueAtIndex( 0 , 0.5 );
+    BOOST_CHECK_CLOSE( 5.0 , (*state.getPoreVolume())[0] , 1e-10 );
+    BOOST_CHECK_CLOSE( 20.0 , (*state.getPoreVolume())[2] , 1e-10 );
+
+    Opm::EclipseState noMinpv( createDeck( false ));
+    BOOST_CHECK_EQUAL( 5U , noMinpv.getEclipseGrid()->getNumActive() );
+    BOOST_CHECK_EQUAL( 0U , noMinpv.getPinchConnections().size() );
+}
+
+
+// Without PORV or PORO there is no pore volume; only PINCH applies.
+BOOST_AUTO_TEST_CASE(EclipseStateMinpvWithoutPoreVolume) {
+    Opm::EclipseState state( createDeck( true , false ));
+    BOOST_CHECK_EQUAL( 4U , state.getEclipseGrid()->getNumActive() );
+    const std::vector< std::pair<size_t , size_t> > expected = { {0 , 2} };
+    BOOST_CHECK( expected == state.getPinchConnections() );
+    BOOST_CHECK_THROW( state.getPoreVolume() , std::invalid_argument );
+}
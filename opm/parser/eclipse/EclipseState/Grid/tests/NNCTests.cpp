@@ -0,0 +1,191 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <iostream>
+#include <boost/filesystem.hpp>
+
+#define BOOST_TEST_MODULE NNCTests
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+#include <opm/parser/eclipse/Parser/Parser.hpp>
+#include <opm/parser/eclipse/Deck/Deck.hpp>
+#include <opm/parser/eclipse/EclipseState/EclipseState.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/NNC.hpp>
+
+
+typedef std::function<double(size_t i , size_t j , size_t k , size_t di , size_t dj , size_t dk)> DepthFunction;
+
+/*
+  A grid with vertical pillars on a dx x dy lattice; the depth of
+  every corner is given by the depth function.
+*/
+static void createGrid(size_t nx , size_t ny , size_t nz , double dx , double dy , DepthFunction depth ,
+                       std::vector<double>& coord , std::vector<double>& zcorn) {
+    coord.clear();
+    for (size_t j = 0; j <= ny; j++) {
+        for (size_t i = 0; i <= nx; i++) {
+            const double pillar[6] = { i*dx , j*dy , 0 , i*dx , j*dy , 100 };
+            coord.insert( coord.end() , pillar , pillar + 6 );
+        }
+    }
+
+    zcorn.resize( 8*nx*ny*nz );
+    for (size_t k = 0; k < nz; k++)
+        for (size_t dk = 0; dk < 2; dk++)
+            for (size_t j = 0; j < ny; j++)
+                for (size_t dj = 0; dj < 2; dj++)
+                    for (size_t i = 0; i < nx; i++)
+                        for (size_t di = 0; di < 2; di++)
+                            zcorn[k*8*nx*ny + dk*4*nx*ny + j*4*nx + dj*2*nx + 2*i + di] = depth( i , j , k , di , dj , dk );
+}
+
+
+BOOST_AUTO_TEST_CASE(UnfaultedGrid) {
+    std::vector<double> coord , zcorn;
+    createGrid( 4 , 3 , 5 , 10 , 20 , [](size_t , size_t , size_t k , size_t , size_t , size_t dk) { return 1000.0 + k + dk; } , coord , zcorn );
+
+    Opm::NNC nnc( 4 , 3 , 5 , coord , zcorn , std::vector<int>());
+    BOOST_CHECK_EQUAL( 0U , nnc.size() );
+    BOOST_CHECK_EQUAL( 61U , nnc.getRowStart().size() );
+    BOOST_CHECK_THROW( Opm::NNC( 4 , 3 , 6 , coord , zcorn , std::vector<int>()) , std::invalid_argument );
+}
+
+
+BOOST_AUTO_TEST_CASE(ThrowFault) {
+    // The column i = 1 is displaced half a layer down.
+    std::vector<double> coord , zcorn;
+    createGrid( 2 , 1 , 3 , 10 , 2 , [](size_t i , size_t , size_t k , size_t , size_t , size_t dk) { return 1000.0 + k + dk + 0.5*i; } , coord , zcorn );
+
+    Opm::NNC nnc( 2 , 1 , 3 , coord , zcorn , std::vector<int>());
+    BOOST_CHECK_EQUAL( 2U , nnc.size() );
+
+    std::vector< std::pair<size_t , size_t> > connections;
+    nnc.exportConnections( connections );
+    BOOST_CHECK( std::make_pair( size_t(1) , size_t(2) ) == connections[0] );
+    BOOST_CHECK( std::make_pair( size_t(3) , size_t(4) ) == connections[1] );
+    BOOST_CHECK_CLOSE( 0.5 * 2 , nnc.getArea()[0] , 1e-10 );
+    BOOST_CHECK_CLOSE( 0.5 * 2 , nnc.getArea()[1] , 1e-10 );
+    BOOST_CHECK_EQUAL( 1.0 , nnc.getMultipliers()[0] );
+
+    BOOST_CHECK_EQUAL( 0U , nnc.getRowStart()[1] );
+    BOOST_CHECK_EQUAL( 1U , nnc.getRowStart()[2] );
+    BOOST_CHECK_EQUAL( 2 , nnc.getCell2()[0] );
+
+    // No connections to inactive cells
+    std::vector<int> actnum( 6 , 1 );
+    actnum[2] = 0;
+    Opm::NNC activeNNC( 2 , 1 , 3 , coord , zcorn , actnum );
+    BOOST_CHECK_EQUAL( 1U , activeNNC.size() );
+    BOOST_CHECK_EQUAL( 4 , activeNNC.getCell2()[0] );
+}
+
+
+BOOST_AUTO_TEST_CASE(SlopingFault) {
+    // The column j = 1 is displaced from 0 to one full layer along
+    // the fault, i.e. the overlap with the layer above is a triangle.
+    std::vector<double> coord , zcorn;
+    createGrid( 1 , 2 , 3 , 4 , 10 , [](size_t , size_t j , size_t k , size_t di , size_t , size_t dk) { return 1000.0 + k + dk + 1.0*j*di; } , coord , zcorn );
+
+    Opm::NNC nnc( 1 , 2 , 3 , coord , zcorn , std::vector<int>());
+    BOOST_CHECK_EQUAL( 2U , nnc.size() );
+
+    std::vector< std::pair<size_t , size_t> > connections;
+    nnc.exportConnections( connections );
+    BOOST_CHECK( std::make_pair( size_t(1) , size_t(2) ) == connections[0] );
+    BOOST_CHECK( std::make_pair( size_t(3) , size_t(4) ) == connections[1] );
+    BOOST_CHECK_CLOSE( 0.5 * 4 , nnc.getArea()[0] , 1e-10 );
+    BOOST_CHECK_CLOSE( 0.5 * 4 , nnc.getArea()[1] , 1e-10 );
+}
+
+
+BOOST_AUTO_TEST_CASE(LargeGrid) {
+    // Large enough for the parallel code path; every second column is
+    // displaced by a third of a layer.
+    const size_t nx = 40, ny = 40, nz = 45;
+    std::vector<double> coord , zcorn;
+    createGrid( nx , ny , nz , 10 , 10 , [](size_t i , size_t j , size_t k , size_t , size_t , size_t dk) { return 1000.0 + k + dk + ((i + j) % 2) / 3.0; } , coord , zcorn );
+
+    Opm::NNC nnc( nx , ny , nz , coord , zcorn , std::vector<int>());
+
+    // Every column pair is displaced, i.e. nz - 1 NNCs per pair.
+    const size_t numPairs = (nx - 1)*ny + nx*(ny - 1);
+    BOOST_CHECK_EQUAL( numPairs * (nz - 1) , nnc.size() );
+
+    const std::vector<size_t>& rowStart = nnc.getRowStart();
+    for (size_t g = 0; g < nx*ny*nz; g++) {
+        for (size_t n = rowStart[g]; n < rowStart[g + 1]; n++) {
+            BOOST_CHECK( static_cast<size_t>(nnc.getCell2()[n]) > g );
+            if (n > rowStart[g])
+                BOOST_CHECK( nnc.getCell2()[n - 1] < nnc.getCell2()[n] );
+
+            BOOST_CHECK_CLOSE( 10.0 / 3 , nnc.getArea()[n] , 1e-8 );
+        }
+    }
+}
+
+
+static Opm::DeckPtr createDeck() {
+    std::vector<double> coord , zcorn;
+    createGrid( 2 , 1 , 3 , 10 , 2 , [](size_t i , size_t , size_t k , size_t , size_t , size_t dk) { return 1000.0 + k + dk + 0.5*i; } , coord , zcorn );
+
+    std::ostringstream deckData;
+    deckData << "RUNSPEC\n"
+             << "DIMENS\n"
+             << " 2 1 3 /\n"
+             << "GRID\n"
+             << "COORD\n";
+    for (size_t c = 0; c < coord.size(); c++)
+        deckData << coord[c] << " ";
+    deckData << "/\n"
+             << "ZCORN\n";
+    for (size_t z = 0; z < zcorn.size(); z++)
+        deckData << zcorn[z] << " ";
+    deckData << "/\n"
+             << "MULTNUM\n"
+             << "1 2 1 2 1 3 /\n"
+             << "MULTREGT\n"
+             << "1 2 0.50 XYZ NNC M /\n"
+             << "1 3 0.25 XYZ NONNC M /\n"
+             << "/\n"
+             << "EDIT\n"
+             << "\n";
+
+    Opm::ParserPtr parser(new Opm::Parser());
+    return parser->parseString( deckData.str() );
+}
+
+
+BOOST_AUTO_TEST_CASE(EclipseStateNNC) {
+    Opm::EclipseState state( createDeck() );
+    std::shared_ptr<const Opm::NNC> nnc = state.getNNC();
+    BOOST_CHECK_EQUAL( nnc.get() , state.getNNC().get() );
+    BOOST_CHECK_EQUAL( 2U , nnc->size() );
+
+    // The NNC (1,2) is between MULTNUM 2 and 1, the NNC (3,4) between
+    // 2 and 1 as well; the NONNC record does not apply.
+    BOOST_CHECK_EQUAL( 0.50 , nnc->getMultipliers()[0] );
+    BOOST_CHECK_EQUAL( 0.50 , nnc->getMultipliers()[1] );
+
+    // The neighbour connection (4,5) between 1 and 3 only gets the NONNC multiplier.
+    BOOST_CHECK_EQUAL( 0.25 , state.getTransMult()->getMultiplier( 4 , Opm::FaceDir::XPlus ));
+}
@@ -0,0 +1,149 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <memory>
+#include <stdexcept>
+#include <iostream>
+#include <boost/filesystem.hpp>
+
+#define BOOST_TEST_MODULE RegionIndexTests
+#include <boost/test/unit_test.hpp>
+
+#include <opm/parser/eclipse/EclipseState/Grid/Box.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/GridProperties.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/RegionIndex.hpp>
+
+
+static Opm::GridPropertyView<int> createView(const std::vector<int>& values) {
+    std::shared_ptr<const std::vector<int> > data = std::make_shared<const std::vector<int> >( values );
+    return Opm::GridPropertyView<int>( data );
+}
+
+
+BOOST_AUTO_TEST_CASE(DenseRegions) {
+    // A 3 x 2 x 2 grid; region 4 is not present.
+    const std::vector<int> values = { 1 , 1 , 2 ,
+                                      1 , 3 , 2 ,
+
+                                      5 , 5 , 2 ,
+                                      5 , 3 , 3 };
+    Opm::RegionIndex regionIndex( 3 , 2 , 2 , createView( values ));
+
+    const std::vector<int> expectedRegions = { 1 , 2 , 3 , 5 };
+    BOOST_CHECK( expectedRegions == regionIndex.getRegions() );
+    BOOST_CHECK_EQUAL( 4U , regionIndex.numRegions() );
+    BOOST_CHECK( !regionIndex.hasRegion( 4 ));
+    BOOST_CHECK_EQUAL( 0U , regionIndex.numCells( 4 ));
+    BOOST_CHECK_EQUAL( 3U , regionIndex.numCells( 2 ));
+    BOOST_CHECK_THROW( regionIndex.getBoundingBox( 4 ) , std::invalid_argument );
+
+    const std::pair<size_t , size_t> range = regionIndex.getCellRange( 3 );
+    BOOST_CHECK_EQUAL( 3U , range.second - range.first );
+    BOOST_CHECK_EQUAL( 4 , regionIndex.getCells()[range.first] );
+    BOOST_CHECK_EQUAL( 10 , regionIndex.getCells()[range.first + 1] );
+    BOOST_CHECK_EQUAL( 11 , regionIndex.getCells()[range.first + 2] );
+
+    const std::vector<size_t> expectedRowStart = { 0 , 3 , 6 , 9 , 12 };
+    BOOST_CHECK( expectedRowStart == regionIndex.getRowStart() );
+
+    // Region 3: i in [1,2], j = 1, k in [0,1]
+    const Opm::Box& box = regionIndex.getBoundingBox( 3 );
+    BOOST_CHECK_EQUAL( 2U , box.getDim(0) );
+    BOOST_CHECK_EQUAL( 1U , box.getDim(1) );
+    BOOST_CHECK_EQUAL( 2U , box.getDim(2) );
+    BOOST_CHECK_EQUAL( 4U , box.getRun(0).begin );
+
+    BOOST_CHECK_THROW( Opm::RegionIndex( 3 , 2 , 3 , createView( values )) , std::invalid_argument );
+}
+
+
+BOOST_AUTO_TEST_CASE(SparseAndConstantRegions) {
+    const std::vector<int> values = { 1000000 , -7 , 1000000 , 42 };
+    Opm::RegionIndex sparse( 2 , 2 , 1 , createView( values ));
+    const std::vector<int> expectedRegions = { -7 , 42 , 1000000 };
+    BOOST_CHECK( expectedRegions == sparse.getRegions() );
+    BOOST_CHECK_EQUAL( 2U , sparse.numCells( 1000000 ));
+    BOOST_CHECK_EQUAL( 3 , sparse.getCells()[1] );
+
+    Opm::RegionIndex constant( 2 , 2 , 3 , Opm::GridPropertyView<int>( 12 , 7 ));
+    BOOST_CHECK_EQUAL( 1U , constant.numRegions() );
+    BOOST_CHECK_EQUAL( 12U , constant.numCells( 7 ));
+    BOOST_CHECK( constant.getBoundingBox( 7 ).isGlobal() );
+}
+
+
+BOOST_AUTO_TEST_CASE(LargeGrid) {
+    // Large enough for the parallel code path.
+    const size_t nx = 60, ny = 50, nz = 40;
+    std::vector<int> values( nx*ny*nz );
+    for (size_t g = 0; g < values.size(); g++)
+        values[g] = static_cast<int>((g / nx) % ny) / 10 + 1;
+
+    Opm::RegionIndex regionIndex( nx , ny , nz , createView( values ));
+    BOOST_CHECK_EQUAL( 5U , regionIndex.numRegions() );
+    for (int region = 1; region <= 5; region++) {
+        BOOST_CHECK_EQUAL( nx*10*nz , regionIndex.numCells( region ));
+
+        const std::pair<size_t , size_t> range = regionIndex.getCellRange( region );
+        for (size_t n = range.first; n < range.second; n++) {
+            BOOST_CHECK_EQUAL( region , values[regionIndex.getCells()[n]] );
+            if (n > range.first)
+                BOOST_CHECK( regionIndex.getCells()[n - 1] < regionIndex.getCells()[n] );
+        }
+
+        const Opm::Box& box = regionIndex.getBoundingBox( region );
+        BOOST_CHECK_EQUAL( nx , box.getDim(0) );
+        BOOST_CHECK_EQUAL( 10U , box.getDim(1) );
+        BOOST_CHECK_EQUAL( nz , box.getDim(2) );
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(CachedIndex) {
+    typedef Opm::GridProperties<int>::SupportedKeywordInfo SupportedKeywordInfo;
+    std::vector<SupportedKeywordInfo> supportedKeywords = { SupportedKeywordInfo( "FIPNUM" , 1 , "1" ) };
+    Opm::GridProperties<int> gridProperties( 4 , 3 , 2 , supportedKeywords );
+
+    std::shared_ptr<const Opm::RegionIndex> regionIndex = gridProperties.getRegionIndex( "FIPNUM" );
+    BOOST_CHECK_EQUAL( 24U , regionIndex->numCells( 1 ));
+    BOOST_CHECK_EQUAL( regionIndex.get() , gridProperties.getRegionIndex( "FIPNUM" ).get() );
+
+    std::shared_ptr<Opm::GridProperty<int> > fipnum = gridProperties.getKeyword( "FIPNUM" );
+    const Opm::Box globalBox( 4 , 3 , 2 );
+    fipnum->setScalar( 2 , std::make_shared<const Opm::Box>( globalBox , 0 , 1 , 0 , 2 , 1 , 1 ));
+    std::shared_ptr<const Opm::RegionIndex> edited = gridProperties.getRegionIndex( "FIPNUM" );
+    BOOST_CHECK( edited.get() != regionIndex.get() );
+    BOOST_CHECK_EQUAL( 18U , edited->numCells( 1 ));
+    BOOST_CHECK_EQUAL( 6U , edited->numCells( 2 ));
+    BOOST_CHECK_EQUAL( edited.get() , gridProperties.getRegionIndex( "FIPNUM" ).get() );
+
+    // The old index is unchanged, and compressing the storage does
+    // not change the values.
+    BOOST_CHECK_EQUAL( 24U , regionIndex->numCells( 1 ));
+    fipnum->compress();
+    BOOST_CHECK_EQUAL( edited.get() , gridProperties.getRegionIndex( "FIPNUM" ).get() );
+
+    // Deferred edits are seen when the index is requested.
+    gridProperties.setDeferredEdits( true );
+    fipnum->add( 1 , std::make_shared<const Opm::Box>( globalBox ));
+    std::shared_ptr<const Opm::RegionIndex> deferred = gridProperties.getRegionIndex( "FIPNUM" );
+    BOOST_CHECK_EQUAL( 18U , deferred->numCells( 2 ));
+    BOOST_CHECK_EQUAL( 6U , deferred->numCells( 3 ));
+    BOOST_CHECK_EQUAL( deferred.get() , gridProperties.getRegionIndex( "FIPNUM" ).get() );
+}
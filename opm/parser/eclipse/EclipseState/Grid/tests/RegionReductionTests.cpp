@@ -0,0 +1,177 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <iostream>
+#include <boost/filesystem.hpp>
+
+#define BOOST_TEST_MODULE RegionReductionTests
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+#include <opm/parser/eclipse/Parser/Parser.hpp>
+#include <opm/parser/eclipse/Deck/Deck.hpp>
+#include <opm/parser/eclipse/EclipseState/EclipseState.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/RegionReduction.hpp>
+
+
+template <typename T>
+static Opm::GridPropertyView<T> createView(const std::vector<T>& values) {
+    std::shared_ptr<const std::vector<T> > data = std::make_shared<const std::vector<T> >( values );
+    return Opm::GridPropertyView<T>( data );
+}
+
+
+BOOST_AUTO_TEST_CASE(Reduction) {
+    const Opm::GridPropertyView<int> regions = createView<int>( { 1 , 1 , 3 , 3 , 3 , 1000000 } );
+    const Opm::GridPropertyView<double> values = createView<double>( { 1 , 2 , 3 , 4 , 8 , 5 } );
+    const Opm::GridPropertyView<double> weights = createView<double>( { 1 , 3 , 1 , 1 , 2 , 1 } );
+
+    Opm::RegionReduction reduction( regions , values , &weights , std::vector<int>());
+    const std::vector<int> expectedRegions = { 1 , 3 , 1000000 };
+    BOOST_CHECK( expectedRegions == reduction.getRegions() );
+    BOOST_CHECK( !reduction.hasRegion( 2 ));
+    BOOST_CHECK_THROW( reduction.getSum( 2 ) , std::invalid_argument );
+
+    BOOST_CHECK_EQUAL( 3U , reduction.getCount( 3 ));
+    BOOST_CHECK_EQUAL( 15.0 , reduction.getSum( 3 ));
+    BOOST_CHECK_EQUAL( 3.0 , reduction.getMin( 3 ));
+    BOOST_CHECK_EQUAL( 8.0 , reduction.getMax( 3 ));
+    BOOST_CHECK_EQUAL( 5.0 , reduction.getMean( 3 ));
+    BOOST_CHECK_EQUAL( 4.0 , reduction.getWeightSum( 3 ));
+    BOOST_CHECK_EQUAL( 23.0 / 4 , reduction.getWeightedMean( 3 ));
+    BOOST_CHECK_EQUAL( 7.0 / 4 , reduction.getWeightedMean( 1 ));
+
+    // Region 1000000 has no active cells.
+    const std::vector<int> actnum = { 1 , 0 , 1 , 1 , 1 , 0 };
+    Opm::RegionReduction active( regions , values , nullptr , actnum );
+    BOOST_CHECK_EQUAL( 2U , active.numRegions() );
+    BOOST_CHECK_EQUAL( 1U , active.getCount( 1 ));
+    BOOST_CHECK_EQUAL( 1.0 , active.getMean( 1 ));
+    BOOST_CHECK( std::isnan( active.getWeightedMean( 1 )));
+
+    BOOST_CHECK_THROW( Opm::RegionReduction( regions , values , nullptr , std::vector<int>( 5 , 1 )) , std::invalid_argument );
+    BOOST_CHECK_THROW( Opm::RegionReduction( regions , Opm::GridPropertyView<double>( 5 , 1.0 ) , nullptr , std::vector<int>()) , std::invalid_argument );
+}
+
+
+BOOST_AUTO_TEST_CASE(LargeGrid) {
+    // Large enough for the parallel code path; the partial sums are
+    // merged in a fixed order.
+    const size_t size = 300000;
+    std::vector<int> regionValues( size );
+    std::vector<double> valueData( size );
+    std::vector<int> actnum( size );
+    for (size_t g = 0; g < size; g++) {
+        regionValues[g] = static_cast<int>(g % 7);
+        valueData[g] = static_cast<double>(g % 11);
+        actnum[g] = (g % 3) != 0;
+    }
+
+    Opm::RegionReduction reduction( createView( regionValues ) , createView( valueData ) , nullptr , actnum );
+    BOOST_CHECK_EQUAL( 7U , reduction.numRegions() );
+    for (int region = 0; region < 7; region++) {
+        size_t count = 0;
+        double sum = 0;
+        for (size_t g = 0; g < size; g++) {
+            if (actnum[g] && regionValues[g] == region) {
+                count++;
+                sum += valueData[g];
+            }
+        }
+
+        BOOST_CHECK_EQUAL( count , reduction.getCount( region ));
+        BOOST_CHECK_EQUAL( sum , reduction.getSum( region ));
+        BOOST_CHECK_EQUAL( 0.0 , reduction.getMin( region ));
+        BOOST_CHECK_EQUAL( 10.0 , reduction.getMax( region ));
+    }
+}
+
+
+static Opm::DeckPtr createDeck() {
+    const char *deckData =
+        "RUNSPEC\n"
+        "DIMENS\n"
+        " 2 2 1 /\n"
+        "GRID\n"
+        "DXV\n"
+        "2*10 /\n"
+        "DYV\n"
+        "2*10 /\n"
+        "DZV\n"
+        "1 /\n"
+        "DEPTHZ\n"
+        "9*1000 /\n"
+        "PORO\n"
+        "0.1 0.2 0.3 0.01 /\n"
+        "NTG\n"
+        "1 3 1 1 /\n"
+        "MINPV\n"
+        "5 /\n"
+        "EDIT\n"
+        "REGIONS\n"
+        "FIPNUM\n"
+        "1 1 2 2 /\n"
+        "\n";
+
+    Opm::ParserPtr parser(new Opm::Parser());
+    return parser->parseString(deckData) ;
+}
+
+
+BOOST_AUTO_TEST_CASE(EclipseStateReduction) {
+    // The pore volume of the last cell is below MINPV.
+    Opm::EclipseState state( createDeck() );
+
+    Opm::RegionReduction reduction = state.getRegionReduction( "FIPNUM" , "PORO" , "NTG" );
+    BOOST_CHECK_EQUAL( 2U , reduction.numRegions() );
+    BOOST_CHECK_EQUAL( 1U , reduction.getCount( 2 ));
+    BOOST_CHECK_CLOSE( 0.3 , reduction.getMax( 2 ) , 1e-10 );
+    BOOST_CHECK_CLOSE( 0.7 / 4 , reduction.getWeightedMean( 1 ) , 1e-10 );
+
+    Opm::RegionReduction all = state.getRegionReduction( "FIPNUM" , "PORO" , "" , false );
+    BOOST_CHECK_EQUAL( 2U , all.getCount( 2 ));
+    BOOST_CHECK_CLOSE( 0.155 , all.getMean( 2 ) , 1e-10 );
+
+    // absent keywords are not created
+    BOOST_CHECK_THROW( state.getRegionReduction( "SATNUM" , "PORO" ) , std::invalid_argument );
+    BOOST_CHECK_THROW( state.getRegionReduction( "FIPNUM" , "PERMX" ) , std::invalid_argument );
+    BOOST_CHECK_THROW( state.getRegionReduction( "FIPNUM" , "PORO" , "MULTPV" ) , std::invalid_argument );
+    BOOST_CHECK( !state.hasIntGridProperty("SATNUM") );
+    BOOST_CHECK( !state.hasDoubleGridProperty("PERMX") );
+    BOOST_CHECK( !state.hasDoubleGridProperty("MULTPV") );
+}
+
+
+// The pore volume per FIPNUM region; 10 x 10 x 1 cells, cell 3 is deactivated by MINPV.
+BOOST_AUTO_TEST_CASE(EclipseStatePoreVolumeReduction) {
+    Opm::EclipseState state( createDeck() );
+    const Opm::GridPropertyView<double> poreVolume( state.getPoreVolume() );
+
+    Opm::RegionReduction reduction = state.getRegionReduction( "FIPNUM" , poreVolume );
+    BOOST_CHECK_CLOSE( 10.0 + 60.0 , reduction.getSum( 1 ) , 1e-10 );
+    BOOST_CHECK_CLOSE( 30.0 , reduction.getSum( 2 ) , 1e-10 );
+
+    Opm::RegionReduction all = state.getRegionReduction( "FIPNUM" , poreVolume , "" , false );
+    BOOST_CHECK_CLOSE( 30.0 + 1.0 , all.getSum( 2 ) , 1e-10 );
+
+    BOOST_CHECK_THROW( state.getRegionReduction( "FIPNUM" , Opm::GridPropertyView<double>( 3 , 1.0 )) , std::invalid_argument );
+}
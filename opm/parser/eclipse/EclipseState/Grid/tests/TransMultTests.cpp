@@ -28,6 +28,7 @@
 
 #include <opm/parser/eclipse/EclipseState/Grid/TransMult.hpp>
 #include <opm/parser/eclipse/EclipseState/Grid/GridProperty.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/FaultCollection.hpp>
 
 BOOST_AUTO_TEST_CASE(Empty) {
     Opm::TransMult transMult(10,10,10);
@@ -48,3 +49,174 @@ BOOST_AUTO_TEST_CASE(Empty) {
     BOOST_CHECK_EQUAL( mult->getKeywordName() , "MULTZ");
     BOOST_CHECK( transMult.hasDirectionProperty( Opm::FaceDir::ZPlus ));
 }
+
+
+/*
+  Multipliers written through the property of a direction are seen
+  by the queries, and multipliers applied afterwards go to both.
+*/
+BOOST_AUTO_TEST_CASE(DirectionProperty) {
+    Opm::TransMult transMult(10,10,10);
+    Opm::GridPropertySupportedKeywordInfo<double> kwInfo( "MULTY" , 1.0 , "1" );
+    auto multy = std::make_shared<Opm::GridProperty<double> >( 10 , 10 , 10 , kwInfo );
+    multy->multiplyValueAtIndex( 5 , 0.5 );
+    transMult.applyMULT( multy , Opm::FaceDir::YPlus );
+
+    std::shared_ptr<Opm::GridProperty<double> > property = transMult.getDirectionProperty( Opm::FaceDir::YPlus );
+    BOOST_CHECK_EQUAL( 0.5 , property->iget( 5 ));
+    property->multiplyValueAtIndex( 7 , 0.25 );
+    BOOST_CHECK_EQUAL( 0.25 , transMult.getMultiplier( 7 , Opm::FaceDir::YPlus ));
+
+    std::vector<double> multipliers;
+    transMult.getMultipliers( {5 , 7 , 8} , Opm::FaceDir::YPlus , multipliers );
+    BOOST_CHECK( multipliers == std::vector<double>({0.5 , 0.25 , 1.0}) );
+
+    transMult.applyMULT( multy , Opm::FaceDir::YPlus );
+    BOOST_CHECK_EQUAL( 0.25 , property->iget( 5 ));
+    BOOST_CHECK_EQUAL( 0.25 , transMult.getMultiplier( 5 , Opm::FaceDir::YPlus ));
+    BOOST_CHECK_EQUAL( 0.25 , transMult.getMultiplier( 7 , Opm::FaceDir::YPlus ));
+
+    std::shared_ptr<const Opm::GridProperty<double> > copy = transMult.copyDirectionProperty( Opm::FaceDir::YPlus );
+    BOOST_CHECK_EQUAL( copy->getKeywordName() , "MULTY");
+    BOOST_CHECK_EQUAL( 0.25 , copy->iget( 7 ));
+    property->multiplyValueAtIndex( 7 , 2.0 );
+    BOOST_CHECK_EQUAL( 0.25 , copy->iget( 7 ));
+    BOOST_CHECK_EQUAL( 0.5 , transMult.getMultiplier( 7 , Opm::FaceDir::YPlus ));
+
+    BOOST_CHECK_EQUAL( 1.0 , transMult.copyDirectionProperty( Opm::FaceDir::ZMinus )->iget( 7 ));
+    BOOST_CHECK( !transMult.hasDirectionProperty( Opm::FaceDir::ZMinus ));
+
+    // a copy holds the current multipliers, and does not share the
+    // property with the original.
+    Opm::TransMult snapshot( transMult );
+    BOOST_CHECK( snapshot.hasDirectionProperty( Opm::FaceDir::YPlus ));
+    BOOST_CHECK_EQUAL( 0.5 , snapshot.getMultiplier( 7 , Opm::FaceDir::YPlus ));
+    property->multiplyValueAtIndex( 7 , 2.0 );
+    BOOST_CHECK_EQUAL( 1.0 , transMult.getMultiplier( 7 , Opm::FaceDir::YPlus ));
+    BOOST_CHECK_EQUAL( 0.5 , snapshot.getMultiplier( 7 , Opm::FaceDir::YPlus ));
+
+    std::shared_ptr<Opm::GridProperty<double> > snapshotProperty = snapshot.getDirectionProperty( Opm::FaceDir::YPlus );
+    BOOST_CHECK( snapshotProperty != property );
+    snapshotProperty->multiplyValueAtIndex( 5 , 0.5 );
+    BOOST_CHECK_EQUAL( 0.125 , snapshot.getMultiplier( 5 , Opm::FaceDir::YPlus ));
+    BOOST_CHECK_EQUAL( 0.25 , transMult.getMultiplier( 5 , Opm::FaceDir::YPlus ));
+}
+
+
+BOOST_AUTO_TEST_CASE(FaceMultiplierStorage) {
+    Opm::FaceMultiplierStore store( 100 );
+    BOOST_CHECK( store.isDefault() );
+
+    // repeated faces are multiplied in order
+    store.multiply( {7 , 3 , 7} , {0.5 , 0.25 , 0.1} );
+    BOOST_CHECK_EQUAL( Opm::FaceMultiplierStore::Sparse , store.getStorageType() );
+    BOOST_CHECK_EQUAL( 0.5 * 0.1 , store.get(7) );
+    BOOST_CHECK_EQUAL( 0.25 , store.get(3) );
+    BOOST_CHECK_EQUAL( 1.0 , store.get(4) );
+
+    store.scale( 2.0 );
+    BOOST_CHECK_EQUAL( 0.5 * 0.1 * 2.0 , store.get(7) );
+    BOOST_CHECK_EQUAL( 2.0 , store.get(99) );
+    BOOST_CHECK( !store.isDefault() );
+
+    store.multiply( {3 , 50} , {3.0 , 0.5} );
+    std::vector<double> all( 100 );
+    store.exportAll( all.data() );
+    BOOST_CHECK_EQUAL( 0.25 * 2.0 * 3.0 , all[3] );
+    BOOST_CHECK_EQUAL( 1.0 , all[50] );
+    BOOST_CHECK_EQUAL( 2.0 , all[51] );
+
+    // more than a quarter of the faces set
+    std::vector<size_t> indices;
+    for (size_t i = 0; i < 30; i++)
+        indices.push_back( i );
+    store.multiply( indices , std::vector<double>( 30 , 0.5 ));
+    BOOST_CHECK_EQUAL( Opm::FaceMultiplierStore::Dense , store.getStorageType() );
+    BOOST_CHECK_EQUAL( 0.25 * 2.0 * 3.0 * 0.5 , store.get(3) );
+    BOOST_CHECK_EQUAL( 1.0 , store.get(50) );
+
+    BOOST_CHECK_THROW( store.multiply( {100} , {0.5} ) , std::invalid_argument );
+    BOOST_CHECK_THROW( store.multiply( {1 , 2} , {0.5} ) , std::invalid_argument );
+}
+
+
+BOOST_AUTO_TEST_CASE(BatchQuery) {
+    Opm::TransMult transMult(10,10,10);
+    Opm::GridPropertySupportedKeywordInfo<double> kwInfo( "MULTX" , 1.0 , "1" );
+    auto multx = std::make_shared<Opm::GridProperty<double> >( 10 , 10 , 10 , kwInfo );
+    multx->multiplyValueAtIndex( 5 , 0.5 );
+    multx->multiplyValueAtIndex( 999 , 0.25 );
+    transMult.applyMULT( multx , Opm::FaceDir::XPlus );
+
+    BOOST_CHECK( transMult.hasDirectionProperty( Opm::FaceDir::XPlus ));
+    BOOST_CHECK( !transMult.hasDirectionProperty( Opm::FaceDir::XMinus ));
+    BOOST_CHECK_EQUAL( 0.5 , transMult.getMultiplier( 5 , 0 , 0 , Opm::FaceDir::XPlus ));
+
+    std::vector<double> multipliers;
+    transMult.getMultipliers( {999 , 5 , 6} , Opm::FaceDir::XPlus , multipliers );
+    BOOST_CHECK( multipliers == std::vector<double>({0.25 , 0.5 , 1.0}) );
+
+    transMult.getMultipliers( Opm::FaceDir::XPlus , multipliers );
+    BOOST_CHECK_EQUAL( 1000U , multipliers.size() );
+    BOOST_CHECK_EQUAL( 0.5 , multipliers[5] );
+    BOOST_CHECK_EQUAL( 0.25 , multipliers[999] );
+
+    std::vector< std::pair<size_t , Opm::FaceDir::DirEnum> > faces = { {5 , Opm::FaceDir::XPlus} ,
+                                                                      {5 , Opm::FaceDir::XMinus} ,
+                                                                      {999 , Opm::FaceDir::XPlus} };
+    transMult.getMultipliers( faces , multipliers );
+    BOOST_CHECK( multipliers == std::vector<double>({0.5 , 1.0 , 0.25}) );
+
+    BOOST_CHECK_EQUAL( 0.25 , transMult.getDirectionProperty( Opm::FaceDir::XPlus )->iget( 999 ));
+    BOOST_CHECK_THROW( transMult.getMultipliers( {1000} , Opm::FaceDir::XPlus , multipliers ) , std::invalid_argument );
+}
+
+
+/*
+  Overlapping faults, applied through the sparse storage (small
+  faults) and the dense storage (a fault covering most of the faces),
+  compared with multiplying the faces one at a time.
+*/
+BOOST_AUTO_TEST_CASE(ApplyMULTFLT) {
+    const size_t nx = 20, ny = 30, nz = 40;
+    for (size_t bigK2 : {2U , 39U}) {
+        auto faults = std::make_shared<Opm::FaultCollection>();
+        std::vector<std::shared_ptr<Opm::Fault> > faultList;
+        faultList.push_back( std::make_shared<Opm::Fault>( "F1" ));
+        faultList.push_back( std::make_shared<Opm::Fault>( "F2" ));
+        faultList.push_back( std::make_shared<Opm::Fault>( "F3" ));
+        faultList[0]->setTransMult( 0.1 );
+        faultList[1]->setTransMult( 0.3 );
+        faultList[2]->setTransMult( 0.7 );
+
+        faultList[0]->addFace( std::make_shared<Opm::FaultFace>( nx , ny , nz , 5 , 5 , 0 , 29 , 0 , 39 , Opm::FaceDir::XPlus ));
+        for (size_t i = 0; i < nx; i++)
+            faultList[1]->addFace( std::make_shared<Opm::FaultFace>( nx , ny , nz , i , i , 0 , 29 , 0 , bigK2 , Opm::FaceDir::XPlus ));
+        faultList[1]->addFace( std::make_shared<Opm::FaultFace>( nx , ny , nz , 0 , 19 , 4 , 4 , 3 , 9 , Opm::FaceDir::YMinus ));
+        faultList[2]->addFace( std::make_shared<Opm::FaultFace>( nx , ny , nz , 5 , 5 , 10 , 12 , 0 , 5 , Opm::FaceDir::XPlus ));
+        for (auto iter = faultList.begin(); iter != faultList.end(); ++iter)
+            faults->addFault( *iter );
+
+        std::vector<double> expectedX( nx*ny*nz , 1.0 );
+        std::vector<double> expectedY( nx*ny*nz , 1.0 );
+        for (auto fault = faultList.begin(); fault != faultList.end(); ++fault)
+            for (auto face = (*fault)->begin(); face != (*fault)->end(); ++face)
+                for (auto cell = (*face)->begin(); cell != (*face)->end(); ++cell) {
+                    std::vector<double>& expected = ((*face)->getDir() == Opm::FaceDir::XPlus) ? expectedX : expectedY;
+                    expected[*cell] *= (*fault)->getTransMult();
+                }
+
+        Opm::TransMult transMult( nx , ny , nz );
+        transMult.applyMULTFLT( faults );
+
+        const bool dense = (bigK2 == 39);
+        BOOST_CHECK_EQUAL( dense , transMult.getDirectionStore( Opm::FaceDir::XPlus ).getStorageType() == Opm::FaceMultiplierStore::Dense );
+        BOOST_CHECK_EQUAL( Opm::FaceMultiplierStore::Sparse , transMult.getDirectionStore( Opm::FaceDir::YMinus ).getStorageType() );
+
+        std::vector<double> multipliers;
+        transMult.getMultipliers( Opm::FaceDir::XPlus , multipliers );
+        BOOST_CHECK( multipliers == expectedX );
+        transMult.getMultipliers( Opm::FaceDir::YMinus , multipliers );
+        BOOST_CHECK( multipliers == expectedY );
+    }
+}
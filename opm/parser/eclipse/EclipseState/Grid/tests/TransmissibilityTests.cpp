@@ -0,0 +1,283 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdexcept>
+#include <iostream>
+#include <boost/filesystem.hpp>
+
+#define BOOST_TEST_MODULE TransmissibilityTests
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+#include <opm/parser/eclipse/Parser/Parser.hpp>
+#include <opm/parser/eclipse/Deck/Deck.hpp>
+#include <opm/parser/eclipse/EclipseState/EclipseState.hpp>
+#include <opm/parser/eclipse/EclipseState/Grid/Transmissibility.hpp>
+
+
+static void createCartesianGrid(size_t nx , size_t ny , size_t nz ,
+                                double dx , double dy , double dz ,
+                                std::vector<double>& coord , std::vector<double>& zcorn) {
+    coord.clear();
+    for (size_t j = 0; j <= ny; j++) {
+        for (size_t i = 0; i <= nx; i++) {
+            const double pillar[6] = { i*dx , j*dy , 0 , i*dx , j*dy , nz*dz };
+            coord.insert( coord.end() , pillar , pillar + 6 );
+        }
+    }
+
+    zcorn.resize( 8*nx*ny*nz );
+    for (size_t k = 0; k < 2*nz; k++)
+        for (size_t c = 0; c < 4*nx*ny; c++)
+            zcorn[k*4*nx*ny + c] = ((k + 1) / 2) * dz;
+}
+
+
+static double harmonic(double t1 , double t2) {
+    return t1 * t2 / (t1 + t2);
+}
+
+
+BOOST_AUTO_TEST_CASE(CartesianGrid) {
+    const size_t nx = 3, ny = 2, nz = 2;
+    const double dx = 1, dy = 2, dz = 5;
+    std::vector<double> coord , zcorn;
+    createCartesianGrid( nx , ny , nz , dx , dy , dz , coord , zcorn );
+
+    std::vector<double> permx( nx*ny*nz );
+    for (size_t g = 0; g < permx.size(); g++)
+        permx[g] = 100 + g;
+    std::vector<int> actnum( nx*ny*nz , 1 );
+    actnum[4] = 0;   // (1,1,0)
+
+    Opm::TransMult transMult( nx , ny , nz );
+    Opm::GridPropertyView<double> permxView( std::make_shared<const std::vector<double> >( permx ));
+    Opm::GridPropertyView<double> permyView( nx*ny*nz , 50.0 );
+    Opm::GridPropertyView<double> permzView( nx*ny*nz , 10.0 );
+    Opm::GridPropertyView<double> ntgView( nx*ny*nz , 0.5 );
+
+    BOOST_CHECK_THROW( Opm::Transmissibility( nx , ny , nz + 1 , coord , zcorn , actnum , permxView , permyView , permzView , ntgView , transMult ) , std::invalid_argument );
+
+    Opm::Transmissibility trans( nx , ny , nz , coord , zcorn , actnum , permxView , permyView , permzView , ntgView , transMult );
+
+    // X: 2*2*2 - 2 connections to the inactive cell; Y: 3*2 - 1; Z: 6 - 1
+    BOOST_CHECK_EQUAL( 6U + 5U + 5U , trans.size() );
+    BOOST_CHECK( std::make_pair( size_t(0) , size_t(6) ) == trans.getConnectionRange( Opm::FaceDir::XPlus ));
+    BOOST_CHECK( std::make_pair( size_t(6) , size_t(11) ) == trans.getConnectionRange( Opm::FaceDir::YPlus ));
+    BOOST_CHECK( std::make_pair( size_t(11) , size_t(16) ) == trans.getConnectionRange( Opm::FaceDir::ZPlus ));
+    BOOST_CHECK_THROW( trans.getConnectionRange( Opm::FaceDir::XMinus ) , std::invalid_argument );
+
+    const std::vector<int>& cell1 = trans.getCell1();
+    const std::vector<int>& cell2 = trans.getCell2();
+    for (size_t n = 0; n < trans.size(); n++) {
+        BOOST_CHECK( actnum[cell1[n]] && actnum[cell2[n]] );
+        if (n > 0 && n != 6 && n != 11)
+            BOOST_CHECK( cell1[n - 1] < cell1[n] );
+    }
+
+    // The half transmissibility of a box is K * NTG * A / (d / 2)
+    BOOST_CHECK_EQUAL( 0 , cell1[0] );
+    BOOST_CHECK_EQUAL( 1 , cell2[0] );
+    BOOST_CHECK_CLOSE( permx[0] * 0.5 * dy*dz / (dx / 2) , trans.getHalfTrans1()[0] , 1e-10 );
+    BOOST_CHECK_CLOSE( permx[1] * 0.5 * dy*dz / (dx / 2) , trans.getHalfTrans2()[0] , 1e-10 );
+    BOOST_CHECK_CLOSE( harmonic( trans.getHalfTrans1()[0] , trans.getHalfTrans2()[0] ) , trans.getTrans()[0] , 1e-10 );
+
+    BOOST_CHECK_EQUAL( 0 , cell1[6] );
+    BOOST_CHECK_EQUAL( 3 , cell2[6] );
+    BOOST_CHECK_CLOSE( 50.0 * 0.5 * dx*dz / (dy / 2) / 2 , trans.getTrans()[6] , 1e-10 );
+
+    // NTG does not apply in the Z direction
+    BOOST_CHECK_EQUAL( 0 , cell1[11] );
+    BOOST_CHECK_EQUAL( 6 , cell2[11] );
+    BOOST_CHECK_CLOSE( 10.0 * dx*dy / (dz / 2) / 2 , trans.getTrans()[11] , 1e-10 );
+
+    // The multipliers on both sides of the face are applied
+    Opm::TransMult multiplied( nx , ny , nz );
+    std::shared_ptr<Opm::GridProperty<double> > multx = std::make_shared<Opm::GridProperty<double> >( nx , ny , nz , Opm::GridPropertySupportedKeywordInfo<double>( "MULTX" , 1.0 , "1" ));
+    std::shared_ptr<Opm::GridProperty<double> > multxMinus = std::make_shared<Opm::GridProperty<double> >( nx , ny , nz , Opm::GridPropertySupportedKeywordInfo<double>( "MULTX-" , 1.0 , "1" ));
+    multx->setScalar( 0.5 , std::make_shared<const Opm::Box>( Opm::Box( nx , ny , nz ) , 0 , 0 , 0 , 0 , 0 , 0 ));
+    multxMinus->setScalar( 0.1 , std::make_shared<const Opm::Box>( Opm::Box( nx , ny , nz ) , 1 , 1 , 0 , 0 , 0 , 0 ));
+    multiplied.applyMULT( multx , Opm::FaceDir::XPlus );
+    multiplied.applyMULT( multxMinus , Opm::FaceDir::XMinus );
+
+    Opm::Transmissibility multTrans( nx , ny , nz , coord , zcorn , actnum , permxView , permyView , permzView , ntgView , multiplied );
+    BOOST_CHECK_CLOSE( 0.5 * 0.1 * trans.getTrans()[0] , multTrans.getTrans()[0] , 1e-10 );
+    BOOST_CHECK_EQUAL( trans.getTrans()[1] , multTrans.getTrans()[1] );
+    BOOST_CHECK_EQUAL( trans.getHalfTrans1()[0] , multTrans.getHalfTrans1()[0] );
+}
+
+
+BOOST_AUTO_TEST_CASE(FaultedGrid) {
+    const double dx = 10, dy = 20, dz = 10;
+    const double perm = 100;
+    Opm::GridPropertyView<double> permView( 2 , perm );
+    Opm::GridPropertyView<double> ntgView( 2 , 1.0 );
+    Opm::TransMult transMult( 2 , 1 , 1 );
+    std::vector<double> coord , zcorn;
+
+    // X: the second cell is moved down by half its thickness, so half
+    // of either face connects the cells.
+    createCartesianGrid( 2 , 1 , 1 , dx , dy , dz , coord , zcorn );
+    for (size_t z : {2 , 3 , 6 , 7 , 10 , 11 , 14 , 15})
+        zcorn[z] += 0.5 * dz;
+    {
+        Opm::Transmissibility trans( 2 , 1 , 1 , coord , zcorn , std::vector<int>() , permView , permView , permView , ntgView , transMult );
+        BOOST_CHECK_EQUAL( 1U , trans.size() );
+        BOOST_CHECK_CLOSE( 0.5 * perm * dy*dz / (dx / 2) , trans.getHalfTrans1()[0] , 1e-10 );
+        BOOST_CHECK_CLOSE( 0.5 * perm * dy*dz / (dx / 2) , trans.getHalfTrans2()[0] , 1e-10 );
+        BOOST_CHECK_CLOSE( 0.25 * perm * dy*dz / (dx / 2) , trans.getTrans()[0] , 1e-10 );
+    }
+
+    // Y: the throw grows from zero on the first pillar to 1.5 times
+    // the thickness on the second; the faces overlap in a triangle
+    // covering a third of either face.
+    createCartesianGrid( 1 , 2 , 1 , dx , dy , dz , coord , zcorn );
+    for (size_t z : {5 , 7 , 13 , 15})
+        zcorn[z] += 1.5 * dz;
+    {
+        Opm::Transmissibility trans( 1 , 2 , 1 , coord , zcorn , std::vector<int>() , permView , permView , permView , ntgView , transMult );
+        BOOST_CHECK_EQUAL( 1U , trans.size() );
+        BOOST_CHECK_CLOSE( perm * dx*dz / (dy / 2) / 3 , trans.getHalfTrans1()[0] , 1e-10 );
+        BOOST_CHECK_CLOSE( 0.5 * perm * dx*dz / (dy / 2) / 3 , trans.getTrans()[0] , 1e-10 );
+    }
+
+    // no overlap, no flow
+    createCartesianGrid( 2 , 1 , 1 , dx , dy , dz , coord , zcorn );
+    for (size_t z : {2 , 3 , 6 , 7 , 10 , 11 , 14 , 15})
+        zcorn[z] += 2 * dz;
+    {
+        Opm::Transmissibility trans( 2 , 1 , 1 , coord , zcorn , std::vector<int>() , permView , permView , permView , ntgView , transMult );
+        BOOST_CHECK_EQUAL( 0.0 , trans.getTrans()[0] );
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(LargeGrid) {
+    // Large enough for the parallel code path
+    const size_t nx = 40, ny = 40, nz = 45;
+    const double dx = 10, dy = 20, dz = 2;
+    std::vector<double> coord , zcorn;
+    createCartesianGrid( nx , ny , nz , dx , dy , dz , coord , zcorn );
+
+    std::vector<int> actnum( nx*ny*nz );
+    for (size_t g = 0; g < actnum.size(); g++)
+        actnum[g] = (g % 7) != 3;
+
+    Opm::TransMult transMult( nx , ny , nz );
+    const size_t numCells = nx*ny*nz;
+    Opm::GridPropertyView<double> perm( numCells , 1.0 );
+    Opm::Transmissibility trans( nx , ny , nz , coord , zcorn , actnum , perm , perm , perm , perm , transMult );
+
+    const size_t stride[3] = { 1 , nx , nx*ny };
+    const double reference[3] = { harmonic( dy*dz / (dx / 2) , dy*dz / (dx / 2)) ,
+                                  harmonic( dx*dz / (dy / 2) , dx*dz / (dy / 2)) ,
+                                  harmonic( dx*dy / (dz / 2) , dx*dy / (dz / 2)) };
+    const Opm::FaceDir::DirEnum directions[3] = { Opm::FaceDir::XPlus , Opm::FaceDir::YPlus , Opm::FaceDir::ZPlus };
+
+    size_t n = 0;
+    for (int d = 0; d < 3; d++) {
+        BOOST_CHECK_EQUAL( n , trans.getConnectionRange( directions[d] ).first );
+        for (size_t g = 0; g < numCells; g++) {
+            const size_t ijk[3] = { g % nx , (g / nx) % ny , g / (nx*ny) };
+            const size_t dims[3] = { nx , ny , nz };
+            if (!actnum[g] || ijk[d] + 1 == dims[d] || !actnum[g + stride[d]])
+                continue;
+
+            BOOST_REQUIRE( n < trans.size() );
+            BOOST_CHECK_EQUAL( static_cast<int>(g) , trans.getCell1()[n] );
+            BOOST_CHECK_EQUAL( static_cast<int>(g + stride[d]) , trans.getCell2()[n] );
+            BOOST_CHECK_CLOSE( reference[d] , trans.getTrans()[n] , 1e-8 );
+            n++;
+        }
+        BOOST_CHECK_EQUAL( n , trans.getConnectionRange( directions[d] ).second );
+    }
+    BOOST_CHECK_EQUAL( n , trans.size() );
+}
+
+
+static Opm::DeckPtr createDeck(bool withPerm) {
+    std::string deckData =
+        "RUNSPEC\n"
+        "\n"
+        "DIMENS\n"
+        " 3 2 2 /\n"
+        "GRID\n"
+        "DXV\n"
+        "3*10 /\n"
+        "DYV\n"
+        "2*20 /\n"
+        "DZV\n"
+        "2*5 /\n"
+        "DEPTHZ\n"
+        "12*1000 /\n";
+    if (withPerm)
+        deckData +=
+            "PERMX\n"
+            "12*100 /\n"
+            "PERMY\n"
+            "12*100 /\n"
+            "PERMZ\n"
+            "12*10 /\n"
+            "MULTX\n"
+            "12*0.5 /\n";
+    deckData += "EDIT\n\n";
+
+    Opm::ParserPtr parser(new Opm::Parser());
+    return parser->parseString(deckData) ;
+}
+
+
+BOOST_AUTO_TEST_CASE(EclipseStateTransmissibility) {
+    Opm::EclipseState state( createDeck( true ));
+    std::shared_ptr<const Opm::Transmissibility> trans = state.getTransmissibility();
+    BOOST_CHECK_EQUAL( trans.get() , state.getTransmissibility().get() );
+    BOOST_CHECK_EQUAL( 8U + 6U + 6U , trans->size() );
+
+    // PERMX is converted to SI units
+    const double permx = state.getDoubleGridProperty("PERMX")->iget(0);
+    BOOST_CHECK_CLOSE( 100 * 9.869233e-16 , permx , 1e-3 );
+    BOOST_CHECK_CLOSE( 0.5 * harmonic( permx * 20*5 / 5 , permx * 20*5 / 5 ) , trans->getTrans()[0] , 1e-10 );
+
+    const double permz = state.getDoubleGridProperty("PERMZ")->iget(0);
+    const size_t zBegin = trans->getConnectionRange( Opm::FaceDir::ZPlus ).first;
+    BOOST_CHECK_CLOSE( harmonic( permz * 10*20 / 2.5 , permz * 10*20 / 2.5 ) , trans->getTrans()[zBegin] , 1e-10 );
+
+    // no NNCs in a Cartesian grid
+    std::shared_ptr<const Opm::CellAdjacency> graph = state.getCellAdjacency();
+    BOOST_CHECK_EQUAL( 12U , graph->numVertices() );
+    BOOST_CHECK_EQUAL( trans->size() , graph->numEdges() );
+    BOOST_CHECK_EQUAL( graph.get() , state.getCellAdjacency().get() );
+
+    // Modifying a property computes the transmissibilities and the graph again.
+    state.getDoubleGridProperty("PERMX")->multiplyValueAtIndex( 1 , 0.5 );
+    std::shared_ptr<const Opm::Transmissibility> modifiedTrans = state.getTransmissibility();
+    BOOST_CHECK( modifiedTrans.get() != trans.get() );
+    BOOST_CHECK_CLOSE( 0.5 * harmonic( permx * 20*5 / 5 , 0.5 * permx * 20*5 / 5 ) , modifiedTrans->getTrans()[0] , 1e-10 );
+    BOOST_CHECK( state.getCellAdjacency().get() != graph.get() );
+    BOOST_CHECK_EQUAL( modifiedTrans->getTrans()[0] , state.getCellAdjacency()->getWeights()[0] );
+
+    // NTG defaults to one without being created; adding it computes
+    // the transmissibilities again.
+    BOOST_CHECK( !state.hasDoubleGridProperty("NTG") );
+    state.getDoubleGridProperty("NTG")->multiplyValueAtIndex( 0 , 0.5 );
+    BOOST_CHECK_CLOSE( 0.5 * harmonic( 0.5 * permx * 20*5 / 5 , 0.5 * permx * 20*5 / 5 ) , state.getTransmissibility()->getTrans()[0] , 1e-10 );
+
+    Opm::EclipseState noPerm( createDeck( false ));
+    BOOST_CHECK_THROW( noPerm.getTransmissibility() , std::invalid_argument );
+}
@@ -108,27 +108,26 @@ namespace Opm {
     }
 
     const std::map<std::string , boost::gregorian::greg_month>& TimeMap::eclipseMonthNames() {
-        static std::map<std::string , boost::gregorian::greg_month> monthNames;
-
-        if (monthNames.size() == 0) {
-            monthNames.insert( std::make_pair( "JAN" , boost::gregorian::Jan ));
-            monthNames.insert( std::make_pair( "FEB" , boost::gregorian::Feb ));
-            monthNames.insert( std::make_pair( "MAR" , boost::gregorian::Mar ));
-            monthNames.insert( std::make_pair( "APR" , boost::gregorian::Apr ));
-            monthNames.insert( std::make_pair( "MAI" , boost::gregorian::May ));
-            monthNames.insert( std::make_pair( "MAY" , boost::gregorian::May ));
-            monthNames.insert( std::make_pair( "JUN" , boost::gregorian::Jun ));
-            monthNames.insert( std::make_pair( "JUL" , boost::gregorian::Jul ));
-            monthNames.insert( std::make_pair( "JLY" , boost::gregorian::Jul ));
-            monthNames.insert( std::make_pair( "AUG" , boost::gregorian::Aug ));
-            monthNames.insert( std::make_pair( "SEP" , boost::gregorian::Sep ));
-            monthNames.insert( std::make_pair( "OCT" , boost::gregorian::Oct ));
-            monthNames.insert( std::make_pair( "OKT" , boost::gregorian::Oct ));
-            monthNames.insert( std::make_pair( "NOV" , boost::gregorian::Nov ));
-            monthNames.insert( std::make_pair( "DEC" , boost::gregorian::Dec ));
-            monthNames.insert( std::make_pair( "DES" , boost::gregorian::Dec ));
-        }
-        
+        // initialized once in a thread safe manner; schedules may be
+        // created concurrently.
+        static const std::map<std::string , boost::gregorian::greg_month> monthNames =
+            {{ "JAN" , boost::gregorian::Jan },
+             { "FEB" , boost::gregorian::Feb },
+             { "MAR" , boost::gregorian::Mar },
+             { "APR" , boost::gregorian::Apr },
+             { "MAI" , boost::gregorian::May },
+             { "MAY" , boost::gregorian::May },
+             { "JUN" , boost::gregorian::Jun },
+             { "JUL" , boost::gregorian::Jul },
+             { "JLY" , boost::gregorian::Jul },
+             { "AUG" , boost::gregorian::Aug },
+             { "SEP" , boost::gregorian::Sep },
+             { "OCT" , boost::gregorian::Oct },
+             { "OKT" , boost::gregorian::Oct },
+             { "NOV" , boost::gregorian::Nov },
+             { "DEC" , boost::gregorian::Dec },
+             { "DES" , boost::gregorian::Dec }};
+
         return monthNames;
     }
 
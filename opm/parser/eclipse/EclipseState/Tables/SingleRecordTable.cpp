@@ -17,6 +17,10 @@
   along with OPM.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <opm/parser/eclipse/EclipseState/Tables/SingleRecordTable.hpp>
+#include <opm/parser/eclipse/EclipseState/Util/Parallel.hpp>
+
+#include <algorithm>
+#include <functional>
 
 namespace Opm {
 size_t SingleRecordTable::numTables(Opm::DeckKeywordConstPtr keyword)
@@ -125,6 +129,53 @@ double SingleRecordTable::evaluate(const std::string& columnName, double xPos) c
     return yColumn[intervalIdx]*(1-alpha) + yColumn[intervalIdx + 1]*alpha;
 }
 
+void SingleRecordTable::evaluate(const std::string& columnName,
+                                 const std::vector<double>& xPos,
+                                 std::vector<double>& result) const
+{
+    const std::vector<double>& xColumn = getColumn(0);
+    const std::vector<double>& yColumn = getColumn(columnName);
+    const long numPositions = static_cast<long>(xPos.size());
+    result.resize(xPos.size());
+
+    const double* x = xColumn.data();
+    const double* y = yColumn.data();
+    const size_t numRows = xColumn.size();
+    const bool isDescending = (xColumn.front() > xColumn.back());
+    const double xMin = std::min(xColumn.front(), xColumn.back());
+    const double xMax = std::max(xColumn.front(), xColumn.back());
+    const double yMin = isDescending ? yColumn.back() : yColumn.front();
+    const double yMax = isDescending ? yColumn.front() : yColumn.back();
+
+    // the positions are independent; this is only worth the threads for
+    // large batches.
+#pragma omp parallel for schedule(static) if (static_cast<size_t>(numPositions) >= parallelThreshold)
+    for (long posIdx = 0; posIdx < numPositions; ++posIdx) {
+        const double pos = xPos[posIdx];
+
+        // handle the constant interpolation cases
+        if (pos < xMin || numRows == 1) {
+            result[posIdx] = yMin;
+            continue;
+        }
+        else if (xMax < pos) {
+            result[posIdx] = yMax;
+            continue;
+        }
+
+        // any interval which contains the position gives the same value
+        size_t intervalIdx;
+        if (isDescending)
+            intervalIdx = std::upper_bound(x, x + numRows, pos, std::greater<double>()) - x;
+        else
+            intervalIdx = std::upper_bound(x, x + numRows, pos) - x;
+        intervalIdx = std::min(std::max(intervalIdx, size_t(1)), numRows - 1) - 1;
+
+        double alpha = (pos - x[intervalIdx])/(x[intervalIdx + 1] - x[intervalIdx]);
+        result[posIdx] = y[intervalIdx]*(1-alpha) + y[intervalIdx + 1]*alpha;
+    }
+}
+
 void SingleRecordTable::checkNonDefaultable(const std::string& columnName)
 {
     int columnIdx = m_columnNames.at(columnName);
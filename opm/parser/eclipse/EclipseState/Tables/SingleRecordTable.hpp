@@ -75,6 +75,17 @@ namespace Opm {
          * X coordinate.
          */
         double evaluate(const std::string& columnName, double xPos) const;
+
+        /*!
+         * \brief Evaluate a column of the table at many positions.
+         *
+         * The result is identical to calling evaluate() for each position, but the
+         * column is only looked up once and large batches are evaluated in
+         * parallel.
+         */
+        void evaluate(const std::string& columnName,
+                      const std::vector<double>& xPos,
+                      std::vector<double>& result) const;
     protected:
         void checkNonDefaultable(const std::string& columnName);
         void checkMonotonic(const std::string& columnName,
@@ -75,6 +75,43 @@ BOOST_AUTO_TEST_CASE(CreateSingleRecordTable) {
                                  /*firstEntryOffset=*/0);
 }
 
+BOOST_AUTO_TEST_CASE(EvaluateSingleRecordTableBatch) {
+    const char *deckData =
+        "TABDIMS\n"
+        " 2 /\n"
+        "\n"
+        "SWOF\n"
+        " 1 2 3 4\n"
+        " 5 6 7 8\n"
+        " 9 10 15 12 /\n"
+        " 9 10 11 12\n"
+        " 5 6 7 8\n"
+        " 1 2 3 4 /\n";
+
+    Opm::ParserPtr parser(new Opm::Parser);
+    Opm::DeckConstPtr deck(parser->parseString(deckData));
+    std::vector<std::string> columnNames{"A", "B", "C", "D"};
+
+    // an ascending and a descending table
+    for (size_t recordIdx = 0; recordIdx < 2; ++recordIdx) {
+        Opm::SingleRecordTable table;
+        table.initFORUNITTESTONLY(deck->getKeyword("SWOF"),
+                                  columnNames,
+                                  recordIdx,
+                                  /*firstEntryOffset=*/0);
+
+        std::vector<double> xPos;
+        for (int i = -4; i < 60; ++i)
+            xPos.push_back(0.2*i);
+
+        std::vector<double> result;
+        table.evaluate("C", xPos, result);
+        BOOST_CHECK_EQUAL(xPos.size(), result.size());
+        for (size_t i = 0; i < xPos.size(); ++i)
+            BOOST_CHECK_CLOSE(table.evaluate("C", xPos[i]), result[i], 1e-12);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(CreateMultiTable) {
     const char *deckData =
         "TABDIMS\n"
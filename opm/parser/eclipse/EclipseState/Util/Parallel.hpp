@@ -0,0 +1,36 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OPM_PARALLEL_HPP
+#define OPM_PARALLEL_HPP
+
+#include <cstddef>
+
+namespace Opm {
+
+    /*
+      The OpenMP loops over cells, faces and connections only fork
+      threads when they have at least this many iterations; for
+      smaller loops starting the thread team costs more than the work
+      it saves, and the loop runs in the calling thread.
+    */
+    const std::size_t parallelThreshold = 1 << 16;
+}
+
+#endif
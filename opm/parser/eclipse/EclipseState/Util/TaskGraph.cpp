@@ -0,0 +1,100 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <future>
+#include <stdexcept>
+
+#include <opm/parser/eclipse/EclipseState/Util/TaskGraph.hpp>
+
+namespace Opm {
+
+    void TaskGraph::addTask(const std::string& name,
+                            std::function<void()> task,
+                            const std::vector<std::string>& dependencies) {
+        if (hasTask(name))
+            throw std::invalid_argument("The task: " + name + " has already been added");
+
+        Task newTask;
+        newTask.name = name;
+        newTask.function = task;
+        for (auto iter = dependencies.begin(); iter != dependencies.end(); ++iter) {
+            auto indexIter = m_taskIndex.find( *iter );
+            if (indexIter == m_taskIndex.end())
+                throw std::invalid_argument("The task: " + name + " depends on the unknown task: " + *iter);
+
+            newTask.dependencies.push_back( indexIter->second );
+        }
+
+        m_taskIndex[name] = m_tasks.size();
+        m_tasks.push_back( newTask );
+    }
+
+
+    bool TaskGraph::hasTask(const std::string& name) const {
+        return m_taskIndex.count( name ) > 0;
+    }
+
+
+    size_t TaskGraph::size() const {
+        return m_tasks.size();
+    }
+
+
+    void TaskGraph::run(bool parallel) const {
+        if (parallel)
+            runParallel();
+        else
+            runSequential();
+    }
+
+
+    void TaskGraph::runSequential() const {
+        for (auto iter = m_tasks.begin(); iter != m_tasks.end(); ++iter)
+            iter->function();
+    }
+
+
+    void TaskGraph::runParallel() const {
+        std::vector<std::shared_future<void> > futures;
+        futures.reserve( m_tasks.size() );
+
+        for (auto iter = m_tasks.begin(); iter != m_tasks.end(); ++iter) {
+            const Task& task = *iter;
+            std::vector<std::shared_future<void> > dependencies;
+            for (auto depIter = task.dependencies.begin(); depIter != task.dependencies.end(); ++depIter)
+                dependencies.push_back( futures[*depIter] );
+
+            futures.push_back( std::async( std::launch::async , [&task , dependencies]() {
+                        // get() will rethrow if one of the dependencies failed.
+                        for (auto depIter = dependencies.begin(); depIter != dependencies.end(); ++depIter)
+                            depIter->get();
+
+                        task.function();
+                    }).share());
+        }
+
+        // All tasks must have completed before we leave this scope; the
+        // tasks keep references into m_tasks.
+        for (auto iter = futures.begin(); iter != futures.end(); ++iter)
+            iter->wait();
+
+        for (auto iter = futures.begin(); iter != futures.end(); ++iter)
+            iter->get();
+    }
+}
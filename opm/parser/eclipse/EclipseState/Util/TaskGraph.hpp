@@ -0,0 +1,71 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TASK_GRAPH_HPP
+#define TASK_GRAPH_HPP
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+/*
+  The TaskGraph class keeps a list of named tasks along with the
+  names of the tasks they depend on. A task can only depend on tasks
+  which have already been added, i.e. the insertion order is always a
+  valid sequential execution order and the graph can not contain
+  cycles.
+
+  When run in parallel every task is started asynchronously and waits
+  for the tasks it depends on before it starts doing work; tasks
+  without a mutual dependency will therefore overlap. An exception
+  thrown by a task is propagated to all the tasks depending on it, and
+  finally rethrown from run() - after all the started tasks have
+  completed.
+*/
+
+namespace Opm {
+
+    class TaskGraph {
+    public:
+        void addTask(const std::string& name,
+                     std::function<void()> task,
+                     const std::vector<std::string>& dependencies = std::vector<std::string>());
+
+        bool hasTask(const std::string& name) const;
+        size_t size() const;
+        void run(bool parallel) const;
+
+    private:
+        struct Task {
+            std::string name;
+            std::function<void()> function;
+            std::vector<size_t> dependencies;
+        };
+
+        void runSequential() const;
+        void runParallel() const;
+
+        std::vector<Task> m_tasks;
+        std::map<std::string , size_t> m_taskIndex;
+    };
+}
+
+#endif
@@ -0,0 +1,98 @@
+/*
+  Copyright 2014 Statoil ASA.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdexcept>
+#include <iostream>
+#include <mutex>
+#include <vector>
+#include <string>
+
+#define BOOST_TEST_MODULE TASKGRAPHTESTS
+#include <boost/test/unit_test.hpp>
+
+#include <opm/parser/eclipse/EclipseState/Util/TaskGraph.hpp>
+
+
+BOOST_AUTO_TEST_CASE( check_add_task ) {
+    Opm::TaskGraph graph;
+
+    graph.addTask("A" , []() {});
+    graph.addTask("B" , []() {} , {"A"});
+
+    BOOST_CHECK_EQUAL( 2U , graph.size() );
+    BOOST_CHECK( graph.hasTask("A") );
+    BOOST_CHECK( !graph.hasTask("C") );
+
+    BOOST_CHECK_THROW( graph.addTask("A" , []() {}) , std::invalid_argument );
+    BOOST_CHECK_THROW( graph.addTask("C" , []() {} , {"D"}) , std::invalid_argument );
+}
+
+
+BOOST_AUTO_TEST_CASE( check_sequential_order ) {
+    Opm::TaskGraph graph;
+    std::vector<std::string> order;
+
+    graph.addTask("A" , [&order]() { order.push_back("A"); });
+    graph.addTask("B" , [&order]() { order.push_back("B"); });
+    graph.addTask("C" , [&order]() { order.push_back("C"); } , {"A" , "B"});
+    graph.run( false );
+
+    BOOST_CHECK_EQUAL( 3U , order.size() );
+    BOOST_CHECK_EQUAL( "A" , order[0] );
+    BOOST_CHECK_EQUAL( "B" , order[1] );
+    BOOST_CHECK_EQUAL( "C" , order[2] );
+}
+
+
+BOOST_AUTO_TEST_CASE( check_parallel_dependencies ) {
+    for (int iter = 0; iter < 20; iter++) {
+        Opm::TaskGraph graph;
+        std::mutex mutex;
+        std::vector<std::string> order;
+        auto record = [&mutex , &order](const std::string& name) {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back( name );
+        };
+
+        graph.addTask("A" , [&record]() { record("A"); });
+        graph.addTask("B" , [&record]() { record("B"); });
+        graph.addTask("C" , [&record]() { record("C"); } , {"A" , "B"});
+        graph.addTask("D" , [&record]() { record("D"); } , {"C"});
+        graph.run( true );
+
+        BOOST_CHECK_EQUAL( 4U , order.size() );
+        BOOST_CHECK_EQUAL( "C" , order[2] );
+        BOOST_CHECK_EQUAL( "D" , order[3] );
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( check_parallel_exception ) {
+    Opm::TaskGraph graph;
+    bool dependentRun = false;
+    bool independentRun = false;
+
+    graph.addTask("A" , []() { throw std::invalid_argument("Failed"); });
+    graph.addTask("B" , [&independentRun]() { independentRun = true; });
+    graph.addTask("C" , [&dependentRun]() { dependentRun = true; } , {"A"});
+
+    BOOST_CHECK_THROW( graph.run( true ) , std::invalid_argument );
+    BOOST_CHECK( independentRun );
+    BOOST_CHECK( !dependentRun );
+}
@@ -19,6 +19,7 @@
 
 #include <stdexcept>
 #include <iostream>
+#include <future>
 #include <boost/filesystem.hpp>
 
 #define BOOST_TEST_MODULE EclipseStateTests
@@ -172,7 +173,7 @@ BOOST_AUTO_TEST_CASE(PropertiesNotSupportedThrows) {
     EclipseState state(deck, /*beStrict=*/false);
     DeckKeywordConstPtr swat = deck->getKeyword("SWAT");
     BOOST_CHECK_EQUAL( false , state.supportsGridProperty("SWAT"));
-    BOOST_CHECK_THROW( state.loadGridPropertyFromDeckKeyword( std::make_shared<const Box>(10,10,10) , swat ) , std::invalid_argument)
+    BOOST_CHECK_THROW( state.loadGridPropertyFromDeckKeyword( std::make_shared<const Box>(10,10,10) , swat ) , std::invalid_argument);
 }
 
 
@@ -264,3 +265,114 @@ BOOST_AUTO_TEST_CASE(FaceTransMults) {
         }
     }
 }
+
+
+BOOST_AUTO_TEST_CASE(ParallelInit) {
+    DeckPtr deck = createDeck();
+    EclipseState sequentialState(deck, /*beStrict=*/false, /*parallelInit=*/false);
+    EclipseState parallelState(deck, /*beStrict=*/false, /*parallelInit=*/true);
+
+    BOOST_CHECK( sequentialState.getEclipseGrid()->equal( *parallelState.getEclipseGrid() ));
+    BOOST_CHECK_EQUAL( sequentialState.getTitle() , parallelState.getTitle() );
+    BOOST_CHECK_EQUAL( sequentialState.hasPhase( Phase::PhaseEnum::GAS ) , parallelState.hasPhase( Phase::PhaseEnum::GAS ));
+    BOOST_CHECK_EQUAL( sequentialState.getSchedule()->getStartTime() , parallelState.getSchedule()->getStartTime());
+
+    {
+        const auto& satnum1 = sequentialState.getIntGridProperty("SATNUM")->getData();
+        const auto& satnum2 = parallelState.getIntGridProperty("SATNUM")->getData();
+        BOOST_CHECK_EQUAL_COLLECTIONS( satnum1.begin() , satnum1.end() , satnum2.begin() , satnum2.end());
+    }
+
+    {
+        std::shared_ptr<const TransMult> transMult1 = sequentialState.getTransMult();
+        std::shared_ptr<const TransMult> transMult2 = parallelState.getTransMult();
+        for (size_t g = 0; g < 1000; g++) {
+            BOOST_CHECK_EQUAL( transMult1->getMultiplier(g , FaceDir::XPlus)  , transMult2->getMultiplier(g , FaceDir::XPlus));
+            BOOST_CHECK_EQUAL( transMult1->getMultiplier(g , FaceDir::XMinus) , transMult2->getMultiplier(g , FaceDir::XMinus));
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(ParallelInitPropagatesErrors) {
+    const char *deckData =
+        "RUNSPEC\n"
+        "\n"
+        "DIMENS\n"
+        " 10 10 10 /\n"
+        "GRID\n"
+        "DX\n"
+        "1000*0.25 /\n"
+        "DYV\n"
+        "10*0.25 /\n"
+        "DZ\n"
+        "1000*0.25 /\n"
+        "TOPS\n"
+        "1000*0.25 /\n"
+        "EDIT\n"
+        "MULTIPLY\n"
+        "  'NOT_A_PROPERTY' 2.0 /\n"
+        "/\n"
+        "\n";
+
+    ParserPtr parser(new Parser());
+    DeckPtr deck = parser->parseString(deckData) ;
+    BOOST_CHECK_THROW( EclipseState(deck, /*beStrict=*/false, /*parallelInit=*/true) , std::invalid_argument );
+}
+
+
+static DeckPtr createDeckWithConnateWater(double swl) {
+    const std::string deckData =
+        "RUNSPEC\n"
+        "\n"
+        "TABDIMS\n"
+        "1 /\n"
+        "DIMENS\n"
+        " 2 2 2 /\n"
+        "GRID\n"
+        "DX\n"
+        "8*0.25 /\n"
+        "DY\n"
+        "8*0.25 /\n"
+        "DZ\n"
+        "8*0.25 /\n"
+        "TOPS\n"
+        "4*0.25 /\n"
+        "PROPS\n"
+        "SWOF\n"
+        "  " + std::to_string(swl) + "  0      1.0    2.0\n"
+        "  0.93  0.91   0.0    0.0\n"
+        "/\n"
+        "SGOF\n"
+        "  0.00  0.01   0.9    2.0\n"
+        "  0.80  1.00   0.0    0.0\n"
+        "/\n"
+        "\n";
+
+    ParserPtr parser(new Parser());
+    return parser->parseString(deckData) ;
+}
+
+
+BOOST_AUTO_TEST_CASE(ConcurrentMultiDeck) {
+    const size_t numStates = 8;
+    std::vector<DeckPtr> decks;
+    for (size_t i = 0; i < numStates; i++)
+        decks.push_back( createDeckWithConnateWater( 0.01 * (i + 1) ));
+
+    std::vector<std::future<std::shared_ptr<EclipseState> > > futures;
+    for (size_t i = 0; i < numStates; i++) {
+        DeckPtr deck = decks[i];
+        futures.push_back( std::async( std::launch::async , [deck]() {
+                    return std::make_shared<EclipseState>( deck );
+                }));
+    }
+
+    for (size_t i = 0; i < numStates; i++) {
+        std::shared_ptr<EclipseState> state = futures[i].get();
+        const auto& swl = state->getDoubleGridProperty("SWL")->getData();
+        BOOST_CHECK_EQUAL( swl.size() , 8U );
+        for (size_t g = 0; g < swl.size(); g++)
+            BOOST_CHECK_CLOSE( swl[g] , 0.01 * (i + 1) , 1e-8 );
+    }
+}